@@ -22,14 +22,20 @@ class IBindMap
     IBindMap &operator=( IBindMap && ) noexcept = default;
 
   public:
-    void BindAction( const AbInputBind &ib, void *pThis, AbAction a, AbMouseAction ma )
+    /**
+     * @param pOwner - object that controls the life time of the bind, all binds of an owner are removed together
+     */
+    void BindAction( const AbInputBind &ib, const void *pOwner, void *pThis, AbAction a, AbMouseAction ma )
     {
-        static_cast<Map *>( this )->BindActionImpl( ib, pThis, a, ma );
+        static_cast<Map *>( this )->BindActionImpl( ib, pOwner, pThis, a, ma );
     }
 
-    void UnbindAction( const AbInputBind &ib, void *pThis )
+    /**
+     * @brief Removes every bind of the owner in a single pass, O(binds).
+     */
+    void UnbindOwner( const void *pOwner )
     {
-        static_cast<Map *>( this )->UnbindActionImpl( ib, pThis );
+        static_cast<Map *>( this )->UnbindOwnerImpl( pOwner );
     }
 };
 
@@ -0,0 +1,208 @@
+#include "B33Core.h"
+
+#include "Input/InputRecording.hpp"
+
+namespace B33::App
+{
+
+using namespace ::std;
+using namespace ::B33::Core::Debug;
+
+// The layout of AbInputStruct is written as is, the header guards against replaying a stream
+// recorded by a build with a different layout
+static constexpr char     RecordingMagic[ 4 ] = { 'B', '3', '3', 'I' };
+static constexpr uint32_t RecordingVersion    = 1;
+
+struct RecordingHeader
+{
+    char     Magic[ 4 ];
+    uint32_t uVersion;
+    uint32_t uEventSize;
+};
+
+struct RecordedFrameHeader
+{
+    float    fDelta;
+    uint32_t uEventCount;
+    uint64_t uFrameEnd;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+InputRecorder::InputRecorder()
+  : m_File()
+  , m_uFrames( 0 )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+InputRecorder::~InputRecorder()
+{
+    Close();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InputRecorder::Open( const filesystem::path &path )
+{
+    Close();
+
+    m_File.open( path, ios::binary | ios::trunc );
+    if ( !m_File.is_open() )
+    {
+        B33_LOG( Error, L"Couldn't create the input recording. [Path: %ls]", path.wstring().c_str() );
+        return false;
+    }
+
+    RecordingHeader header = {};
+    memcpy( header.Magic, RecordingMagic, sizeof( header.Magic ) );
+    header.uVersion   = RecordingVersion;
+    header.uEventSize = sizeof( AbInputStruct );
+
+    m_File.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    m_uFrames = 0;
+
+    B33_LOG( Info, L"Recording input. [Path: %ls]", path.wstring().c_str() );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void InputRecorder::Close()
+{
+    if ( !m_File.is_open() )
+    {
+        return;
+    }
+
+    m_File.close();
+    B33_LOG( Info, L"Input recording closed. [Frames: %u]", m_uFrames );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InputRecorder::IsOpen() const
+{
+    return m_File.is_open();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void InputRecorder::WriteFrame( float fDelta, uint64_t uFrameEnd, const vector<AbInputStruct> &vEvents )
+{
+    B33_ASSERT( m_File.is_open() );
+
+    RecordedFrameHeader frame = {};
+    frame.fDelta              = fDelta;
+    frame.uEventCount         = static_cast<uint32_t>( vEvents.size() );
+    frame.uFrameEnd           = uFrameEnd;
+
+    m_File.write( reinterpret_cast<const char *>( &frame ), sizeof( frame ) );
+    m_File.write( reinterpret_cast<const char *>( vEvents.data() ), sizeof( AbInputStruct ) * vEvents.size() );
+
+    ++m_uFrames;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+InputReplayer::InputReplayer()
+  : m_File()
+  , m_uFrames( 0 )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+InputReplayer::~InputReplayer()
+{
+    Close();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InputReplayer::Open( const filesystem::path &path )
+{
+    Close();
+
+    m_File.open( path, ios::binary );
+    if ( !m_File.is_open() )
+    {
+        B33_LOG( Error, L"Couldn't open the input recording. [Path: %ls]", path.wstring().c_str() );
+        return false;
+    }
+
+    RecordingHeader header = {};
+    m_File.read( reinterpret_cast<char *>( &header ), sizeof( header ) );
+
+    if ( !m_File || memcmp( header.Magic, RecordingMagic, sizeof( header.Magic ) ) != 0 ||
+         header.uVersion != RecordingVersion || header.uEventSize != sizeof( AbInputStruct ) )
+    {
+        B33_LOG( Error, L"File isn't a compatible input recording. [Path: %ls]", path.wstring().c_str() );
+        m_File.close();
+        return false;
+    }
+
+    m_uFrames = 0;
+
+    B33_LOG( Info, L"Replaying input. [Path: %ls]", path.wstring().c_str() );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void InputReplayer::Close()
+{
+    if ( !m_File.is_open() )
+    {
+        return;
+    }
+
+    m_File.close();
+    B33_LOG( Info, L"Input replay closed. [Frames: %u]", m_uFrames );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InputReplayer::IsOpen() const
+{
+    return m_File.is_open();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InputReplayer::ReadFrame( float &fDelta, uint64_t &uFrameEnd, vector<AbInputStruct> &vEvents )
+{
+    B33_ASSERT( m_File.is_open() );
+
+    RecordedFrameHeader frame = {};
+    if ( !m_File.read( reinterpret_cast<char *>( &frame ), sizeof( frame ) ) )
+    {
+        return false;
+    }
+
+    vEvents.resize( frame.uEventCount );
+    if ( !m_File.read( reinterpret_cast<char *>( vEvents.data() ), sizeof( AbInputStruct ) * vEvents.size() ) )
+    {
+        B33_LOG( Warning, L"Input recording is truncated. [Frame: %u]", m_uFrames );
+        return false;
+    }
+
+    fDelta    = frame.fDelta;
+    uFrameEnd = frame.uFrameEnd;
+    ++m_uFrames;
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InputReplayer::PeekDelta( float &fDelta )
+{
+    B33_ASSERT( m_File.is_open() );
+
+    const streampos     position = m_File.tellg();
+    RecordedFrameHeader frame    = {};
+
+    if ( !m_File.read( reinterpret_cast<char *>( &frame ), sizeof( frame ) ) )
+    {
+        // ReadFrame reports the end, the state has to stay readable for it
+        m_File.clear();
+        m_File.seekg( position );
+        return false;
+    }
+
+    m_File.seekg( position );
+    fDelta = frame.fDelta;
+
+    return true;
+}
+
+} // namespace B33::App
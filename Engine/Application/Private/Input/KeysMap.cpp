@@ -7,51 +7,92 @@ namespace B33::App
 
 // --------------------------------------------------------------------------------------------------------------------
 KeysMap::KeysMap()
-  : m_vKeys( AmountOfBindableKeys )
+  : KeysMap( AmountOfBindableKeys )
 {
-    memset( m_vKeys.data(), 0, sizeof( ActionReplayData ) * m_vKeys.size() );
 }
 
 // --------------------------------------------------------------------------------------------------------------------
 KeysMap::KeysMap( size_t uAmountOfBindableKeys )
-  : m_vKeys( uAmountOfBindableKeys )
+  : m_vBinds()
+  , m_vActions()
+  , m_vKeyOffsets( uAmountOfBindableKeys + 1, 0 )
+  , m_bDirty( false )
 {
-    memset( m_vKeys.data(), 0, sizeof( ActionReplayData ) * m_vKeys.size() );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void KeysMap::BindActionImpl( const AbInputBind &ib, void *pThis, AbAction a, AbMouseAction ma )
+void KeysMap::BindActionImpl( const AbInputBind &ib, const void *pOwner, void *pThis, AbAction a, AbMouseAction ma )
 {
     B33_ASSERT( ib.Type == EAbBindType::Keyboard || ib.Type == EAbBindType::MouseButton );
-    B33_ASSERT( ib.Keyboard.KeyCode > B33_INVALID_KEY && ib.Keyboard.KeyCode < B33_KEY_COUNT );
-    B33_ASSERT( m_vKeys[ ib.Keyboard.KeyCode ].pThis == nullptr );
+    B33_ASSERT( ib.Keyboard.KeyCode > B33_INVALID_KEY && ib.Keyboard.KeyCode < m_vKeyOffsets.size() - 1 );
     B33_ASSERT( ma == nullptr );
     B33_ASSERT( pThis != nullptr );
 
-    m_vKeys[ ib.Keyboard.KeyCode ] = ActionReplayData { pThis, a };
+    m_vBinds.push_back( ActionReplayData { pThis, a, pOwner, ib.Keyboard.KeyCode } );
+    m_bDirty = true;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void KeysMap::UnbindActionImpl( const AbInputBind &ib, void *pThis )
+void KeysMap::UnbindOwnerImpl( const void *pOwner )
 {
-    B33_ASSERT( ib.Type == EAbBindType::Keyboard || ib.Type == EAbBindType::MouseButton );
-    B33_ASSERT( ib.Keyboard.KeyCode > B33_INVALID_KEY && ib.Keyboard.KeyCode < B33_KEY_COUNT );
-    B33_ASSERT( pThis != nullptr );
+    const size_t uErased = ::std::erase_if( m_vBinds,
+                                            [ pOwner ]( const ActionReplayData &bind )
+                                            {
+                                                return bind.pOwner == pOwner;
+                                            } );
 
-    m_vKeys[ ib.Keyboard.KeyCode ].pThis = nullptr;
+    m_bDirty |= uErased != 0;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 void KeysMap::PlayAction( const float fDelta, AbKeyId keyCode )
 {
-    B33_ASSERT( keyCode > B33_INVALID_KEY && keyCode < B33_KEY_COUNT );
+    B33_ASSERT( keyCode > B33_INVALID_KEY && keyCode < m_vKeyOffsets.size() - 1 );
 
-    const auto &playableAction = m_vKeys[ keyCode ];
+    if ( m_bDirty )
+    {
+        RebuildTable();
+    }
 
-    if ( playableAction.pThis )
+    const uint32_t uEnd = m_vKeyOffsets[ keyCode + 1 ];
+    for ( uint32_t i = m_vKeyOffsets[ keyCode ]; i < uEnd; ++i )
     {
+        const auto &playableAction = m_vActions[ i ];
+
         playableAction.action( fDelta, playableAction.pThis );
     }
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void KeysMap::RebuildTable()
+{
+    // Counting sort by key, binds of the same key keep their registration order
+    ::std::fill( m_vKeyOffsets.begin(), m_vKeyOffsets.end(), 0 );
+
+    for ( const auto &bind : m_vBinds )
+    {
+        ++m_vKeyOffsets[ bind.keyCode + 1 ];
+    }
+
+    for ( size_t i = 1; i < m_vKeyOffsets.size(); ++i )
+    {
+        m_vKeyOffsets[ i ] += m_vKeyOffsets[ i - 1 ];
+    }
+
+    m_vActions.resize( m_vBinds.size() );
+    for ( const auto &bind : m_vBinds )
+    {
+        // Offsets of the key are used as the write cursor, shifted back below
+        m_vActions[ m_vKeyOffsets[ bind.keyCode ]++ ] = bind;
+    }
+
+    for ( size_t i = m_vKeyOffsets.size() - 1; i > 0; --i )
+    {
+        m_vKeyOffsets[ i ] = m_vKeyOffsets[ i - 1 ];
+    }
+    m_vKeyOffsets[ 0 ] = 0;
+
+    m_bDirty = false;
+}
+
 } // namespace B33::App
@@ -7,14 +7,23 @@
 namespace B33::App
 {
 
+/**
+ * @brief Key to actions table, a key can have any number of actions.
+ *
+ * Binds are kept in registration order and the dispatch table (actions grouped by key plus per key offsets)
+ * is rebuilt lazily with a counting sort, so binding or unbinding many actions at once costs O(binds + keys)
+ * and playing a key is a walk over a contiguous range.
+ */
 class KeysMap : public IBindMap<KeysMap>
 {
     static constexpr size_t AmountOfBindableKeys = B33_KEY_COUNT;
 
     struct ActionReplayData
     {
-        void    *pThis;
-        AbAction action;
+        void       *pThis;
+        AbAction    action;
+        const void *pOwner;
+        AbKeyId     keyCode;
     };
 
   public:
@@ -23,15 +32,25 @@ class KeysMap : public IBindMap<KeysMap>
     explicit KeysMap( size_t uAmountOfBindableKeys );
 
   public:
-    void BindActionImpl( const AbInputBind &ib, void *pThis, AbAction a, AbMouseAction ma );
+    void BindActionImpl( const AbInputBind &ib, const void *pOwner, void *pThis, AbAction a, AbMouseAction ma );
 
-    void UnbindActionImpl( const AbInputBind &ib, void *pThis );
+    void UnbindOwnerImpl( const void *pOwner );
 
   public:
+    /**
+     * @param fDelta - for continuous binds it's the time the key was held within the current frame,
+     * not the whole frame delta
+     */
     void PlayAction( const float fDelta, AbKeyId keyCode );
 
   private:
-    ::std::vector<ActionReplayData> m_vKeys;
+    void RebuildTable();
+
+  private:
+    ::std::vector<ActionReplayData> m_vBinds;
+    ::std::vector<ActionReplayData> m_vActions;
+    ::std::vector<uint32_t>         m_vKeyOffsets;
+    bool                            m_bDirty;
 };
 
 } // namespace B33::App
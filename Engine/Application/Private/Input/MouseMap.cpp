@@ -6,32 +6,24 @@ namespace B33::App
 {
 
 // ---------------------------------------------------------------------------------------------------------------------
-void MouseMap::BindActionImpl( const AbInputBind &ib, void *pThis, AbAction a, AbMouseAction ma )
+void MouseMap::BindActionImpl( const AbInputBind &ib, const void *pOwner, void *pThis, AbAction a, AbMouseAction ma )
 {
     B33_ASSERT( ib.Type == EAbBindType::Mouse );
     B33_ASSERT( a == nullptr );
     B33_ASSERT( pThis != nullptr );
 
-    m_vMouseBinds.push_back( DataForActionReplay { pThis, ma } );
+    m_vMouseBinds.push_back( DataForActionReplay { pThis, ma, pOwner } );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void MouseMap::UnbindActionImpl( const AbInputBind &ib, void *pThis )
+void MouseMap::UnbindOwnerImpl( const void *pOwner )
 {
-    B33_ASSERT( ib.Type == EAbBindType::Mouse );
-    B33_ASSERT( pThis != nullptr );
-
-    auto it = m_vMouseBinds.begin();
-    for ( ; it != m_vMouseBinds.end(); ++it )
-    {
-        if ( it->pThis == pThis )
-        {
-            m_vMouseBinds.erase( it );
-            return;
-        }
-    }
-
-    B33_ASSERT( it != m_vMouseBinds.end() );
+    // Single compacting pass instead of erasing binds one by one
+    ::std::erase_if( m_vMouseBinds,
+                     [ pOwner ]( const DataForActionReplay &bind )
+                     {
+                         return bind.pOwner == pOwner;
+                     } );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -12,12 +12,13 @@ class MouseMap : public IBindMap<MouseMap>
     {
         void         *pThis;
         AbMouseAction Action;
+        const void   *pOwner;
     };
 
   public:
-    void BindActionImpl( const AbInputBind &ib, void *pThis, AbAction a, AbMouseAction ma );
+    void BindActionImpl( const AbInputBind &ib, const void *pOwner, void *pThis, AbAction a, AbMouseAction ma );
 
-    void UnbindActionImpl( const AbInputBind &ib, void *pThis );
+    void UnbindOwnerImpl( const void *pOwner );
 
   public:
     void PlayAction( const float fDelta, int32_t fX, int32_t fY );
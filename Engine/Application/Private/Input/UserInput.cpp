@@ -2,6 +2,7 @@
 
 #include "Input/ControllerObject.hpp"
 #include "Input/InputEvents.h"
+#include "Input/InputRecording.hpp"
 #include "Input/MouseButtonList.hpp"
 #include "Input/UserInput.hpp"
 #include "KeysMap.hpp"
@@ -17,20 +18,43 @@ using namespace ::B33::Core::Debug;
 // --------------------------------------------------------------------------------------------------------------------
 struct UserInput::UserInputImpl
 {
+    UserInputImpl() = default;
+
+    // Copies get the binds only, recording and replay stay with the original
+    UserInputImpl( const UserInputImpl &other )
+      : KeyReleaseMap( other.KeyReleaseMap )
+      , KeyPressMap( other.KeyPressMap )
+      , KeyContinuous( other.KeyContinuous )
+      , ButtonReleaseMap( other.ButtonReleaseMap )
+      , ButtonPressMap( other.ButtonPressMap )
+      , MotionMouseMap( other.MotionMouseMap )
+      , FrameEvents()
+      , Recorder()
+      , Replayer()
+    {
+    }
+
     KeysMap  KeyReleaseMap;
     KeysMap  KeyPressMap;
     KeysMap  KeyContinuous;
     KeysMap  ButtonReleaseMap = KeysMap( 4 );
     KeysMap  ButtonPressMap   = KeysMap( 4 );
     MouseMap MotionMouseMap;
+
+    ::std::vector<AbInputStruct> FrameEvents;
+    InputRecorder                Recorder;
+    InputReplayer                Replayer;
 };
 
 // --------------------------------------------------------------------------------------------------------------------
 UserInput::UserInput( ::std::shared_ptr<WindowDesc> pWd )
   : WindowListener( pWd )
   , m_bIsCapturing( false )
-  , m_BindsHandles()
-  , m_vCurrentlyPressedKeys()
+  , m_vBoundControllers()
+  , m_vCurrentlyPressedKeys {}
+  , m_vKeysPressTime()
+  , m_uLastUpdateTime( 0 )
+  , m_uOldestInputTime( 0 )
   , m_pImpl( make_unique<UserInputImpl>() )
 {
 }
@@ -42,8 +66,11 @@ UserInput::~UserInput() {}
 UserInput::UserInput( const UserInput &other ) noexcept
   : WindowListener( other )
   , m_bIsCapturing( false )
-  , m_BindsHandles( other.m_BindsHandles )
-  , m_vCurrentlyPressedKeys()
+  , m_vBoundControllers( other.m_vBoundControllers )
+  , m_vCurrentlyPressedKeys {}
+  , m_vKeysPressTime()
+  , m_uLastUpdateTime( 0 )
+  , m_uOldestInputTime( 0 )
   , m_pImpl( make_unique<UserInputImpl>( *other.m_pImpl.get() ) )
 {
 }
@@ -53,8 +80,11 @@ UserInput &UserInput::operator=( const UserInput &other ) noexcept
 {
     this->ListenToWindow( other.GetWindowDesc() );
     this->m_bIsCapturing          = false;
-    this->m_BindsHandles          = other.m_BindsHandles;
+    this->m_vBoundControllers     = other.m_vBoundControllers;
     this->m_vCurrentlyPressedKeys = {};
+    this->m_vKeysPressTime        = {};
+    this->m_uLastUpdateTime       = 0;
+    this->m_uOldestInputTime      = 0;
     this->m_pImpl                 = make_unique<UserInputImpl>( *other.m_pImpl.get() );
 
     return *this;
@@ -64,8 +94,11 @@ UserInput &UserInput::operator=( const UserInput &other ) noexcept
 UserInput::UserInput( UserInput &&other ) noexcept
   : WindowListener( std::move( other ) )
   , m_bIsCapturing( false )
-  , m_BindsHandles( std::move( other.m_BindsHandles ) )
-  , m_vCurrentlyPressedKeys()
+  , m_vBoundControllers( std::move( other.m_vBoundControllers ) )
+  , m_vCurrentlyPressedKeys {}
+  , m_vKeysPressTime()
+  , m_uLastUpdateTime( 0 )
+  , m_uOldestInputTime( 0 )
   , m_pImpl( std::move( other.m_pImpl ) )
 {
 }
@@ -75,8 +108,11 @@ UserInput &UserInput::operator=( UserInput &&other ) noexcept
 {
     this->ListenToWindow( ::std::move( other.GetWindowDesc() ) );
     this->m_bIsCapturing          = false;
-    this->m_BindsHandles          = ::std::move( other.m_BindsHandles );
+    this->m_vBoundControllers     = ::std::move( other.m_vBoundControllers );
     this->m_vCurrentlyPressedKeys = {};
+    this->m_vKeysPressTime        = {};
+    this->m_uLastUpdateTime       = 0;
+    this->m_uOldestInputTime      = 0;
     this->m_pImpl                 = ::std::move( other.m_pImpl );
 
     return *this;
@@ -108,33 +144,108 @@ void UserInput::StopCapturing()
     m_bIsCapturing = false;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+static bool IsKeyPressed( const ::std::array<uint64_t, ( B33_KEY_COUNT + 63 ) / 64> &vKeys, AbKeyId key )
+{
+    return ( vKeys[ key >> 6 ] >> ( key & 63 ) ) & 1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static float HeldWithinFrameMs( uint64_t uPressTime, uint64_t uEndTime, uint64_t uFrameStart )
+{
+    const uint64_t uStart = max( uPressTime, uFrameStart );
+
+    return uEndTime > uStart ? static_cast<float>( uEndTime - uStart ) / 1000.f : 0.f;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void UserInput::Update( const float fDelta )
 {
     B33_ASSERT( this->GetWindowDesc().get() != nullptr );
 
-    if ( !m_bIsCapturing )
+    const auto &pWindowDesc = this->GetWindowDesc();
+
+    if ( !pWindowDesc->InputQueue )
     {
         return;
     }
 
-    const auto &pWindowDesc = this->GetWindowDesc();
+    AbInputQueue &inputQueue = *pWindowDesc->InputQueue;
+    AbInputStruct is;
 
-    // Always replay the continuos keybinds that are currently pressed
-    if ( m_vCurrentlyPressedKeys.any() )
+    if ( !m_bIsCapturing )
     {
-        for ( AbKeyId i = 0; i < B33_KEY_COUNT; ++i )
+        // The queue is bounded, don't let stale events pile up until the capture starts again. Releases still
+        // apply, a key let go in the meantime must not keep its continuous bind firing once the capture resumes
+        while ( inputQueue.TryPop( is ) )
         {
-            if ( !m_vCurrentlyPressedKeys.test( i ) )
-                continue;
+            const AbKeyId key = is.Keyboard.KeyId;
 
-            m_pImpl->KeyContinuous.PlayAction( fDelta, i );
+            if ( is.Event == EAbInputEvents::AbKeyRelease && key > B33_INVALID_KEY && key < B33_KEY_COUNT )
+                m_vCurrentlyPressedKeys[ key >> 6 ] &= ~( 1ull << ( key & 63 ) );
         }
+
+        m_uLastUpdateTime = 0;
+        return;
     }
 
-    while ( !pWindowDesc->InputStruct.empty() )
+    auto    &vEvents     = m_pImpl->FrameEvents;
+    float    fFrameDelta = fDelta;
+    uint64_t uFrameEnd   = 0;
+
+    if ( m_pImpl->Replayer.IsOpen() )
     {
-        AbInputStruct &is = pWindowDesc->InputStruct.front();
+        // Live input is dropped while the recorded one is injected
+        while ( inputQueue.TryPop( is ) )
+            ;
+
+        if ( !m_pImpl->Replayer.ReadFrame( fFrameDelta, uFrameEnd, vEvents ) )
+        {
+            StopReplay();
+            return;
+        }
+    }
+    else
+    {
+        // Events that arrive while we are draining are clamped to the end of this frame
+        // and their held time is counted by the next Update
+        uFrameEnd = AbInputTimestampNow();
+
+        vEvents.clear();
+        while ( inputQueue.TryPop( is ) )
+            vEvents.push_back( is );
+    }
+
+    if ( m_pImpl->Recorder.IsOpen() )
+    {
+        m_pImpl->Recorder.WriteFrame( fFrameDelta, uFrameEnd, vEvents );
+    }
+
+    PlayFrame( fFrameDelta, uFrameEnd, vEvents );
+
+    pWindowDesc->LastEvent &= ~EAbWindowEvents::Input;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void UserInput::PlayFrame( const float fDelta, const uint64_t uFrameEnd, const ::std::vector<AbInputStruct> &vEvents )
+{
+    // Everything is measured against [uFrameStart, uFrameEnd]
+    const uint64_t uFrameLength = static_cast<uint64_t>( fDelta * 1000.f );
+    const uint64_t uFrameStart  = m_uLastUpdateTime ? m_uLastUpdateTime : uFrameEnd - min( uFrameEnd, uFrameLength );
+
+    int32_t iMotionX = 0;
+    int32_t iMotionY = 0;
+    bool    bMotion  = false;
+
+    m_uLastUpdateTime  = uFrameEnd;
+    m_uOldestInputTime = 0;
+
+    for ( const AbInputStruct &is : vEvents )
+    {
+        const uint64_t uTime = clamp( is.Timestamp, uFrameStart, uFrameEnd );
+
+        if ( m_uOldestInputTime == 0 )
+            m_uOldestInputTime = is.Timestamp;
 
         switch ( is.Event )
         {
@@ -145,14 +256,13 @@ void UserInput::Update( const float fDelta )
                 if ( key <= B33_INVALID_KEY || key >= B33_KEY_COUNT )
                     break;
 
-                if ( m_vCurrentlyPressedKeys.test( key ) )
+                if ( IsKeyPressed( m_vCurrentlyPressedKeys, key ) )
                     break;
 
-                m_vCurrentlyPressedKeys.set( key );
+                m_vCurrentlyPressedKeys[ key >> 6 ] |= 1ull << ( key & 63 );
+                m_vKeysPressTime[ key ] = uTime;
 
                 m_pImpl->KeyPressMap.PlayAction( fDelta, key );
-                // Don't wait for the next update to play continuos actions
-                m_pImpl->KeyContinuous.PlayAction( fDelta, key );
                 break;
             }
 
@@ -163,11 +273,14 @@ void UserInput::Update( const float fDelta )
                 if ( key <= B33_INVALID_KEY || key >= B33_KEY_COUNT )
                     break;
 
-                if ( !m_vCurrentlyPressedKeys.test( key ) )
+                if ( !IsKeyPressed( m_vCurrentlyPressedKeys, key ) )
                     break;
 
-                m_vCurrentlyPressedKeys.flip( key );
+                m_vCurrentlyPressedKeys[ key >> 6 ] &= ~( 1ull << ( key & 63 ) );
 
+                // Play only the part of the frame in which the key was really held
+                m_pImpl->KeyContinuous.PlayAction( HeldWithinFrameMs( m_vKeysPressTime[ key ], uTime, uFrameStart ),
+                                                   key );
                 m_pImpl->KeyReleaseMap.PlayAction( fDelta, key );
                 break;
             }
@@ -196,19 +309,99 @@ void UserInput::Update( const float fDelta )
 
             case EAbInputEvents::AbMotion:
             {
-                m_pImpl->MotionMouseMap.PlayAction( fDelta, is.Mouse.MouseX, is.Mouse.MouseY );
-                is.Mouse.MouseX = 0;
-                is.Mouse.MouseY = 0;
+                // Deltas are accumulated, absolute positions are simply overwritten by the newest one
+                iMotionX = is.Mouse.IsDelta ? iMotionX + is.Mouse.MouseX : is.Mouse.MouseX;
+                iMotionY = is.Mouse.IsDelta ? iMotionY + is.Mouse.MouseY : is.Mouse.MouseY;
+                bMotion  = true;
                 break;
             }
         }
+    }
 
-        // Consume the input event
-        if ( !pWindowDesc->InputStruct.empty() )
-            pWindowDesc->InputStruct.pop();
+    if ( bMotion )
+    {
+        m_pImpl->MotionMouseMap.PlayAction( fDelta, iMotionX, iMotionY );
     }
 
-    pWindowDesc->LastEvent &= ~EAbWindowEvents::Input;
+    // Keys that are still held are played up to the end of this frame
+    for ( size_t uWord = 0; uWord < m_vCurrentlyPressedKeys.size(); ++uWord )
+    {
+        for ( uint64_t uBits = m_vCurrentlyPressedKeys[ uWord ]; uBits != 0; uBits &= uBits - 1 )
+        {
+            const AbKeyId key = static_cast<AbKeyId>( ( uWord << 6 ) + countr_zero( uBits ) );
+
+            m_pImpl->KeyContinuous.PlayAction( HeldWithinFrameMs( m_vKeysPressTime[ key ], uFrameEnd, uFrameStart ),
+                                               key );
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint64_t UserInput::GetOldestInputTimestamp() const
+{
+    return m_uOldestInputTime;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool UserInput::StartRecording( const ::std::filesystem::path &path )
+{
+    if ( !m_pImpl->Recorder.Open( path ) )
+    {
+        return false;
+    }
+
+    ResetFrameState();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void UserInput::StopRecording()
+{
+    m_pImpl->Recorder.Close();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool UserInput::StartReplay( const ::std::filesystem::path &path )
+{
+    if ( !m_pImpl->Replayer.Open( path ) )
+    {
+        return false;
+    }
+
+    ResetFrameState();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void UserInput::StopReplay()
+{
+    if ( !m_pImpl->Replayer.IsOpen() )
+    {
+        return;
+    }
+
+    m_pImpl->Replayer.Close();
+    ResetFrameState();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool UserInput::IsReplaying() const
+{
+    return m_pImpl->Replayer.IsOpen();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool UserInput::PeekReplayDelta( float &fDelta )
+{
+    return m_pImpl->Replayer.IsOpen() && m_pImpl->Replayer.PeekDelta( fDelta );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void UserInput::ResetFrameState()
+{
+    // Recording and replay both start with every key released and a fresh frame clock
+    m_vCurrentlyPressedKeys = {};
+    m_uLastUpdateTime       = 0;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -234,13 +427,13 @@ void UserInput::Bind( void *pThis, ControllerObject *pCo, AbAction action, AbMou
         switch ( bind.Keyboard.KeyState )
         {
             case EAbOnState::Press:
-                m_pImpl->KeyPressMap.BindAction( bind, pThis, action, nullptr );
+                m_pImpl->KeyPressMap.BindAction( bind, pCo, pThis, action, nullptr );
                 break;
             case EAbOnState::Release:
-                m_pImpl->KeyReleaseMap.BindAction( bind, pThis, action, nullptr );
+                m_pImpl->KeyReleaseMap.BindAction( bind, pCo, pThis, action, nullptr );
                 break;
             case EAbOnState::Continuous:
-                m_pImpl->KeyContinuous.BindAction( bind, pThis, action, nullptr );
+                m_pImpl->KeyContinuous.BindAction( bind, pCo, pThis, action, nullptr );
                 break;
             default:
                 Logger::Get().Log( Error,
@@ -253,10 +446,10 @@ void UserInput::Bind( void *pThis, ControllerObject *pCo, AbAction action, AbMou
         switch ( bind.Keyboard.KeyState )
         {
             case EAbOnState::Press:
-                m_pImpl->ButtonPressMap.BindAction( bind, pThis, action, nullptr );
+                m_pImpl->ButtonPressMap.BindAction( bind, pCo, pThis, action, nullptr );
                 break;
             case EAbOnState::Release:
-                m_pImpl->ButtonReleaseMap.BindAction( bind, pThis, action, nullptr );
+                m_pImpl->ButtonReleaseMap.BindAction( bind, pCo, pThis, action, nullptr );
                 break;
             default:
                 Logger::Get().Log( Error,
@@ -266,19 +459,23 @@ void UserInput::Bind( void *pThis, ControllerObject *pCo, AbAction action, AbMou
     }
     else if ( bind.Type & EAbBindType::Mouse )
     {
-        m_pImpl->MotionMouseMap.BindAction( bind, pThis, nullptr, mouseAction );
+        m_pImpl->MotionMouseMap.BindAction( bind, pCo, pThis, nullptr, mouseAction );
+    }
+
+    if ( ::std::find( m_vBoundControllers.begin(), m_vBoundControllers.end(), pCo ) == m_vBoundControllers.end() )
+    {
+        m_vBoundControllers.push_back( pCo );
     }
 
-    m_BindsHandles[ pCo ].push_back( { bind, pThis } );
     B33_LOG( Info, L"New bind [Controller address: %p] [Bind type: %d]", pCo, bind.Type );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 void UserInput::Unbind( ControllerObject *pCo )
 {
-    const auto &handle = m_BindsHandles.find( pCo );
+    const auto handle = ::std::find( m_vBoundControllers.begin(), m_vBoundControllers.end(), pCo );
 
-    if ( handle == m_BindsHandles.end() )
+    if ( handle == m_vBoundControllers.end() )
     {
         Logger::Get().Log( Warning,
                            L"Cannot unbind this bind from this UserInput, because UserInput doesn't handles it. "
@@ -288,36 +485,15 @@ void UserInput::Unbind( ControllerObject *pCo )
     }
     B33_LOG( Info, L"Unbind [Controller address: %p]", pCo );
 
-    for ( const auto &bindHandle : handle->second )
-    {
-        auto &bind = bindHandle.Ib;
-
-        if ( bind.Type & EAbBindType::Keyboard )
-        {
-            switch ( bind.Keyboard.KeyState )
-            {
-                case EAbOnState::Press:
-                    m_pImpl->KeyPressMap.UnbindAction( bind, bindHandle.pThis );
-                    break;
-                case EAbOnState::Release:
-                    m_pImpl->KeyReleaseMap.UnbindAction( bind, bindHandle.pThis );
-                    break;
-                case EAbOnState::Continuous:
-                    m_pImpl->KeyContinuous.UnbindAction( bind, bindHandle.pThis );
-                    break;
-                default:
-                    Logger::Get().Log( Error,
-                                       L"Key state wasn't valid? Coulnd't map the bind. [KeyState: %d]",
-                                       bind.Keyboard.KeyState );
-            }
-        }
-        else if ( bind.Type & EAbBindType::Mouse )
-        {
-            m_pImpl->MotionMouseMap.UnbindAction( bind, bindHandle.pThis );
-        }
-    }
+    // Every map drops all binds of the controller in one pass
+    m_pImpl->KeyPressMap.UnbindOwner( pCo );
+    m_pImpl->KeyReleaseMap.UnbindOwner( pCo );
+    m_pImpl->KeyContinuous.UnbindOwner( pCo );
+    m_pImpl->ButtonPressMap.UnbindOwner( pCo );
+    m_pImpl->ButtonReleaseMap.UnbindOwner( pCo );
+    m_pImpl->MotionMouseMap.UnbindOwner( pCo );
 
-    m_BindsHandles.erase( handle );
+    m_vBoundControllers.erase( handle );
 }
 
 } // namespace B33::App
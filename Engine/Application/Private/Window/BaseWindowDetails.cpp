@@ -31,6 +31,13 @@ static unordered_map<string, DisplayCount> Displays = {};
 
     auto &mapped = Displays[ pszDisplayName ];
 
+    // Window policies read input through their own connection on a separate thread
+    static const Status threadsStatus = XInitThreads();
+    if ( threadsStatus == 0 )
+    {
+        B33_LOG( B33::Core::Debug::Warning, L"XInitThreads failed, Xlib isn't thread safe!" );
+    }
+
     if ( mapped.Count == 0 )
     {
         mapped.DisplayPtr = XOpenDisplay( pszDisplayName );
@@ -8,12 +8,36 @@
 #    include "Window/WindowPolicy/Linux/BasicLinuxPolicy.hpp"
 #    include "X11ErrorHandling.hpp"
 
+#    include <errno.h>
+#    include <poll.h>
+
 namespace B33::App
 {
 
 using namespace ::B33::Core;
 using namespace ::B33::Core::Debug;
 
+// Statics // ----------------------------------------------------------------------------------------------------------
+// Windows share one main X11 connection, so an Update of one window can read events of another one.
+// Those are parked here, keyed by the X Window, until the owner's Update picks them up. Main thread only.
+static ::std::unordered_map<Window, ::std::vector<XEvent>> PendingWindowEvents = {};
+
+// ---------------------------------------------------------------------------------------------------------------------
+BasicLinuxWindowPolicy::BasicLinuxWindowPolicy()
+  : m_InputPump()
+  , m_InputThread()
+  , m_bPumpRunning( false )
+  , m_pWakePipe { -1, -1 }
+  , m_bQueueOverflow( false )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+BasicLinuxWindowPolicy::~BasicLinuxWindowPolicy()
+{
+    StopInputPump();
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 uint32_t BasicLinuxWindowPolicy::CreateImpl( WindowDesc *pWd )
 {
@@ -48,25 +72,21 @@ uint32_t BasicLinuxWindowPolicy::CreateImpl( WindowDesc *pWd )
     free( szWindowName );
     XFree( windowName.value );
 
-    int bSupported;
-    XkbSetDetectableAutoRepeat( pDisplay, True, &bSupported );
-    if ( !bSupported )
-    {
-        B33_LOG( Error, L"Detectable auto repeat ISN'T SUPPORTED!" );
-    }
-
+    // Key, button and motion events are selected by the input pump connection
     XSelectInput( pDisplay,
                   window,
-                  FocusChangeMask | PointerMotionMask | PointerMotionHintMask | ButtonPressMask | ButtonReleaseMask |
-                      KeyPressMask | KeyReleaseMask | ExposureMask | StructureNotifyMask | SubstructureNotifyMask |
+                  FocusChangeMask | ExposureMask | StructureNotifyMask | SubstructureNotifyMask |
                       SubstructureRedirectMask );
     pWd->Screen       = screen;
     pWd->WindowHandle = window;
 
+    PendingWindowEvents[ window ] = {};
+
     Atom wmDeleteMessage = XInternAtom( pDisplay, "WM_DELETE_WINDOW", 0 );
     XSetWMProtocols( pDisplay, window, &wmDeleteMessage, 1 );
 
     OnCreate( pWd );
+    StartInputPump( pWd );
 
     XMapWindow( pDisplay, window );
 
@@ -103,6 +123,9 @@ void BasicLinuxWindowPolicy::DestroyImpl( WindowDesc *pWd )
     B33_ASSERT( pWd->pDisplayHandle );
     B33_ASSERT( pWd->WindowHandle );
 
+    StopInputPump();
+
+    PendingWindowEvents.erase( pWd->WindowHandle );
     XDestroyWindow( pWd->pDisplayHandle, pWd->WindowHandle );
     AbAskToCloseDisplayLinux( NULL );
 
@@ -123,24 +146,38 @@ void BasicLinuxWindowPolicy::UpdateImpl( WindowDesc *pWd )
     Window   window  = pWd->WindowHandle;
     XEvent   event;
 
-    while ( XPending( pWd->pDisplayHandle ) )
+    // Replay events that other windows read for us, keep the early escape semantics of OnUpdate
+    auto  &vPending  = PendingWindowEvents[ window ];
+    size_t uConsumed = 0;
+
+    while ( uConsumed < vPending.size() )
     {
-        XPeekEvent( display, &event );
+        if ( OnUpdate( pWd, vPending[ uConsumed++ ] ) != 0 )
+            break;
+    }
+
+    vPending.erase( vPending.begin(), vPending.begin() + uConsumed );
+    if ( !vPending.empty() )
+    {
+        return;
+    }
+
+    while ( XPending( display ) )
+    {
+        XNextEvent( display, &event );
 
         if ( event.xany.window != window && event.type != UnmapNotify && event.type != DestroyNotify &&
              event.type != GenericEvent )
         {
-            for ( const auto &handle : B33::App::AppStatus::Get().GetWindowHandles() )
+            auto route = PendingWindowEvents.find( event.xany.window );
+
+            if ( route != PendingWindowEvents.end() )
             {
-                if ( event.xany.window == handle->WindowHandle )
-                {
-                    return;
-                }
+                route->second.push_back( event );
+                continue;
             }
         }
 
-        XNextEvent( display, &event );
-
         if ( OnUpdate( pWd, event ) != 0 )
             break;
     }
@@ -154,46 +191,6 @@ uint32_t BasicLinuxWindowPolicy::OnUpdate( WindowDesc *pWd, XEvent &event )
 
     switch ( event.type )
     {
-        case KeyPress:
-            HandleKey( pWd, event, AbKeyPress );
-            return 0;
-
-        case KeyRelease:
-            HandleKey( pWd, event, AbKeyRelease );
-            return 0;
-
-        case ButtonPress:
-            HandleMouseButton( pWd, event, AbButtonPress );
-            return 0;
-
-        case ButtonRelease:
-            HandleMouseButton( pWd, event, AbButtonRelease );
-            return 0;
-
-        case MotionNotify:
-            int    rootX, rootY, dummy;
-            Window dummyWindow;
-
-            XQueryPointer( display,
-                           window,
-                           &dummyWindow,
-                           &dummyWindow,
-                           &rootX,
-                           &rootY,
-                           &dummy,
-                           &dummy,
-                           reinterpret_cast<unsigned int *>( &dummy ) );
-
-            pWd->LastEvent |= Input;
-            AbInputStruct is;
-
-            is.Event        = AbMotion;
-            is.Mouse.MouseX = static_cast<int32_t>( rootX );
-            is.Mouse.MouseY = static_cast<int32_t>( rootY );
-
-            pWd->InputStruct.push( is );
-            return 0;
-
         case Expose:
             pWd->LastEvent |= Resize;
             pWd->Width  = event.xexpose.width;
@@ -228,27 +225,281 @@ uint32_t BasicLinuxWindowPolicy::OnUpdate( WindowDesc *pWd, XEvent &event )
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void BasicLinuxWindowPolicy::HandleKey( WindowDesc *pWd, XEvent &event, EAbInputEvents ie )
+void BasicLinuxWindowPolicy::OnInputUpdate( InputPumpDesc *pIpd, XEvent &event )
+{
+    switch ( event.type )
+    {
+        case KeyPress:
+            HandleKey( pIpd, event, AbKeyPress );
+            return;
+
+        case KeyRelease:
+            HandleKey( pIpd, event, AbKeyRelease );
+            return;
+
+        case ButtonPress:
+            HandleMouseButton( pIpd, event, AbButtonPress );
+            return;
+
+        case ButtonRelease:
+            HandleMouseButton( pIpd, event, AbButtonRelease );
+            return;
+
+        case MotionNotify:
+            // Raw motion reports the same movement, and warping generates core motion too
+            if ( pIpd->XiOpCode >= 0 )
+                return;
+
+            pIpd->MotionX = event.xmotion.x_root;
+            pIpd->MotionY = event.xmotion.y_root;
+            pIpd->bMotion = true;
+            return;
+
+        case GenericEvent:
+            if ( event.xcookie.extension != pIpd->XiOpCode || !XGetEventData( pIpd->pDisplay, &event.xcookie ) )
+                return;
+
+            if ( event.xcookie.evtype == XI_RawMotion )
+                HandleRawMotion( pIpd, event );
+
+            XFreeEventData( pIpd->pDisplay, &event.xcookie );
+            return;
+
+        case ConfigureNotify:
+            pIpd->Width  = event.xconfigure.width;
+            pIpd->Height = event.xconfigure.height;
+            return;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BasicLinuxWindowPolicy::OnInputFlush( InputPumpDesc *pIpd )
+{
+    if ( !pIpd->bMotion )
+    {
+        return;
+    }
+
+    const bool bIsDelta = pIpd->XiOpCode >= 0;
+
+    AbInputStruct is;
+    is.Event         = AbMotion;
+    is.Mouse.MouseX  = static_cast<int32_t>( pIpd->MotionX );
+    is.Mouse.MouseY  = static_cast<int32_t>( pIpd->MotionY );
+    is.Mouse.IsDelta = bIsDelta;
+
+    PushInput( pIpd, is );
+
+    pIpd->MotionX = bIsDelta ? pIpd->MotionX - is.Mouse.MouseX : 0.;
+    pIpd->MotionY = bIsDelta ? pIpd->MotionY - is.Mouse.MouseY : 0.;
+    pIpd->bMotion = false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool BasicLinuxWindowPolicy::EnableRawMotion( InputPumpDesc *pIpd )
+{
+    Display      *pDisplay = pIpd->pDisplay;
+    XIEventMask   evmask;
+    unsigned char pMask[ ( XI_LASTEVENT + 7 ) / 8 ] = { 0 };
+
+    int opCode, event, error;
+    int major = 2, minor = 0;
+
+    if ( !XQueryExtension( pDisplay, "XInputExtension", &opCode, &event, &error ) )
+    {
+        B33_LOG( Error, L"XInput2 not available." );
+        return false;
+    }
+
+    if ( XIQueryVersion( pDisplay, &major, &minor ) == BadRequest )
+    {
+        B33_LOG( Error, L"XInput2 isn't available. Need at least 2.0." );
+        return false;
+    }
+    B33_LOG( Info, L"XInput2 version: %d.%d", major, minor );
+
+    XISetMask( pMask, XI_RawMotion );
+
+    evmask.deviceid = XIAllMasterDevices;
+    evmask.mask_len = sizeof( pMask );
+    evmask.mask     = pMask;
+
+    if ( XISelectEvents( pDisplay, DefaultRootWindow( pDisplay ), &evmask, 1 ) != Success )
+    {
+        B33_LOG( Error, L"XISelectEvents failed." );
+        return false;
+    }
+
+    pIpd->XiOpCode = opCode;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BasicLinuxWindowPolicy::PushInput( InputPumpDesc *pIpd, const AbInputStruct &is )
+{
+    if ( AbPushInputEvent( *pIpd->pQueue, is ) )
+    {
+        m_bQueueOverflow = false;
+        return;
+    }
+
+    if ( !m_bQueueOverflow )
+    {
+        B33_LOG( Warning, L"Input queue is full, dropping input events until UserInput catches up." );
+    }
+
+    m_bQueueOverflow = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BasicLinuxWindowPolicy::StartInputPump( WindowDesc *pWd )
+{
+    B33_ASSERT( !m_InputThread.joinable() );
+
+    // Window has to exist on the server, before the second connection can select events on it
+    XSync( pWd->pDisplayHandle, False );
+
+    Display *pDisplay = XOpenDisplay( DisplayString( pWd->pDisplayHandle ) );
+    if ( pDisplay == NULL )
+    {
+        throw B33_EXCEPT( "Couldn't open the input connection!" );
+    }
+
+    if ( pipe( m_pWakePipe ) != 0 )
+    {
+        XCloseDisplay( pDisplay );
+        throw B33_EXCEPT( "Couldn't create the input pump wake pipe!" );
+    }
+
+    // Auto repeat detection is a per client setting
+    int bSupported;
+    XkbSetDetectableAutoRepeat( pDisplay, True, &bSupported );
+    if ( !bSupported )
+    {
+        B33_LOG( Error, L"Detectable auto repeat ISN'T SUPPORTED!" );
+    }
+
+    XSelectInput( pDisplay,
+                  pWd->WindowHandle,
+                  KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask |
+                      FocusChangeMask | StructureNotifyMask );
+
+    m_InputPump.pDisplay     = pDisplay;
+    m_InputPump.WindowHandle = pWd->WindowHandle;
+    m_InputPump.Width        = pWd->Width;
+    m_InputPump.Height       = pWd->Height;
+    m_InputPump.pQueue       = pWd->InputQueue;
+    m_InputPump.XiOpCode     = -1;
+    m_InputPump.MotionX      = 0.;
+    m_InputPump.MotionY      = 0.;
+    m_InputPump.bMotion      = false;
+    m_bQueueOverflow         = false;
+
+    OnInputCreate( &m_InputPump );
+    XSync( pDisplay, False );
+
+    m_bPumpRunning.store( true, ::std::memory_order_release );
+    m_InputThread = ::std::thread( &BasicLinuxWindowPolicy::InputPumpLoop, this );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BasicLinuxWindowPolicy::StopInputPump()
 {
-    pWd->LastEvent |= Input;
+    if ( !m_InputThread.joinable() )
+    {
+        return;
+    }
+
+    const char cWake = 1;
+
+    m_bPumpRunning.store( false, ::std::memory_order_release );
+    if ( write( m_pWakePipe[ 1 ], &cWake, sizeof( cWake ) ) != sizeof( cWake ) )
+    {
+        B33_LOG( Error, L"Couldn't wake the input pump!" );
+    }
+
+    m_InputThread.join();
+
+    XCloseDisplay( m_InputPump.pDisplay );
+    close( m_pWakePipe[ 0 ] );
+    close( m_pWakePipe[ 1 ] );
+
+    m_pWakePipe[ 0 ] = -1;
+    m_pWakePipe[ 1 ] = -1;
+    m_InputPump      = {};
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BasicLinuxWindowPolicy::InputPumpLoop()
+{
+    Display *pDisplay = m_InputPump.pDisplay;
+    XEvent   event;
+    pollfd   pFds[ 2 ] = {
+        { ConnectionNumber( pDisplay ), POLLIN, 0 },
+        { m_pWakePipe[ 0 ], POLLIN, 0 },
+    };
+
+    while ( m_bPumpRunning.load( ::std::memory_order_acquire ) )
+    {
+        // XPending reads everything that is already on the socket, so poll below only sleeps when Xlib has
+        // nothing buffered
+        while ( XPending( pDisplay ) )
+        {
+            XNextEvent( pDisplay, &event );
+            OnInputUpdate( &m_InputPump, event );
+        }
 
+        OnInputFlush( &m_InputPump );
+
+        if ( poll( pFds, 2, -1 ) < 0 && errno != EINTR )
+        {
+            B33_LOG( Error, L"Input pump poll failed, input won't be read anymore. [errno: %d]", errno );
+            break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BasicLinuxWindowPolicy::HandleKey( InputPumpDesc *pIpd, XEvent &event, EAbInputEvents ie )
+{
     AbInputStruct is;
     is.Event          = ie;
     is.Keyboard.KeyId = event.xkey.keycode - 8;
 
-    pWd->InputStruct.push( is );
+    PushInput( pIpd, is );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void BasicLinuxWindowPolicy::HandleMouseButton( WindowDesc *pWd, XEvent &event, EAbInputEvents ie )
+void BasicLinuxWindowPolicy::HandleMouseButton( InputPumpDesc *pIpd, XEvent &event, EAbInputEvents ie )
 {
-    pWd->LastEvent |= Input;
-
     AbInputStruct is;
     is.Event             = ie;
     is.MouseButton.KeyId = event.xbutton.button;
 
-    pWd->InputStruct.push( is );
+    PushInput( pIpd, is );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void BasicLinuxWindowPolicy::HandleRawMotion( InputPumpDesc *pIpd, XEvent &event )
+{
+    XIRawEvent *rawev = reinterpret_cast<XIRawEvent *>( event.xcookie.data );
+    double     *pRaw  = rawev->raw_values;
+
+    // raw_values are packed, only the valuators that are set in the mask have a value
+    for ( int i = 0; i < rawev->valuators.mask_len * 8 && i < 2; ++i )
+    {
+        if ( !XIMaskIsSet( rawev->valuators.mask, i ) )
+            continue;
+
+        if ( i == 0 )
+            pIpd->MotionX += *pRaw;
+        else
+            pIpd->MotionY += *pRaw;
+
+        ++pRaw;
+    }
+
+    pIpd->bMotion = true;
 }
 
 } // namespace B33::App
@@ -11,113 +11,51 @@ using namespace B33::Core;
 using namespace B33::Core::Debug;
 
 // ---------------------------------------------------------------------------------------------------------------------
-void GameLinuxWindowPolicy::OnCreate( WindowDesc *pWd )
+void GameLinuxWindowPolicy::OnInputCreate( InputPumpDesc *pIpd )
 {
-    Display      *pDisplay = pWd->pDisplayHandle;
-    Window        window   = RootWindow( pDisplay, pWd->Screen );
-    XIEventMask   evmask;
-    unsigned char pMask[ ( XI_LASTEVENT + 7 ) / 8 ] = { 0 };
-
-    int event, error;
-    int major = 2, minor = 0;
-
-    XSync( pDisplay, False );
-
-    if ( !XQueryExtension( pDisplay, "XInputExtension", &m_OpCode, &event, &error ) )
-    {
-        B33_LOG( Error, L"XInput2 not available." );
-        return;
-    }
-
-    if ( XIQueryVersion( pDisplay, &major, &minor ) == BadRequest )
+    if ( !EnableRawMotion( pIpd ) )
     {
-        B33_LOG( Error, L"XInput2 isn't available. Need at least 2.0." );
-        return;
+        B33_LOG( Warning, L"Raw motion isn't available, falling back to the core pointer motion." );
     }
-    B33_LOG( Info, L"XInput2 version: %d.%d", major, minor );
-
-    XISetMask( pMask, XI_RawMotion );
-
-    evmask.deviceid = XIAllMasterDevices;
-    evmask.mask_len = sizeof( pMask );
-    evmask.mask     = pMask;
-
-    int status = XISelectEvents( pDisplay, window, &evmask, 1 );
-    if ( status != Success )
-    {
-        B33_LOG( Error, L"XISelectEvents failed." );
-    }
-
-    XFlush( pDisplay );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-uint32_t GameLinuxWindowPolicy::OnUpdate( WindowDesc *pWd, XEvent &event )
+void GameLinuxWindowPolicy::OnInputUpdate( InputPumpDesc *pIpd, XEvent &event )
 {
-    Display *pDisplay = pWd->pDisplayHandle;
-
-    if ( event.xcookie.type == GenericEvent && event.xcookie.extension == m_OpCode &&
-         XGetEventData( pDisplay, &event.xcookie ) )
-    {
-        if ( event.xcookie.evtype == XI_RawMotion )
-            HandleRawInput( pWd, event );
-
-        XFreeEventData( pDisplay, &event.xcookie );
-        return 0;
-    }
-
     switch ( event.type )
     {
         case FocusIn:
-            HandleFocusIn( pWd );
-            return 1;
+            HandleFocusIn( pIpd );
+            return;
         case FocusOut:
-            HandleFocusOut( pWd );
-            return 1;
-        case MotionNotify:
-            return 0;
+            HandleFocusOut( pIpd );
+            return;
     }
 
-    return BasicLinuxWindowPolicy::OnUpdate( pWd, event );
+    BasicLinuxWindowPolicy::OnInputUpdate( pIpd, event );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void GameLinuxWindowPolicy::HandleRawInput( WindowDesc *pWd, XEvent &event )
+void GameLinuxWindowPolicy::OnInputFlush( InputPumpDesc *pIpd )
 {
-    XIRawEvent *rawev = reinterpret_cast<XIRawEvent *>( event.xcookie.data );
-    double      dx = 0.0, dy = 0.0;
+    const bool bMoved = pIpd->bMotion;
 
-    for ( size_t i = 0; i < rawev->valuators.mask_len * 8; ++i )
+    BasicLinuxWindowPolicy::OnInputFlush( pIpd );
+
+    // One warp per pump is enough to keep the cursor away from the window edges
+    if ( bMoved && pIpd->XiOpCode >= 0 )
     {
-        if ( XIMaskIsSet( rawev->valuators.mask, i ) )
-        {
-            double val = rawev->raw_values[ i ];
-
-            if ( i == 0 )
-                dx += val;
-            else
-                dy += val;
-        }
+        XWarpPointer( pIpd->pDisplay, None, pIpd->WindowHandle, 0, 0, 0, 0, pIpd->Width * 0.5f, pIpd->Height * 0.5f );
+        XFlush( pIpd->pDisplay );
     }
-
-    pWd->LastEvent |= Input;
-
-    AbInputStruct is;
-    is.Event        = AbMotion;
-    is.Mouse.MouseX = dx;
-    is.Mouse.MouseY = dy;
-
-    pWd->InputStruct.push( is );
-
-    XWarpPointer( pWd->pDisplayHandle, None, pWd->WindowHandle, 0, 0, 0, 0, pWd->Width * 0.5f, pWd->Height * 0.5f );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void GameLinuxWindowPolicy::HandleFocusIn( WindowDesc *pWd )
+void GameLinuxWindowPolicy::HandleFocusIn( InputPumpDesc *pIpd )
 {
     static char pEmptyData[ 8 ] = { 0 };
-    Display    *pDisplay        = pWd->pDisplayHandle;
-    Window      window          = pWd->WindowHandle;
+    Display    *pDisplay        = pIpd->pDisplay;
+    Window      window          = pIpd->WindowHandle;
 
     XGrabPointer( pDisplay,
                   window,
@@ -139,16 +77,16 @@ void GameLinuxWindowPolicy::HandleFocusIn( WindowDesc *pWd )
 
     XDefineCursor( pDisplay, window, invisibleCursor );
 
-    XWarpPointer( pDisplay, None, window, 0, 0, 0, 0, pWd->Width * 0.5f, pWd->Height * 0.5f );
+    XWarpPointer( pDisplay, None, window, 0, 0, 0, 0, pIpd->Width * 0.5f, pIpd->Height * 0.5f );
 
     XFlush( pDisplay );
 }
 
 // --------------------------------------------------------------------------------------------------------------------
-void GameLinuxWindowPolicy::HandleFocusOut( WindowDesc *pWd )
+void GameLinuxWindowPolicy::HandleFocusOut( InputPumpDesc *pIpd )
 {
-    Display *pDisplay = pWd->pDisplayHandle;
-    Window   window   = pWd->WindowHandle;
+    Display *pDisplay = pIpd->pDisplay;
+    Window   window   = pIpd->WindowHandle;
 
     XUngrabPointer( pDisplay, CurrentTime );
     XUndefineCursor( pDisplay, window );
@@ -138,7 +138,7 @@ void BasicWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM lParam )
             is.Event          = EAbInputEvents::AbKeyPress;
             is.Keyboard.KeyId = LOWORD( wKeyFlags );
 
-            m_pWindowDesc->InputStruct.push( is );
+            AbPushInputEvent( *m_pWindowDesc->InputQueue, is );
             return;
         }
 
@@ -150,7 +150,7 @@ void BasicWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM lParam )
             is.Event          = EAbInputEvents::AbKeyRelease;
             is.Keyboard.KeyId = LOWORD( HIWORD( lParam ) );
 
-            m_pWindowDesc->InputStruct.push( is );
+            AbPushInputEvent( *m_pWindowDesc->InputQueue, is );
             return;
         }
 
@@ -162,7 +162,7 @@ void BasicWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM lParam )
             is.Event             = EAbInputEvents::AbButtonPress;
             is.MouseButton.KeyId = 1;
 
-            m_pWindowDesc->InputStruct.push( is );
+            AbPushInputEvent( *m_pWindowDesc->InputQueue, is );
             break;
         }
 
@@ -174,7 +174,7 @@ void BasicWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM lParam )
             is.Event             = EAbInputEvents::AbButtonPress;
             is.MouseButton.KeyId = 3;
 
-            m_pWindowDesc->InputStruct.push( is );
+            AbPushInputEvent( *m_pWindowDesc->InputQueue, is );
             break;
         }
 
@@ -186,7 +186,7 @@ void BasicWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM lParam )
             is.Event             = EAbInputEvents::AbButtonPress;
             is.MouseButton.KeyId = 2;
 
-            m_pWindowDesc->InputStruct.push( is );
+            AbPushInputEvent( *m_pWindowDesc->InputQueue, is );
             break;
         }
 
@@ -199,7 +199,7 @@ void BasicWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM lParam )
             is.Mouse.MouseX = GET_X_LPARAM( lParam );
             is.Mouse.MouseY = GET_Y_LPARAM( lParam );
 
-            m_pWindowDesc->InputStruct.push( is );
+            AbPushInputEvent( *m_pWindowDesc->InputQueue, is );
 
             return;
         }
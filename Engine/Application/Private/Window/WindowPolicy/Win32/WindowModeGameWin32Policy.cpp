@@ -121,8 +121,9 @@ void WindowModeGameWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM
 
             pWd->LastEvent |= EAbWindowEvents::Input;
 
-            is.Event = EAbInputEvents::AbMotion;
-            pRi      = reinterpret_cast<PRAWINPUT>( &vRi[ 0 ] );
+            is.Event         = EAbInputEvents::AbMotion;
+            is.Mouse.IsDelta = 1;
+            pRi              = reinterpret_cast<PRAWINPUT>( &vRi[ 0 ] );
             for ( size_t i = 0; i < uRiRead; ++i, pRi = NEXTRAWINPUTBLOCK( pRi ) )
             {
                 auto &mouse = pRi->data.mouse;
@@ -134,7 +135,7 @@ void WindowModeGameWin32WindowPolicy::OnUpdate( UINT uMsg, WPARAM wParam, LPARAM
                 is.Mouse.MouseY += mouse.lLastY;
             }
 
-            pWd->InputStruct.push( is );
+            AbPushInputEvent( *pWd->InputQueue, is );
 
             GetWindowRect( this->GetWindowDesc()->hWnd, &clientPos );
 
@@ -15,6 +15,8 @@ typedef enum EAbInputEvents
 typedef struct AbInputStruct
 {
     EAbInputEvents Event;
+    // Monotonic time in microseconds, taken when the window pump received the event
+    uint64_t Timestamp;
 
     union
     {
@@ -27,6 +29,8 @@ typedef struct AbInputStruct
         {
             int32_t MouseX;
             int32_t MouseY;
+            // Non zero when X and Y are relative deltas (raw input), otherwise it's the absolute cursor position
+            uint8_t IsDelta;
         } Mouse;
 
         struct
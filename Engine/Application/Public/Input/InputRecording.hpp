@@ -0,0 +1,94 @@
+#ifndef B33_INPUT_RECORDING_H
+#define B33_INPUT_RECORDING_H
+
+#include "B33Core.h"
+
+#include "Input/InputEvents.h"
+
+namespace B33::App
+{
+
+/**
+ * @brief Writes what UserInput::Update consumed, frame by frame: the delta, the frame end timestamp
+ * and the raw AbInputStruct events. Read back by InputReplayer.
+ */
+class InputRecorder
+{
+  public:
+    BEAST_API InputRecorder();
+
+    BEAST_API ~InputRecorder();
+
+  public:
+    InputRecorder( const InputRecorder & )            = delete;
+    InputRecorder &operator=( const InputRecorder & ) = delete;
+
+    InputRecorder( InputRecorder && ) noexcept            = default;
+    InputRecorder &operator=( InputRecorder && ) noexcept = default;
+
+  public:
+    /**
+     * @return False if the file couldn't be created.
+     */
+    BEAST_API bool Open( const ::std::filesystem::path &path );
+
+    BEAST_API void Close();
+
+    BEAST_API bool IsOpen() const;
+
+    BEAST_API void WriteFrame( float fDelta, uint64_t uFrameEnd, const ::std::vector<AbInputStruct> &vEvents );
+
+  private:
+    ::std::ofstream m_File;
+    uint32_t        m_uFrames;
+};
+
+/**
+ * @brief Reads a stream written by InputRecorder. Injected events alone don't reproduce a run, the loop has to
+ * step with the recorded deltas too, see PeekDelta.
+ */
+class InputReplayer
+{
+  public:
+    BEAST_API InputReplayer();
+
+    BEAST_API ~InputReplayer();
+
+  public:
+    InputReplayer( const InputReplayer & )            = delete;
+    InputReplayer &operator=( const InputReplayer & ) = delete;
+
+    InputReplayer( InputReplayer && ) noexcept            = default;
+    InputReplayer &operator=( InputReplayer && ) noexcept = default;
+
+  public:
+    /**
+     * @return False if the file is missing or wasn't written by a compatible InputRecorder.
+     */
+    BEAST_API bool Open( const ::std::filesystem::path &path );
+
+    BEAST_API void Close();
+
+    BEAST_API bool IsOpen() const;
+
+    /**
+     * @brief Replaces vEvents with the events of the next recorded frame.
+     *
+     * @return False when the stream ended or is corrupted, outputs are undefined then.
+     */
+    BEAST_API bool ReadFrame( float &fDelta, uint64_t &uFrameEnd, ::std::vector<AbInputStruct> &vEvents );
+
+    /**
+     * @brief Delta of the next recorded frame without consuming it, so the loop can run the frame with it.
+     *
+     * @return False when the stream ended.
+     */
+    BEAST_API bool PeekDelta( float &fDelta );
+
+  private:
+    ::std::ifstream m_File;
+    uint32_t        m_uFrames;
+};
+
+} // namespace B33::App
+#endif // !B33_INPUT_RECORDING_H
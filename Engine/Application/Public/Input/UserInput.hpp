@@ -14,16 +14,11 @@ class ControllerObject;
 
 class UserInput : public WindowListener
 {
-    struct BindHandle
-    {
-        AbInputBind Ib;
-        void       *pThis;
-    };
-
     struct UserInputImpl;
 
-    using HandlesMap = ::std::unordered_map<void *, ::std::vector<BindHandle>>;
-    using KeysStatus = ::std::bitset<B33_KEY_COUNT>;
+    // One bit per key, walked with count trailing zeros so only pressed keys are visited
+    using KeysStatus     = ::std::array<uint64_t, ( B33_KEY_COUNT + 63 ) / 64>;
+    using KeysTimestamps = ::std::array<uint64_t, B33_KEY_COUNT>;
 
   public:
     BEAST_API explicit UserInput( ::std::shared_ptr<WindowDesc> pWd = nullptr );
@@ -76,15 +71,61 @@ class UserInput : public WindowListener
 
     /**
      * Reads and consumes the input queue from WindowDesc.
-     * Plays continues binds.
+     * Plays continues binds with the time the key was actually held since the previous Update,
+     * mouse motion is coalesced into one call per Update.
+     * Only one UserInput per window may call it, the queue has a single consumer.
      */
     BEAST_API void Update( const float fDelta );
 
+    /**
+     * @return Timestamp (AbInputTimestampNow clock) of the oldest event consumed by the last Update,
+     * zero if there was none. Compare it with the present time to measure input to photon latency.
+     */
+    BEAST_API uint64_t GetOldestInputTimestamp() const;
+
+  public:
+    /**
+     * @brief Writes every frame consumed by Update (its delta and events) to the file, see InputRecorder.
+     * All keys are treated as released from now on, so a replay starts from the same state.
+     */
+    BEAST_API bool StartRecording( const ::std::filesystem::path &path );
+
+    BEAST_API void StopRecording();
+
+    /**
+     * @brief Update reads frames from the recording instead of the window, live input is dropped.
+     * Binds are played with the recorded deltas and timestamps, so the actions receive exactly what they
+     * received while recording. Replay stops by itself at the end of the file.
+     */
+    BEAST_API bool StartReplay( const ::std::filesystem::path &path );
+
+    BEAST_API void StopReplay();
+
+    BEAST_API bool IsReplaying() const;
+
+    /**
+     * @brief Delta the next replayed frame was recorded with. The loop should step with it instead of its clock,
+     * otherwise the simulation gets the same input at different times and the replay diverges.
+     *
+     * @return False when nothing is replayed or the recording ended.
+     */
+    BEAST_API bool PeekReplayDelta( float &fDelta );
+
+  private:
+    void PlayFrame( const float fDelta, const uint64_t uFrameEnd, const ::std::vector<AbInputStruct> &vEvents );
+
+    void ResetFrameState();
+
   private:
     bool m_bIsCapturing;
 
-    HandlesMap m_BindsHandles;
-    KeysStatus m_vCurrentlyPressedKeys;
+    // Controllers that have at least one bind, the binds themselves live in the maps
+    ::std::vector<ControllerObject *> m_vBoundControllers;
+
+    KeysStatus     m_vCurrentlyPressedKeys;
+    KeysTimestamps m_vKeysPressTime;
+    uint64_t       m_uLastUpdateTime;
+    uint64_t       m_uOldestInputTime;
 
     ::std::unique_ptr<UserInputImpl> m_pImpl;
 };
@@ -132,6 +132,12 @@ class IBaseWindow
             return;
         }
 
+        // Descs that didn't come from CreateWindowDesc don't have an input queue yet
+        if ( !m_pWindowDesc->InputQueue )
+        {
+            m_pWindowDesc->InputQueue = ::std::make_shared<AbInputQueue>();
+        }
+
         B33::App::AppStatus::Get().SendOpenWindowSignal( m_pWindowDesc );
 
         if ( m_Policy->WindowPolicyCreate( m_pWindowDesc.get() ) != 0 )
@@ -3,8 +3,17 @@
 
 #include "B33App.h"
 #include "Input/InputEvents.h"
+#include "Synchronization/SpscRing.hpp"
 #include "WindowEvents.h"
 
+#define B33_INPUT_QUEUE_SIZE 1024
+
+/**
+ * Input events travel from the window pump (which may run on its own thread) to UserInput through this ring.
+ * There must be exactly one producer and one consumer per queue.
+ */
+using AbInputQueue = ::B33::Core::SpscRing<AbInputStruct, B33_INPUT_QUEUE_SIZE>;
+
 /**
  * Struct that contains all the handles and information about the window.
  * Can be used to connect with different instances
@@ -13,13 +22,13 @@
  */
 struct WindowDesc
 {
-    ::std::wstring              Name;
-    const wchar_t              *pwszClassName;
-    int32_t                     Width;
-    int32_t                     Height;
-    bool                        bIsAlive;
-    EAbWindowEventsFlags        LastEvent;
-    ::std::queue<AbInputStruct> InputStruct;
+    ::std::wstring                  Name;
+    const wchar_t                  *pwszClassName;
+    int32_t                         Width;
+    int32_t                         Height;
+    bool                            bIsAlive;
+    EAbWindowEventsFlags            LastEvent;
+    ::std::shared_ptr<AbInputQueue> InputQueue;
 
 #if defined( _WIN32 )
     HWND       hWnd;
@@ -41,6 +50,7 @@ WindowDesc CreateWindowDesc( U &&wstrName, int32_t width = 1200, int32_t height
     wd.Width         = width;
     wd.Height        = height;
     wd.bIsAlive      = false;
+    wd.InputQueue    = ::std::make_shared<AbInputQueue>();
     wd.LastEvent &= 0;
 
 #if defined( _WIN32 )
@@ -54,4 +64,27 @@ WindowDesc CreateWindowDesc( U &&wstrName, int32_t width = 1200, int32_t height
     return wd;
 }
 
+/**
+ * @return Current monotonic time in microseconds, the same clock that stamps AbInputStruct::Timestamp.
+ */
+inline uint64_t AbInputTimestampNow()
+{
+    using namespace ::std::chrono;
+
+    return duration_cast<microseconds>( steady_clock::now().time_since_epoch() ).count();
+}
+
+/**
+ * @brief Stamps the event with the current monotonic time and pushes it into the queue.
+ * Has to be called only from the thread that produces the events for this queue.
+ *
+ * @return False if the queue was full and the event got dropped.
+ */
+inline bool AbPushInputEvent( AbInputQueue &queue, AbInputStruct is )
+{
+    is.Timestamp = AbInputTimestampNow();
+
+    return queue.TryPush( is );
+}
+
 #endif // !B33_WINDOW_DESC_H
@@ -7,11 +7,50 @@
 namespace B33::App
 {
 
+/**
+ * @brief State owned by the input pump thread. Main thread touches it only before the pump starts
+ * and after it was joined.
+ */
+struct InputPumpDesc
+{
+    Display                        *pDisplay;
+    Window                          WindowHandle;
+    int32_t                         Width;
+    int32_t                         Height;
+    ::std::shared_ptr<AbInputQueue> pQueue;
+
+    // XInput2 opcode when raw motion is selected, -1 otherwise
+    int XiOpCode;
+
+    // Motion gathered since the last flush, deltas for raw motion, the newest position otherwise.
+    // Raw deltas keep their sub pixel remainder between flushes
+    double MotionX;
+    double MotionY;
+    bool   bMotion;
+};
+
 /**
  * @brief Baisc linux window implementation that uses X11.
+ *
+ * Input events are read on a separate thread through a second X11 connection, which blocks on the
+ * connection's fd and pushes timestamped events into WindowDesc::InputQueue. Window events (resize, expose,
+ * close) stay on the main connection and are processed in UpdateImpl, events of other windows that share
+ * the connection are routed to them by their X Window.
  */
 class BEAST_API BasicLinuxWindowPolicy : public IWindowPolicy<BasicLinuxWindowPolicy>
 {
+  public:
+    BasicLinuxWindowPolicy();
+
+    virtual ~BasicLinuxWindowPolicy();
+
+  public:
+    BasicLinuxWindowPolicy( const BasicLinuxWindowPolicy & )            = delete;
+    BasicLinuxWindowPolicy &operator=( const BasicLinuxWindowPolicy & ) = delete;
+
+    BasicLinuxWindowPolicy( BasicLinuxWindowPolicy && )            = delete;
+    BasicLinuxWindowPolicy &operator=( BasicLinuxWindowPolicy && ) = delete;
+
   public:
     uint32_t CreateImpl( WindowDesc *pWd );
 
@@ -36,10 +75,58 @@ class BEAST_API BasicLinuxWindowPolicy : public IWindowPolicy<BasicLinuxWindowPo
      */
     virtual uint32_t OnUpdate( WindowDesc *pWd, XEvent &event );
 
+    /**
+     * @brief Called on the main thread after the input connection was opened, before the pump thread starts.
+     * Use it to select additional input events on pIpd->pDisplay.
+     */
+    virtual void OnInputCreate( InputPumpDesc *pIpd ) {}
+
+    /**
+     * @brief Called on the input pump thread for every event of the input connection.
+     * Must only use pIpd, WindowDesc isn't safe to touch from there.
+     */
+    virtual void OnInputUpdate( InputPumpDesc *pIpd, XEvent &event );
+
+    /**
+     * @brief Called on the input pump thread after every batch of events that was read in one go.
+     * Pushes the coalesced motion, so the game thread gets one motion event per pump instead of one per packet.
+     */
+    virtual void OnInputFlush( InputPumpDesc *pIpd );
+
+  protected:
+    /**
+     * @brief Selects XInput2 raw motion on the root window for the input connection.
+     * Core motion events are ignored afterwards and unaccelerated deltas are reported instead.
+     * Call it from OnInputCreate.
+     *
+     * @return False if XInput2 2.0 isn't available, core motion stays in use then.
+     */
+    bool EnableRawMotion( InputPumpDesc *pIpd );
+
+    /**
+     * @brief Pushes the event into the input queue, warns once per overflow streak.
+     */
+    void PushInput( InputPumpDesc *pIpd, const AbInputStruct &is );
+
   private:
-    void HandleKey( WindowDesc *pWd, XEvent &event, EAbInputEvents ie );
+    void StartInputPump( WindowDesc *pWd );
+
+    void StopInputPump();
+
+    void InputPumpLoop();
 
-    void HandleMouseButton( WindowDesc *pWd, XEvent &event, EAbInputEvents ie );
+    void HandleKey( InputPumpDesc *pIpd, XEvent &event, EAbInputEvents ie );
+
+    void HandleMouseButton( InputPumpDesc *pIpd, XEvent &event, EAbInputEvents ie );
+
+    void HandleRawMotion( InputPumpDesc *pIpd, XEvent &event );
+
+  private:
+    InputPumpDesc      m_InputPump;
+    ::std::thread      m_InputThread;
+    ::std::atomic_bool m_bPumpRunning;
+    int                m_pWakePipe[ 2 ];
+    bool               m_bQueueOverflow;
 };
 
 } // namespace B33::App
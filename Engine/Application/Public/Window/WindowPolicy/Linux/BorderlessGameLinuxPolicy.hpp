@@ -9,7 +9,7 @@ namespace B33::App
 
 /**
  * @brief Game version of BasicLinuxWindowPolicy, hides cursor, captures it and outputs raw deltas from the mouse
- * for the InputStruct.
+ * for the InputQueue.
  */
 class BEAST_API BorderlessGameLinuxWindowPolicy : public GameLinuxWindowPolicy
 {
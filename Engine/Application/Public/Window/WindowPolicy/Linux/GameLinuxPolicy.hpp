@@ -9,24 +9,21 @@ namespace B33::App
 
 /**
  * @brief Game version of BasicLinuxWindowPolicy, hides cursor, captures it and outputs raw deltas from the mouse
- * for the InputStruct.
+ * for the InputQueue. Grab, cursor and raw motion all live on the input pump connection.
  */
 class BEAST_API GameLinuxWindowPolicy : public BasicLinuxWindowPolicy
 {
   public:
-    virtual void OnCreate( WindowDesc *pWd ) override;
+    virtual void OnInputCreate( InputPumpDesc *pIpd ) override;
 
-    virtual uint32_t OnUpdate( WindowDesc *pWd, XEvent &event ) override;
+    virtual void OnInputUpdate( InputPumpDesc *pIpd, XEvent &event ) override;
 
-  private:
-    void HandleRawInput( WindowDesc *pWd, XEvent &event );
-
-    void HandleFocusIn( WindowDesc *pWd );
-
-    void HandleFocusOut( WindowDesc *pWd );
+    virtual void OnInputFlush( InputPumpDesc *pIpd ) override;
 
   private:
-    int m_OpCode;
+    void HandleFocusIn( InputPumpDesc *pIpd );
+
+    void HandleFocusOut( InputPumpDesc *pIpd );
 };
 
 } // namespace B33::App
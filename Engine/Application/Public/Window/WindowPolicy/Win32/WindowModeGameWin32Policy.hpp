@@ -9,7 +9,7 @@ namespace B33::App
 
 /**
  * @brief Game version of BasicWin32WindowPolicy, hides cursor, captures it and outputs raw deltas from the mouse
- * for the InputStruct.
+ * for the InputQueue.
  */
 class BEAST_API WindowModeGameWin32WindowPolicy : public BasicWin32WindowPolicy
 {
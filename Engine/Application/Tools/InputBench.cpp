@@ -0,0 +1,145 @@
+#include "B33Core.h"
+
+#include "Input/ControllerObject.hpp"
+#include "Input/KeyList.hpp"
+#include "Input/MouseButtonList.hpp"
+#include "Input/UserInput.hpp"
+#include "Window/WindowDesc.hpp"
+
+#include <numeric>
+
+using namespace ::std;
+using namespace ::B33::App;
+
+using BenchClock = chrono::steady_clock;
+
+// Counts what the binds received, keeps the dispatch from being optimized away
+struct BenchSink
+{
+    uint64_t uActions = 0;
+    int64_t  iMotion  = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+static AbActionType CountAction( const float, void *pThis )
+{
+    ++static_cast<BenchSink *>( pThis )->uActions;
+    return AbActionType();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static AbActionType CountMotion( const float, void *pThis, int32_t iX, int32_t iY )
+{
+    static_cast<BenchSink *>( pThis )->iMotion += iX + iY;
+    return AbActionType();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static void PrintHelp()
+{
+    printf( "Usage:\n"
+            "    B33InputBench <recording> [passes]\n"
+            "\n"
+            "Plays a recording written with B33_RECORD_INPUT through UserInput, with a press, release and continuous\n"
+            "bind on every key and mouse button and a motion bind, and reports the time spent in Update per frame.\n"
+            "\n"
+            "    passes    how many times the recording is played, 10 by default\n" );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static void BindEverything( UserInput &input, ControllerObject &controller, BenchSink &sink )
+{
+    AbInputBind ib;
+
+    ib.Type = EAbBindType::Keyboard;
+    for ( AbKeyId key = B33_INVALID_KEY + 1; key < B33_KEY_COUNT; ++key )
+    {
+        for ( EAbOnState state : { EAbOnState::Press, EAbOnState::Release, EAbOnState::Continuous } )
+        {
+            ib.Keyboard = AbKeyboardBind { state, key };
+            input.Bind( &sink, &controller, &CountAction, nullptr, ib );
+        }
+    }
+
+    ib.Type = EAbBindType::MouseButton;
+    for ( AbKeyId button = B33_INVALID_BUTTON + 1; button < B33_MOUSE_BUTTONS_COUNT; ++button )
+    {
+        for ( EAbOnState state : { EAbOnState::Press, EAbOnState::Release } )
+        {
+            ib.MouseButton = AbMouseButtonBind { state, button };
+            input.Bind( &sink, &controller, &CountAction, nullptr, ib );
+        }
+    }
+
+    ib.Type = EAbBindType::Mouse;
+    input.Bind( &sink, &controller, nullptr, &CountMotion, ib );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+    if ( argc < 2 || string_view( argv[ 1 ] ) == "--help" || string_view( argv[ 1 ] ) == "-h" )
+    {
+        PrintHelp();
+        return argc < 2 ? -1 : 0;
+    }
+
+    const filesystem::path recording = argv[ 1 ];
+    const uint32_t         uPasses   = argc > 2 ? max( atoi( argv[ 2 ] ), 1 ) : 10;
+
+    // Never shown, the queue only has to exist for Update, replay drops whatever is in it
+    auto pWindowDesc = make_shared<WindowDesc>( CreateWindowDesc( L"B33InputBench" ) );
+    auto pInput      = make_shared<UserInput>( pWindowDesc );
+
+    BenchSink        sink;
+    ControllerObject controller;
+
+    controller.SignObject( pInput );
+    BindEverything( *pInput, controller, sink );
+    pInput->StartCapturing();
+
+    vector<double> vFrameUs;
+    for ( uint32_t uPass = 0; uPass < uPasses; ++uPass )
+    {
+        if ( !pInput->StartReplay( recording ) )
+        {
+            printf( "Couldn't replay %s\n", recording.string().c_str() );
+            return -1;
+        }
+
+        // The call that hits the end of the file stops the replay, it isn't a frame
+        while ( true )
+        {
+            const BenchClock::time_point start = BenchClock::now();
+            pInput->Update( 0.f );
+            const BenchClock::time_point end = BenchClock::now();
+
+            if ( !pInput->IsReplaying() )
+                break;
+
+            vFrameUs.push_back( chrono::duration<double, micro>( end - start ).count() );
+        }
+    }
+
+    pInput->StopCapturing();
+
+    if ( vFrameUs.empty() )
+    {
+        printf( "%s has no frames\n", recording.string().c_str() );
+        return -1;
+    }
+
+    const double fTotalUs = accumulate( vFrameUs.begin(), vFrameUs.end(), 0. );
+    sort( vFrameUs.begin(), vFrameUs.end() );
+
+    printf( "Frames:  %zu in %u passes\n", vFrameUs.size(), uPasses );
+    printf( "Actions: %llu, motion sum %lld\n",
+            static_cast<unsigned long long>( sink.uActions ),
+            static_cast<long long>( sink.iMotion ) );
+    printf( "Mean:    %.3f us per frame\n", fTotalUs / vFrameUs.size() );
+    printf( "Median:  %.3f us\n", vFrameUs[ vFrameUs.size() / 2 ] );
+    printf( "P99:     %.3f us\n", vFrameUs[ min( vFrameUs.size() - 1, vFrameUs.size() * 99 / 100 ) ] );
+    printf( "Max:     %.3f us\n", vFrameUs.back() );
+
+    return 0;
+}
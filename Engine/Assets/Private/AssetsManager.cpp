@@ -0,0 +1,234 @@
+#include "B33Assets.hpp"
+
+#include "AssetsManager.hpp"
+#include "Inflate.hpp"
+
+namespace B33::Assets
+{
+
+using namespace ::std;
+using namespace ::B33::Core::Debug;
+
+static constexpr char AssetExtension[] = ".b33asset";
+
+// ---------------------------------------------------------------------------------------------------------------------
+AssetsManager::AssetsManager( filesystem::path rootDirectory, size_t uBudgetBytes )
+  : m_RootDirectory( move( rootDirectory ) )
+  , m_uBudgetBytes( uBudgetBytes )
+  , m_uResidentBytes( 0 )
+  , m_uLoading( 0 )
+  , m_pPacks( make_shared<const PackList>() )
+  , m_Lru()
+  , m_Assets()
+  , m_Pending()
+  , m_CompletedMutex()
+  , m_vCompleted()
+  , m_JobSystem()
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+AssetsManager::~AssetsManager()
+{
+    // Queued loads are dropped, handles still alive will report them as queued forever
+    m_Pending.clear();
+
+    B33_LOG( Info,
+             L"Destroying assets manager. [Cached: %zu] [ResidentBytes: %zu] [Loading: %u]",
+             m_Assets.size(),
+             m_uResidentBytes,
+             m_uLoading );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void AssetsManager::Update()
+{
+    RetireCompleted();
+    DispatchPending();
+    Evict();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool AssetsManager::MountPack( const filesystem::path &path )
+{
+    auto pPack = make_shared<PackReader>();
+    if ( !pPack->Open( path ) )
+        return false;
+
+    auto pPacks = make_shared<PackList>( *m_pPacks );
+    pPacks->push_back( move( pPack ) );
+    m_pPacks = move( pPacks );
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void AssetsManager::SetBudget( size_t uBudgetBytes )
+{
+    m_uBudgetBytes = uBudgetBytes;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+shared_ptr<AssetEntry> AssetsManager::RequestInternal( string strFullName, AssetEntry::Loader loader )
+{
+    auto it = m_Assets.find( strFullName );
+    if ( it != m_Assets.end() )
+    {
+        // Touch, the entry becomes the most recently used
+        m_Lru.splice( m_Lru.begin(), m_Lru, it->second );
+        return *it->second;
+    }
+
+    auto pEntry  = make_shared<AssetEntry>();
+    pEntry->Path = m_RootDirectory / ( strFullName + AssetExtension );
+    pEntry->Name = move( strFullName );
+    pEntry->Load = move( loader );
+
+    m_Lru.push_front( pEntry );
+    m_Assets.emplace( pEntry->Name, m_Lru.begin() );
+    m_Pending.push_back( pEntry );
+
+    B33_LOG( Info, L"Asset requested. [Path: %ls]", pEntry->Path.wstring().c_str() );
+
+    DispatchPending();
+    return pEntry;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void AssetsManager::DispatchPending()
+{
+    while ( !m_Pending.empty() )
+    {
+        auto &pEntry = m_Pending.front();
+
+        pEntry->State.store( EAssetState::Loading, memory_order_relaxed );
+        const bool bPushed = m_JobSystem.TryPushJob(
+            [ this, pEntry, pPacks = m_pPacks ]()
+            {
+                LoadJob( pEntry, *pPacks );
+            } );
+
+        if ( !bPushed )
+        {
+            pEntry->State.store( EAssetState::Queued, memory_order_relaxed );
+            return;
+        }
+
+        ++m_uLoading;
+        m_Pending.pop_front();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void AssetsManager::RetireCompleted()
+{
+    vector<shared_ptr<AssetEntry>> vCompleted;
+    {
+        lock_guard lg( m_CompletedMutex );
+        vCompleted.swap( m_vCompleted );
+    }
+
+    for ( const auto &pEntry : vCompleted )
+    {
+        --m_uLoading;
+
+        if ( pEntry->State.load( memory_order_acquire ) == EAssetState::Failed )
+        {
+            B33_LOG( Warning, L"Couldn't load the asset. [Path: %ls]", pEntry->Path.wstring().c_str() );
+
+            // Handles keep reporting the failure, the next request of the name loads it again
+            auto it = m_Assets.find( pEntry->Name );
+            if ( it != m_Assets.end() && *it->second == pEntry )
+            {
+                m_Lru.erase( it->second );
+                m_Assets.erase( it );
+            }
+
+            continue;
+        }
+
+        m_uResidentBytes += pEntry->uSizeInBytes;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void AssetsManager::Evict()
+{
+    if ( m_uResidentBytes <= m_uBudgetBytes )
+        return;
+
+    auto it = m_Lru.end();
+    while ( it != m_Lru.begin() && m_uResidentBytes > m_uBudgetBytes )
+    {
+        --it;
+
+        const auto &pEntry = *it;
+        const auto  state  = pEntry->State.load( memory_order_acquire );
+
+        // The list is the only owner left when no handle and no job references the entry. Finished loads are
+        // accounted in RetireCompleted, until then the completed queue holds a reference too.
+        if ( pEntry.use_count() != 1 || state != EAssetState::Ready )
+            continue;
+
+        B33_LOG( Info,
+                 L"Evicting asset. [Path: %ls] [Bytes: %zu]",
+                 pEntry->Path.wstring().c_str(),
+                 pEntry->uSizeInBytes );
+
+        m_uResidentBytes -= pEntry->uSizeInBytes;
+
+        m_Assets.erase( pEntry->Name );
+        it = m_Lru.erase( it );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void AssetsManager::LoadJob( const shared_ptr<AssetEntry> &pEntry, const PackList &packs )
+{
+    EAssetState     result = EAssetState::Failed;
+    vector<uint8_t> vData;
+
+    if ( ReadFromPacks( packs, pEntry->Name, vData ) || ReadLooseFile( pEntry->Path, vData ) )
+    {
+        size_t uSizeInBytes = 0;
+        pEntry->pAsset      = pEntry->Load( move( vData ), uSizeInBytes );
+        if ( pEntry->pAsset != nullptr )
+        {
+            pEntry->uSizeInBytes = uSizeInBytes;
+            result               = EAssetState::Ready;
+        }
+    }
+
+    pEntry->State.store( result, memory_order_release );
+
+    lock_guard lg( m_CompletedMutex );
+    m_vCompleted.push_back( pEntry );
+}
+
+// Statics // ----------------------------------------------------------------------------------------------------------
+bool AssetsManager::ReadFromPacks( const PackList &packs, string_view name, vector<uint8_t> &vData )
+{
+    for ( auto it = packs.rbegin(); it != packs.rend(); ++it )
+    {
+        if ( const PackTocEntry *pEntry = ( *it )->Find( name ) )
+            return ( *it )->Read( *pEntry, vData );
+    }
+
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool AssetsManager::ReadLooseFile( const filesystem::path &path, vector<uint8_t> &vData )
+{
+    ifstream file( path, ios::binary | ios::ate );
+    if ( !file.is_open() )
+        return false;
+
+    vector<uint8_t> vCompressed( static_cast<size_t>( file.tellg() ) );
+    file.seekg( 0 );
+
+    return file.read( reinterpret_cast<char *>( vCompressed.data() ), vCompressed.size() ) &&
+           InflateRaw( vCompressed.data(), vCompressed.size(), vData );
+}
+
+} // namespace B33::Assets
@@ -0,0 +1,86 @@
+#include "B33Assets.hpp"
+
+#include "Inflate.hpp"
+
+#include <zlib.h>
+
+namespace B33::Assets
+{
+
+using namespace ::std;
+
+static constexpr size_t StreamBufferSize = 64 * 1024;
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InflateRaw( const uint8_t *pIn, size_t uInSize, vector<uint8_t> &vOut, size_t uSizeHint )
+{
+    z_stream stream = {};
+
+    // Negative window bits select raw deflate
+    if ( inflateInit2( &stream, -MAX_WBITS ) != Z_OK )
+        return false;
+
+    // Without a hint, text assets usually compress 3-4 times, start there and grow geometrically. With a hint one
+    // more byte lets the stream end be reached without another resize.
+    vOut.resize( uSizeHint != 0 ? uSizeHint + 1 : max<size_t>( uInSize * 4, 4096 ) );
+
+    stream.next_in  = const_cast<Bytef *>( pIn );
+    stream.avail_in = static_cast<uInt>( uInSize );
+
+    int    iResult  = Z_OK;
+    size_t uWritten = 0;
+    while ( iResult == Z_OK )
+    {
+        if ( uWritten == vOut.size() )
+            vOut.resize( vOut.size() * 2 );
+
+        stream.next_out  = vOut.data() + uWritten;
+        stream.avail_out = static_cast<uInt>( vOut.size() - uWritten );
+
+        iResult  = inflate( &stream, Z_NO_FLUSH );
+        uWritten = vOut.size() - stream.avail_out;
+
+        if ( iResult == Z_BUF_ERROR && stream.avail_in != 0 )
+            iResult = Z_OK;
+    }
+
+    inflateEnd( &stream );
+
+    if ( iResult != Z_STREAM_END )
+        return false;
+
+    vOut.resize( uWritten );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool InflateRawStream( const uint8_t *pIn, size_t uInSize, const function<bool( const uint8_t *, size_t )> &sink )
+{
+    z_stream stream = {};
+
+    if ( inflateInit2( &stream, -MAX_WBITS ) != Z_OK )
+        return false;
+
+    array<uint8_t, StreamBufferSize> buffer;
+
+    stream.next_in  = const_cast<Bytef *>( pIn );
+    stream.avail_in = static_cast<uInt>( uInSize );
+
+    int iResult = Z_OK;
+    while ( iResult == Z_OK )
+    {
+        stream.next_out  = buffer.data();
+        stream.avail_out = static_cast<uInt>( buffer.size() );
+
+        iResult = inflate( &stream, Z_NO_FLUSH );
+
+        const size_t uProduced = buffer.size() - stream.avail_out;
+        if ( ( iResult == Z_OK || iResult == Z_STREAM_END ) && uProduced != 0 && !sink( buffer.data(), uProduced ) )
+            iResult = Z_STREAM_ERROR;
+    }
+
+    inflateEnd( &stream );
+    return iResult == Z_STREAM_END;
+}
+
+} // namespace B33::Assets
@@ -0,0 +1,28 @@
+#ifndef B33_INFLATE_H
+#define B33_INFLATE_H
+
+#include "B33Core.h"
+
+namespace B33::Assets
+{
+
+/**
+ * @brief Decompresses a raw deflate stream (no zlib or gzip header), as written by B33Packer. Exported for the
+ * packer, which reads built .b33asset files back with it.
+ *
+ * @param uSizeHint - decompressed size if it's known, the output is grown geometrically otherwise
+ * @return False if the stream is corrupted or truncated, vOut is undefined then
+ */
+BEAST_API bool InflateRaw( const uint8_t *pIn, size_t uInSize, ::std::vector<uint8_t> &vOut, size_t uSizeHint = 0 );
+
+/**
+ * @brief Decompresses a raw deflate stream through a fixed buffer, sink gets every filled part of it.
+ *
+ * @return False if the stream is corrupted, truncated or the sink stopped it
+ */
+bool InflateRawStream( const uint8_t                                          *pIn,
+                       size_t                                                  uInSize,
+                       const ::std::function<bool( const uint8_t *, size_t )> &sink );
+
+} // namespace B33::Assets
+#endif // !B33_INFLATE_H
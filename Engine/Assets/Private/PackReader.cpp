@@ -0,0 +1,234 @@
+#include "B33Assets.hpp"
+
+#include "PackReader.hpp"
+#include "Inflate.hpp"
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#endif // !_WIN32
+
+namespace B33::Assets
+{
+
+using namespace ::std;
+using namespace ::B33::Core::Debug;
+
+// ---------------------------------------------------------------------------------------------------------------------
+PackReader::PackReader()
+  : m_Path()
+  , m_pMapped( nullptr )
+  , m_uMappedSize( 0 )
+  , m_Toc()
+  , m_pNames( nullptr )
+#ifdef _WIN32
+  , m_hFile( INVALID_HANDLE_VALUE )
+  , m_hMapping( nullptr )
+#endif // !_WIN32
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+PackReader::~PackReader()
+{
+    Close();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PackReader::Open( const filesystem::path &path )
+{
+    Close();
+
+#ifdef _WIN32
+    m_hFile = CreateFileW( path.c_str(),
+                           GENERIC_READ,
+                           FILE_SHARE_READ,
+                           nullptr,
+                           OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+                           nullptr );
+
+    LARGE_INTEGER size = {};
+    if ( m_hFile != INVALID_HANDLE_VALUE && GetFileSizeEx( m_hFile, &size ) && size.QuadPart > 0 )
+    {
+        m_hMapping = CreateFileMappingW( m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        if ( m_hMapping != nullptr )
+        {
+            m_pMapped     = static_cast<const uint8_t *>( MapViewOfFile( m_hMapping, FILE_MAP_READ, 0, 0, 0 ) );
+            m_uMappedSize = static_cast<size_t>( size.QuadPart );
+        }
+    }
+#else
+    const int iFile = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+
+    struct stat fileStat = {};
+    if ( iFile != -1 && fstat( iFile, &fileStat ) == 0 && fileStat.st_size > 0 )
+    {
+        void *pMapped = mmap( nullptr, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, iFile, 0 );
+        if ( pMapped != MAP_FAILED )
+        {
+            m_pMapped     = static_cast<const uint8_t *>( pMapped );
+            m_uMappedSize = static_cast<size_t>( fileStat.st_size );
+        }
+    }
+
+    // Mapping keeps its own reference to the file
+    if ( iFile != -1 )
+        close( iFile );
+#endif // !_WIN32
+
+    if ( m_pMapped == nullptr )
+    {
+        B33_LOG( Error, L"Couldn't map the pack. [Path: %ls]", path.wstring().c_str() );
+        Close();
+        return false;
+    }
+
+    m_Path = path;
+
+    if ( !Validate() )
+    {
+        B33_LOG( Error, L"File isn't a compatible pack. [Path: %ls]", path.wstring().c_str() );
+        Close();
+        return false;
+    }
+
+    B33_LOG( Info, L"Pack mounted. [Path: %ls] [Entries: %zu]", path.wstring().c_str(), m_Toc.size() );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void PackReader::Close()
+{
+#ifdef _WIN32
+    if ( m_pMapped != nullptr )
+        UnmapViewOfFile( m_pMapped );
+
+    if ( m_hMapping != nullptr )
+        CloseHandle( m_hMapping );
+
+    if ( m_hFile != INVALID_HANDLE_VALUE )
+        CloseHandle( m_hFile );
+
+    m_hMapping = nullptr;
+    m_hFile    = INVALID_HANDLE_VALUE;
+#else
+    if ( m_pMapped != nullptr )
+        munmap( const_cast<uint8_t *>( m_pMapped ), m_uMappedSize );
+#endif // !_WIN32
+
+    m_Path.clear();
+    m_pMapped     = nullptr;
+    m_uMappedSize = 0;
+    m_Toc         = {};
+    m_pNames      = nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const PackTocEntry *PackReader::Find( string_view name ) const
+{
+    const uint64_t uHash = HashPackName( name );
+
+    auto it = lower_bound( m_Toc.begin(),
+                           m_Toc.end(),
+                           uHash,
+                           []( const PackTocEntry &entry, uint64_t uValue )
+                           {
+                               return entry.uNameHash < uValue;
+                           } );
+
+    // Colliding hashes are adjacent, names settle them
+    for ( ; it != m_Toc.end() && it->uNameHash == uHash; ++it )
+    {
+        if ( GetName( *it ) == name )
+            return &*it;
+    }
+
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+string_view PackReader::GetName( const PackTocEntry &entry ) const
+{
+    return string_view( m_pNames + entry.uNameOffset, entry.uNameLength );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+span<const uint8_t> PackReader::GetPayload( const PackTocEntry &entry ) const
+{
+    return span<const uint8_t>( m_pMapped + entry.uOffset, static_cast<size_t>( entry.uStoredSize ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PackReader::Read( const PackTocEntry &entry, vector<uint8_t> &vOut ) const
+{
+    const auto payload = GetPayload( entry );
+
+    if ( !( entry.uFlags & PackEntryCompressed ) )
+    {
+        vOut.assign( payload.begin(), payload.end() );
+        return true;
+    }
+
+    return InflateRaw( payload.data(), payload.size(), vOut, static_cast<size_t>( entry.uSize ) ) &&
+           vOut.size() == entry.uSize;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PackReader::Stream( const PackTocEntry &entry, const StreamSink &sink ) const
+{
+    const auto payload = GetPayload( entry );
+
+    if ( !( entry.uFlags & PackEntryCompressed ) )
+        return payload.empty() || sink( payload.data(), payload.size() );
+
+    return InflateRawStream( payload.data(), payload.size(), sink );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool FitsInFile( uint64_t uOffset, uint64_t uSize, uint64_t uFileSize )
+{
+    // Never added, a crafted offset could wrap around and pass
+    return uOffset <= uFileSize && uSize <= uFileSize - uOffset;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PackReader::Validate()
+{
+    if ( m_uMappedSize < sizeof( PackHeader ) )
+        return false;
+
+    const auto &header = *reinterpret_cast<const PackHeader *>( m_pMapped );
+    if ( memcmp( header.Magic, PackMagic, sizeof( header.Magic ) ) != 0 || header.uVersion != PackVersion )
+        return false;
+
+    const uint64_t uTocSize = static_cast<uint64_t>( header.uEntryCount ) * sizeof( PackTocEntry );
+    if ( header.uTocOffset % alignof( PackTocEntry ) != 0 ||
+         !FitsInFile( header.uTocOffset, uTocSize, m_uMappedSize ) ||
+         !FitsInFile( header.uNamesOffset, header.uNamesSize, m_uMappedSize ) )
+        return false;
+
+    m_Toc    = span<const PackTocEntry>( reinterpret_cast<const PackTocEntry *>( m_pMapped + header.uTocOffset ),
+                                      header.uEntryCount );
+    m_pNames = reinterpret_cast<const char *>( m_pMapped + header.uNamesOffset );
+
+    for ( size_t i = 0; i < m_Toc.size(); ++i )
+    {
+        const auto &entry = m_Toc[ i ];
+
+        if ( entry.uOffset % PackAlignment != 0 || !FitsInFile( entry.uOffset, entry.uStoredSize, m_uMappedSize ) ||
+             static_cast<uint64_t>( entry.uNameOffset ) + entry.uNameLength > header.uNamesSize )
+            return false;
+
+        if ( !( entry.uFlags & PackEntryCompressed ) && entry.uStoredSize != entry.uSize )
+            return false;
+
+        if ( i != 0 && m_Toc[ i - 1 ].uNameHash > entry.uNameHash )
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace B33::Assets
@@ -0,0 +1,60 @@
+#ifndef B33_ASSET_H
+#define B33_ASSET_H
+
+#include "B33Core.h"
+
+/**
+ * @brief Marks a class as a loadable asset. Name of the class is used as the type postfix of the asset file,
+ * "Test" requested as BinaryAsset is loaded from "Test_BinaryAsset.b33asset".
+ *
+ * Asset class has to be default constructible and provide:
+ * - bool Deserialize( ::std::vector<uint8_t> &&vData ) - called on a job processor with the decompressed file
+ * - size_t GetSizeInBytes() const - memory kept by the asset, counted against the cache budget
+ */
+#define B33_ASSET( className )                                                                                         \
+  public:                                                                                                              \
+    static ::std::string_view GetAssetTypeName()                                                                       \
+    {                                                                                                                  \
+        return #className;                                                                                             \
+    }                                                                                                                  \
+                                                                                                                       \
+  private:
+
+namespace B33::Assets
+{
+
+/**
+ * @brief Decompressed file kept as is, for data that is parsed by the user.
+ */
+class BinaryAsset
+{
+    B33_ASSET( BinaryAsset );
+
+  public:
+    BinaryAsset() = default;
+
+    ~BinaryAsset() = default;
+
+  public:
+    bool Deserialize( ::std::vector<uint8_t> &&vData )
+    {
+        m_vData = ::std::move( vData );
+        return true;
+    }
+
+    size_t GetSizeInBytes() const
+    {
+        return m_vData.size();
+    }
+
+    const ::std::vector<uint8_t> &GetData() const
+    {
+        return m_vData;
+    }
+
+  private:
+    ::std::vector<uint8_t> m_vData = {};
+};
+
+} // namespace B33::Assets
+#endif // !B33_ASSET_H
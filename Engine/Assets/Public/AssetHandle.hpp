@@ -0,0 +1,106 @@
+#ifndef B33_ASSET_HANDLE_H
+#define B33_ASSET_HANDLE_H
+
+#include "B33Core.h"
+
+namespace B33::Assets
+{
+
+enum class EAssetState : uint8_t
+{
+    Queued,
+    Loading,
+    Ready,
+    Failed,
+};
+
+/**
+ * @brief Cache slot shared by the AssetsManager and every handle of the asset. Job processor fills pAsset and
+ * uSizeInBytes before publishing Ready or Failed, they are immutable afterwards.
+ */
+struct AssetEntry
+{
+    using Loader = ::std::function<::std::shared_ptr<void>( ::std::vector<uint8_t> &&, size_t & )>;
+
+    ::std::string              Name         = {};
+    ::std::filesystem::path    Path         = {};
+    Loader                     Load         = {};
+    ::std::atomic<EAssetState> State        = EAssetState::Queued;
+    ::std::shared_ptr<void>    pAsset       = nullptr;
+    size_t                     uSizeInBytes = 0;
+};
+
+/**
+ * @brief Future like reference to an asset returned by AssetsManager::Request. Asset stays in the cache as long
+ * as any handle of it is alive, Get() is nullptr until the load is finished.
+ */
+template <class ASSET_TYPE>
+class AssetHandle
+{
+  public:
+    AssetHandle() = default;
+
+    explicit AssetHandle( ::std::shared_ptr<AssetEntry> pEntry )
+      : m_pEntry( ::std::move( pEntry ) )
+    {
+    }
+
+    ~AssetHandle() = default;
+
+  public:
+    AssetHandle( const AssetHandle & )            = default;
+    AssetHandle &operator=( const AssetHandle & ) = default;
+
+    AssetHandle( AssetHandle && ) noexcept            = default;
+    AssetHandle &operator=( AssetHandle && ) noexcept = default;
+
+  public:
+    bool IsValid() const
+    {
+        return m_pEntry != nullptr;
+    }
+
+    EAssetState GetState() const
+    {
+        B33_ASSERT( IsValid() );
+        return m_pEntry->State.load( ::std::memory_order_acquire );
+    }
+
+    bool IsReady() const
+    {
+        return IsValid() && GetState() == EAssetState::Ready;
+    }
+
+    bool IsFailed() const
+    {
+        return IsValid() && GetState() == EAssetState::Failed;
+    }
+
+    /**
+     * @return Loaded asset or nullptr if it's still loading or the load failed
+     */
+    const ASSET_TYPE *Get() const
+    {
+        if ( !IsReady() )
+            return nullptr;
+
+        return static_cast<const ASSET_TYPE *>( m_pEntry->pAsset.get() );
+    }
+
+    const ::std::string &GetName() const
+    {
+        B33_ASSERT( IsValid() );
+        return m_pEntry->Name;
+    }
+
+    void Reset()
+    {
+        m_pEntry.reset();
+    }
+
+  private:
+    ::std::shared_ptr<AssetEntry> m_pEntry = nullptr;
+};
+
+} // namespace B33::Assets
+#endif // !B33_ASSET_HANDLE_H
@@ -0,0 +1,139 @@
+#ifndef B33_ASSETS_MANAGER_H
+#define B33_ASSETS_MANAGER_H
+
+#include "B33Assets.hpp"
+#include "PackReader.hpp"
+#include "Synchronization/JobSystem.hpp"
+
+namespace B33::Assets
+{
+
+/**
+ * @brief Streams .b33asset files (raw deflate) in the background. Reading, decompression and Deserialize run on
+ * the manager's own job system, the owning thread only queues requests and retires finished loads in Update.
+ *
+ * Assets are looked up in mounted packs first, the most recently mounted one wins, then as loose files in the
+ * root directory. Assets are shared, requesting the same name and type again returns the same entry. Entries without any handle
+ * are kept as a cache and evicted least recently requested first once the resident size exceeds the budget.
+ * Failed loads leave the cache when Update retires them, requesting the asset again retries the load.
+ * Request and Update have to be called from the same thread.
+ */
+class AssetsManager
+{
+  public:
+    static constexpr size_t DefaultBudgetBytes = 256ull * 1024ull * 1024ull;
+
+  public:
+    BEAST_API explicit AssetsManager( ::std::filesystem::path rootDirectory = "Assets",
+                                      size_t                  uBudgetBytes  = DefaultBudgetBytes );
+
+    BEAST_API ~AssetsManager();
+
+  public:
+    AssetsManager( const AssetsManager & )            = delete;
+    AssetsManager &operator=( const AssetsManager & ) = delete;
+
+    AssetsManager( AssetsManager && )            = delete;
+    AssetsManager &operator=( AssetsManager && ) = delete;
+
+  public:
+    /**
+     * @brief Never blocks, the load is started right away if a job processor is idle or in one of the next Updates.
+     */
+    template <class ASSET_TYPE>
+    AssetHandle<ASSET_TYPE> Request( ::std::string_view assetName )
+    {
+        auto pEntry = RequestInternal( ConstructFullAssetNameInternal<ASSET_TYPE>( assetName ),
+                                       []( ::std::vector<uint8_t> &&vData, size_t &uSizeInBytes )
+                                       {
+                                           auto pAsset = ::std::make_shared<ASSET_TYPE>();
+                                           if ( !pAsset->Deserialize( ::std::move( vData ) ) )
+                                               return ::std::shared_ptr<void>();
+
+                                           uSizeInBytes = pAsset->GetSizeInBytes();
+                                           return ::std::static_pointer_cast<void>( pAsset );
+                                       } );
+
+        return AssetHandle<ASSET_TYPE>( ::std::move( pEntry ) );
+    }
+
+    /**
+     * @brief Should be called once per frame. Starts queued loads on idle job processors, accounts finished ones
+     * and evicts unreferenced assets above the budget.
+     */
+    BEAST_API void Update();
+
+    /**
+     * @brief Maps a .b33pack, loads requested afterwards look in it before the loose files. Loads already running
+     * keep the packs that were mounted when they started.
+     *
+     * @return False if the pack couldn't be opened
+     */
+    BEAST_API bool MountPack( const ::std::filesystem::path &path );
+
+  public:
+    BEAST_API void SetBudget( size_t uBudgetBytes );
+
+    size_t GetBudget() const
+    {
+        return m_uBudgetBytes;
+    }
+
+    size_t GetResidentBytes() const
+    {
+        return m_uResidentBytes;
+    }
+
+    size_t GetInFlightCount() const
+    {
+        return m_Pending.size() + m_uLoading;
+    }
+
+  private:
+    using LruList  = ::std::list<::std::shared_ptr<AssetEntry>>;
+    using PackList = ::std::vector<::std::shared_ptr<const PackReader>>;
+
+  private:
+    template <class ASSET_TYPE>
+    static ::std::string ConstructFullAssetNameInternal( ::std::string_view assetName )
+    {
+        return ::std::string( assetName ) + '_' + ::std::string( ASSET_TYPE::GetAssetTypeName() );
+    }
+
+    BEAST_API ::std::shared_ptr<AssetEntry> RequestInternal( ::std::string strFullName, AssetEntry::Loader loader );
+
+    void DispatchPending();
+
+    void RetireCompleted();
+
+    void Evict();
+
+    void LoadJob( const ::std::shared_ptr<AssetEntry> &pEntry, const PackList &packs );
+
+    static bool ReadFromPacks( const PackList &packs, ::std::string_view name, ::std::vector<uint8_t> &vData );
+
+    static bool ReadLooseFile( const ::std::filesystem::path &path, ::std::vector<uint8_t> &vData );
+
+  private:
+    ::std::filesystem::path m_RootDirectory;
+    size_t                  m_uBudgetBytes;
+    size_t                  m_uResidentBytes;
+    uint32_t                m_uLoading;
+
+    // Replaced, never modified, jobs hold the list they started with
+    ::std::shared_ptr<const PackList> m_pPacks;
+
+    // Front is the most recently requested entry
+    LruList                                                m_Lru;
+    ::std::unordered_map<::std::string, LruList::iterator> m_Assets;
+    ::std::deque<::std::shared_ptr<AssetEntry>>            m_Pending;
+
+    ::std::mutex                                 m_CompletedMutex;
+    ::std::vector<::std::shared_ptr<AssetEntry>> m_vCompleted;
+
+    // Declared last, joins the processors before anything they touch is destroyed
+    ::B33::Core::JobSystem m_JobSystem;
+};
+
+} // namespace B33::Assets
+#endif // !B33_ASSETS_MANAGER_H
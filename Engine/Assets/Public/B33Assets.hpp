@@ -0,0 +1,9 @@
+#ifndef B33_B33_ASSETS_H
+#define B33_B33_ASSETS_H
+
+#include "B33Core.h"
+
+#include "Asset.hpp"
+#include "AssetHandle.hpp"
+
+#endif // !B33_B33_ASSETS_H
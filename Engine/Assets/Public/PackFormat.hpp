@@ -0,0 +1,76 @@
+#ifndef B33_PACK_FORMAT_H
+#define B33_PACK_FORMAT_H
+
+#include "B33Core.h"
+
+/**
+ * Layout of a .b33pack, all values little endian:
+ *
+ * PackHeader
+ * PackTocEntry[ uEntryCount ]  - sorted by uNameHash, then by name
+ * char[ uNamesSize ]           - entry names without terminators, referenced by uNameOffset and uNameLength
+ * payloads                     - each one starts at a PackAlignment boundary
+ *
+ * Payload is either the asset as is or raw deflate, the same stream a loose .b33asset holds.
+ */
+namespace B33::Assets
+{
+
+static constexpr char     PackMagic[ 4 ] = { 'B', '3', '3', 'P' };
+static constexpr uint32_t PackVersion    = 1;
+static constexpr uint64_t PackAlignment  = 4096;
+
+enum EPackEntryFlags : uint32_t
+{
+    PackEntryNone       = 0,
+    PackEntryCompressed = 1 << 0,
+};
+
+struct PackHeader
+{
+    char     Magic[ 4 ];
+    uint32_t uVersion;
+    uint32_t uEntryCount;
+    uint32_t uNamesSize;
+    uint64_t uTocOffset;
+    uint64_t uNamesOffset;
+    uint64_t uDataOffset;
+};
+
+struct PackTocEntry
+{
+    uint64_t uNameHash;
+    uint64_t uOffset;
+    uint64_t uStoredSize;
+    uint64_t uSize;
+    uint32_t uNameOffset;
+    uint32_t uNameLength;
+    uint32_t uFlags;
+    uint32_t uReserved;
+};
+
+static_assert( sizeof( PackHeader ) == 40, "PackHeader layout is a part of the file format" );
+static_assert( sizeof( PackTocEntry ) == 48, "PackTocEntry layout is a part of the file format" );
+
+/**
+ * @brief FNV-1a, names are full asset names, "Test_BinaryAsset" for instance.
+ */
+constexpr uint64_t HashPackName( ::std::string_view name )
+{
+    uint64_t uHash = 14695981039346656037ull;
+    for ( const char c : name )
+    {
+        uHash ^= static_cast<uint8_t>( c );
+        uHash *= 1099511628211ull;
+    }
+
+    return uHash;
+}
+
+constexpr uint64_t AlignPackOffset( uint64_t uOffset )
+{
+    return ( uOffset + PackAlignment - 1 ) & ~( PackAlignment - 1 );
+}
+
+} // namespace B33::Assets
+#endif // !B33_PACK_FORMAT_H
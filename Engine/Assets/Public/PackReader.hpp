@@ -0,0 +1,101 @@
+#ifndef B33_PACK_READER_H
+#define B33_PACK_READER_H
+
+#include "B33Assets.hpp"
+#include "PackFormat.hpp"
+
+namespace B33::Assets
+{
+
+/**
+ * @brief Maps a whole .b33pack into memory, opening costs one open and one mmap, the table of contents is used in
+ * place. Const methods are safe to call from many threads at once.
+ */
+class PackReader
+{
+  public:
+    /**
+     * @brief Called with consecutive parts of an entry, returning false stops the stream.
+     */
+    using StreamSink = ::std::function<bool( const uint8_t *, size_t )>;
+
+  public:
+    BEAST_API PackReader();
+
+    BEAST_API ~PackReader();
+
+  public:
+    PackReader( const PackReader & )            = delete;
+    PackReader &operator=( const PackReader & ) = delete;
+
+    PackReader( PackReader && )            = delete;
+    PackReader &operator=( PackReader && ) = delete;
+
+  public:
+    /**
+     * @return False if the file can't be mapped or isn't a valid pack.
+     */
+    BEAST_API bool Open( const ::std::filesystem::path &path );
+
+    BEAST_API void Close();
+
+    bool IsOpen() const
+    {
+        return m_pMapped != nullptr;
+    }
+
+  public:
+    /**
+     * @return Entry of the asset or nullptr, binary search over the name hashes.
+     */
+    BEAST_API const PackTocEntry *Find( ::std::string_view name ) const;
+
+    BEAST_API ::std::string_view GetName( const PackTocEntry &entry ) const;
+
+    /**
+     * @brief Stored bytes of the entry inside the mapping, no copy is made. For compressed entries it's the raw
+     * deflate stream. Valid until Close.
+     */
+    BEAST_API ::std::span<const uint8_t> GetPayload( const PackTocEntry &entry ) const;
+
+    /**
+     * @brief Copies or decompresses the entry into vOut.
+     */
+    BEAST_API bool Read( const PackTocEntry &entry, ::std::vector<uint8_t> &vOut ) const;
+
+    /**
+     * @brief Hands the entry out in parts without materializing it. Uncompressed entries are passed in a single
+     * call pointing into the mapping, compressed ones are inflated through a small buffer.
+     */
+    BEAST_API bool Stream( const PackTocEntry &entry, const StreamSink &sink ) const;
+
+    uint32_t GetEntryCount() const
+    {
+        return static_cast<uint32_t>( m_Toc.size() );
+    }
+
+    const ::std::filesystem::path &GetPath() const
+    {
+        return m_Path;
+    }
+
+  private:
+    /**
+     * @brief Checks the header and every entry against the mapped size, sets up the table of contents view.
+     */
+    bool Validate();
+
+  private:
+    ::std::filesystem::path         m_Path;
+    const uint8_t                  *m_pMapped;
+    size_t                          m_uMappedSize;
+    ::std::span<const PackTocEntry> m_Toc;
+    const char                     *m_pNames;
+#ifdef _WIN32
+    HANDLE m_hFile;
+    HANDLE m_hMapping;
+#endif // !_WIN32
+};
+
+} // namespace B33::Assets
+#endif // !B33_PACK_READER_H
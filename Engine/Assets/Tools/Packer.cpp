@@ -0,0 +1,298 @@
+#include "B33Core.h"
+
+#include "Inflate.hpp"
+#include "PackFormat.hpp"
+
+#include <zlib.h>
+
+using namespace ::std;
+using namespace ::B33::Assets;
+
+// Compressed entries that don't save at least this much are stored, they are served without a copy then
+static constexpr double MinCompressionGain = 0.1;
+
+struct PackerInput
+{
+    string           Name;
+    filesystem::path Path;
+    vector<uint8_t>  vData;
+    vector<uint8_t>  vStored;
+    uint32_t         uFlags;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+static void PrintHelp()
+{
+    printf( "Usage:\n"
+            "    B33Packer [--store] <output.b33pack> <Type>:<file> ...\n"
+            "    B33Packer --asset <Type>:<file> ...\n"
+            "\n"
+            "Type is the asset class name, BinaryAsset for instance. Entry of \"Models/Test.obj\" requested as\n"
+            "BinaryAsset is named \"Test_BinaryAsset\". Already built .b33asset files can be passed without the type,\n"
+            "their file name is the entry name.\n"
+            "\n"
+            "    --store    keep every entry uncompressed\n"
+            "    --asset    write a loose <name>_<Type>.b33asset next to every input instead of a pack\n" );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool ReadWholeFile( const filesystem::path &path, vector<uint8_t> &vData )
+{
+    ifstream file( path, ios::binary | ios::ate );
+    if ( !file.is_open() )
+        return false;
+
+    vData.resize( static_cast<size_t>( file.tellg() ) );
+    file.seekg( 0 );
+
+    return static_cast<bool>( file.read( reinterpret_cast<char *>( vData.data() ), vData.size() ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool DeflateRaw( const vector<uint8_t> &vIn, vector<uint8_t> &vOut )
+{
+    z_stream stream = {};
+
+    if ( deflateInit2( &stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 9, Z_DEFAULT_STRATEGY ) != Z_OK )
+        return false;
+
+    vOut.resize( deflateBound( &stream, static_cast<uLong>( vIn.size() ) ) );
+
+    stream.next_in   = const_cast<Bytef *>( vIn.data() );
+    stream.avail_in  = static_cast<uInt>( vIn.size() );
+    stream.next_out  = vOut.data();
+    stream.avail_out = static_cast<uInt>( vOut.size() );
+
+    const int iResult = deflate( &stream, Z_FINISH );
+    vOut.resize( stream.total_out );
+    deflateEnd( &stream );
+
+    return iResult == Z_STREAM_END;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool LoadInput( const string &strArgument, PackerInput &input )
+{
+    const size_t uSeparator = strArgument.find( ':' );
+
+    // Drive letters aren't types, "C:\..." is a path
+    const bool bTyped = uSeparator != string::npos && uSeparator > 1;
+
+    input.Path = bTyped ? strArgument.substr( uSeparator + 1 ) : strArgument;
+
+    vector<uint8_t> vFile;
+    if ( !ReadWholeFile( input.Path, vFile ) )
+    {
+        fprintf( stderr, "Couldn't read \"%s\"\n", input.Path.string().c_str() );
+        return false;
+    }
+
+    if ( bTyped )
+    {
+        input.Name  = input.Path.stem().string() + '_' + strArgument.substr( 0, uSeparator );
+        input.vData = move( vFile );
+        return true;
+    }
+
+    if ( input.Path.extension() != ".b33asset" )
+    {
+        fprintf( stderr, "\"%s\" needs a type, <Type>:<file>\n", strArgument.c_str() );
+        return false;
+    }
+
+    input.Name = input.Path.stem().string();
+    if ( !InflateRaw( vFile.data(), vFile.size(), input.vData ) )
+    {
+        fprintf( stderr, "\"%s\" isn't a raw deflate stream\n", input.Path.string().c_str() );
+        return false;
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool CompressInput( PackerInput &input, bool bStore )
+{
+    input.uFlags = PackEntryNone;
+
+    if ( !bStore && !input.vData.empty() )
+    {
+        if ( !DeflateRaw( input.vData, input.vStored ) )
+            return false;
+
+        if ( input.vStored.size() <= input.vData.size() * ( 1.0 - MinCompressionGain ) )
+        {
+            input.uFlags = PackEntryCompressed;
+            return true;
+        }
+    }
+
+    input.vStored = input.vData;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool WriteLooseAssets( vector<PackerInput> &vInputs )
+{
+    for ( auto &input : vInputs )
+    {
+        if ( !DeflateRaw( input.vData, input.vStored ) )
+            return false;
+
+        const auto path = input.Path.parent_path() / ( input.Name + ".b33asset" );
+
+        ofstream file( path, ios::binary | ios::trunc );
+        if ( !file.write( reinterpret_cast<const char *>( input.vStored.data() ), input.vStored.size() ) )
+        {
+            fprintf( stderr, "Couldn't write \"%s\"\n", path.string().c_str() );
+            return false;
+        }
+
+        printf( "%s: %zu -> %zu bytes\n", path.string().c_str(), input.vData.size(), input.vStored.size() );
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool WritePack( const filesystem::path &output, vector<PackerInput> &vInputs )
+{
+    sort( vInputs.begin(),
+          vInputs.end(),
+          []( const PackerInput &a, const PackerInput &b )
+          {
+              const uint64_t uHashA = HashPackName( a.Name );
+              const uint64_t uHashB = HashPackName( b.Name );
+              return uHashA != uHashB ? uHashA < uHashB : a.Name < b.Name;
+          } );
+
+    for ( size_t i = 1; i < vInputs.size(); ++i )
+    {
+        if ( vInputs[ i - 1 ].Name == vInputs[ i ].Name )
+        {
+            fprintf( stderr, "\"%s\" is packed twice\n", vInputs[ i ].Name.c_str() );
+            return false;
+        }
+    }
+
+    PackHeader header = {};
+    memcpy( header.Magic, PackMagic, sizeof( header.Magic ) );
+    header.uVersion     = PackVersion;
+    header.uEntryCount  = static_cast<uint32_t>( vInputs.size() );
+    header.uTocOffset   = sizeof( PackHeader );
+    header.uNamesOffset = header.uTocOffset + sizeof( PackTocEntry ) * vInputs.size();
+
+    string               strNames;
+    vector<PackTocEntry> vToc( vInputs.size() );
+    for ( size_t i = 0; i < vInputs.size(); ++i )
+    {
+        vToc[ i ].uNameHash   = HashPackName( vInputs[ i ].Name );
+        vToc[ i ].uNameOffset = static_cast<uint32_t>( strNames.size() );
+        vToc[ i ].uNameLength = static_cast<uint32_t>( vInputs[ i ].Name.size() );
+        strNames += vInputs[ i ].Name;
+    }
+
+    header.uNamesSize  = static_cast<uint32_t>( strNames.size() );
+    header.uDataOffset = AlignPackOffset( header.uNamesOffset + header.uNamesSize );
+
+    uint64_t uOffset = header.uDataOffset;
+    for ( size_t i = 0; i < vInputs.size(); ++i )
+    {
+        vToc[ i ].uOffset     = uOffset;
+        vToc[ i ].uStoredSize = vInputs[ i ].vStored.size();
+        vToc[ i ].uSize       = vInputs[ i ].vData.size();
+        vToc[ i ].uFlags      = vInputs[ i ].uFlags;
+
+        uOffset = AlignPackOffset( uOffset + vToc[ i ].uStoredSize );
+    }
+
+    ofstream file( output, ios::binary | ios::trunc );
+    if ( !file.is_open() )
+    {
+        fprintf( stderr, "Couldn't create \"%s\"\n", output.string().c_str() );
+        return false;
+    }
+
+    const vector<char> vPadding( PackAlignment, 0 );
+
+    file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    file.write( reinterpret_cast<const char *>( vToc.data() ), sizeof( PackTocEntry ) * vToc.size() );
+    file.write( strNames.data(), strNames.size() );
+
+    for ( size_t i = 0; i < vInputs.size(); ++i )
+    {
+        const uint64_t uPosition = static_cast<uint64_t>( file.tellp() );
+        file.write( vPadding.data(), static_cast<streamsize>( vToc[ i ].uOffset - uPosition ) );
+        file.write( reinterpret_cast<const char *>( vInputs[ i ].vStored.data() ), vInputs[ i ].vStored.size() );
+
+        printf( "%-48s %10zu -> %10zu bytes%s\n",
+                vInputs[ i ].Name.c_str(),
+                vInputs[ i ].vData.size(),
+                vInputs[ i ].vStored.size(),
+                vInputs[ i ].uFlags & PackEntryCompressed ? "" : " (stored)" );
+    }
+
+    if ( !file )
+    {
+        fprintf( stderr, "Couldn't write \"%s\"\n", output.string().c_str() );
+        return false;
+    }
+
+    printf( "%s: %zu entries, %llu bytes\n",
+            output.string().c_str(),
+            vInputs.size(),
+            static_cast<unsigned long long>( file.tellp() ) );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int main( int argc, char **argv )
+{
+    bool           bStore = false;
+    bool           bAsset = false;
+    vector<string> vArguments;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        const string_view argument = argv[ i ];
+        if ( argument == "--store" )
+            bStore = true;
+        else if ( argument == "--asset" )
+            bAsset = true;
+        else if ( argument == "--help" || argument == "-h" )
+        {
+            PrintHelp();
+            return 0;
+        }
+        else
+            vArguments.emplace_back( argument );
+    }
+
+    const size_t uFirstInput = bAsset ? 0 : 1;
+    if ( vArguments.size() <= uFirstInput )
+    {
+        PrintHelp();
+        return -1;
+    }
+
+    vector<PackerInput> vInputs( vArguments.size() - uFirstInput );
+    for ( size_t i = 0; i < vInputs.size(); ++i )
+    {
+        if ( !LoadInput( vArguments[ uFirstInput + i ], vInputs[ i ] ) )
+            return -1;
+    }
+
+    if ( bAsset )
+        return WriteLooseAssets( vInputs ) ? 0 : -1;
+
+    for ( auto &input : vInputs )
+    {
+        if ( !CompressInput( input, bStore ) )
+        {
+            fprintf( stderr, "Couldn't compress \"%s\"\n", input.Path.string().c_str() );
+            return -1;
+        }
+    }
+
+    return WritePack( vArguments[ 0 ], vInputs ) ? 0 : -1;
+}
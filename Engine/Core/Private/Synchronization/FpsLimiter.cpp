@@ -2,6 +2,11 @@
 
 #include "Synchronization/FpsLimiter.hpp"
 
+#if defined( __linux__ )
+#    include <cerrno>
+#    include <time.h>
+#endif // !__linux__
+
 namespace B33::Core
 {
 
@@ -9,17 +14,23 @@ using namespace ::std;
 using namespace ::std::chrono;
 
 // --------------------------------------------------------------------------------------------------------------------
-FpsLimiter::FpsLimiter( const float fTargetMs )
+FpsLimiter::FpsLimiter( const float fTargetMs, const EPacingMode mode )
   : m_fTarget( fTargetMs )
   , m_fBalance( 0.f )
+  , m_Mode( mode )
+  , m_NextDeadline()
+  , m_LastRelease()
+  , m_LastPresent()
+  , m_bPresentFed( false )
+  , m_Samples()
+  , m_uHead( 0 )
+  , m_uCount( 0 )
 {
 }
 
 // --------------------------------------------------------------------------------------------------------------------
 float FpsLimiter::Block( const float fDeltaMs, const float fFetchMs )
 {
-    using DurationMs = duration<float, milli>;
-
     m_fBalance += m_fTarget - fFetchMs;
     const float fTotalWait = m_fTarget - fDeltaMs + m_fBalance;
     if ( fTotalWait <= 0.f )
@@ -28,9 +39,130 @@ float FpsLimiter::Block( const float fDeltaMs, const float fFetchMs )
         return 0.f;
     }
 
-    this_thread::sleep_for( DurationMs( fTotalWait ) );
+    WaitUntil( ClockType::now() + duration_cast<ClockType::duration>( DurationMs( fTotalWait ) ) );
 
     return fTotalWait;
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+float FpsLimiter::Pace()
+{
+    const auto      target = duration_cast<ClockType::duration>( DurationMs( m_fTarget ) );
+    const TimeStamp now    = ClockType::now();
+
+    if ( m_LastRelease == TimeStamp() )
+    {
+        m_LastRelease  = now;
+        m_NextDeadline = now + target;
+        return 0.f;
+    }
+
+    // Fell behind by more than a frame, catching up would only produce a burst of short frames
+    if ( now > m_NextDeadline + target )
+        m_NextDeadline = now;
+
+    if ( now < m_NextDeadline )
+        WaitUntil( m_NextDeadline );
+
+    const TimeStamp release = ClockType::now();
+    if ( !m_bPresentFed )
+        PushSample( duration_cast<DurationMs>( release - m_LastRelease ).count() );
+
+    m_LastRelease = release;
+    m_NextDeadline += target;
+
+    return duration_cast<DurationMs>( release - now ).count();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void FpsLimiter::ReportPresent( const TimeStamp &present )
+{
+    // Frame didn't reach the present, ex. swapchain was recreated
+    if ( m_bPresentFed && present == m_LastPresent )
+        return;
+
+    if ( m_bPresentFed )
+    {
+        const float fInterval = duration_cast<DurationMs>( present - m_LastPresent ).count();
+        const float fError    = clamp( fInterval - m_fTarget, -0.5f * m_fTarget, 0.5f * m_fTarget );
+
+        PushSample( fInterval );
+        m_NextDeadline -= duration_cast<ClockType::duration>( DurationMs( fError * PresentCorrectionGain ) );
+    }
+
+    m_LastPresent = present;
+    m_bPresentFed = true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+FramePacingStats FpsLimiter::GetStats() const
+{
+    FramePacingStats stats = {};
+    stats.fTargetMs        = m_fTarget;
+    stats.uSamples         = static_cast<uint32_t>( m_uCount );
+
+    if ( m_uCount == 0 )
+        return stats;
+
+    for ( size_t i = 0; i < m_uCount; ++i )
+    {
+        const float fSample = m_Samples[ i ];
+
+        stats.fMeanMs += fSample;
+        stats.fMaxErrorMs = max( stats.fMaxErrorMs, abs( fSample - m_fTarget ) );
+        stats.uMissed += fSample > m_fTarget * 1.5f ? 1 : 0;
+    }
+    stats.fMeanMs /= m_uCount;
+
+    for ( size_t i = 0; i < m_uCount; ++i )
+        stats.fStdDevMs += ( m_Samples[ i ] - stats.fMeanMs ) * ( m_Samples[ i ] - stats.fMeanMs );
+    stats.fStdDevMs = sqrt( stats.fStdDevMs / m_uCount );
+
+    return stats;
+}
+
+// Private // ----------------------------------------------------------------------------------------------------------
+void FpsLimiter::WaitUntil( const TimeStamp &deadline )
+{
+    if ( m_Mode == EPacingMode::SleepOnly )
+    {
+        this_thread::sleep_until( deadline );
+        return;
+    }
+
+    const TimeStamp spinFrom = deadline - duration_cast<ClockType::duration>( DurationMs( SpinThresholdMs ) );
+    if ( ClockType::now() < spinFrom )
+    {
+#if defined( __linux__ )
+        if ( m_Mode == EPacingMode::DeadlineSpin )
+        {
+            // steady_clock is CLOCK_MONOTONIC on Linux, so its epoch can be used for the absolute deadline
+            const auto ns = duration_cast<nanoseconds>( spinFrom.time_since_epoch() ).count();
+            timespec   ts = {
+                  .tv_sec  = static_cast<time_t>( ns / 1000000000 ),
+                  .tv_nsec = static_cast<long>( ns % 1000000000 ),
+            };
+
+            while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr ) == EINTR )
+                ;
+        }
+        else
+#endif // !__linux__
+        {
+            this_thread::sleep_until( spinFrom );
+        }
+    }
+
+    while ( ClockType::now() < deadline )
+        ;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void FpsLimiter::PushSample( const float fIntervalMs )
+{
+    m_Samples[ m_uHead ] = fIntervalMs;
+    m_uHead              = ( m_uHead + 1 ) % StatsWindow;
+    m_uCount             = min( m_uCount + 1, StatsWindow );
+}
+
 } // namespace B33::Core
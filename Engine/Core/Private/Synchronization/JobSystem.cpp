@@ -12,8 +12,6 @@ void JobSystem::JobProcessorLoop( mutex              &mutex,
                                   atomic_bool        &IsFree,
                                   Job                &currentJob )
 {
-    IsFree.store( true );
-
     while ( 1 )
     {
         unique_lock ul( mutex );
@@ -24,7 +22,10 @@ void JobSystem::JobProcessorLoop( mutex              &mutex,
                         } );
 
         if ( currentJob.Runnable != nullptr )
+        {
             currentJob.Runnable();
+            currentJob.Runnable = nullptr;
+        }
 
         if ( !IsWorking.load() )
             return;
@@ -59,7 +60,10 @@ JobSystem::~JobSystem()
     for ( auto &t : m_Threads )
     {
         B33_TRACE( L"JobSystem::~JobSystem(): Stopping one of job processors" );
-        t.IsWorking.store( false );
+        {
+            lock_guard lg( t.Mutex );
+            t.IsWorking.store( false );
+        }
         t.Condition.notify_all();
         t.Thread.join();
     }
@@ -95,11 +99,41 @@ void JobSystem::PushJobInternal( Job newJob )
                                    } );
     }
 
-    headThread.CurrentJob = newJob;
-    headThread.IsFree.store( false );
+    {
+        // Publish the job under the lock, otherwise processor can miss the notification between checking its
+        // predicate and going to sleep.
+        lock_guard lg( headThread.Mutex );
+        headThread.CurrentJob = newJob;
+        headThread.IsFree.store( false );
+    }
     headThread.Condition.notify_all();
 
     m_uHead = ( m_uHead + 1 ) % m_Threads.size();
 }
 
+bool JobSystem::TryPushJobInternal( Job &newJob )
+{
+    for ( size_t i = 0; i < m_Threads.size(); ++i )
+    {
+        auto &processor = m_Threads[ ( m_uHead + i ) % m_Threads.size() ];
+
+        // Processor holds its mutex while running a job, only the owner clears IsFree so a free processor stays
+        // free until the job is published below
+        if ( !processor.IsFree.load() )
+            continue;
+
+        {
+            lock_guard lg( processor.Mutex );
+            processor.CurrentJob = move( newJob );
+            processor.IsFree.store( false );
+        }
+        processor.Condition.notify_all();
+
+        m_uHead = ( m_uHead + i + 1 ) % m_Threads.size();
+        return true;
+    }
+
+    return false;
+}
+
 }; // namespace B33::Core
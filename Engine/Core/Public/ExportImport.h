@@ -13,4 +13,10 @@
 #        define BEAST_API __declspec( dllimport )
 #    endif // !_BEAST_EXPORTS
 #endif     // !__linux__
-#endif     // !B33_EXPORT_IMPORT_
+
+#ifdef _MSC_VER
+#    define B33_FORCE_INLINE __forceinline
+#else
+#    define B33_FORCE_INLINE inline __attribute__( ( always_inline ) )
+#endif // !_MSC_VER
+#endif // !B33_EXPORT_IMPORT_
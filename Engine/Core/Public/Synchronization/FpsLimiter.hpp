@@ -4,12 +4,44 @@
 namespace B33::Core
 {
 
+enum EPacingMode
+{
+    /** Plain sleep, cheapest but exposed to the scheduler jitter */
+    SleepOnly,
+    /** Sleeps until SpinThresholdMs before the deadline, then spins on the steady clock */
+    HybridSpin,
+    /** Same as HybridSpin, but the sleep is scheduled on an absolute deadline (clock_nanosleep where available) */
+    DeadlineSpin,
+};
+
+/**
+ * @brief Achieved frame intervals compared with the target, gathered over the last StatsWindow frames.
+ */
+struct FramePacingStats
+{
+    float      fTargetMs   = 0.f;
+    float      fMeanMs     = 0.f;
+    float      fStdDevMs   = 0.f;
+    float      fMaxErrorMs = 0.f;
+    ::uint32_t uSamples    = 0;
+    ::uint32_t uMissed     = 0;
+};
+
 class FpsLimiter
 {
+    using ClockType  = ::std::chrono::steady_clock;
+    using DurationMs = ::std::chrono::duration<float, ::std::milli>;
+    using TimeStamp  = ::std::chrono::time_point<ClockType>;
+
+  public:
+    static constexpr float    SpinThresholdMs       = 1.f;
+    static constexpr float    PresentCorrectionGain = 0.25f;
+    static constexpr ::size_t StatsWindow           = 256;
+
   public:
     FpsLimiter() = delete;
 
-    explicit BEAST_API FpsLimiter( const float fTargetMs );
+    explicit BEAST_API FpsLimiter( const float fTargetMs, const EPacingMode mode = EPacingMode::SleepOnly );
 
     ~FpsLimiter() = default;
 
@@ -26,6 +58,16 @@ class FpsLimiter
         return m_fTarget;
     }
 
+    EPacingMode GetMode() const
+    {
+        return m_Mode;
+    }
+
+    void SetMode( const EPacingMode mode )
+    {
+        m_Mode = mode;
+    }
+
   public:
     /**
      * @brief Blocks current thread for the amount of time needed to achive target interval (stored in ms)
@@ -36,9 +78,43 @@ class FpsLimiter
      */
     BEAST_API float Block( const float fDeltaMs, const float fFetchMs );
 
+    /**
+     * @brief Blocks until the next frame deadline. Deadlines are absolute, so an error on one frame doesn't drift
+     * the next ones. Schedule is restarted when the caller falls behind by more than a frame.
+     *
+     * @return Time spent waiting in ms
+     */
+    BEAST_API float Pace();
+
+    /**
+     * @brief Feeds measured present (or GPU completion) time of the last frame. Achieved intervals are measured
+     * between presents then, and the deadline phase is nudged towards the target present interval.
+     */
+    BEAST_API void ReportPresent( const TimeStamp &present );
+
+    /**
+     * @return Achieved vs target intervals over the last StatsWindow frames
+     */
+    BEAST_API FramePacingStats GetStats() const;
+
   private:
-    float m_fTarget  = -1.f;
-    float m_fBalance = -1.f;
+    void WaitUntil( const TimeStamp &deadline );
+
+    void PushSample( const float fIntervalMs );
+
+  private:
+    float       m_fTarget  = -1.f;
+    float       m_fBalance = -1.f;
+    EPacingMode m_Mode     = EPacingMode::SleepOnly;
+
+    TimeStamp m_NextDeadline = {};
+    TimeStamp m_LastRelease  = {};
+    TimeStamp m_LastPresent  = {};
+    bool      m_bPresentFed  = false;
+
+    ::std::array<float, StatsWindow> m_Samples = {};
+    ::size_t                         m_uHead   = 0;
+    ::size_t                         m_uCount  = 0;
 };
 
 } // namespace B33::Core
@@ -24,8 +24,27 @@ class JobSystem
         PushJobInternal( ::std::move( newJob ) );
     }
 
+    /**
+     * @brief Non blocking variant of PushJob, hands the job to any idle processor.
+     *
+     * @return False if every processor is busy, the job isn't queued then
+     */
+    template <typename FUNCTION>
+    bool TryPushJob( FUNCTION fn )
+    {
+        Job newJob      = {};
+        newJob.Runnable = fn;
+
+        return TryPushJobInternal( newJob );
+    }
+
     BEAST_API void BlockAndWait();
 
+    ::size_t GetProcessorCount() const
+    {
+        return m_Threads.size();
+    }
+
   private:
     struct Job
     {
@@ -45,6 +64,8 @@ class JobSystem
   private:
     BEAST_API void PushJobInternal( Job newJob );
 
+    BEAST_API bool TryPushJobInternal( Job &newJob );
+
     static void JobProcessorLoop( ::std::mutex              &mutex,
                                   ::std::condition_variable &condition,
                                   ::std::atomic_bool        &IsWorking,
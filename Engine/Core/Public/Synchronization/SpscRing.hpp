@@ -0,0 +1,117 @@
+#if !defined( B33_SPSC_RING_HPP )
+#    define B33_SPSC_RING_HPP
+
+#    include "B33Core.h"
+
+namespace B33::Core
+{
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * Head and tail live on separate cache lines and every side keeps a cached copy of the other side's index,
+ * so the shared indices are only re-read when the ring looks full (producer) or empty (consumer).
+ * Capacity has to be a power of two.
+ */
+template <class T, ::size_t uCapacity>
+class SpscRing
+{
+    static_assert( uCapacity >= 2 && ( uCapacity & ( uCapacity - 1 ) ) == 0, "Capacity must be a power of two" );
+
+    static constexpr ::size_t CacheLineSize = 64;
+    static constexpr ::size_t IndexMask     = uCapacity - 1;
+
+  public:
+    SpscRing()
+      : m_uHead( 0 )
+      , m_uCachedTail( 0 )
+      , m_uTail( 0 )
+      , m_uCachedHead( 0 )
+      , m_vBuffer()
+    {
+    }
+
+    ~SpscRing() = default;
+
+  public:
+    SpscRing( const SpscRing & )            = delete;
+    SpscRing &operator=( const SpscRing & ) = delete;
+
+    SpscRing( SpscRing && )            = delete;
+    SpscRing &operator=( SpscRing && ) = delete;
+
+  public:
+    /**
+     * @brief Producer side. Never blocks.
+     *
+     * @return False when the ring is full, the item is not queued then.
+     */
+    bool TryPush( const T &item )
+    {
+        const ::size_t uTail = m_uTail.load( ::std::memory_order_relaxed );
+
+        if ( uTail - m_uCachedHead == uCapacity )
+        {
+            m_uCachedHead = m_uHead.load( ::std::memory_order_acquire );
+
+            if ( uTail - m_uCachedHead == uCapacity )
+                return false;
+        }
+
+        m_vBuffer[ uTail & IndexMask ] = item;
+        m_uTail.store( uTail + 1, ::std::memory_order_release );
+
+        return true;
+    }
+
+    /**
+     * @brief Consumer side. Never blocks.
+     *
+     * @return False when the ring is empty, item is left untouched then.
+     */
+    bool TryPop( T &item )
+    {
+        const ::size_t uHead = m_uHead.load( ::std::memory_order_relaxed );
+
+        if ( uHead == m_uCachedTail )
+        {
+            m_uCachedTail = m_uTail.load( ::std::memory_order_acquire );
+
+            if ( uHead == m_uCachedTail )
+                return false;
+        }
+
+        item = m_vBuffer[ uHead & IndexMask ];
+        m_uHead.store( uHead + 1, ::std::memory_order_release );
+
+        return true;
+    }
+
+    /**
+     * @brief Only a snapshot, the other side may change it right after the call.
+     */
+    ::size_t SizeApprox() const
+    {
+        return m_uTail.load( ::std::memory_order_acquire ) - m_uHead.load( ::std::memory_order_acquire );
+    }
+
+    static constexpr ::size_t Capacity()
+    {
+        return uCapacity;
+    }
+
+  private:
+    // Written by the consumer
+    alignas( CacheLineSize )::std::atomic<::size_t> m_uHead;
+    ::size_t m_uCachedTail;
+
+    // Written by the producer
+    alignas( CacheLineSize )::std::atomic<::size_t> m_uTail;
+    ::size_t m_uCachedHead;
+
+    alignas( CacheLineSize )::std::array<T, uCapacity> m_vBuffer;
+};
+
+} // namespace B33::Core
+
+#endif // !B33_SPSC_RING_HPP
@@ -0,0 +1,235 @@
+#include "B33Math.hpp"
+
+#include "Noise.hpp"
+
+namespace B33::Math
+{
+
+using namespace ::std;
+
+// Statics // ----------------------------------------------------------------------------------------------------------
+
+static constexpr uint32_t PrimeX = 501125321u;
+static constexpr uint32_t PrimeY = 1136930381u;
+static constexpr uint32_t PrimeZ = 1720413743u;
+
+static constexpr float SimplexF3 = 1.f / 3.f;
+static constexpr float SimplexG3 = 1.f / 6.f;
+
+// Fractal octaves are sampled through a stack buffer of this many samples
+static constexpr size_t FractalBlock = 64;
+
+// ---------------------------------------------------------------------------------------------------------------------
+static B33_FORCE_INLINE int32_t FastFloor( float f )
+{
+    const int32_t i = static_cast<int32_t>( f );
+    return i - static_cast<int32_t>( f < static_cast<float>( i ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static B33_FORCE_INLINE uint32_t HashLattice( int32_t x, int32_t y, int32_t z, uint32_t uSeed )
+{
+    uint32_t uHash = uSeed ^ ( static_cast<uint32_t>( x ) * PrimeX ) ^ ( static_cast<uint32_t>( y ) * PrimeY ) ^
+                     ( static_cast<uint32_t>( z ) * PrimeZ );
+
+    uHash *= 0x27d4eb2du;
+    return uHash ^ ( uHash >> 15 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static B33_FORCE_INLINE float LatticeValue( int32_t x, int32_t y, int32_t z, uint32_t uSeed )
+{
+    return static_cast<float>( HashLattice( x, y, z, uSeed ) >> 8 ) * ( 2.f / 16777215.f ) - 1.f;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static B33_FORCE_INLINE float Lerp( float a, float b, float t )
+{
+    return a + ( b - a ) * t;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static B33_FORCE_INLINE float ValueSample( float x, float y, float z, uint32_t uSeed )
+{
+    const int32_t ix = FastFloor( x );
+    const int32_t iy = FastFloor( y );
+    const int32_t iz = FastFloor( z );
+
+    const float fx = x - static_cast<float>( ix );
+    const float fy = y - static_cast<float>( iy );
+    const float fz = z - static_cast<float>( iz );
+
+    const float sx = fx * fx * ( 3.f - 2.f * fx );
+    const float sy = fy * fy * ( 3.f - 2.f * fy );
+    const float sz = fz * fz * ( 3.f - 2.f * fz );
+
+    const float x00 = Lerp( LatticeValue( ix, iy, iz, uSeed ), LatticeValue( ix + 1, iy, iz, uSeed ), sx );
+    const float x10 = Lerp( LatticeValue( ix, iy + 1, iz, uSeed ), LatticeValue( ix + 1, iy + 1, iz, uSeed ), sx );
+    const float x01 = Lerp( LatticeValue( ix, iy, iz + 1, uSeed ), LatticeValue( ix + 1, iy, iz + 1, uSeed ), sx );
+    const float x11 =
+        Lerp( LatticeValue( ix, iy + 1, iz + 1, uSeed ), LatticeValue( ix + 1, iy + 1, iz + 1, uSeed ), sx );
+
+    return Lerp( Lerp( x00, x10, sy ), Lerp( x01, x11, sy ), sz );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static B33_FORCE_INLINE float
+SimplexCorner( float x, float y, float z, int32_t ix, int32_t iy, int32_t iz, uint32_t uSeed )
+{
+    float t = 0.6f - x * x - y * y - z * z;
+    t       = ( t + fabs( t ) ) * 0.5f;
+
+    // One of the 12 cube edges picked by the hash. Selects are blends by 0 or 1 instead of branches or a table,
+    // compilers give up on vectorizing the row loop otherwise
+    const uint32_t h  = HashLattice( ix, iy, iz, uSeed ) & 15u;
+    const float    fU = static_cast<float>( h < 8u );
+    const float    fV = static_cast<float>( h < 4u );
+    const float    fW = static_cast<float>( ( h | 2u ) == 14u );
+
+    const float u = y + ( x - y ) * fU;
+    const float w = z + ( x - z ) * fW;
+    const float v = w + ( y - w ) * fV;
+
+    const float fGradient =
+        u * ( 1.f - 2.f * static_cast<float>( h & 1u ) ) + v * ( 1.f - static_cast<float>( h & 2u ) );
+
+    t *= t;
+    return t * t * fGradient;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static B33_FORCE_INLINE float SimplexSample( float x, float y, float z, uint32_t uSeed )
+{
+    const float   s  = ( x + y + z ) * SimplexF3;
+    const int32_t ix = FastFloor( x + s );
+    const int32_t iy = FastFloor( y + s );
+    const int32_t iz = FastFloor( z + s );
+
+    const float t  = static_cast<float>( ix + iy + iz ) * SimplexG3;
+    const float x0 = x - static_cast<float>( ix ) + t;
+    const float y0 = y - static_cast<float>( iy ) + t;
+    const float z0 = z - static_cast<float>( iz ) + t;
+
+    // Order of the offsets picks the simplex, first and second corner steps
+    const int32_t i1 = ( x0 >= y0 ) & ( x0 >= z0 );
+    const int32_t j1 = ( y0 > x0 ) & ( y0 >= z0 );
+    const int32_t k1 = ( z0 > x0 ) & ( z0 > y0 );
+    const int32_t i2 = ( x0 >= y0 ) | ( x0 >= z0 );
+    const int32_t j2 = ( y0 > x0 ) | ( y0 >= z0 );
+    const int32_t k2 = ( z0 > x0 ) | ( z0 > y0 );
+
+    const float fN0 = SimplexCorner( x0, y0, z0, ix, iy, iz, uSeed );
+    const float fN1 = SimplexCorner( x0 - i1 + SimplexG3,
+                                     y0 - j1 + SimplexG3,
+                                     z0 - k1 + SimplexG3,
+                                     ix + i1,
+                                     iy + j1,
+                                     iz + k1,
+                                     uSeed );
+    const float fN2 = SimplexCorner( x0 - i2 + 2.f * SimplexG3,
+                                     y0 - j2 + 2.f * SimplexG3,
+                                     z0 - k2 + 2.f * SimplexG3,
+                                     ix + i2,
+                                     iy + j2,
+                                     iz + k2,
+                                     uSeed );
+    const float fN3 = SimplexCorner( x0 - 1.f + 3.f * SimplexG3,
+                                     y0 - 1.f + 3.f * SimplexG3,
+                                     z0 - 1.f + 3.f * SimplexG3,
+                                     ix + 1,
+                                     iy + 1,
+                                     iz + 1,
+                                     uSeed );
+
+    return 32.f * ( fN0 + fN1 + fN2 + fN3 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+float ValueNoise3( float x, float y, float z, uint32_t uSeed )
+{
+    return ValueSample( x, y, z, uSeed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+float SimplexNoise3( float x, float y, float z, uint32_t uSeed )
+{
+    return SimplexSample( x, y, z, uSeed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ValueNoise3Row( float x0, float fStep, float y, float z, uint32_t uSeed, float *pOut, size_t uCount )
+{
+    for ( size_t i = 0; i < uCount; ++i )
+        pOut[ i ] = ValueSample( x0 + static_cast<float>( static_cast<int32_t>( i ) ) * fStep, y, z, uSeed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SimplexNoise3Row( float x0, float fStep, float y, float z, uint32_t uSeed, float *pOut, size_t uCount )
+{
+    for ( size_t i = 0; i < uCount; ++i )
+        pOut[ i ] = SimplexSample( x0 + static_cast<float>( static_cast<int32_t>( i ) ) * fStep, y, z, uSeed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void FractalNoise3Row( const FractalParams &params,
+                       float                x0,
+                       float                fStep,
+                       float                y,
+                       float                z,
+                       uint32_t             uSeed,
+                       float               *pOut,
+                       size_t               uCount )
+{
+    float fOctave[ FractalBlock ];
+
+    for ( size_t uBegin = 0; uBegin < uCount; uBegin += FractalBlock )
+    {
+        const size_t uBlock = min( FractalBlock, uCount - uBegin );
+        const float  fX     = x0 + static_cast<float>( uBegin ) * fStep;
+        float       *pBlock = pOut + uBegin;
+
+        float fAmplitude = 1.f;
+        float fFrequency = params.fFrequency;
+        float fTotal     = 0.f;
+
+        for ( size_t i = 0; i < uBlock; ++i )
+            pBlock[ i ] = 0.f;
+
+        for ( uint32_t uOctave = 0; uOctave < params.uOctaves; ++uOctave )
+        {
+            if ( params.Type == ENoiseType::Value )
+            {
+                ValueNoise3Row( fX * fFrequency,
+                                fStep * fFrequency,
+                                y * fFrequency,
+                                z * fFrequency,
+                                uSeed + uOctave,
+                                fOctave,
+                                uBlock );
+            }
+            else
+            {
+                SimplexNoise3Row( fX * fFrequency,
+                                  fStep * fFrequency,
+                                  y * fFrequency,
+                                  z * fFrequency,
+                                  uSeed + uOctave,
+                                  fOctave,
+                                  uBlock );
+            }
+
+            for ( size_t i = 0; i < uBlock; ++i )
+                pBlock[ i ] += fOctave[ i ] * fAmplitude;
+
+            fTotal     += fAmplitude;
+            fAmplitude *= params.fGain;
+            fFrequency *= params.fLacunarity;
+        }
+
+        const float fNormalize = fTotal > 0.f ? 1.f / fTotal : 0.f;
+        for ( size_t i = 0; i < uBlock; ++i )
+            pBlock[ i ] *= fNormalize;
+    }
+}
+
+} // namespace B33::Math
@@ -29,4 +29,42 @@ void WorldObjects::AddRotation( const Rot3 &rot, size_t uIndex )
     m_vRotations[ uIndex ] += rot;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void WorldObjects::StoreTransforms()
+{
+    m_vPrevPositions = m_vPositions;
+    m_vPrevRotations = m_vRotations;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorldObjects::ResetInterpolation( size_t uIndex )
+{
+    m_vPrevPositions[ uIndex ] = m_vPositions[ uIndex ];
+    m_vPrevRotations[ uIndex ] = m_vRotations[ uIndex ];
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool WorldObjects::Interpolate( float fAlpha )
+{
+    // Compared with the last blend and not with the current transforms, the blend that converges once an object
+    // stops has to be uploaded as well. Before the first call the current transforms were rendered
+    bool bChanged = !m_bInterpolated;
+
+    fAlpha          = ::std::clamp( fAlpha, 0.f, 1.f );
+    m_bInterpolated = true;
+
+    for ( size_t i = 0; i < m_vPositions.size(); ++i )
+    {
+        const Vec3 position = Lerp( m_vPrevPositions[ i ], m_vPositions[ i ], fAlpha );
+        const Rot3 rotation = LerpAngles( m_vPrevRotations[ i ], m_vRotations[ i ], fAlpha );
+
+        bChanged |= !( position == m_vBlendedPositions[ i ] ) || !( rotation == m_vBlendedRotations[ i ] );
+
+        m_vBlendedPositions[ i ] = position;
+        m_vBlendedRotations[ i ] = rotation;
+    }
+
+    return bChanged;
+}
+
 } // namespace B33::Math
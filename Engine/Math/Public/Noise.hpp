@@ -0,0 +1,57 @@
+#ifndef B33_NOISE_H
+#define B33_NOISE_H
+
+#include "B33Core.h"
+
+namespace B33::Math
+{
+
+enum class ENoiseType
+{
+    Value,
+    Simplex,
+};
+
+/**
+ * @brief Octaves of fractal Brownian motion, every octave multiplies the frequency by fLacunarity and the amplitude
+ * by fGain.
+ */
+struct FractalParams
+{
+    ENoiseType Type        = ENoiseType::Simplex;
+    uint32_t   uOctaves    = 4;
+    float      fFrequency  = 1.f / 64.f;
+    float      fLacunarity = 2.f;
+    float      fGain       = 0.5f;
+};
+
+/**
+ * Noise functions return values in [-1, 1] and are deterministic for a seed.
+ *
+ * Row variants sample uCount points ( x0 + i * fStep, y, z ) at once. Their loops are branch free and don't call
+ * anything per sample, so the compiler vectorizes them for whatever instruction set the build targets, prefer
+ * them over the single sample functions whenever whole rows are needed.
+ */
+BEAST_API float ValueNoise3( float x, float y, float z, uint32_t uSeed );
+
+BEAST_API float SimplexNoise3( float x, float y, float z, uint32_t uSeed );
+
+BEAST_API void ValueNoise3Row( float x0, float fStep, float y, float z, uint32_t uSeed, float *pOut, size_t uCount );
+
+BEAST_API void SimplexNoise3Row( float x0, float fStep, float y, float z, uint32_t uSeed, float *pOut, size_t uCount );
+
+/**
+ * @brief Fractal sum of the noise normalized back to [-1, 1]. Coordinates are in world units, params.fFrequency
+ * scales them.
+ */
+BEAST_API void FractalNoise3Row( const FractalParams &params,
+                                 float                x0,
+                                 float                fStep,
+                                 float                y,
+                                 float                z,
+                                 uint32_t             uSeed,
+                                 float               *pOut,
+                                 size_t               uCount );
+
+} // namespace B33::Math
+#endif // !B33_NOISE_H
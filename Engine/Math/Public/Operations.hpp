@@ -1,6 +1,7 @@
 #ifndef B33_OPERATIONS_H
 #define B33_OPERATIONS_H
 
+#include "Rot.hpp"
 #include "Vec3.hpp"
 
 namespace B33::Math
@@ -242,5 +243,42 @@ inline iVec3 MultiplyScalar( const iVec3 &vA, const float vB )
     return r;
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+template <class Vector>
+constexpr inline Vector Lerp( const Vector &vA, const Vector &vB, const float fT )
+{
+    static_assert( Core::TypeIsAlwaysFalse<Vector>, "This size of a vector doesn't have impementation of lerp yet" );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+template <>
+inline Vec3 Lerp( const Vec3 &vA, const Vec3 &vB, const float fT )
+{
+    Vec3 r;
+
+    r.x = vA.x + ( vB.x - vA.x ) * fT;
+    r.y = vA.y + ( vB.y - vA.y ) * fT;
+    r.z = vA.z + ( vB.z - vA.z ) * fT;
+
+    return r;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+/**
+ * @brief Lerps euler angles in radians over the shorter arc, so an angle crossing +-pi doesn't spin the long way.
+ */
+inline Rot3 LerpAngles( const Rot3 &rA, const Rot3 &rB, const float fT )
+{
+    constexpr float TwoPi = 6.28318530718f;
+
+    Rot3 r;
+
+    r.x = rA.x + ::std::remainder( rB.x - rA.x, TwoPi ) * fT;
+    r.y = rA.y + ::std::remainder( rB.y - rA.y, TwoPi ) * fT;
+    r.z = rA.z + ::std::remainder( rB.z - rA.z, TwoPi ) * fT;
+
+    return r;
+}
+
 } // namespace B33::Math
 #endif // !B33_OPERATIONS_H
@@ -49,6 +49,9 @@ class Cubes : public WorldObjects
     virtual void RemoveObject( ::size_t uIndex ) override
     {
         WorldObjects::RemoveObject( uIndex );
+
+        // Slots aren't reused, a zero size hides the object
+        m_vHalfSizes[ uIndex ] = Vec3();
     }
 
   private:
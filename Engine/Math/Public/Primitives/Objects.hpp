@@ -8,17 +8,27 @@ namespace B33::Math
 
 /**
  * Holds positon of an object and rotation in radians.
+ * Transforms from the previous simulation step are kept as well, so rendering can blend between the two.
  * */
 class WorldObjects
 {
   public:
     explicit WorldObjects()
       : m_uRollingIndex( 0 )
+      , m_bInterpolated( false )
       , m_vPositions( {} )
       , m_vRotations( {} )
+      , m_vPrevPositions( {} )
+      , m_vPrevRotations( {} )
+      , m_vBlendedPositions( {} )
+      , m_vBlendedRotations( {} )
     {
         m_vPositions.reserve( 64 * 64 * 64 );
         m_vRotations.reserve( 64 * 64 * 64 );
+        m_vPrevPositions.reserve( 64 * 64 * 64 );
+        m_vPrevRotations.reserve( 64 * 64 * 64 );
+        m_vBlendedPositions.reserve( 64 * 64 * 64 );
+        m_vBlendedRotations.reserve( 64 * 64 * 64 );
     }
 
     ~WorldObjects() = default;
@@ -39,6 +49,24 @@ class WorldObjects
 
     BEAST_API void AddRotation( const Rot3 &rot, ::size_t uIndex );
 
+    /**
+     * @brief Saves current transforms as the previous ones, should be called before every simulation step
+     */
+    BEAST_API void StoreTransforms();
+
+    /**
+     * @brief Makes the object start interpolation from its current transform, ex. after spawning or teleporting
+     */
+    BEAST_API void ResetInterpolation( ::size_t uIndex );
+
+    /**
+     * @brief Blends previous and current transforms, results are returned by GetRenderPositions/Rotations
+     *
+     * @param fAlpha 0 is previous simulation step, 1 is the current one
+     * @return True if any of the blended transforms differs from the one blended by the previous call
+     */
+    BEAST_API bool Interpolate( float fAlpha );
+
   public:
     const ::std::vector<Vec3> &GetPositions() const
     {
@@ -50,6 +78,16 @@ class WorldObjects
         return m_vRotations;
     }
 
+    const ::std::vector<Vec3> &GetRenderPositions() const
+    {
+        return m_bInterpolated ? m_vBlendedPositions : m_vPositions;
+    }
+
+    const ::std::vector<Vec3> &GetRenderRotations() const
+    {
+        return m_bInterpolated ? m_vBlendedRotations : m_vRotations;
+    }
+
     const Vec3 &GetPosition( ::size_t uIndex ) const
     {
         return m_vPositions[ uIndex ];
@@ -67,6 +105,10 @@ class WorldObjects
 
         m_vPositions.push_back( Vec3() );
         m_vRotations.push_back( Vec3() );
+        m_vPrevPositions.push_back( Vec3() );
+        m_vPrevRotations.push_back( Vec3() );
+        m_vBlendedPositions.push_back( Vec3() );
+        m_vBlendedRotations.push_back( Vec3() );
 
         B33_ASSERT( i == m_vPositions.size() - 1 );
         B33_ASSERT( i == m_vRotations.size() - 1 );
@@ -78,8 +120,13 @@ class WorldObjects
 
   private:
     ::size_t            m_uRollingIndex;
+    bool                m_bInterpolated;
     ::std::vector<Vec3> m_vPositions;
     ::std::vector<Rot3> m_vRotations;
+    ::std::vector<Vec3> m_vPrevPositions;
+    ::std::vector<Rot3> m_vPrevRotations;
+    ::std::vector<Vec3> m_vBlendedPositions;
+    ::std::vector<Rot3> m_vBlendedRotations;
 };
 
 } // namespace B33::Math
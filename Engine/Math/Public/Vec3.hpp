@@ -165,8 +165,14 @@ struct alignas( 16 ) iVec3
 
     inline iVec3 operator+( const Vec3 &vB ) const;
 
+    inline iVec3 operator+( const iVec3 &vB ) const;
+
+    inline iVec3 operator+( const int32_t vB ) const;
+
     inline iVec3 operator-( const iVec3 &vB ) const;
 
+    inline iVec3 operator-( const int32_t vB ) const;
+
     inline iVec3 operator*( const uint32_t vB ) const;
 };
 
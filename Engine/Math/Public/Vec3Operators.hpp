@@ -106,6 +106,20 @@ inline iVec3 iVec3::operator+( const Vec3 &vB ) const
     return AddAssign( n, iVec3( vB ) );
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+inline iVec3 iVec3::operator+( const iVec3 &vB ) const
+{
+    iVec3 n( *this );
+    return AddAssign( n, vB );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+inline iVec3 iVec3::operator+( const int32_t vB ) const
+{
+    iVec3 n( *this );
+    return AddAssign( n, iVec3( vB, vB, vB ) );
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 inline iVec3 iVec3::operator-( const iVec3 &vB ) const
 {
@@ -113,6 +127,13 @@ inline iVec3 iVec3::operator-( const iVec3 &vB ) const
     return SubtractAssign( n, iVec3( vB ) );
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+inline iVec3 iVec3::operator-( const int32_t vB ) const
+{
+    iVec3 n( *this );
+    return SubtractAssign( n, iVec3( vB, vB, vB ) );
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 inline iVec3 iVec3::operator*( const uint32_t vB ) const
 {
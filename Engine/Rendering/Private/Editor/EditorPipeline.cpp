@@ -233,8 +233,9 @@ VkShaderModule EditorPipeline::LoadShader( const string &strPath )
 // ---------------------------------------------------------------------------------------------------------------------
 VkPipeline EditorPipeline::CreatePipelineImpl()
 {
-    const VkDevice device   = GetAdaterInternal()->GetAdapterHandle();
-    VkPipeline     pipeline = VK_NULL_HANDLE;
+    const VkDevice        device        = GetAdaterInternal()->GetAdapterHandle();
+    const VkPipelineCache pipelineCache = GetPipelineCacheInternal();
+    VkPipeline            pipeline      = VK_NULL_HANDLE;
     m_ShaderModule = LoadShader( ::B33::App::AppResources::Get().GetExecutablePathA() + "/Assets/Shaders/Editor.spv" );
 
     VkPipelineShaderStageCreateInfo shaderStage = {};
@@ -248,7 +249,7 @@ VkPipeline EditorPipeline::CreatePipelineImpl()
     pipelineInfo.stage                       = shaderStage;
     pipelineInfo.layout                      = this->GetLayoutHandle();
 
-    THROW_IF_FAILED( vkCreateComputePipelines( device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pipeline ) );
+    THROW_IF_FAILED( vkCreateComputePipelines( device, pipelineCache, 1, &pipelineInfo, NULL, &pipeline ) );
 
     return pipeline;
 }
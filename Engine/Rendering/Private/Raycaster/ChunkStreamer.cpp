@@ -0,0 +1,469 @@
+#include "B33Rendering.hpp"
+
+#include "Raycaster/ChunkStreamer.hpp"
+
+namespace B33::Rendering
+{
+
+using namespace ::std;
+using namespace ::B33::Math;
+using namespace ::B33::Core::Debug;
+
+// Statics // ----------------------------------------------------------------------------------------------------------
+
+// Keys pack 21 bits per axis, chunks stay addressable within +-2^20 chunks of the origin
+static constexpr int32_t  KeyBias = 1 << 20;
+static constexpr uint64_t KeyMask = ( 1ull << 21 ) - 1;
+
+static constexpr uint64_t NoOwner = ~0ull;
+
+// ---------------------------------------------------------------------------------------------------------------------
+static iVec3 ToChunk( const Vec3 &position )
+{
+    return iVec3( static_cast<int32_t>( floor( position.x / ChunkStreamer::ChunkDim ) ),
+                  static_cast<int32_t>( floor( position.y / ChunkStreamer::ChunkDim ) ),
+                  static_cast<int32_t>( floor( position.z / ChunkStreamer::ChunkDim ) ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ChunkStreamer::ChunkStreamer( ChunkLoader loader, ChunkStreamerDesc desc )
+  : m_Desc( desc )
+  , m_Loader( move( loader ) )
+  , m_iWindowReach( static_cast<int32_t>( ceil( ( desc.fRadius + ChunkDim * 0.87f ) / ChunkDim ) ) )
+  , m_Chunks()
+  , m_Lru()
+  , m_Queue()
+  , m_Focus()
+  , m_Prefetch()
+  , m_FocusChunk( INT32_MIN, INT32_MIN, INT32_MIN )
+  , m_PrefetchChunk( INT32_MIN, INT32_MIN, INT32_MIN )
+  , m_uWantedEpoch( 0 )
+  , m_uResidentBytes( 0 )
+  , m_uInFlight( 0 )
+  , m_vSlotOwners( desc.uGpuSlots, NoOwner )
+  , m_vFreeSlots()
+  , m_vDirtySlots()
+  , m_TableHeader()
+  , m_vTable()
+  , m_bTableDirty( true )
+  , m_LoadedMutex()
+  , m_vLoaded()
+  , m_JobSystem()
+{
+    const int32_t iWindowDim = 2 * m_iWindowReach + 1;
+
+    m_TableHeader.WindowDim = iVec3( iWindowDim, iWindowDim, iWindowDim );
+    m_vTable.assign( static_cast<size_t>( iWindowDim ) * iWindowDim * iWindowDim, SlotMissing );
+
+    // Lowest slots are handed out first
+    m_vFreeSlots.reserve( desc.uGpuSlots );
+    for ( uint32_t uSlot = desc.uGpuSlots; uSlot > 0; --uSlot )
+        m_vFreeSlots.push_back( uSlot - 1 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ChunkStreamer::~ChunkStreamer()
+{
+    m_JobSystem.BlockAndWait();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ChunkStreamer::ChunkLoader ChunkStreamer::FromWorldFile( shared_ptr<WorldFile> pWorldFile )
+{
+    return [ pWorldFile ]( const iVec3 &chunk, vector<uint32_t> &vColors ) -> bool
+    {
+        const int32_t iPerAxis = static_cast<int32_t>( ( pWorldFile->GetGridWidth() + ChunkDim - 1 ) / ChunkDim );
+
+        if ( chunk.x < 0 || chunk.y < 0 || chunk.z < 0 || chunk.x >= iPerAxis || chunk.y >= iPerAxis ||
+             chunk.z >= iPerAxis )
+        {
+            return true;
+        }
+
+        const WorldChunk *pChunk = pWorldFile->GetChunk( chunk.x + chunk.y * static_cast<size_t>( iPerAxis ) +
+                                                         chunk.z * static_cast<size_t>( iPerAxis ) * iPerAxis );
+        if ( pChunk == nullptr )
+            return false;
+
+        size_t uCell = 0;
+        for ( int32_t z = 0; z < pChunk->Extent.z; ++z )
+        {
+            for ( int32_t y = 0; y < pChunk->Extent.y; ++y )
+            {
+                uint32_t *pRow = &vColors[ ( static_cast<size_t>( z ) * ChunkDim + y ) * ChunkDim ];
+
+                for ( int32_t x = 0; x < pChunk->Extent.x; ++x, ++uCell )
+                {
+                    const uint16_t uValue = pChunk->vCells[ uCell ];
+
+                    pRow[ x ] = uValue != 0 ? pChunk->vPalette[ uValue ] : 0;
+                }
+            }
+        }
+
+        return true;
+    };
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ChunkStreamer::ChunkLoader ChunkStreamer::FromGenerator( shared_ptr<const TerrainGenerator> pGenerator )
+{
+    return [ pGenerator ]( const iVec3 &chunk, vector<uint32_t> &vColors ) -> bool
+    {
+        pGenerator->GenerateColors( chunk * ChunkDim, iVec3( ChunkDim, ChunkDim, ChunkDim ), vColors.data() );
+        return true;
+    };
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ChunkStreamer::Update( const Camera &camera, const Vec3 &lookDir )
+{
+    m_Focus    = camera.GetPosition();
+    m_Prefetch = m_Focus + lookDir * m_Desc.fPrefetchDistance;
+
+    const iVec3 focusChunk    = ToChunk( m_Focus );
+    const iVec3 prefetchChunk = ToChunk( m_Prefetch );
+
+    bool bResidencyChanged = false;
+
+    if ( focusChunk != m_FocusChunk || prefetchChunk != m_PrefetchChunk )
+    {
+        if ( focusChunk != m_FocusChunk )
+        {
+            m_TableHeader.WindowOrigin = focusChunk - m_iWindowReach;
+            bResidencyChanged          = true;
+        }
+
+        m_FocusChunk    = focusChunk;
+        m_PrefetchChunk = prefetchChunk;
+
+        CollectWanted();
+    }
+
+    bResidencyChanged |= RetireLoaded();
+    bResidencyChanged |= Evict();
+
+    DispatchQueued();
+
+    if ( bResidencyChanged )
+        AssignSlots();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ChunkStreamer::ForceGpuUpload()
+{
+    m_vDirtySlots.clear();
+
+    for ( uint32_t uSlot = 0; uSlot < m_vSlotOwners.size(); ++uSlot )
+    {
+        if ( m_vSlotOwners[ uSlot ] != NoOwner )
+            m_vDirtySlots.push_back( uSlot );
+    }
+
+    m_bTableDirty = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const uint32_t *ChunkStreamer::GetSlotColors( uint32_t uSlot ) const
+{
+    B33_ASSERT( uSlot < m_vSlotOwners.size() && m_vSlotOwners[ uSlot ] != NoOwner );
+
+    return m_Chunks.at( m_vSlotOwners[ uSlot ] ).vColors.data();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint64_t ChunkStreamer::ChunkKey( const iVec3 &chunk )
+{
+    return ( static_cast<uint64_t>( chunk.x + KeyBias ) & KeyMask ) |
+           ( ( static_cast<uint64_t>( chunk.y + KeyBias ) & KeyMask ) << 21 ) |
+           ( ( static_cast<uint64_t>( chunk.z + KeyBias ) & KeyMask ) << 42 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ChunkStreamer::IsStreamed( const iVec3 &chunk ) const
+{
+    if ( chunk.y < m_Desc.iMinChunkY || chunk.y > m_Desc.iMaxChunkY )
+        return false;
+
+    const int64_t iGridChunks = static_cast<int64_t>( m_Desc.uGridWidth / ChunkDim );
+
+    // Chunks the dense grid covers whole never reach the shader lookup
+    return chunk.x < 0 || chunk.y < 0 || chunk.z < 0 || chunk.x >= iGridChunks || chunk.y >= iGridChunks ||
+           chunk.z >= iGridChunks;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+float ChunkStreamer::DistanceSq( const iVec3 &chunk ) const
+{
+    const Vec3 delta = Vec3::ToVec( chunk * ChunkDim ) + ChunkDim / 2 - m_Focus;
+
+    return delta.x * delta.x + delta.y * delta.y + delta.z * delta.z;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int64_t ChunkStreamer::TableIndex( const iVec3 &chunk ) const
+{
+    const iVec3   local = chunk - m_TableHeader.WindowOrigin;
+    const int64_t iDim  = m_TableHeader.WindowDim.x;
+
+    if ( local.x < 0 || local.y < 0 || local.z < 0 || local.x >= iDim || local.y >= iDim || local.z >= iDim )
+        return -1;
+
+    return local.x + local.y * iDim + local.z * iDim * iDim;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ChunkStreamer::ReleaseSlot( StreamedChunk &streamed )
+{
+    if ( streamed.uSlot == SlotMissing )
+        return;
+
+    const uint32_t uSlot = streamed.uSlot;
+
+    m_vSlotOwners[ uSlot ] = NoOwner;
+    m_vFreeSlots.push_back( uSlot );
+    m_vDirtySlots.erase( remove( m_vDirtySlots.begin(), m_vDirtySlots.end(), uSlot ), m_vDirtySlots.end() );
+
+    const int64_t iEntry = TableIndex( streamed.Chunk );
+    if ( iEntry >= 0 )
+        m_vTable[ iEntry ] = SlotMissing;
+
+    streamed.uSlot = SlotMissing;
+    m_bTableDirty  = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ChunkStreamer::CollectWanted()
+{
+    ++m_uWantedEpoch;
+    m_Queue.clear();
+
+    // Chunk is in when any of its part can be, the distance is measured to the center
+    const float   fReach   = m_Desc.fRadius + ChunkDim * 0.87f;
+    const float   fReachSq = fReach * fReach;
+    const int32_t iReach   = static_cast<int32_t>( ceil( fReach / ChunkDim ) );
+
+    const iVec3 lo( min( m_FocusChunk.x, m_PrefetchChunk.x ) - iReach,
+                    max( min( m_FocusChunk.y, m_PrefetchChunk.y ) - iReach, m_Desc.iMinChunkY ),
+                    min( m_FocusChunk.z, m_PrefetchChunk.z ) - iReach );
+    const iVec3 hi( max( m_FocusChunk.x, m_PrefetchChunk.x ) + iReach,
+                    min( max( m_FocusChunk.y, m_PrefetchChunk.y ) + iReach, m_Desc.iMaxChunkY ),
+                    max( m_FocusChunk.z, m_PrefetchChunk.z ) + iReach );
+
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
+        {
+            for ( int32_t x = lo.x; x <= hi.x; ++x )
+            {
+                const iVec3 chunk( x, y, z );
+                if ( !IsStreamed( chunk ) )
+                    continue;
+
+                const Vec3 center        = Vec3::ToVec( chunk * ChunkDim ) + ChunkDim / 2;
+                const Vec3 deltaFocus    = center - m_Focus;
+                const Vec3 deltaPrefetch = center - m_Prefetch;
+
+                const float fFocusSq = deltaFocus.x * deltaFocus.x + deltaFocus.y * deltaFocus.y +
+                                       deltaFocus.z * deltaFocus.z;
+                const float fPrefetchSq = deltaPrefetch.x * deltaPrefetch.x + deltaPrefetch.y * deltaPrefetch.y +
+                                          deltaPrefetch.z * deltaPrefetch.z;
+
+                if ( fFocusSq > fReachSq && fPrefetchSq > fReachSq )
+                    continue;
+
+                auto it = m_Chunks.find( ChunkKey( chunk ) );
+                if ( it == m_Chunks.end() )
+                {
+                    m_Queue.push_back( { fFocusSq, chunk } );
+                    continue;
+                }
+
+                // Wanted chunks gather at the front of the LRU, eviction stops at the first one from the back
+                it->second.uWantedEpoch = m_uWantedEpoch;
+                if ( !it->second.bLoading )
+                    m_Lru.splice( m_Lru.begin(), m_Lru, it->second.LruIt );
+            }
+        }
+    }
+
+    make_heap( m_Queue.begin(), m_Queue.end() );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ChunkStreamer::DispatchQueued()
+{
+    while ( !m_Queue.empty() )
+    {
+        const iVec3 chunk = m_Queue.front().Chunk;
+
+        const bool bPushed = m_JobSystem.TryPushJob(
+            [ this, chunk ]()
+            {
+                LoadedChunk loaded = { chunk, vector<uint32_t>( ChunkVoxels, 0 ), false };
+                loaded.bLoaded     = m_Loader( chunk, loaded.vColors );
+
+                lock_guard<mutex> lock( m_LoadedMutex );
+                m_vLoaded.push_back( move( loaded ) );
+            } );
+
+        if ( !bPushed )
+            break;
+
+        pop_heap( m_Queue.begin(), m_Queue.end() );
+        m_Queue.pop_back();
+
+        m_Chunks.emplace( ChunkKey( chunk ),
+                          StreamedChunk { chunk, {}, m_Lru.end(), m_uWantedEpoch, SlotMissing, true } );
+        ++m_uInFlight;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ChunkStreamer::RetireLoaded()
+{
+    vector<LoadedChunk> vLoaded;
+    {
+        lock_guard<mutex> lock( m_LoadedMutex );
+        vLoaded.swap( m_vLoaded );
+    }
+
+    for ( auto &loaded : vLoaded )
+    {
+        const uint64_t uKey     = ChunkKey( loaded.Chunk );
+        StreamedChunk &streamed = m_Chunks.at( uKey );
+
+        if ( !loaded.bLoaded )
+        {
+            B33_LOG( Warning,
+                     L"Couldn't load a streamed chunk. [Chunk: %d %d %d]",
+                     loaded.Chunk.x,
+                     loaded.Chunk.y,
+                     loaded.Chunk.z );
+        }
+
+        const bool bSolid = loaded.bLoaded && any_of( loaded.vColors.begin(),
+                                                      loaded.vColors.end(),
+                                                      []( uint32_t uColor ) { return uColor != 0; } );
+        if ( bSolid )
+            streamed.vColors = move( loaded.vColors );
+
+        streamed.bLoading = false;
+        m_uResidentBytes += sizeof( StreamedChunk ) + streamed.vColors.size() * sizeof( uint32_t );
+
+        // Chunks that stopped being wanted while loading go straight to the eviction end
+        streamed.LruIt = m_Lru.insert( streamed.uWantedEpoch == m_uWantedEpoch ? m_Lru.begin() : m_Lru.end(), uKey );
+    }
+
+    m_uInFlight -= vLoaded.size();
+
+    return !vLoaded.empty();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ChunkStreamer::Evict()
+{
+    bool bEvicted = false;
+
+    while ( m_uResidentBytes > m_Desc.uBudgetBytes && !m_Lru.empty() )
+    {
+        auto it = m_Chunks.find( m_Lru.back() );
+
+        // Everything in front of it is wanted too, the budget can't go lower than the wanted chunks
+        if ( it->second.uWantedEpoch == m_uWantedEpoch )
+            break;
+
+        ReleaseSlot( it->second );
+
+        m_uResidentBytes -= sizeof( StreamedChunk ) + it->second.vColors.size() * sizeof( uint32_t );
+        m_Lru.pop_back();
+        m_Chunks.erase( it );
+
+        bEvicted = true;
+    }
+
+    return bEvicted;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ChunkStreamer::AssignSlots()
+{
+    const int32_t iDim = m_TableHeader.WindowDim.x;
+
+    vector<QueuedChunk> vCandidates;
+    size_t              uEntry = 0;
+
+    for ( int32_t z = 0; z < iDim; ++z )
+    {
+        for ( int32_t y = 0; y < iDim; ++y )
+        {
+            for ( int32_t x = 0; x < iDim; ++x, ++uEntry )
+            {
+                const iVec3 chunk = m_TableHeader.WindowOrigin + iVec3( x, y, z );
+
+                m_vTable[ uEntry ] = SlotMissing;
+
+                if ( !IsStreamed( chunk ) )
+                {
+                    m_vTable[ uEntry ] = SlotEmpty;
+                    continue;
+                }
+
+                auto it = m_Chunks.find( ChunkKey( chunk ) );
+                if ( it == m_Chunks.end() || it->second.bLoading )
+                    continue;
+
+                if ( it->second.vColors.empty() )
+                    m_vTable[ uEntry ] = SlotEmpty;
+                else if ( it->second.uSlot != SlotMissing )
+                    m_vTable[ uEntry ] = it->second.uSlot;
+                else
+                    vCandidates.push_back( { DistanceSq( chunk ), chunk } );
+            }
+        }
+    }
+
+    m_bTableDirty = true;
+
+    if ( vCandidates.empty() )
+        return;
+
+    // Both end up farthest first, candidates are taken from the back and victims from the front
+    vector<QueuedChunk> vVictims;
+    for ( const uint64_t uOwner : m_vSlotOwners )
+    {
+        if ( uOwner != NoOwner )
+            vVictims.push_back( { DistanceSq( m_Chunks.at( uOwner ).Chunk ), m_Chunks.at( uOwner ).Chunk } );
+    }
+
+    sort( vCandidates.begin(), vCandidates.end() );
+    sort( vVictims.begin(), vVictims.end() );
+
+    size_t uVictim = 0;
+    while ( !vCandidates.empty() )
+    {
+        const QueuedChunk &candidate = vCandidates.back();
+
+        if ( m_vFreeSlots.empty() )
+        {
+            // Slot is taken over only from a chunk farther than the one that wants it
+            if ( uVictim == vVictims.size() || vVictims[ uVictim ].fDistanceSq <= candidate.fDistanceSq )
+                break;
+
+            ReleaseSlot( m_Chunks.at( ChunkKey( vVictims[ uVictim++ ].Chunk ) ) );
+        }
+
+        const uint64_t uKey  = ChunkKey( candidate.Chunk );
+        const uint32_t uSlot = m_vFreeSlots.back();
+        m_vFreeSlots.pop_back();
+
+        m_Chunks.at( uKey ).uSlot                 = uSlot;
+        m_vSlotOwners[ uSlot ]                    = uKey;
+        m_vTable[ TableIndex( candidate.Chunk ) ] = uSlot;
+        m_vDirtySlots.push_back( uSlot );
+
+        vCandidates.pop_back();
+    }
+}
+
+} // namespace B33::Rendering
@@ -0,0 +1,365 @@
+#include "B33Rendering.hpp"
+
+#include "Raycaster/TerrainGenerator.hpp"
+
+namespace B33::Rendering
+{
+
+using namespace ::std;
+using namespace ::B33::Math;
+
+// Statics // ----------------------------------------------------------------------------------------------------------
+
+// Cave fields must not share seeds with the height octaves, those are uSeed + octave
+static constexpr uint32_t CaveSeedA = 0x68E31DA4u;
+static constexpr uint32_t CaveSeedB = 0xB5297A4Du;
+
+// ---------------------------------------------------------------------------------------------------------------------
+TerrainGenerator::TerrainGenerator( size_t uGridWidth, TerrainParams params )
+  : m_Params( params )
+  , m_uGridDim( uGridWidth )
+  , m_iChunksPerAxis( static_cast<int32_t>( ( uGridWidth + ChunkDim - 1 ) / ChunkDim ) )
+  , m_vStates( static_cast<size_t>( m_iChunksPerAxis ) * m_iChunksPerAxis * m_iChunksPerAxis, ChunkMissing )
+  , m_Queue()
+  , m_Focus()
+  , m_FocusChunk( INT32_MIN, INT32_MIN, INT32_MIN )
+  , m_fRadius( -1.f )
+  , m_uInFlight( 0 )
+  , m_uGenerated( 0 )
+  , m_CompletedMutex()
+  , m_vCompleted()
+  , m_JobSystem()
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+TerrainGenerator::~TerrainGenerator()
+{
+    m_JobSystem.BlockAndWait();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void TerrainGenerator::SetFocus( const Vec3 &focus, float fRadius )
+{
+    const iVec3 focusChunk( static_cast<int32_t>( floor( focus.x / ChunkDim ) ),
+                            static_cast<int32_t>( floor( focus.y / ChunkDim ) ),
+                            static_cast<int32_t>( floor( focus.z / ChunkDim ) ) );
+
+    m_Focus = focus;
+
+    if ( focusChunk == m_FocusChunk && fRadius == m_fRadius )
+        return;
+
+    m_FocusChunk = focusChunk;
+    m_fRadius    = fRadius;
+
+    RebuildQueue();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+size_t TerrainGenerator::Update( IWorldGrid &grid, size_t uMaxChunks )
+{
+    DispatchQueued();
+
+    vector<TerrainChunk> vFinished;
+    {
+        lock_guard<mutex> lock( m_CompletedMutex );
+
+        const size_t uTake = min( uMaxChunks, m_vCompleted.size() );
+
+        vFinished.assign( make_move_iterator( m_vCompleted.begin() ),
+                          make_move_iterator( m_vCompleted.begin() + uTake ) );
+        m_vCompleted.erase( m_vCompleted.begin(), m_vCompleted.begin() + uTake );
+    }
+
+    if ( vFinished.empty() )
+        return 0;
+
+    WorldEditBatch batch( grid );
+
+    for ( const auto &chunk : vFinished )
+    {
+        if ( chunk.uSolidCount != 0 )
+            grid.PasteRegion( chunk.Region, chunk.Origin );
+
+        m_vStates[ ChunkIndex( iVec3( chunk.Origin.x / static_cast<int32_t>( ChunkDim ),
+                                      chunk.Origin.y / static_cast<int32_t>( ChunkDim ),
+                                      chunk.Origin.z / static_cast<int32_t>( ChunkDim ) ) ) ] = ChunkGenerated;
+    }
+
+    m_uInFlight  -= vFinished.size();
+    m_uGenerated += vFinished.size();
+
+    return vFinished.size();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void TerrainGenerator::GenerateAll( IWorldGrid &grid )
+{
+    for ( const auto &queued : m_Queue )
+        m_vStates[ queued.uChunk ] = ChunkMissing;
+
+    m_Queue.clear();
+
+    for ( size_t uChunk = 0; uChunk < m_vStates.size(); ++uChunk )
+    {
+        if ( m_vStates[ uChunk ] != ChunkMissing )
+            continue;
+
+        const Vec3 center = Vec3::ToVec( ChunkCoord( uChunk ) * ChunkDim ) + ChunkDim / 2;
+        const Vec3 delta  = center - m_Focus;
+
+        m_vStates[ uChunk ] = ChunkQueued;
+        m_Queue.push_back( { delta.x * delta.x + delta.y * delta.y + delta.z * delta.z,
+                             static_cast<uint32_t>( uChunk ) } );
+    }
+
+    make_heap( m_Queue.begin(), m_Queue.end() );
+
+    while ( !m_Queue.empty() || m_uInFlight != 0 )
+    {
+        if ( Update( grid ) == 0 )
+            this_thread::yield();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void TerrainGenerator::Reset()
+{
+    m_JobSystem.BlockAndWait();
+
+    {
+        lock_guard<mutex> lock( m_CompletedMutex );
+        m_vCompleted.clear();
+    }
+
+    fill( m_vStates.begin(), m_vStates.end(), ChunkMissing );
+    m_Queue.clear();
+    m_uInFlight  = 0;
+    m_uGenerated = 0;
+
+    RebuildQueue();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void TerrainGenerator::GenerateChunk( const iVec3 &chunk, TerrainChunk &out ) const
+{
+    const int32_t iDim   = static_cast<int32_t>( m_uGridDim );
+    const iVec3   origin = chunk * ChunkDim;
+    const iVec3   extent( min( static_cast<int32_t>( ChunkDim ), iDim - origin.x ),
+                        min( static_cast<int32_t>( ChunkDim ), iDim - origin.y ),
+                        min( static_cast<int32_t>( ChunkDim ), iDim - origin.z ) );
+
+    out.Origin      = origin;
+    out.uSolidCount = 0;
+
+    if ( extent.x <= 0 || extent.y <= 0 || extent.z <= 0 )
+    {
+        out.Region = {};
+        return;
+    }
+
+    const size_t uCells = static_cast<size_t>( extent.x ) * extent.y * extent.z;
+
+    out.Region.Extent = extent;
+    out.Region.vColors.assign( uCells, 0 );
+    out.Region.vSolid.assign( uCells, 0 );
+
+    out.uSolidCount = GenerateColors( origin, extent, out.Region.vColors.data() );
+    if ( out.uSolidCount == 0 )
+        return;
+
+    for ( size_t uCell = 0; uCell < uCells; ++uCell )
+        out.Region.vSolid[ uCell ] = out.Region.vColors[ uCell ] != 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+size_t TerrainGenerator::GenerateColors( const iVec3 &origin, const iVec3 &extent, uint32_t *pColors ) const
+{
+    B33_ASSERT( extent.x <= static_cast<int32_t>( ChunkDim ) && extent.y <= static_cast<int32_t>( ChunkDim ) &&
+                extent.z <= static_cast<int32_t>( ChunkDim ) );
+
+    float   fRow[ ChunkDim ];
+    float   fCaveA[ ChunkDim ];
+    float   fCaveB[ ChunkDim ];
+    int32_t iHeights[ ChunkDim * ChunkDim ];
+    int32_t iRowTop[ ChunkDim ];
+    int32_t iChunkTop   = 0;
+    size_t  uSolidCount = 0;
+
+    // Heightmap first, rows above every column of the chunk don't need any 3D noise
+    for ( int32_t z = 0; z < extent.z; ++z )
+    {
+        FractalNoise3Row( m_Params.Height,
+                          static_cast<float>( origin.x ),
+                          1.f,
+                          0.f,
+                          static_cast<float>( origin.z + z ),
+                          m_Params.uSeed,
+                          fRow,
+                          extent.x );
+
+        iRowTop[ z ] = 0;
+        for ( int32_t x = 0; x < extent.x; ++x )
+        {
+            const int32_t iHeight = static_cast<int32_t>( m_Params.fBaseHeight + fRow[ x ] * m_Params.fHeightRange );
+
+            iHeights[ z * ChunkDim + x ] = max( iHeight, 1 );
+            iRowTop[ z ]                 = max( iRowTop[ z ], iHeights[ z * ChunkDim + x ] );
+        }
+
+        iChunkTop = max( iChunkTop, iRowTop[ z ] );
+    }
+
+    if ( origin.y >= iChunkTop )
+        return 0;
+
+    const float fCaveWidthSq = m_Params.fCaveWidth * m_Params.fCaveWidth;
+
+    for ( int32_t z = 0; z < extent.z; ++z )
+    {
+        const int32_t  iWorldZ  = origin.z + z;
+        const int32_t *pHeights = &iHeights[ z * ChunkDim ];
+
+        for ( int32_t y = 0; y < extent.y && origin.y + y < iRowTop[ z ]; ++y )
+        {
+            const int32_t iWorldY = origin.y + y;
+            const bool    bCaves  = iWorldY > 0 && iWorldY < iRowTop[ z ] - m_Params.iCaveRoof;
+
+            if ( bCaves )
+            {
+                FractalNoise3Row( m_Params.Caves,
+                                  static_cast<float>( origin.x ),
+                                  1.f,
+                                  static_cast<float>( iWorldY ),
+                                  static_cast<float>( iWorldZ ),
+                                  m_Params.uSeed ^ CaveSeedA,
+                                  fCaveA,
+                                  extent.x );
+                FractalNoise3Row( m_Params.Caves,
+                                  static_cast<float>( origin.x ),
+                                  1.f,
+                                  static_cast<float>( iWorldY ),
+                                  static_cast<float>( iWorldZ ),
+                                  m_Params.uSeed ^ CaveSeedB,
+                                  fCaveB,
+                                  extent.x );
+            }
+
+            size_t uCell = ( static_cast<size_t>( z ) * extent.y + y ) * extent.x;
+            for ( int32_t x = 0; x < extent.x; ++x, ++uCell )
+            {
+                const int32_t iHeight = pHeights[ x ];
+
+                if ( iWorldY >= iHeight )
+                    continue;
+
+                if ( bCaves && iWorldY < iHeight - m_Params.iCaveRoof &&
+                     fCaveA[ x ] * fCaveA[ x ] + fCaveB[ x ] * fCaveB[ x ] < fCaveWidthSq )
+                    continue;
+
+                uint32_t uColor = m_Params.uStoneColor;
+                if ( iWorldY == iHeight - 1 )
+                    uColor = m_Params.uGrassColor;
+                else if ( iWorldY >= iHeight - 1 - m_Params.iDirtDepth )
+                    uColor = m_Params.uDirtColor;
+
+                pColors[ uCell ] = uColor;
+                ++uSolidCount;
+            }
+        }
+    }
+
+    return uSolidCount;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+iVec3 TerrainGenerator::ChunkCoord( size_t uChunk ) const
+{
+    const size_t uPerAxis = static_cast<size_t>( m_iChunksPerAxis );
+
+    return iVec3( static_cast<int32_t>( uChunk % uPerAxis ),
+                  static_cast<int32_t>( uChunk / uPerAxis % uPerAxis ),
+                  static_cast<int32_t>( uChunk / ( uPerAxis * uPerAxis ) ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+size_t TerrainGenerator::ChunkIndex( const iVec3 &chunk ) const
+{
+    const size_t uPerAxis = static_cast<size_t>( m_iChunksPerAxis );
+
+    return chunk.x + chunk.y * uPerAxis + chunk.z * uPerAxis * uPerAxis;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void TerrainGenerator::RebuildQueue()
+{
+    for ( const auto &queued : m_Queue )
+        m_vStates[ queued.uChunk ] = ChunkMissing;
+
+    m_Queue.clear();
+
+    if ( m_fRadius < 0.f )
+        return;
+
+    // Chunk is in when any of its part can be, the distance is measured to the center
+    const float   fReach     = m_fRadius + ChunkDim * 0.87f;
+    const int32_t iReach     = static_cast<int32_t>( ceil( fReach / ChunkDim ) );
+    const int32_t iLastChunk = m_iChunksPerAxis - 1;
+
+    for ( int32_t z = max( 0, m_FocusChunk.z - iReach ); z <= min( iLastChunk, m_FocusChunk.z + iReach ); ++z )
+    {
+        for ( int32_t y = max( 0, m_FocusChunk.y - iReach ); y <= min( iLastChunk, m_FocusChunk.y + iReach ); ++y )
+        {
+            for ( int32_t x = max( 0, m_FocusChunk.x - iReach ); x <= min( iLastChunk, m_FocusChunk.x + iReach ); ++x )
+            {
+                const size_t uChunk = ChunkIndex( iVec3( x, y, z ) );
+                if ( m_vStates[ uChunk ] != ChunkMissing )
+                    continue;
+
+                const Vec3  center      = Vec3::ToVec( iVec3( x, y, z ) * ChunkDim ) + ChunkDim / 2;
+                const Vec3  delta       = center - m_Focus;
+                const float fDistanceSq = delta.x * delta.x + delta.y * delta.y + delta.z * delta.z;
+
+                if ( fDistanceSq > fReach * fReach )
+                    continue;
+
+                m_vStates[ uChunk ] = ChunkQueued;
+                m_Queue.push_back( { fDistanceSq, static_cast<uint32_t>( uChunk ) } );
+            }
+        }
+    }
+
+    make_heap( m_Queue.begin(), m_Queue.end() );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void TerrainGenerator::DispatchQueued()
+{
+    while ( !m_Queue.empty() )
+    {
+        const uint32_t uChunk = m_Queue.front().uChunk;
+        const iVec3    chunk  = ChunkCoord( uChunk );
+
+        const bool bPushed = m_JobSystem.TryPushJob(
+            [ this, chunk ]()
+            {
+                TerrainChunk generated = {};
+                GenerateChunk( chunk, generated );
+
+                lock_guard<mutex> lock( m_CompletedMutex );
+                m_vCompleted.push_back( move( generated ) );
+            } );
+
+        if ( !bPushed )
+            break;
+
+        pop_heap( m_Queue.begin(), m_Queue.end() );
+        m_Queue.pop_back();
+
+        m_vStates[ uChunk ] = ChunkGenerating;
+        ++m_uInFlight;
+    }
+}
+
+} // namespace B33::Rendering
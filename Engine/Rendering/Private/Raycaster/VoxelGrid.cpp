@@ -12,88 +12,299 @@ using namespace ::B33::Math;
 void IWorldGrid::SetVoxel( const iVec &pos, uint32_t uColor )
 {
     vector<Voxel> &voxelsGrid = this->GetGrid();
-    const size_t   uDim       = this->GetGridWidth();
     const size_t   uIndex     = CalcIndex( pos );
 
     B33_ASSERT( uIndex < voxelsGrid.size() );
 
     voxelsGrid[ uIndex ].Type  = Voxel::FullSolid;
     voxelsGrid[ uIndex ].Color = uColor;
-    this->ForceUpload();
+    this->MarkCellsChanged( pos, pos );
+    this->RequestUpload();
 }
 
 // --------------------------------------------------------------------------------------------------------------------
-size_t IWorldGrid::CalcIndex( const iVec &pos ) const
+void IWorldGrid::FillBox( const iVec &min, const iVec &max, uint32_t uColor )
 {
-    return pos.x + pos.y * m_uGridDim + pos.z * m_uGridDim * m_uGridDim;
+    WriteBox( min, max, Voxel::FullSolid, uColor );
 }
 
 // --------------------------------------------------------------------------------------------------------------------
-void IWorldGrid::PlaceOnGrid( const iVec &pos, const iVec &area, const size_t uId )
+void IWorldGrid::ClearBox( const iVec &min, const iVec &max )
 {
-    // Incremeant the type on connected voxels'
-    size_t uCornerIndex;
-    for ( int32_t x = -area.x; x <= area.x; ++x )
+    WriteBox( min, max, 0, 0 );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void IWorldGrid::FillSphere( const iVec &center, int32_t iRadius, uint32_t uColor )
+{
+    iVec lo, hi;
+    if ( iRadius < 0 || !ClipRegion( center - iRadius, center + iRadius, lo, hi ) )
+        return;
+
+    const int64_t iRadiusSq = static_cast<int64_t>( iRadius ) * iRadius;
+
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
+        {
+            const int64_t iDy   = y - center.y;
+            const int64_t iDz   = z - center.z;
+            const int64_t iLeft = iRadiusSq - iDy * iDy - iDz * iDz;
+
+            if ( iLeft < 0 )
+                continue;
+
+            // Sphere cuts every row into a single span
+            const int32_t iHalf  = static_cast<int32_t>( sqrt( static_cast<double>( iLeft ) ) );
+            const int32_t iBegin = ::std::max( lo.x, center.x - iHalf );
+            const int32_t iEnd   = ::std::min( hi.x, center.x + iHalf );
+
+            Voxel *pVoxel = &m_VoxelGrid[ CalcIndex( iVec( iBegin, y, z ) ) ];
+            for ( int32_t x = iBegin; x <= iEnd; ++x, ++pVoxel )
+            {
+                if ( pVoxel->Type != Voxel::FullSolid && pVoxel->Type != 0 )
+                    continue;
+
+                pVoxel->Type  = Voxel::FullSolid;
+                pVoxel->Color = uColor;
+            }
+        }
+    }
+
+    this->MarkCellsChanged( lo, hi );
+    this->RequestUpload();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+VoxelRegion IWorldGrid::CopyRegion( const iVec &min, const iVec &max ) const
+{
+    VoxelRegion region;
+
+    iVec lo, hi;
+    if ( !ClipRegion( min, max, lo, hi ) )
+        return region;
+
+    region.Extent = hi - lo + 1;
+
+    const size_t uRow   = region.Extent.x;
+    const size_t uCells = uRow * region.Extent.y * region.Extent.z;
+
+    region.vColors.resize( uCells );
+    region.vSolid.resize( uCells );
+
+    size_t uCell = 0;
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
     {
-        for ( int32_t y = -area.y; y <= area.y; ++y )
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
         {
-            for ( int32_t z = -area.z; z <= area.z; ++z )
+            const Voxel *pVoxel = &m_VoxelGrid[ CalcIndex( iVec( lo.x, y, z ) ) ];
+            for ( size_t x = 0; x < uRow; ++x, ++uCell, ++pVoxel )
             {
-                uCornerIndex = CalcIndex( iVec( pos.x + x, pos.y + y, pos.z + z ) );
+                region.vSolid[ uCell ]  = pVoxel->Type == Voxel::FullSolid;
+                region.vColors[ uCell ] = pVoxel->Color;
+            }
+        }
+    }
+
+    return region;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void IWorldGrid::PasteRegion( const VoxelRegion &region, const iVec &dst, bool bPasteEmpty )
+{
+    iVec lo, hi;
+    if ( !ClipRegion( dst, dst + region.Extent - 1, lo, hi ) )
+        return;
+
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
+        {
+            size_t uCell = ( lo.x - dst.x ) + ( y - dst.y ) * static_cast<size_t>( region.Extent.x ) +
+                           ( z - dst.z ) * static_cast<size_t>( region.Extent.x ) * region.Extent.y;
 
-                if ( uCornerIndex >= m_VoxelGrid.size() )
+            Voxel *pVoxel = &m_VoxelGrid[ CalcIndex( iVec( lo.x, y, z ) ) ];
+            for ( int32_t x = lo.x; x <= hi.x; ++x, ++uCell, ++pVoxel )
+            {
+                // Objects keep their voxels
+                if ( pVoxel->Type != Voxel::FullSolid && pVoxel->Type != 0 )
                     continue;
 
-                Voxel &voxel = m_VoxelGrid[ uCornerIndex ];
+                if ( region.vSolid[ uCell ] )
+                {
+                    pVoxel->Type  = Voxel::FullSolid;
+                    pVoxel->Color = region.vColors[ uCell ];
+                }
+                else if ( bPasteEmpty )
+                {
+                    pVoxel->Type  = 0;
+                    pVoxel->Color = 0;
+                }
+            }
+        }
+    }
+
+    this->MarkCellsChanged( lo, hi );
+    this->RequestUpload();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void IWorldGrid::EndEditBatch()
+{
+    B33_ASSERT( m_uBatchDepth != 0 );
+
+    if ( --m_uBatchDepth != 0 )
+        return;
 
-                if ( voxel.Type == Voxel::FullSolid )
+    m_uChanged        |= m_uPendingChanged;
+    m_uPendingChanged  = 0;
+
+    if ( m_bBatchUpload )
+    {
+        m_bBatchUpload = false;
+        this->ForceUpload();
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void IWorldGrid::MarkCellsChanged( const iVec &min, const iVec &max )
+{
+    if ( !m_bCellsChanged )
+    {
+        m_CellsChangedMin = min;
+        m_CellsChangedMax = max;
+        m_bCellsChanged   = true;
+        return;
+    }
+
+    m_CellsChangedMin = iVec( ::std::min( m_CellsChangedMin.x, min.x ),
+                              ::std::min( m_CellsChangedMin.y, min.y ),
+                              ::std::min( m_CellsChangedMin.z, min.z ) );
+    m_CellsChangedMax = iVec( ::std::max( m_CellsChangedMax.x, max.x ),
+                              ::std::max( m_CellsChangedMax.y, max.y ),
+                              ::std::max( m_CellsChangedMax.z, max.z ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+bool IWorldGrid::ConsumeCellChanges( iVec &min, iVec &max )
+{
+    if ( !m_bCellsChanged )
+        return false;
+
+    m_bCellsChanged = false;
+
+    return ClipRegion( m_CellsChangedMin, m_CellsChangedMax, min, max );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+size_t IWorldGrid::CalcIndex( const iVec &pos ) const
+{
+    return pos.x + pos.y * m_uGridDim + pos.z * m_uGridDim * m_uGridDim;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+bool IWorldGrid::ClipRegion( const iVec &min, const iVec &max, iVec &lo, iVec &hi ) const
+{
+    const int32_t iLast = static_cast<int32_t>( m_uGridDim ) - 1;
+
+    lo = iVec( ::std::max( min.x, 0 ), ::std::max( min.y, 0 ), ::std::max( min.z, 0 ) );
+    hi = iVec( ::std::min( max.x, iLast ), ::std::min( max.y, iLast ), ::std::min( max.z, iLast ) );
+
+    return lo.x <= hi.x && lo.y <= hi.y && lo.z <= hi.z;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void IWorldGrid::PlaceOnGrid( const iVec &pos, const iVec &area, const size_t uId )
+{
+    iVec lo, hi;
+    if ( !ClipRegion( pos - area, pos + area, lo, hi ) )
+        return;
+
+    // Incremeant the type on connected voxels'
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
+        {
+            Voxel *pVoxel = &m_VoxelGrid[ CalcIndex( iVec( lo.x, y, z ) ) ];
+            for ( int32_t x = lo.x; x <= hi.x; ++x, ++pVoxel )
+            {
+                if ( pVoxel->Type == Voxel::FullSolid )
                     continue;
 
-                if ( voxel.Type >= Voxel::MaxPerInstance )
+                if ( pVoxel->Type >= Voxel::MaxPerInstance )
                 {
                     B33_LOG( Core::Debug::Warning, L"Reached object limit for the connected voxel" );
                     continue;
                 }
 
-                voxel.Id[ voxel.Type++ ] = uId;
+                pVoxel->Id[ pVoxel->Type++ ] = uId;
             }
         }
     }
+
+    this->MarkCellsChanged( lo, hi );
 }
 
 // --------------------------------------------------------------------------------------------------------------------
 void IWorldGrid::RemoveFromGrid( const iVec &pos, const iVec &area, const size_t uId )
 {
+    iVec lo, hi;
+    if ( !ClipRegion( pos - area, pos + area, lo, hi ) )
+        return;
+
     // Decremeant the type on connected voxels
-    size_t uCornerIndex;
-    size_t uLastIdOnList;
     size_t uIndexOfIdOnList;
-    for ( int32_t x = -area.x; x <= area.x; ++x )
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
     {
-        for ( int32_t y = -area.y; y <= area.y; ++y )
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
         {
-            for ( int32_t z = -area.z; z <= area.z; ++z )
+            Voxel *pVoxel = &m_VoxelGrid[ CalcIndex( iVec( lo.x, y, z ) ) ];
+            for ( int32_t x = lo.x; x <= hi.x; ++x, ++pVoxel )
             {
-                uCornerIndex = CalcIndex( iVec( pos.x + x, pos.y + y, pos.z + z ) );
-
-                if ( uCornerIndex >= m_VoxelGrid.size() )
+                if ( pVoxel->Type == Voxel::FullSolid || pVoxel->Type == 0 )
                     continue;
 
-                Voxel &voxel = m_VoxelGrid[ uCornerIndex ];
+                for ( uIndexOfIdOnList = 0; uIndexOfIdOnList < pVoxel->Type; ++uIndexOfIdOnList )
+                    if ( pVoxel->Id[ uIndexOfIdOnList ] == uId )
+                        break;
 
-                if ( voxel.Type == Voxel::FullSolid || voxel.Type == 0 )
+                if ( uIndexOfIdOnList == pVoxel->Type )
                     continue;
 
-                uLastIdOnList = voxel.Id[ voxel.Type - 1 ];
+                pVoxel->Id[ uIndexOfIdOnList ] = pVoxel->Id[ --pVoxel->Type ];
+            }
+        }
+    }
 
-                for ( uIndexOfIdOnList = 0; uIndexOfIdOnList < voxel.Type; ++uIndexOfIdOnList )
-                    if ( voxel.Id[ uIndexOfIdOnList ] == uId )
-                        break;
+    this->MarkCellsChanged( lo, hi );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void IWorldGrid::WriteBox( const iVec &min, const iVec &max, uint32_t uType, uint32_t uColor )
+{
+    iVec lo, hi;
+    if ( !ClipRegion( min, max, lo, hi ) )
+        return;
 
-                voxel.Id[ uIndexOfIdOnList ] = voxel.Id[ --voxel.Type ];
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
+        {
+            Voxel *pVoxel = &m_VoxelGrid[ CalcIndex( iVec( lo.x, y, z ) ) ];
+            for ( int32_t x = lo.x; x <= hi.x; ++x, ++pVoxel )
+            {
+                // Cells occupied by objects keep their ids
+                if ( pVoxel->Type != Voxel::FullSolid && pVoxel->Type != 0 )
+                    continue;
+
+                pVoxel->Type  = uType;
+                pVoxel->Color = uColor;
             }
         }
     }
+
+    this->MarkCellsChanged( lo, hi );
+    this->RequestUpload();
 }
 
 } // namespace B33::Rendering
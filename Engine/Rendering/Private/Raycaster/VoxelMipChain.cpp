@@ -0,0 +1,191 @@
+#include "B33Rendering.hpp"
+
+#include "Raycaster/VoxelMipChain.hpp"
+
+namespace B33::Rendering
+{
+
+using namespace ::std;
+using namespace ::B33::Math;
+
+// Statics // ----------------------------------------------------------------------------------------------------------
+
+// Solid cells can't be 0, static voxels of that color become opaque black
+static constexpr uint32_t SolidBlack = 0x000000FF;
+
+// --------------------------------------------------------------------------------------------------------------------
+VoxelMipChain::VoxelMipChain()
+  : m_Header()
+  , m_vCells()
+  , m_vDirtySpans()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+VoxelMipChain::~VoxelMipChain() = default;
+
+// Public // -----------------------------------------------------------------------------------------------------------
+void VoxelMipChain::Build( const IWorldGrid &grid )
+{
+    m_Header = {};
+
+    uint32_t uDim    = static_cast<uint32_t>( grid.GetGridWidth() );
+    uint32_t uOffset = 0;
+    while ( m_Header.uLevelCount < VoxelMipHeader::MaxLevels && uDim > 1 )
+    {
+        uDim = ( uDim + 1 ) / 2;
+
+        m_Header.Levels[ m_Header.uLevelCount++ ] = { .uOffset = uOffset, .uDim = uDim };
+        uOffset += uDim * uDim * uDim;
+    }
+
+    // Occupancy of every level starts on its own word after the colors of all levels
+    for ( uint32_t uLevel = 0; uLevel < m_Header.uLevelCount; ++uLevel )
+    {
+        const uint32_t uLevelDim = m_Header.Levels[ uLevel ].uDim;
+
+        m_Header.Levels[ uLevel ].uOccupancyOffset = uOffset;
+        uOffset += ( uLevelDim * uLevelDim * uLevelDim + 31 ) / 32;
+    }
+
+    m_vCells.assign( uOffset, 0 );
+    m_vDirtySpans.assign( m_Header.uLevelCount * 2, Span { 0, 0 } );
+
+    const int32_t iLast = static_cast<int32_t>( grid.GetGridWidth() ) - 1;
+    if ( iLast >= 0 )
+        Update( grid, iVec3( 0, 0, 0 ), iVec3( iLast, iLast, iLast ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelMipChain::Update( const IWorldGrid &grid, const iVec3 &min, const iVec3 &max )
+{
+    iVec3 lo = min;
+    iVec3 hi = max;
+
+    for ( uint32_t uLevel = 1; uLevel <= m_Header.uLevelCount; ++uLevel )
+    {
+        const VoxelMipLevel &level = m_Header.Levels[ uLevel - 1 ];
+
+        // Boxes stay inside of the grid, halving non negative bounds rounds down
+        lo = iVec3( lo.x >> 1, lo.y >> 1, lo.z >> 1 );
+        hi = iVec3( hi.x >> 1, hi.y >> 1, hi.z >> 1 );
+
+        ReduceLevel( grid, uLevel, lo, hi );
+
+        const size_t uFirst = lo.x + lo.y * level.uDim + lo.z * level.uDim * level.uDim;
+        const size_t uLast  = hi.x + hi.y * level.uDim + hi.z * level.uDim * level.uDim;
+
+        MarkDirty( ( uLevel - 1 ) * 2, level.uOffset + uFirst, level.uOffset + uLast + 1 );
+        MarkDirty( ( uLevel - 1 ) * 2 + 1,
+                   level.uOccupancyOffset + uFirst / 32,
+                   level.uOccupancyOffset + uLast / 32 + 1 );
+    }
+}
+
+// Private // ----------------------------------------------------------------------------------------------------------
+void VoxelMipChain::ReduceLevel( const IWorldGrid &grid, uint32_t uLevel, const iVec3 &lo, const iVec3 &hi )
+{
+    const VoxelMipLevel &level       = m_Header.Levels[ uLevel - 1 ];
+    const size_t         uChildDim   = uLevel == 1 ? grid.GetGridWidth() : m_Header.Levels[ uLevel - 2 ].uDim;
+    const size_t         uChildBase  = uLevel == 1 ? 0 : m_Header.Levels[ uLevel - 2 ].uOffset;
+    const size_t         uChildBits  = uLevel == 1 ? 0 : m_Header.Levels[ uLevel - 2 ].uOccupancyOffset;
+    const Voxel         *pVoxels     = grid.GetGrid().data();
+    const int32_t        iChildLimit = static_cast<int32_t>( uChildDim );
+
+    uint32_t uColors[ 8 ];
+    uint32_t uVotes[ 8 ];
+
+    for ( int32_t z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int32_t y = lo.y; y <= hi.y; ++y )
+        {
+            for ( int32_t x = lo.x; x <= hi.x; ++x )
+            {
+                uint32_t uChildren = 0;
+                uint32_t uSolid    = 0;
+                uint32_t uDistinct = 0;
+                bool     bOccupied = false;
+
+                for ( int32_t i = 0; i < 8; ++i )
+                {
+                    const int32_t cx = x * 2 + ( i & 1 );
+                    const int32_t cy = y * 2 + ( ( i >> 1 ) & 1 );
+                    const int32_t cz = z * 2 + ( i >> 2 );
+
+                    // Odd dimensions leave the last cells with fewer children
+                    if ( cx >= iChildLimit || cy >= iChildLimit || cz >= iChildLimit )
+                        continue;
+
+                    const size_t uChild = cx + cy * uChildDim + cz * uChildDim * uChildDim;
+
+                    bool     bSolid;
+                    uint32_t uColor;
+                    if ( uLevel == 1 )
+                    {
+                        bSolid     = pVoxels[ uChild ].Type == Voxel::FullSolid;
+                        bOccupied |= pVoxels[ uChild ].Type != 0;
+                        uColor     = pVoxels[ uChild ].Color != 0 ? pVoxels[ uChild ].Color : SolidBlack;
+                    }
+                    else
+                    {
+                        uColor     = m_vCells[ uChildBase + uChild ];
+                        bSolid     = uColor != 0;
+                        bOccupied |= ( m_vCells[ uChildBits + uChild / 32 ] >> ( uChild % 32 ) ) & 1;
+                    }
+
+                    ++uChildren;
+                    if ( !bSolid )
+                        continue;
+
+                    ++uSolid;
+
+                    uint32_t uSlot = 0;
+                    while ( uSlot < uDistinct && uColors[ uSlot ] != uColor )
+                        ++uSlot;
+
+                    if ( uSlot == uDistinct )
+                    {
+                        uColors[ uDistinct ]  = uColor;
+                        uVotes[ uDistinct++ ] = 0;
+                    }
+
+                    ++uVotes[ uSlot ];
+                }
+
+                uint32_t uResult = 0;
+                if ( uSolid != 0 && uSolid * 2 >= uChildren )
+                {
+                    uint32_t uBest = 0;
+                    for ( uint32_t uSlot = 1; uSlot < uDistinct; ++uSlot )
+                        if ( uVotes[ uSlot ] > uVotes[ uBest ] )
+                            uBest = uSlot;
+
+                    uResult = uColors[ uBest ];
+                }
+
+                const size_t   uCell = x + y * level.uDim + z * level.uDim * level.uDim;
+                const uint32_t uBit  = 1u << ( uCell % 32 );
+                uint32_t      &uWord = m_vCells[ level.uOccupancyOffset + uCell / 32 ];
+
+                m_vCells[ level.uOffset + uCell ] = uResult;
+                uWord                             = bOccupied ? ( uWord | uBit ) : ( uWord & ~uBit );
+            }
+        }
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelMipChain::MarkDirty( size_t uSpan, size_t uBegin, size_t uEnd )
+{
+    Span &span = m_vDirtySpans[ uSpan ];
+    if ( span.uBegin == span.uEnd )
+    {
+        span = { uBegin, uEnd };
+        return;
+    }
+
+    span.uBegin = ::std::min( span.uBegin, uBegin );
+    span.uEnd   = ::std::max( span.uEnd, uEnd );
+}
+
+} // namespace B33::Rendering
@@ -2,6 +2,7 @@
 #include "B33Rendering.hpp"
 
 #include "Raycaster/VoxelPipeline.hpp"
+#include "Synchronization/JobSystem.hpp"
 #include "Vulkan/ErrorHandling.hpp"
 #include "Vulkan/GPUStreamBuffer.hpp"
 #include "Vulkan/Memory.hpp"
@@ -33,6 +34,141 @@ VoxelPipeline::~VoxelPipeline()
     m_RotationsBuffer      = nullptr;
     m_HalfSizesBuffer      = nullptr;
 
+    m_StageChunkTableBuffer = nullptr;
+    m_StageChunkSlotsBuffer = nullptr;
+    m_ChunkTableBuffer      = nullptr;
+    m_ChunkSlotsBuffer      = nullptr;
+    m_pChunkStreamer        = nullptr;
+
+    m_StageVoxelMipsBuffer = nullptr;
+    m_VoxelMipsBuffer      = nullptr;
+    m_TileStartBuffer      = nullptr;
+    m_HistoryBuffer        = nullptr;
+    m_PreviousFrameBuffer  = nullptr;
+    m_RenderImage          = nullptr;
+    m_LightCacheBuffer     = nullptr;
+    m_LightChangesBuffer   = nullptr;
+    m_ObjectCellsBuffer    = nullptr;
+    m_ObjectIdsBuffer      = nullptr;
+
+    m_WavefrontQueuesBuffer = nullptr;
+    m_HitRecordsBuffer      = nullptr;
+
+    for ( auto &variant : m_vRaycastVariants )
+        vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), variant.second, NULL );
+
+    m_vRaycastVariants.clear();
+
+    for ( auto &variant : m_vWavefrontVariants )
+    {
+        for ( VkPipeline pipeline : { variant.second.Primary,
+                                      variant.second.Shadow,
+                                      variant.second.Reflection,
+                                      variant.second.Shade } )
+        {
+            if ( pipeline != VK_NULL_HANDLE )
+                vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), pipeline, NULL );
+        }
+    }
+
+    m_vWavefrontVariants.clear();
+
+    if ( m_BeamPipeline != VK_NULL_HANDLE )
+    {
+        vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), m_BeamPipeline, NULL );
+        m_BeamPipeline = VK_NULL_HANDLE;
+    }
+
+    if ( m_UpscalePipeline != VK_NULL_HANDLE )
+    {
+        vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), m_UpscalePipeline, NULL );
+        m_UpscalePipeline = VK_NULL_HANDLE;
+    }
+
+    if ( m_LightCachePipeline != VK_NULL_HANDLE )
+    {
+        vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), m_LightCachePipeline, NULL );
+        m_LightCachePipeline = VK_NULL_HANDLE;
+    }
+
+    if ( m_ObjectCountPipeline != VK_NULL_HANDLE )
+    {
+        vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), m_ObjectCountPipeline, NULL );
+        m_ObjectCountPipeline = VK_NULL_HANDLE;
+    }
+
+    if ( m_ObjectScanPipeline != VK_NULL_HANDLE )
+    {
+        vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), m_ObjectScanPipeline, NULL );
+        m_ObjectScanPipeline = VK_NULL_HANDLE;
+    }
+
+    if ( m_ObjectFillPipeline != VK_NULL_HANDLE )
+    {
+        vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), m_ObjectFillPipeline, NULL );
+        m_ObjectFillPipeline = VK_NULL_HANDLE;
+    }
+
+    if ( m_BeamShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_BeamShaderModule, NULL );
+        m_BeamShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_UpscaleShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_UpscaleShaderModule, NULL );
+        m_UpscaleShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_LightCacheShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_LightCacheShaderModule, NULL );
+        m_LightCacheShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_ObjectCountShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_ObjectCountShaderModule, NULL );
+        m_ObjectCountShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_ObjectScanShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_ObjectScanShaderModule, NULL );
+        m_ObjectScanShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_ObjectFillShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_ObjectFillShaderModule, NULL );
+        m_ObjectFillShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_PrimaryShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_PrimaryShaderModule, NULL );
+        m_PrimaryShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_ShadowShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_ShadowShaderModule, NULL );
+        m_ShadowShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_ReflectionShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_ReflectionShaderModule, NULL );
+        m_ReflectionShaderModule = VK_NULL_HANDLE;
+    }
+
+    if ( m_ShadeShaderModule != VK_NULL_HANDLE )
+    {
+        vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_ShadeShaderModule, NULL );
+        m_ShadeShaderModule = VK_NULL_HANDLE;
+    }
+
     if ( m_ShaderModule != VK_NULL_HANDLE )
     {
         vkDestroyShaderModule( GetAdaterInternal()->GetAdapterHandle(), m_ShaderModule, NULL );
@@ -43,7 +179,15 @@ VoxelPipeline::~VoxelPipeline()
 // Public // -----------------------------------------------------------------------------------------------------------
 void VoxelPipeline::CreatePipelineResourcesImpl( ::std::shared_ptr<::B33::Rendering::CubeWorld> pWorld )
 {
-    m_pVoxelGrid = pWorld;
+    CreatePipelineResourcesImpl( pWorld, nullptr );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::CreatePipelineResourcesImpl( ::std::shared_ptr<::B33::Rendering::CubeWorld>     pWorld,
+                                                 ::std::shared_ptr<::B33::Rendering::ChunkStreamer> pChunkStreamer )
+{
+    m_pVoxelGrid     = pWorld;
+    m_pChunkStreamer = pChunkStreamer;
 
     m_StageVoxelBuffer = std::move( GetMemoryInternal()->ReserveStagingBuffer( m_pVoxelGrid->GetVoxelsSizeInBytes() ) );
     m_StagePositonsBuffer  = std::move( GetMemoryInternal()->ReserveStagingBuffer(
@@ -59,16 +203,105 @@ void VoxelPipeline::CreatePipelineResourcesImpl( ::std::shared_ptr<::B33::Render
         m_pVoxelGrid->GetStoredObjects().GetRotations().capacity() * sizeof( Vec3 ) ) );
     m_HalfSizesBuffer      = std::move( GetMemoryInternal()->ReserveGPUBuffer(
         ( /*FIXME: */ (Cubes &)m_pVoxelGrid->GetStoredObjects() ).GetHalfSizes().capacity() * sizeof( Vec3 ) ) );
+
+    // Without a streamer the window is empty and rays leaving the grid end there
+    const size_t uTableBytes =
+        m_pChunkStreamer != nullptr ? m_pChunkStreamer->GetTableSizeInBytes() : sizeof( ChunkTableHeader );
+    const size_t uSlotsBytes =
+        m_pChunkStreamer != nullptr ? m_pChunkStreamer->GetSlotsSizeInBytes() : sizeof( uint32_t );
+
+    m_StageChunkTableBuffer = std::move( GetMemoryInternal()->ReserveStagingBuffer( uTableBytes ) );
+    m_StageChunkSlotsBuffer = std::move( GetMemoryInternal()->ReserveStagingBuffer( uSlotsBytes ) );
+    m_ChunkTableBuffer      = std::move( GetMemoryInternal()->ReserveGPUBuffer( uTableBytes ) );
+    m_ChunkSlotsBuffer      = std::move( GetMemoryInternal()->ReserveGPUBuffer( uSlotsBytes ) );
+
+    // First upload binds both buffers, the shader may not see unwritten descriptors even if it never reads them
+    const ChunkTableHeader emptyHeader = {};
+    const uint32_t         uEmptySlot  = 0;
+
+    GetMemoryInternal()->UploadOnStreamBuffer(
+        &emptyHeader,
+        sizeof( emptyHeader ),
+        GetUniformUploadDescriptor( m_StageChunkTableBuffer, m_ChunkTableBuffer, EShaderResource::ChunkTable ) );
+    GetMemoryInternal()->UploadOnStreamBuffer(
+        &uEmptySlot,
+        sizeof( uEmptySlot ),
+        GetUniformUploadDescriptor( m_StageChunkSlotsBuffer, m_ChunkSlotsBuffer, EShaderResource::ChunkSlots ) );
+
+    m_vChunkTableCopies.push_back( { .srcOffset = 0, .dstOffset = 0, .size = sizeof( emptyHeader ) } );
+    m_vChunkSlotsCopies.push_back( { .srcOffset = 0, .dstOffset = 0, .size = sizeof( uEmptySlot ) } );
+
+    // Whole chain is built here, the changes gathered until now are part of it
+    iVec changedMin, changedMax;
+    m_pVoxelGrid->ConsumeCellChanges( changedMin, changedMax );
+    m_VoxelMips.Build( *m_pVoxelGrid );
+
+    m_StageVoxelMipsBuffer = std::move( GetMemoryInternal()->ReserveStagingBuffer( m_VoxelMips.GetSizeInBytes() ) );
+    m_VoxelMipsBuffer      = std::move( GetMemoryInternal()->ReserveGPUBuffer( m_VoxelMips.GetSizeInBytes() ) );
+
+    const UploadDescriptor mipsUpload =
+        GetUniformUploadDescriptor( m_StageVoxelMipsBuffer, m_VoxelMipsBuffer, EShaderResource::VoxelMips );
+
+    GetMemoryInternal()->UploadOnStreamBuffer( &m_VoxelMips.GetHeader(), sizeof( VoxelMipHeader ), 0, mipsUpload );
+    if ( !m_VoxelMips.GetCells().empty() )
+    {
+        GetMemoryInternal()->UploadOnStreamBuffer( m_VoxelMips.GetCells().data(),
+                                                   m_VoxelMips.GetCells().size() * sizeof( uint32_t ),
+                                                   sizeof( VoxelMipHeader ),
+                                                   mipsUpload );
+    }
+
+    m_vVoxelMipsCopies.push_back( { .srcOffset = 0, .dstOffset = 0, .size = m_VoxelMips.GetSizeInBytes() } );
+    m_VoxelMips.ClearDirty();
+
+    // Written straight from the command buffer every frame
+    m_PreviousFrameBuffer = std::move( GetMemoryInternal()->ReserveGPUBuffer( sizeof( VoxelPushConstants ) ) );
+    BindStorageBuffer( m_PreviousFrameBuffer, EShaderResource::PreviousFrame );
+
+    // Cache starts with garbage, the first frame resets all of it
+    const int32_t iLast            = static_cast<int32_t>( m_pVoxelGrid->GetGridWidth() ) - 1;
+    const size_t  uLightCacheBytes = m_pVoxelGrid->GetVoxels() * 6 * sizeof( uint32_t );
+
+    m_LightCacheBuffer   = std::move( GetMemoryInternal()->ReserveGPUBuffer( uLightCacheBytes ) );
+    m_LightChangesBuffer = std::move( GetMemoryInternal()->ReserveGPUBuffer( sizeof( LightCacheChanges ) ) );
+    BindStorageBuffer( m_LightCacheBuffer, EShaderResource::LightCache );
+    BindStorageBuffer( m_LightChangesBuffer, EShaderResource::LightChanges );
+    MarkLightChanges( iVec( 0, 0, 0 ), iVec( iLast, iLast, iLast ) );
+
+    // Object grid covers the voxel grid, the ids are sized by the cells the objects overlap
+    const uint32_t uObjectCells =
+        static_cast<uint32_t>( ( m_pVoxelGrid->GetGridWidth() + ( 1 << ObjectCellShift ) - 1 ) >> ObjectCellShift );
+
+    m_ObjectGridHeader.uCellsPerAxis = uObjectCells;
+
+    m_ObjectCellsBuffer = std::move( GetMemoryInternal()->ReserveGPUBuffer(
+        sizeof( ObjectGridHeader ) + uObjectCells * uObjectCells * uObjectCells * 2 * sizeof( uint32_t ) ) );
+    BindStorageBuffer( m_ObjectCellsBuffer, EShaderResource::ObjectCells );
+    ReserveObjectIds();
+    m_bObjectGridDirty = true;
+
+    ReserveScreenBuffers();
 }
 
 // --------------------------------------------------------------------------------------------------------------------
 void VoxelPipeline::Update()
 {
+    if ( m_pChunkStreamer != nullptr )
+        UploadStreamedChunks();
+
+    UploadVoxelMips();
+
     if ( !( m_pVoxelGrid->ReuploadStatus() & EReupload::RequestStaging ) )
         return;
 
     m_uStorageBuffersFlags = m_pVoxelGrid->GetChanged();
 
+    if ( m_uStorageBuffersFlags & ( EGridChanged::Position | EGridChanged::Rotation | EGridChanged::HalfSize ) )
+    {
+        m_bObjectGridDirty = true;
+        ReserveObjectIds();
+    }
+
     GetMemoryInternal()->UploadOnStreamBuffer(
         m_pVoxelGrid->GetGrid().data(),
         m_pVoxelGrid->GetGrid().size() * sizeof( Voxel ),
@@ -77,16 +310,16 @@ void VoxelPipeline::Update()
     if ( m_uStorageBuffersFlags & EGridChanged::Position )
     {
         GetMemoryInternal()->UploadOnStreamBuffer(
-            m_pVoxelGrid->GetStoredObjects().GetPositions().data(),
-            m_pVoxelGrid->GetStoredObjects().GetPositions().size() * sizeof( Vec3 ),
+            m_pVoxelGrid->GetStoredObjects().GetRenderPositions().data(),
+            m_pVoxelGrid->GetStoredObjects().GetRenderPositions().size() * sizeof( Vec3 ),
             GetUniformUploadDescriptor( m_StagePositonsBuffer, VoxelPipeline::EShaderResource::ObjectPositions ) );
     }
 
     if ( m_uStorageBuffersFlags & EGridChanged::Rotation )
     {
         GetMemoryInternal()->UploadOnStreamBuffer(
-            m_pVoxelGrid->GetStoredObjects().GetRotations().data(),
-            m_pVoxelGrid->GetStoredObjects().GetRotations().size() * sizeof( Vec3 ),
+            m_pVoxelGrid->GetStoredObjects().GetRenderRotations().data(),
+            m_pVoxelGrid->GetStoredObjects().GetRenderRotations().size() * sizeof( Vec3 ),
             GetUniformUploadDescriptor( m_StageRotationsBuffer, VoxelPipeline::EShaderResource::ObjectRotations ) );
     }
 
@@ -111,6 +344,26 @@ void VoxelPipeline::RecordCommands( VkPipelineStageFlagBits lastStage, VkCommand
 
     this->LoadImage( swapChain->GetImage() );
 
+    // History is addressed by the pixels of the rendered image, it's useless once the size changes
+    const VkExtent2D renderExtent = {
+        .width  = ::std::clamp<uint32_t>( lroundf( GetWindowDescInternal()->Width * m_fRenderScale ),
+                                          1,
+                                          m_RenderImage->GetExtent().width ),
+        .height = ::std::clamp<uint32_t>( lroundf( GetWindowDescInternal()->Height * m_fRenderScale ),
+                                          1,
+                                          m_RenderImage->GetExtent().height ),
+    };
+
+    if ( renderExtent.width != m_RenderExtent.width || renderExtent.height != m_RenderExtent.height )
+    {
+        m_RenderExtent = renderExtent;
+        m_uFrame       = 0;
+    }
+
+    // Constants come from the caller every frame, the frame index and the extent are the pipeline's own
+    m_Vpc.uFrame        = m_uFrame;
+    m_Vpc.uRenderExtent = m_RenderExtent.width | ( m_RenderExtent.height << 16 );
+
     vkCmdPushConstants( cmdBuffer,
                         GetLayoutHandle(),
                         VK_SHADER_STAGE_COMPUTE_BIT,
@@ -118,6 +371,46 @@ void VoxelPipeline::RecordCommands( VkPipelineStageFlagBits lastStage, VkCommand
                         sizeof( VoxelPushConstants ),
                         &m_Vpc );
 
+    // Both frames in flight share the buffers, the other frame may still read the chunks and mips that are replaced,
+    // reproject with the previous frame and its light cache pass read the changes. Every copy and update waits for it
+    VkBufferMemoryBarrier updateBarriers[ 5 ] = {};
+    uint32_t              uUpdateBarrierCount = 0;
+
+    const auto addUpdateBarrier = [ & ]( const shared_ptr<GPUBuffer> &pBuffer )
+    {
+        updateBarriers[ uUpdateBarrierCount++ ] = {
+            .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+            .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer              = pBuffer->GetBufferHandle(),
+            .offset              = 0,
+            .size                = VK_WHOLE_SIZE,
+        };
+    };
+
+    addUpdateBarrier( m_PreviousFrameBuffer );
+    if ( m_bLightChanged )
+        addUpdateBarrier( m_LightChangesBuffer );
+    if ( !m_vChunkTableCopies.empty() )
+        addUpdateBarrier( m_ChunkTableBuffer );
+    if ( !m_vChunkSlotsCopies.empty() )
+        addUpdateBarrier( m_ChunkSlotsBuffer );
+    if ( !m_vVoxelMipsCopies.empty() )
+        addUpdateBarrier( m_VoxelMipsBuffer );
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          0,
+                          0,
+                          NULL,
+                          uUpdateBarrierCount,
+                          updateBarriers,
+                          0,
+                          NULL );
+
     if ( m_pVoxelGrid->ReuploadStatus() & EReupload::RequestGpuUpload )
     {
         VkBufferCopy copyRegion = {
@@ -196,7 +489,93 @@ void VoxelPipeline::RecordCommands( VkPipelineStageFlagBits lastStage, VkCommand
         m_uStorageBuffersFlags &= 0;
     }
 
-    VkBufferMemoryBarrier bufferBarriers[ 4 ] = {};
+    if ( !m_vChunkTableCopies.empty() )
+    {
+        vkCmdCopyBuffer( cmdBuffer,
+                         m_StageChunkTableBuffer->GetBufferHandle(),
+                         m_ChunkTableBuffer->GetBufferHandle(),
+                         static_cast<uint32_t>( m_vChunkTableCopies.size() ),
+                         m_vChunkTableCopies.data() );
+        m_vChunkTableCopies.clear();
+    }
+
+    if ( !m_vChunkSlotsCopies.empty() )
+    {
+        vkCmdCopyBuffer( cmdBuffer,
+                         m_StageChunkSlotsBuffer->GetBufferHandle(),
+                         m_ChunkSlotsBuffer->GetBufferHandle(),
+                         static_cast<uint32_t>( m_vChunkSlotsCopies.size() ),
+                         m_vChunkSlotsCopies.data() );
+        m_vChunkSlotsCopies.clear();
+    }
+
+    if ( !m_vVoxelMipsCopies.empty() )
+    {
+        vkCmdCopyBuffer( cmdBuffer,
+                         m_StageVoxelMipsBuffer->GetBufferHandle(),
+                         m_VoxelMipsBuffer->GetBufferHandle(),
+                         static_cast<uint32_t>( m_vVoxelMipsCopies.size() ),
+                         m_vVoxelMipsCopies.data() );
+        m_vVoxelMipsCopies.clear();
+    }
+
+    // Small enough to go inline
+    vkCmdUpdateBuffer( cmdBuffer,
+                       m_PreviousFrameBuffer->GetBufferHandle(),
+                       0,
+                       sizeof( VoxelPushConstants ),
+                       &m_PreviousVpc );
+
+    if ( m_bLightChanged )
+    {
+        vkCmdUpdateBuffer( cmdBuffer,
+                           m_LightChangesBuffer->GetBufferHandle(),
+                           0,
+                           sizeof( LightCacheChanges ),
+                           &m_LightChanges );
+    }
+
+    // Object grid is rebuilt from zeroed lists, the previous frame may still read them
+    if ( m_bObjectGridDirty )
+    {
+        VkBufferMemoryBarrier objectCellsBarrier = {
+            .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer              = m_ObjectCellsBuffer->GetBufferHandle(),
+            .offset              = 0,
+            .size                = VK_WHOLE_SIZE,
+        };
+
+        vkCmdPipelineBarrier( cmdBuffer,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              0,
+                              0,
+                              NULL,
+                              1,
+                              &objectCellsBarrier,
+                              0,
+                              NULL );
+
+        m_ObjectGridHeader.uObjectCount =
+            static_cast<uint32_t>( m_pVoxelGrid->GetStoredObjects().GetPositions().size() );
+
+        vkCmdFillBuffer( cmdBuffer,
+                         m_ObjectCellsBuffer->GetBufferHandle(),
+                         sizeof( ObjectGridHeader ),
+                         VK_WHOLE_SIZE,
+                         0 );
+        vkCmdUpdateBuffer( cmdBuffer,
+                           m_ObjectCellsBuffer->GetBufferHandle(),
+                           0,
+                           sizeof( ObjectGridHeader ),
+                           &m_ObjectGridHeader );
+    }
+
+    VkBufferMemoryBarrier bufferBarriers[ 10 ] = {};
 
     bufferBarriers[ 0 ] = {
         .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
@@ -218,20 +597,211 @@ void VoxelPipeline::RecordCommands( VkPipelineStageFlagBits lastStage, VkCommand
     bufferBarriers[ 3 ]        = bufferBarriers[ 2 ];
     bufferBarriers[ 3 ].buffer = m_HalfSizesBuffer->GetBufferHandle();
 
+    bufferBarriers[ 4 ]        = bufferBarriers[ 3 ];
+    bufferBarriers[ 4 ].buffer = m_ChunkTableBuffer->GetBufferHandle();
+
+    bufferBarriers[ 5 ]        = bufferBarriers[ 4 ];
+    bufferBarriers[ 5 ].buffer = m_ChunkSlotsBuffer->GetBufferHandle();
+
+    bufferBarriers[ 6 ]        = bufferBarriers[ 5 ];
+    bufferBarriers[ 6 ].buffer = m_VoxelMipsBuffer->GetBufferHandle();
+
+    bufferBarriers[ 7 ]        = bufferBarriers[ 6 ];
+    bufferBarriers[ 7 ].buffer = m_PreviousFrameBuffer->GetBufferHandle();
+
+    bufferBarriers[ 8 ]        = bufferBarriers[ 7 ];
+    bufferBarriers[ 8 ].buffer = m_LightChangesBuffer->GetBufferHandle();
+
+    bufferBarriers[ 9 ]               = bufferBarriers[ 8 ];
+    bufferBarriers[ 9 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    bufferBarriers[ 9 ].buffer        = m_ObjectCellsBuffer->GetBufferHandle();
+
     vkCmdPipelineBarrier( cmdBuffer,
-                          lastStage,
+                          lastStage | VK_PIPELINE_STAGE_TRANSFER_BIT,
                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
                           0,
                           0,
                           NULL,
-                          4,
+                          10,
                           bufferBarriers,
                           0,
                           NULL );
 
-    const uint32_t groupCountX = ( GetWindowDescInternal()->Width + 31 ) >> 5;
-    const uint32_t groupCountY = ( GetWindowDescInternal()->Height + 7 ) >> 3;
-    vkCmdDispatch( cmdBuffer, groupCountX, groupCountY, 1 );
+    // Beam pass, a thread per tile, the previous frame may still read the starts it overwrites. The history half
+    // written by the previous frame is read by this one and the other way around, the light cache is refined by both
+    // and the object ids are read by the previous frame before they are written again
+    VkBufferMemoryBarrier frameBarriers[ 4 ] = {};
+
+    frameBarriers[ 0 ] = {
+        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+        .dstAccessMask       = VK_ACCESS_SHADER_WRITE_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer              = m_TileStartBuffer->GetBufferHandle(),
+        .offset              = 0,
+        .size                = VK_WHOLE_SIZE,
+    };
+
+    frameBarriers[ 1 ]               = frameBarriers[ 0 ];
+    frameBarriers[ 1 ].srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    frameBarriers[ 1 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    frameBarriers[ 1 ].buffer        = m_HistoryBuffer->GetBufferHandle();
+
+    frameBarriers[ 2 ]        = frameBarriers[ 1 ];
+    frameBarriers[ 2 ].buffer = m_LightCacheBuffer->GetBufferHandle();
+
+    frameBarriers[ 3 ]        = frameBarriers[ 1 ];
+    frameBarriers[ 3 ].buffer = m_ObjectIdsBuffer->GetBufferHandle();
+
+    // Render image is read by the upscale pass of the previous frame, its content isn't kept between frames
+    VkImageMemoryBarrier renderImageBarrier = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+        .dstAccessMask       = VK_ACCESS_SHADER_WRITE_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout           = VK_IMAGE_LAYOUT_GENERAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = m_RenderImage->GetImageHandle(),
+        .subresourceRange    = VkImageSubresourceRange { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+    };
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          0,
+                          0,
+                          NULL,
+                          4,
+                          frameBarriers,
+                          1,
+                          &renderImageBarrier );
+
+    // Object passes, a thread per object counts and fills the lists of the cells it overlaps, a single group turns
+    // the counts into the starts of the lists between them
+    if ( m_bObjectGridDirty )
+    {
+        const uint32_t uObjectGroups = ( m_ObjectGridHeader.uObjectCount + 63 ) >> 6;
+
+        VkBufferMemoryBarrier objectBarrier = frameBarriers[ 0 ];
+        objectBarrier.srcAccessMask         = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        objectBarrier.dstAccessMask         = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        objectBarrier.buffer                = m_ObjectCellsBuffer->GetBufferHandle();
+
+        vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ObjectCountPipeline );
+        vkCmdDispatch( cmdBuffer, uObjectGroups, 1, 1 );
+        vkCmdPipelineBarrier( cmdBuffer,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              0,
+                              0,
+                              NULL,
+                              1,
+                              &objectBarrier,
+                              0,
+                              NULL );
+
+        vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ObjectScanPipeline );
+        vkCmdDispatch( cmdBuffer, 1, 1, 1 );
+        vkCmdPipelineBarrier( cmdBuffer,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                              0,
+                              0,
+                              NULL,
+                              1,
+                              &objectBarrier,
+                              0,
+                              NULL );
+
+        vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ObjectFillPipeline );
+        vkCmdDispatch( cmdBuffer, uObjectGroups, 1, 1 );
+        m_bObjectGridDirty = false;
+    }
+
+    // Light cache pass, a thread per voxel that may be shadowed by the changed cells, only on frames they changed
+    if ( m_bLightChanged )
+    {
+        const iVec     dispatchSize = m_LightChanges.DispatchMax - m_LightChanges.DispatchMin;
+        const uint32_t uGroupCountX = static_cast<uint32_t>( ( dispatchSize.x + 4 ) >> 2 );
+        const uint32_t uGroupCountY = static_cast<uint32_t>( ( dispatchSize.y + 4 ) >> 2 );
+        const uint32_t uGroupCountZ = static_cast<uint32_t>( ( dispatchSize.z + 4 ) >> 2 );
+
+        vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_LightCachePipeline );
+        vkCmdDispatch( cmdBuffer, uGroupCountX, uGroupCountY, uGroupCountZ );
+        m_bLightChanged = false;
+    }
+
+    VkBufferMemoryBarrier raycastBarriers[ 4 ] = { frameBarriers[ 0 ], frameBarriers[ 2 ], frameBarriers[ 3 ] };
+
+    raycastBarriers[ 3 ]        = frameBarriers[ 3 ];
+    raycastBarriers[ 3 ].buffer = m_ObjectCellsBuffer->GetBufferHandle();
+
+    const uint32_t tileCountX = ( m_RenderExtent.width + TileDim - 1 ) / TileDim;
+    const uint32_t tileCountY = ( m_RenderExtent.height + TileDim - 1 ) / TileDim;
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_BeamPipeline );
+    vkCmdDispatch( cmdBuffer, ( tileCountX + 7 ) >> 3, ( tileCountY + 7 ) >> 3, 1 );
+
+    raycastBarriers[ 0 ].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    raycastBarriers[ 0 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    raycastBarriers[ 1 ].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    raycastBarriers[ 2 ].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    raycastBarriers[ 2 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    raycastBarriers[ 3 ].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    raycastBarriers[ 3 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          0,
+                          0,
+                          NULL,
+                          4,
+                          raycastBarriers,
+                          0,
+                          NULL );
+
+    // All pipelines share the layout, the descriptor set and the push constants stay bound
+    const RaycastVariant variant     = GetRaycastVariant( m_Quality, m_Vpc.uMode == 1, m_bTileCache );
+    const uint32_t       groupCountX = ( m_RenderExtent.width + variant.uGroupSizeX - 1 ) / variant.uGroupSizeX;
+    const uint32_t       groupCountY = ( m_RenderExtent.height + variant.uGroupSizeY - 1 ) / variant.uGroupSizeY;
+    // Passes are built up front, a variant without them falls back to the single raycast instead of compiling here
+    const WavefrontPipelines *pWavefront = m_bWavefront ? FindWavefrontPipelines( variant ) : nullptr;
+    if ( pWavefront != nullptr )
+    {
+        RecordWavefront( cmdBuffer, *pWavefront, groupCountX, groupCountY );
+    }
+    else
+    {
+        vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, GetRaycastPipeline( variant ) );
+        vkCmdDispatch( cmdBuffer, groupCountX, groupCountY, 1 );
+    }
+
+    renderImageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    renderImageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    renderImageBarrier.oldLayout     = VK_IMAGE_LAYOUT_GENERAL;
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          0,
+                          0,
+                          NULL,
+                          0,
+                          NULL,
+                          1,
+                          &renderImageBarrier );
+
+    // Upscale pass, a thread per pixel of the swapchain image
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_UpscalePipeline );
+    vkCmdDispatch( cmdBuffer,
+                   ( GetWindowDescInternal()->Width + 7 ) >> 3,
+                   ( GetWindowDescInternal()->Height + 7 ) >> 3,
+                   1 );
+
+    m_PreviousVpc = m_Vpc;
+    ++m_uFrame;
 }
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -248,6 +818,10 @@ void VoxelPipeline::Reset()
     m_StageRotationsBuffer->Reset();
     m_StageHalfSizesBuffer->Reset();
     m_pVoxelGrid->ForceUpload();
+
+    // Frame resources are recreated with the device idle, e.g. after a resize, the history doesn't match anymore
+    ReserveScreenBuffers();
+    m_uFrame = 0;
 }
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -275,65 +849,363 @@ UploadDescriptor VoxelPipeline::GetUniformUploadDescriptor( const shared_ptr<GPU
                              outBuffer );
 }
 
-// ---------------------------------------------------------------------------------------------------------------------
-void VoxelPipeline::LoadImage( VkImage image )
+// --------------------------------------------------------------------------------------------------------------------
+UploadDescriptor VoxelPipeline::GetUniformUploadDescriptor( const shared_ptr<GPUStreamBuffer> &outBuffer,
+                                                            const shared_ptr<GPUBuffer>       &gpuBuffer,
+                                                            const EShaderResource             &sr )
 {
-    if ( m_ImageView != VK_NULL_HANDLE )
-    {
-        vkDestroyImageView( GetAdaterInternal()->GetAdapterHandle(), m_ImageView, nullptr );
-        m_ImageView = VK_NULL_HANDLE;
-    }
+    // Data goes through outBuffer, the shader reads gpuBuffer
+    UploadDescriptor upload  = GetUniformUploadDescriptor( outBuffer, sr );
+    upload.BufferInfo.buffer = gpuBuffer->GetBufferHandle();
 
-    VkImageViewCreateInfo viewInfo = {
-        .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image    = image,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format   = Swapchain::TargetedFormat,
-        .subresourceRange {
-            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel   = 0,
-            .levelCount     = 1,
-            .baseArrayLayer = 0,
-            .layerCount     = 1,
-        },
-    };
+    return upload;
+}
 
-    THROW_IF_FAILED( vkCreateImageView( GetAdaterInternal()->GetAdapterHandle(), &viewInfo, NULL, &m_ImageView ) );
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::UploadStreamedChunks()
+{
+    const size_t uSlotBytes = ChunkStreamer::ChunkVoxels * sizeof( uint32_t );
 
-    VkDescriptorImageInfo imageInfo = {
-        .imageView   = m_ImageView,
-        .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
-    };
+    if ( !m_pChunkStreamer->GetDirtySlots().empty() )
+    {
+        const UploadDescriptor slotsUpload =
+            GetUniformUploadDescriptor( m_StageChunkSlotsBuffer, m_ChunkSlotsBuffer, EShaderResource::ChunkSlots );
 
-    VkWriteDescriptorSet imageWrite = {
-        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet          = this->GetDescriptorSet(),
-        .dstBinding      = 0,
-        .dstArrayElement = 0,
-        .descriptorCount = 1,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-        .pImageInfo      = &imageInfo,
-    };
+        for ( const uint32_t uSlot : m_pChunkStreamer->GetDirtySlots() )
+        {
+            const size_t uOffset = uSlot * uSlotBytes;
 
-    vkUpdateDescriptorSets( GetAdaterInternal()->GetAdapterHandle(), 1, &imageWrite, 0, NULL );
+            GetMemoryInternal()->UploadOnStreamBuffer( m_pChunkStreamer->GetSlotColors( uSlot ),
+                                                       uSlotBytes,
+                                                       uOffset,
+                                                       slotsUpload );
+            m_vChunkSlotsCopies.push_back( { .srcOffset = uOffset, .dstOffset = uOffset, .size = uSlotBytes } );
+        }
+    }
+
+    if ( m_pChunkStreamer->IsTableDirty() )
+    {
+        const UploadDescriptor tableUpload =
+            GetUniformUploadDescriptor( m_StageChunkTableBuffer, m_ChunkTableBuffer, EShaderResource::ChunkTable );
+
+        GetMemoryInternal()->UploadOnStreamBuffer( &m_pChunkStreamer->GetTableHeader(),
+                                                   sizeof( ChunkTableHeader ),
+                                                   0,
+                                                   tableUpload );
+        GetMemoryInternal()->UploadOnStreamBuffer( m_pChunkStreamer->GetTable().data(),
+                                                   m_pChunkStreamer->GetTable().size() * sizeof( uint32_t ),
+                                                   sizeof( ChunkTableHeader ),
+                                                   tableUpload );
+
+        // Whole table goes at once, it's a few kilobytes
+        m_vChunkTableCopies.clear();
+        m_vChunkTableCopies.push_back(
+            { .srcOffset = 0, .dstOffset = 0, .size = m_pChunkStreamer->GetTableSizeInBytes() } );
+    }
+
+    m_pChunkStreamer->ClearGpuDirty();
 }
 
-// Private // ----------------------------------------------------------------------------------------------------------
-VkDescriptorSetLayout VoxelPipeline::CreateDescriptorLayoutImpl()
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::UploadVoxelMips()
 {
-    array<VkDescriptorSetLayoutBinding, 5> bindings = {};
-    VkDescriptorSetLayout                  descriptorSetLayout;
+    iVec changedMin, changedMax;
+    if ( !m_pVoxelGrid->ConsumeCellChanges( changedMin, changedMax ) )
+        return;
 
-    bindings[ 0 ] = {
-        .binding         = 0,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-        .descriptorCount = 1,
-        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
-    };
+    m_VoxelMips.Update( *m_pVoxelGrid, changedMin, changedMax );
+    MarkLightChanges( changedMin, changedMax );
 
-    bindings[ 1 ] = {
-        .binding         = VoxelPipeline::EShaderResource::VoxelGrid,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    const UploadDescriptor mipsUpload =
+        GetUniformUploadDescriptor( m_StageVoxelMipsBuffer, m_VoxelMipsBuffer, EShaderResource::VoxelMips );
+
+    for ( const VoxelMipChain::Span &span : m_VoxelMips.GetDirtySpans() )
+    {
+        if ( span.uBegin == span.uEnd )
+            continue;
+
+        const size_t uOffset = sizeof( VoxelMipHeader ) + span.uBegin * sizeof( uint32_t );
+        const size_t uSize   = ( span.uEnd - span.uBegin ) * sizeof( uint32_t );
+
+        GetMemoryInternal()->UploadOnStreamBuffer( m_VoxelMips.GetCells().data() + span.uBegin,
+                                                   uSize,
+                                                   uOffset,
+                                                   mipsUpload );
+        m_vVoxelMipsCopies.push_back( { .srcOffset = uOffset, .dstOffset = uOffset, .size = uSize } );
+    }
+
+    m_VoxelMips.ClearDirty();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::MarkLightChanges( const iVec &changedMin, const iVec &changedMax )
+{
+    if ( !m_bLightChanged )
+    {
+        m_LightChanges.ChangedMin = changedMin;
+        m_LightChanges.ChangedMax = changedMax;
+        m_bLightChanged           = true;
+    }
+    else
+    {
+        m_LightChanges.ChangedMin = iVec( ::std::min( m_LightChanges.ChangedMin.x, changedMin.x ),
+                                          ::std::min( m_LightChanges.ChangedMin.y, changedMin.y ),
+                                          ::std::min( m_LightChanges.ChangedMin.z, changedMin.z ) );
+        m_LightChanges.ChangedMax = iVec( ::std::max( m_LightChanges.ChangedMax.x, changedMax.x ),
+                                          ::std::max( m_LightChanges.ChangedMax.y, changedMax.y ),
+                                          ::std::max( m_LightChanges.ChangedMax.z, changedMax.z ) );
+    }
+
+    // Faces whose path to the light crosses the box lie behind it as seen from the light, on every axis the light
+    // isn't level with the box only the side away from it is reset. Both have to match LightCache, the light of the
+    // GLSL raycast is lower than the one of the HLSL raycast so the range covers both
+    constexpr float lightMin[ 3 ] = { 20.f, 5.f, 10.f };
+    constexpr float lightMax[ 3 ] = { 20.f, 25.f, 10.f };
+    constexpr float fMargin       = 2.f;
+
+    const int32_t iLast = static_cast<int32_t>( m_pVoxelGrid->GetGridWidth() ) - 1;
+
+    const int32_t changed[ 2 ][ 3 ] = {
+        { m_LightChanges.ChangedMin.x, m_LightChanges.ChangedMin.y, m_LightChanges.ChangedMin.z },
+        { m_LightChanges.ChangedMax.x, m_LightChanges.ChangedMax.y, m_LightChanges.ChangedMax.z },
+    };
+    int32_t dispatch[ 2 ][ 3 ] = {};
+
+    for ( size_t i = 0; i < 3; ++i )
+    {
+        // Faces of a voxel lie on the bounds of its cell, the grown box spans [min - margin, max + 1 + margin]
+        const float fLow  = static_cast<float>( changed[ 0 ][ i ] ) - fMargin;
+        const float fHigh = static_cast<float>( changed[ 1 ][ i ] ) + 1.f + fMargin;
+
+        dispatch[ 0 ][ i ] = lightMax[ i ] < fLow ? static_cast<int32_t>( floorf( fLow ) ) - 1 : 0;
+        dispatch[ 1 ][ i ] = lightMin[ i ] > fHigh ? static_cast<int32_t>( ceilf( fHigh ) ) : iLast;
+        dispatch[ 0 ][ i ] = ::std::clamp( dispatch[ 0 ][ i ], 0, iLast );
+        dispatch[ 1 ][ i ] = ::std::clamp( dispatch[ 1 ][ i ], 0, iLast );
+    }
+
+    m_LightChanges.DispatchMin = iVec( dispatch[ 0 ][ 0 ], dispatch[ 0 ][ 1 ], dispatch[ 0 ][ 2 ] );
+    m_LightChanges.DispatchMax = iVec( dispatch[ 1 ][ 0 ], dispatch[ 1 ][ 1 ], dispatch[ 1 ][ 2 ] );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::ReserveObjectIds()
+{
+    const WorldObjects &objects    = m_pVoxelGrid->GetStoredObjects();
+    const vector<Vec3> &vPositions = objects.GetRenderPositions();
+    const vector<Vec3> &vRotations = objects.GetRenderRotations();
+    const vector<Vec3> &vHalfSizes = static_cast<const Cubes &>( objects ).GetHalfSizes();
+    const int32_t       iLast      = static_cast<int32_t>( m_ObjectGridHeader.uCellsPerAxis ) - 1;
+
+    // Same bounds as ObjectCellBounds, grown a bit so the rounding of the GPU never counts a cell more
+    constexpr float fEpsilon = 1e-3f;
+
+    size_t uIds = 0;
+    for ( size_t i = 0; i < vPositions.size(); ++i )
+    {
+        const float halfSize[ 3 ] = { vHalfSizes[ i ].x, vHalfSizes[ i ].y, vHalfSizes[ i ].z };
+        const float position[ 3 ] = { vPositions[ i ].x, vPositions[ i ].y, vPositions[ i ].z };
+
+        // Slots of removed objects stay, their size is zero
+        if ( halfSize[ 0 ] == 0.f && halfSize[ 1 ] == 0.f && halfSize[ 2 ] == 0.f )
+            continue;
+
+        const float sx = sinf( vRotations[ i ].x );
+        const float cx = cosf( vRotations[ i ].x );
+        const float sy = sinf( vRotations[ i ].y );
+        const float cy = cosf( vRotations[ i ].y );
+        const float sz = sinf( vRotations[ i ].z );
+        const float cz = cosf( vRotations[ i ].z );
+
+        // Rows of RotationMatrix, rotX * rotY * rotZ
+        const float rotation[ 3 ][ 3 ] = {
+            { cy * cz, cy * sz, -sy },
+            { sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy },
+            { cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy },
+        };
+
+        int32_t lo[ 3 ];
+        int32_t hi[ 3 ];
+        bool    bInside = true;
+        for ( size_t a = 0; a < 3; ++a )
+        {
+            const float fExtent = fabsf( rotation[ 0 ][ a ] ) * halfSize[ 0 ] +
+                                  fabsf( rotation[ 1 ][ a ] ) * halfSize[ 1 ] +
+                                  fabsf( rotation[ 2 ][ a ] ) * halfSize[ 2 ] + fEpsilon;
+
+            lo[ a ]  = static_cast<int32_t>( floorf( position[ a ] - fExtent ) ) >> ObjectCellShift;
+            hi[ a ]  = static_cast<int32_t>( floorf( position[ a ] + fExtent ) ) >> ObjectCellShift;
+            bInside &= hi[ a ] >= 0 && lo[ a ] <= iLast;
+        }
+
+        if ( !bInside )
+            continue;
+
+        size_t uCells = 1;
+        for ( size_t a = 0; a < 3; ++a )
+            uCells *= ::std::clamp( hi[ a ], 0, iLast ) - ::std::clamp( lo[ a ], 0, iLast ) + 1;
+
+        uIds += uCells;
+    }
+
+    if ( uIds > MaxObjectIds && !m_bObjectIdsCut )
+        B33_ERROR( L"Objects overlap %zu cells of the object grid, lists past %u ids are cut", uIds, MaxObjectIds );
+
+    m_bObjectIdsCut = uIds > MaxObjectIds;
+
+    if ( m_ObjectIdsBuffer != nullptr && ::std::min<size_t>( uIds, MaxObjectIds ) <= m_ObjectGridHeader.uIdCapacity )
+        return;
+
+    // Grown with room to spare so objects that move don't replace it every frame. The other frame may still read the
+    // lists, the descriptor can't change under it
+    if ( m_ObjectIdsBuffer != nullptr )
+        vkDeviceWaitIdle( GetAdaterInternal()->GetAdapterHandle() );
+
+    m_ObjectGridHeader.uIdCapacity =
+        static_cast<uint32_t>( ::std::clamp<size_t>( uIds * 2, MinObjectIds, MaxObjectIds ) );
+
+    m_ObjectIdsBuffer = std::move(
+        GetMemoryInternal()->ReserveGPUBuffer( m_ObjectGridHeader.uIdCapacity * sizeof( uint32_t ) ) );
+    BindStorageBuffer( m_ObjectIdsBuffer, EShaderResource::ObjectIds );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::ReserveScreenBuffers()
+{
+    const size_t uWidth      = ::std::max<int32_t>( GetWindowDescInternal()->Width, 1 );
+    const size_t uHeight     = ::std::max<int32_t>( GetWindowDescInternal()->Height, 1 );
+    const size_t uTileCountX = ( uWidth + TileDim - 1 ) / TileDim;
+    const size_t uTileCountY = ( uHeight + TileDim - 1 ) / TileDim;
+    const size_t uTileBytes  = uTileCountX * uTileCountY * sizeof( float );
+
+    // Color and the history length as halfs, normal and distance, a uvec4 per pixel in each half
+    const size_t uHistoryBytes = 2 * uWidth * uHeight * 4 * sizeof( uint32_t );
+
+    // Heads of the queues and a packed pixel per pixel in each of them, every pixel has a hit record
+    const size_t uQueueBytes   = sizeof( WavefrontQueue ) + uWidth * uHeight * sizeof( uint32_t );
+    const size_t uQueuesBytes  = WavefrontQueueCount * uQueueBytes;
+    const size_t uRecordsBytes = uWidth * uHeight * WavefrontRecordSize;
+
+    if ( m_RenderImage == nullptr || m_RenderImage->GetExtent().width < uWidth ||
+         m_RenderImage->GetExtent().height < uHeight )
+    {
+        m_RenderImage = std::move( GetMemoryInternal()->ReserveGPUImage( static_cast<uint32_t>( uWidth ),
+                                                                         static_cast<uint32_t>( uHeight ),
+                                                                         VK_FORMAT_R8G8B8A8_UNORM ) );
+        BindStorageImage( m_RenderImage->GetViewHandle(), 0 );
+    }
+
+    if ( m_TileStartBuffer == nullptr || m_TileStartBuffer->GetSizeInBytes() < uTileBytes )
+    {
+        m_TileStartBuffer = std::move( GetMemoryInternal()->ReserveGPUBuffer( uTileBytes ) );
+        BindStorageBuffer( m_TileStartBuffer, EShaderResource::TileStart );
+    }
+
+    if ( m_HistoryBuffer == nullptr || m_HistoryBuffer->GetSizeInBytes() < uHistoryBytes )
+    {
+        m_HistoryBuffer = std::move( GetMemoryInternal()->ReserveGPUBuffer( uHistoryBytes ) );
+        BindStorageBuffer( m_HistoryBuffer, EShaderResource::History );
+    }
+
+    if ( m_WavefrontQueuesBuffer == nullptr || m_WavefrontQueuesBuffer->GetSizeInBytes() < uQueuesBytes )
+    {
+        m_WavefrontQueuesBuffer = std::move(
+            GetMemoryInternal()->ReserveGPUBuffer( uQueuesBytes, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT ) );
+        BindStorageBuffer( m_WavefrontQueuesBuffer, EShaderResource::WavefrontQueues );
+    }
+
+    if ( m_HitRecordsBuffer == nullptr || m_HitRecordsBuffer->GetSizeInBytes() < uRecordsBytes )
+    {
+        m_HitRecordsBuffer = std::move( GetMemoryInternal()->ReserveGPUBuffer( uRecordsBytes ) );
+        BindStorageBuffer( m_HitRecordsBuffer, EShaderResource::HitRecords );
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::BindStorageBuffer( const shared_ptr<GPUBuffer> &gpuBuffer, const EShaderResource &sr )
+{
+    VkDescriptorBufferInfo bufferInfo = {
+        .buffer = gpuBuffer->GetBufferHandle(),
+        .offset = 0,
+        .range  = VK_WHOLE_SIZE,
+    };
+
+    VkWriteDescriptorSet write = {
+        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet          = GetDescriptorSet(),
+        .dstBinding      = static_cast<uint32_t>( sr ),
+        .descriptorCount = 1,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pBufferInfo     = &bufferInfo,
+    };
+
+    vkUpdateDescriptorSets( GetAdaterInternal()->GetAdapterHandle(), 1, &write, 0, NULL );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::LoadImage( VkImage image )
+{
+    if ( m_ImageView != VK_NULL_HANDLE )
+    {
+        vkDestroyImageView( GetAdaterInternal()->GetAdapterHandle(), m_ImageView, nullptr );
+        m_ImageView = VK_NULL_HANDLE;
+    }
+
+    VkImageViewCreateInfo viewInfo = {
+        .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image    = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format   = Swapchain::TargetedFormat,
+        .subresourceRange {
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0,
+            .levelCount     = 1,
+            .baseArrayLayer = 0,
+            .layerCount     = 1,
+        },
+    };
+
+    THROW_IF_FAILED( vkCreateImageView( GetAdaterInternal()->GetAdapterHandle(), &viewInfo, NULL, &m_ImageView ) );
+
+    BindStorageImage( m_ImageView, EShaderResource::UpscaleTarget );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::BindStorageImage( VkImageView imageView, uint32_t uBinding )
+{
+    VkDescriptorImageInfo imageInfo = {
+        .imageView   = imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+    };
+
+    VkWriteDescriptorSet imageWrite = {
+        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet          = this->GetDescriptorSet(),
+        .dstBinding      = uBinding,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        .pImageInfo      = &imageInfo,
+    };
+
+    vkUpdateDescriptorSets( GetAdaterInternal()->GetAdapterHandle(), 1, &imageWrite, 0, NULL );
+}
+
+// Private // ----------------------------------------------------------------------------------------------------------
+VkDescriptorSetLayout VoxelPipeline::CreateDescriptorLayoutImpl()
+{
+    array<VkDescriptorSetLayoutBinding, 18> bindings = {};
+    VkDescriptorSetLayout                  descriptorSetLayout;
+
+    bindings[ 0 ] = {
+        .binding         = 0,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 1 ] = {
+        .binding         = VoxelPipeline::EShaderResource::VoxelGrid,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
         .descriptorCount = 1,
         .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
     };
@@ -359,6 +1231,97 @@ VkDescriptorSetLayout VoxelPipeline::CreateDescriptorLayoutImpl()
         .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
     };
 
+    bindings[ 5 ] = {
+        .binding         = VoxelPipeline::EShaderResource::ChunkTable,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 6 ] = {
+        .binding         = VoxelPipeline::EShaderResource::ChunkSlots,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 7 ] = {
+        .binding         = VoxelPipeline::EShaderResource::VoxelMips,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 8 ] = {
+        .binding         = VoxelPipeline::EShaderResource::TileStart,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 9 ] = {
+        .binding         = VoxelPipeline::EShaderResource::History,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 10 ] = {
+        .binding         = VoxelPipeline::EShaderResource::PreviousFrame,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 11 ] = {
+        .binding         = VoxelPipeline::EShaderResource::UpscaleTarget,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 12 ] = {
+        .binding         = VoxelPipeline::EShaderResource::LightCache,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 13 ] = {
+        .binding         = VoxelPipeline::EShaderResource::LightChanges,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 14 ] = {
+        .binding         = VoxelPipeline::EShaderResource::ObjectCells,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 15 ] = {
+        .binding         = VoxelPipeline::EShaderResource::ObjectIds,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 16 ] = {
+        .binding         = VoxelPipeline::EShaderResource::WavefrontQueues,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
+    bindings[ 17 ] = {
+        .binding         = VoxelPipeline::EShaderResource::HitRecords,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+
     VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {
         .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
         .bindingCount = static_cast<uint32_t>( bindings.size() ),
@@ -377,8 +1340,8 @@ VkDescriptorSetLayout VoxelPipeline::CreateDescriptorLayoutImpl()
 VkDescriptorPool VoxelPipeline::CreateDescriptorPoolImpl()
 {
     const vector<VkDescriptorPoolSize> poolSizes = {
-        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 },
-        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 },
+        { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2 },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 16 },
     };
 
     VkDescriptorPool descriptorPool;
@@ -480,15 +1443,370 @@ VkShaderModule VoxelPipeline::LoadShader( const string &strPath )
 // ---------------------------------------------------------------------------------------------------------------------
 VkPipeline VoxelPipeline::CreatePipelineImpl()
 {
-    const VkDevice device   = GetAdaterInternal()->GetAdapterHandle();
-    VkPipeline     pipeline = VK_NULL_HANDLE;
-    m_ShaderModule = LoadShader( ::B33::App::AppResources::Get().GetExecutablePathA() + "/Assets/Shaders/Raycast.spv" );
+    const string strShaders = ::B33::App::AppResources::Get().GetExecutablePathA() + "/Assets/Shaders/";
+
+    m_ShaderModule            = LoadShader( strShaders + "Raycast.spv" );
+    m_BeamShaderModule        = LoadShader( strShaders + "Beam.spv" );
+    m_UpscaleShaderModule     = LoadShader( strShaders + "Upscale.spv" );
+    m_LightCacheShaderModule  = LoadShader( strShaders + "LightCache.spv" );
+    m_ObjectCountShaderModule = LoadShader( strShaders + "ObjectCount.spv" );
+    m_ObjectScanShaderModule  = LoadShader( strShaders + "ObjectScan.spv" );
+    m_ObjectFillShaderModule  = LoadShader( strShaders + "ObjectFill.spv" );
+    m_PrimaryShaderModule     = LoadShader( strShaders + "WavefrontPrimary.spv" );
+    m_ShadowShaderModule      = LoadShader( strShaders + "WavefrontShadow.spv" );
+    m_ReflectionShaderModule  = LoadShader( strShaders + "WavefrontReflection.spv" );
+    m_ShadeShaderModule       = LoadShader( strShaders + "WavefrontShade.spv" );
+
+    // Light cache, object and beam passes run before the raycast and the upscale after it with the same layout, see
+    // RecordCommands
+    const VkShaderModule auxModules[] = {
+        m_BeamShaderModule,        m_UpscaleShaderModule,    m_LightCacheShaderModule,
+        m_ObjectCountShaderModule, m_ObjectScanShaderModule, m_ObjectFillShaderModule,
+    };
+    VkPipeline *const auxPipelines[] = {
+        &m_BeamPipeline,        &m_UpscalePipeline,    &m_LightCachePipeline,
+        &m_ObjectCountPipeline, &m_ObjectScanPipeline, &m_ObjectFillPipeline,
+    };
+
+    // Every preset with and without the debug view, so switching them never stalls a frame
+    vector<RaycastVariant> vVariants;
+    for ( ERenderQuality quality : { ERenderQuality::Low, ERenderQuality::Medium, ERenderQuality::High } )
+    {
+        vVariants.push_back( GetRaycastVariant( quality, false, m_bTileCache ) );
+        vVariants.push_back( GetRaycastVariant( quality, true, m_bTileCache ) );
+    }
+
+    m_BaseVariant = GetRaycastVariant( m_Quality, false, m_bTileCache );
+
+    // Passes of the wavefront mode are built only when it's on, SetWavefront builds them later otherwise
+    const size_t uFirstWavefront = m_bWavefront ? ReserveWavefrontVariants( vVariants ) : m_vWavefrontVariants.size();
+    const size_t uWavefrontCount = m_vWavefrontVariants.size() - uFirstWavefront;
+
+    // Pipelines are compiled on all cores, the cache is internally synchronized. Jobs can't throw, the results are
+    // checked once all of them are done
+    const size_t       uAuxCount = size( auxModules );
+    vector<VkPipeline> vRaycastPipelines( vVariants.size(), VK_NULL_HANDLE );
+    vector<VkResult>   vResults( uAuxCount + vVariants.size() + uWavefrontCount * 4, VK_SUCCESS );
+    Core::JobSystem    jobSystem;
+
+    for ( size_t i = 0; i < uAuxCount; ++i )
+    {
+        jobSystem.PushJob( [ &, i ]()
+                           { vResults[ i ] = CreateComputePipeline( auxModules[ i ], nullptr, *auxPipelines[ i ] ); } );
+    }
+
+    for ( size_t i = 0; i < vVariants.size(); ++i )
+    {
+        jobSystem.PushJob(
+            [ &, i ]()
+            {
+                vResults[ uAuxCount + i ] =
+                    CreateRaycastPipeline( m_ShaderModule, vVariants[ i ], vRaycastPipelines[ i ] );
+            } );
+    }
+
+    for ( size_t i = 0; i < uWavefrontCount; ++i )
+    {
+        PushWavefrontJobs( jobSystem,
+                           m_vWavefrontVariants[ uFirstWavefront + i ],
+                           &vResults[ uAuxCount + vVariants.size() + i * 4 ] );
+    }
+
+    jobSystem.BlockAndWait();
+
+    VkPipeline basePipeline = VK_NULL_HANDLE;
+    for ( size_t i = 0; i < vVariants.size(); ++i )
+    {
+        if ( vRaycastPipelines[ i ] == VK_NULL_HANDLE )
+            continue;
+
+        if ( vVariants[ i ] == m_BaseVariant )
+            basePipeline = vRaycastPipelines[ i ];
+        else
+            m_vRaycastVariants.emplace_back( vVariants[ i ], vRaycastPipelines[ i ] );
+    }
+
+    for ( const VkResult result : vResults )
+    {
+        if ( result != VK_SUCCESS && basePipeline != VK_NULL_HANDLE )
+            vkDestroyPipeline( GetAdaterInternal()->GetAdapterHandle(), basePipeline, NULL );
+
+        THROW_IF_FAILED( result );
+    }
+
+    return basePipeline;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+RaycastVariant VoxelPipeline::GetRaycastVariant( ERenderQuality quality, bool bDebugView, bool bTileCache )
+{
+    RaycastVariant variant = {};
+
+    // Group size has to stay 32x8, the HLSL raycast can't be specialized with it
+    switch ( quality )
+    {
+        case ERenderQuality::Low:
+            variant.iShadowSamples = 1;
+            variant.uBounces       = 0;
+            variant.fMaxRenderDist = 160.f;
+            variant.iMaxSteps      = 112;
+            break;
+        case ERenderQuality::Medium:
+            variant.iShadowSamples = 1;
+            variant.uBounces       = 1;
+            variant.fMaxRenderDist = 224.f;
+            variant.iMaxSteps      = 160;
+            break;
+        case ERenderQuality::High:
+            variant.iShadowSamples = 2;
+            variant.uBounces       = 2;
+            variant.fMaxRenderDist = 224.f;
+            variant.iMaxSteps      = 192;
+            break;
+    }
+
+    variant.uDebugView = bDebugView ? 1 : 0;
+
+    // Debug view hits other types of voxels too, the brick only knows the solid ones
+    variant.uTileCache = bTileCache && !bDebugView ? 1 : 0;
+
+    return variant;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+VkPipeline VoxelPipeline::GetRaycastPipeline( const RaycastVariant &variant )
+{
+    if ( variant == m_BaseVariant )
+        return GetPipelineHandle();
+
+    for ( const auto &cached : m_vRaycastVariants )
+    {
+        if ( cached.first == variant )
+            return cached.second;
+    }
+
+    B33_LOG( Core::Debug::Info, L"Creating a raycast variant" );
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    THROW_IF_FAILED( CreateRaycastPipeline( m_ShaderModule, variant, pipeline ) );
+
+    m_vRaycastVariants.emplace_back( variant, pipeline );
+
+    return pipeline;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+VkResult VoxelPipeline::CreateRaycastPipeline( VkShaderModule        shaderModule,
+                                               const RaycastVariant &variant,
+                                               VkPipeline           &pipeline )
+{
+    const VkSpecializationMapEntry entries[] = {
+        { 0, offsetof( RaycastVariant, uDebugView ), sizeof( uint32_t ) },
+        { 1, offsetof( RaycastVariant, iShadowSamples ), sizeof( int32_t ) },
+        { 2, offsetof( RaycastVariant, uBounces ), sizeof( uint32_t ) },
+        { 3, offsetof( RaycastVariant, fMaxRenderDist ), sizeof( float ) },
+        { 4, offsetof( RaycastVariant, iMaxSteps ), sizeof( int32_t ) },
+        { 5, offsetof( RaycastVariant, uGroupSizeX ), sizeof( uint32_t ) },
+        { 6, offsetof( RaycastVariant, uGroupSizeY ), sizeof( uint32_t ) },
+        { 7, offsetof( RaycastVariant, uTileCache ), sizeof( uint32_t ) },
+    };
+
+    const VkSpecializationInfo specialization = {
+        .mapEntryCount = static_cast<uint32_t>( size( entries ) ),
+        .pMapEntries   = entries,
+        .dataSize      = sizeof( RaycastVariant ),
+        .pData         = &variant,
+    };
+
+    return CreateComputePipeline( shaderModule, &specialization, pipeline );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::SetWavefront( bool bWavefront )
+{
+    m_bWavefront = bWavefront;
+
+    // Before CreatePipelineImpl the passes are built with the rest of the pipelines
+    if ( !m_bWavefront || m_PrimaryShaderModule == VK_NULL_HANDLE )
+        return;
+
+    vector<RaycastVariant> vVariants;
+    for ( ERenderQuality quality : { ERenderQuality::Low, ERenderQuality::Medium, ERenderQuality::High } )
+        vVariants.push_back( GetRaycastVariant( quality, false, m_bTileCache ) );
+
+    const size_t     uFirst = ReserveWavefrontVariants( vVariants );
+    vector<VkResult> vResults( ( m_vWavefrontVariants.size() - uFirst ) * 4, VK_SUCCESS );
+    Core::JobSystem  jobSystem;
+
+    for ( size_t i = uFirst; i < m_vWavefrontVariants.size(); ++i )
+        PushWavefrontJobs( jobSystem, m_vWavefrontVariants[ i ], &vResults[ ( i - uFirst ) * 4 ] );
+
+    jobSystem.BlockAndWait();
+
+    for ( const VkResult result : vResults )
+        THROW_IF_FAILED( result );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const WavefrontPipelines *VoxelPipeline::FindWavefrontPipelines( const RaycastVariant &variant ) const
+{
+    for ( const auto &cached : m_vWavefrontVariants )
+    {
+        if ( cached.first == variant )
+            return &cached.second;
+    }
+
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+size_t VoxelPipeline::ReserveWavefrontVariants( const vector<RaycastVariant> &vVariants )
+{
+    const size_t uFirst = m_vWavefrontVariants.size();
+
+    for ( const RaycastVariant &variant : vVariants )
+    {
+        if ( variant.uDebugView == 0 && FindWavefrontPipelines( variant ) == nullptr )
+            m_vWavefrontVariants.emplace_back( variant, WavefrontPipelines() );
+    }
+
+    return uFirst;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::PushWavefrontJobs( Core::JobSystem &jobSystem, WavefrontVariant &variant, VkResult *pResults )
+{
+    // Entries stay in the vector when a pass fails, the destructor frees the ones that were created
+    const pair<VkShaderModule, VkPipeline *> passes[] = {
+        { m_PrimaryShaderModule, &variant.second.Primary },
+        { m_ShadowShaderModule, &variant.second.Shadow },
+        { m_ReflectionShaderModule, &variant.second.Reflection },
+        { m_ShadeShaderModule, &variant.second.Shade },
+    };
+
+    for ( size_t i = 0; i < size( passes ); ++i )
+    {
+        jobSystem.PushJob(
+            [ this, &variant, pResults, i, pass = passes[ i ] ]()
+            { pResults[ i ] = CreateRaycastPipeline( pass.first, variant.first, *pass.second ); } );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoxelPipeline::RecordWavefront( VkCommandBuffer           cmdBuffer,
+                                     const WavefrontPipelines &pipelines,
+                                     uint32_t                  uGroupCountX,
+                                     uint32_t                  uGroupCountY )
+{
+    const array<WavefrontQueue, WavefrontQueueCount> queues = {};
+
+    // Previous frame may still dispatch from the queues or read the records
+    VkBufferMemoryBarrier queuesBarrier = {
+        .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer              = m_WavefrontQueuesBuffer->GetBufferHandle(),
+        .offset              = 0,
+        .size                = VK_WHOLE_SIZE,
+    };
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          0,
+                          0,
+                          NULL,
+                          1,
+                          &queuesBarrier,
+                          0,
+                          NULL );
+
+    vkCmdUpdateBuffer( cmdBuffer,
+                       m_WavefrontQueuesBuffer->GetBufferHandle(),
+                       0,
+                       sizeof( queues ),
+                       queues.data() );
+
+    VkBufferMemoryBarrier wavefrontBarriers[ 2 ] = { queuesBarrier, queuesBarrier };
+
+    wavefrontBarriers[ 0 ].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    wavefrontBarriers[ 0 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    wavefrontBarriers[ 1 ].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    wavefrontBarriers[ 1 ].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    wavefrontBarriers[ 1 ].buffer        = m_HitRecordsBuffer->GetBufferHandle();
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          0,
+                          0,
+                          NULL,
+                          2,
+                          wavefrontBarriers,
+                          0,
+                          NULL );
+
+    // Primary pass, a thread per pixel like the raycast, pixels that see the sky are done after it
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.Primary );
+    vkCmdDispatch( cmdBuffer, uGroupCountX, uGroupCountY, 1 );
+
+    wavefrontBarriers[ 0 ].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    wavefrontBarriers[ 0 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    wavefrontBarriers[ 1 ].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    wavefrontBarriers[ 1 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                          0,
+                          0,
+                          NULL,
+                          2,
+                          wavefrontBarriers,
+                          0,
+                          NULL );
+
+    // Shadow and reflection passes write different members of the records, they don't need a barrier between them
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.Shadow );
+    vkCmdDispatchIndirect( cmdBuffer, m_WavefrontQueuesBuffer->GetBufferHandle(), 0 * sizeof( WavefrontQueue ) );
+
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.Reflection );
+    vkCmdDispatchIndirect( cmdBuffer, m_WavefrontQueuesBuffer->GetBufferHandle(), 1 * sizeof( WavefrontQueue ) );
+
+    wavefrontBarriers[ 1 ].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          0,
+                          0,
+                          NULL,
+                          1,
+                          &wavefrontBarriers[ 1 ],
+                          0,
+                          NULL );
+
+    // Shade pass writes the image, the barrier after the raycast covers it too
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.Shade );
+    vkCmdDispatchIndirect( cmdBuffer, m_WavefrontQueuesBuffer->GetBufferHandle(), 2 * sizeof( WavefrontQueue ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+VkResult VoxelPipeline::CreateComputePipeline( VkShaderModule              shaderModule,
+                                               const VkSpecializationInfo *pSpecialization,
+                                               VkPipeline                 &pipeline )
+{
+    const VkDevice        device        = GetAdaterInternal()->GetAdapterHandle();
+    const VkPipelineCache pipelineCache = GetPipelineCacheInternal();
 
     VkPipelineShaderStageCreateInfo shaderStage = {
-        .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
-        .module = m_ShaderModule,
-        .pName  = "main",
+        .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .stage               = VK_SHADER_STAGE_COMPUTE_BIT,
+        .module              = shaderModule,
+        .pName               = "main",
+        .pSpecializationInfo = pSpecialization,
     };
 
     VkComputePipelineCreateInfo pipelineInfo = {
@@ -497,9 +1815,7 @@ VkPipeline VoxelPipeline::CreatePipelineImpl()
         .layout = this->GetLayoutHandle(),
     };
 
-    THROW_IF_FAILED( vkCreateComputePipelines( device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pipeline ) );
-
-    return pipeline;
+    return vkCreateComputePipelines( device, pipelineCache, 1, &pipelineInfo, NULL, &pipeline );
 }
 
 } // namespace B33::Rendering
@@ -0,0 +1,502 @@
+#include "B33Rendering.hpp"
+
+#include "Raycaster/WorldFile.hpp"
+
+namespace B33::Rendering
+{
+
+using namespace ::std;
+using namespace ::B33::Math;
+using namespace ::B33::Core;
+using namespace ::B33::Core::Debug;
+
+static constexpr char     WorldMagic[ 4 ] = { 'B', '3', '3', 'W' };
+static constexpr uint32_t WorldVersion    = 1;
+
+enum EChunkEncoding : uint16_t
+{
+    ChunkUniform   = 0,
+    ChunkRuns      = 1,
+    ChunkIndices8  = 2,
+    ChunkIndices16 = 3,
+};
+
+// Header, WorldFile::ChunkRecord[ uChunkCount ], chunk data, WorldFile::ObjectRecord[ uObjectCount ]
+struct WorldFileHeader
+{
+    char     Magic[ 4 ];
+    uint32_t uVersion;
+    uint32_t uGridDim;
+    uint32_t uChunkDim;
+    uint32_t uChunkCount;
+    uint32_t uObjectCount;
+    uint64_t uChunkDataSize;
+};
+
+struct ChunkRun
+{
+    uint16_t uLength;
+    uint16_t uCell;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+static void ParallelFor( JobSystem &jobSystem, size_t uCount, const function<void( size_t )> &fn )
+{
+    const size_t uJobs = min( jobSystem.GetProcessorCount(), uCount );
+
+    for ( size_t uJob = 0; uJob < uJobs; ++uJob )
+    {
+        jobSystem.PushJob(
+            [ &fn, uJob, uJobs, uCount ]()
+            {
+                for ( size_t i = uJob; i < uCount; i += uJobs )
+                    fn( i );
+            } );
+    }
+
+    jobSystem.BlockAndWait();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static iVec3 CalcChunkOrigin( size_t uChunk, uint32_t uGridDim )
+{
+    const size_t uPerAxis = ( uGridDim + WorldFile::ChunkDim - 1 ) / WorldFile::ChunkDim;
+
+    return iVec3( static_cast<int32_t>( uChunk % uPerAxis * WorldFile::ChunkDim ),
+                  static_cast<int32_t>( uChunk / uPerAxis % uPerAxis * WorldFile::ChunkDim ),
+                  static_cast<int32_t>( uChunk / ( uPerAxis * uPerAxis ) * WorldFile::ChunkDim ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static iVec3 CalcChunkExtent( const iVec3 &origin, uint32_t uGridDim )
+{
+    const int32_t iDim = static_cast<int32_t>( uGridDim );
+    const int32_t iMax = static_cast<int32_t>( WorldFile::ChunkDim );
+
+    return iVec3( min( iMax, iDim - origin.x ), min( iMax, iDim - origin.y ), min( iMax, iDim - origin.z ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static void EncodeChunk( const vector<Voxel>   &grid,
+                         uint32_t               uGridDim,
+                         size_t                 uChunk,
+                         WorldFile::ChunkRecord &record,
+                         vector<uint8_t>        &vOut )
+{
+    const iVec3 origin = CalcChunkOrigin( uChunk, uGridDim );
+    const iVec3 extent = CalcChunkExtent( origin, uGridDim );
+
+    vector<uint32_t>                  vPalette = { 0 };
+    unordered_map<uint32_t, uint16_t> paletteIndices;
+    vector<uint16_t>                  vCells;
+    vector<ChunkRun>                  vRuns;
+
+    vCells.reserve( static_cast<size_t>( extent.x ) * extent.y * extent.z );
+
+    for ( int32_t z = 0; z < extent.z; ++z )
+    {
+        for ( int32_t y = 0; y < extent.y; ++y )
+        {
+            const size_t uRow = origin.x + ( origin.y + y ) * static_cast<size_t>( uGridDim ) +
+                                ( origin.z + z ) * static_cast<size_t>( uGridDim ) * uGridDim;
+
+            for ( int32_t x = 0; x < extent.x; ++x )
+            {
+                const Voxel &voxel = grid[ uRow + x ];
+                uint16_t     uCell = 0;
+
+                // Cells referencing objects are rebuilt from the object table
+                if ( voxel.Type == Voxel::FullSolid )
+                {
+                    auto [ it, bInserted ] =
+                        paletteIndices.try_emplace( voxel.Color, static_cast<uint16_t>( vPalette.size() ) );
+                    if ( bInserted )
+                        vPalette.push_back( voxel.Color );
+
+                    uCell = it->second;
+                }
+
+                if ( !vRuns.empty() && vRuns.back().uCell == uCell )
+                    ++vRuns.back().uLength;
+                else
+                    vRuns.push_back( ChunkRun { 1, uCell } );
+
+                vCells.push_back( uCell );
+            }
+        }
+    }
+
+    const size_t uIndexSize  = vPalette.size() <= 256 ? 1 : 2;
+    const size_t uRunBytes   = vRuns.size() * sizeof( ChunkRun );
+    const size_t uIndexBytes = vCells.size() * uIndexSize;
+
+    record.uPaletteSize = static_cast<uint16_t>( vPalette.size() - 1 );
+    vOut.assign( reinterpret_cast<const uint8_t *>( vPalette.data() + 1 ),
+                 reinterpret_cast<const uint8_t *>( vPalette.data() + vPalette.size() ) );
+
+    if ( vRuns.size() == 1 )
+    {
+        record.uEncoding = ChunkUniform;
+        vOut.insert( vOut.end(),
+                     reinterpret_cast<const uint8_t *>( &vRuns[ 0 ].uCell ),
+                     reinterpret_cast<const uint8_t *>( &vRuns[ 0 ].uCell + 1 ) );
+    }
+    else if ( uRunBytes <= uIndexBytes )
+    {
+        record.uEncoding = ChunkRuns;
+        vOut.insert( vOut.end(),
+                     reinterpret_cast<const uint8_t *>( vRuns.data() ),
+                     reinterpret_cast<const uint8_t *>( vRuns.data() + vRuns.size() ) );
+    }
+    else if ( uIndexSize == 1 )
+    {
+        record.uEncoding = ChunkIndices8;
+        for ( const uint16_t uCell : vCells )
+            vOut.push_back( static_cast<uint8_t>( uCell ) );
+    }
+    else
+    {
+        record.uEncoding = ChunkIndices16;
+        vOut.insert( vOut.end(),
+                     reinterpret_cast<const uint8_t *>( vCells.data() ),
+                     reinterpret_cast<const uint8_t *>( vCells.data() + vCells.size() ) );
+    }
+
+    record.uSize = static_cast<uint32_t>( vOut.size() );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static bool DecodeChunk( const WorldFile::ChunkRecord &record, const uint8_t *pData, WorldChunk &chunk )
+{
+    const size_t uCells        = static_cast<size_t>( chunk.Extent.x ) * chunk.Extent.y * chunk.Extent.z;
+    const size_t uPaletteBytes = record.uPaletteSize * sizeof( uint32_t );
+
+    if ( record.uSize < uPaletteBytes )
+        return false;
+
+    chunk.vPalette.resize( record.uPaletteSize + 1 );
+    chunk.vPalette[ 0 ] = 0;
+    memcpy( chunk.vPalette.data() + 1, pData, uPaletteBytes );
+
+    const uint8_t *pPayload      = pData + uPaletteBytes;
+    const size_t   uPayloadBytes = record.uSize - uPaletteBytes;
+
+    chunk.vCells.resize( uCells );
+
+    switch ( record.uEncoding )
+    {
+        case ChunkUniform:
+        {
+            uint16_t uCell = 0;
+            if ( uPayloadBytes != sizeof( uCell ) )
+                return false;
+
+            memcpy( &uCell, pPayload, sizeof( uCell ) );
+            fill( chunk.vCells.begin(), chunk.vCells.end(), uCell );
+            break;
+        }
+        case ChunkRuns:
+        {
+            if ( uPayloadBytes % sizeof( ChunkRun ) != 0 )
+                return false;
+
+            size_t uWritten = 0;
+            for ( size_t uByte = 0; uByte < uPayloadBytes; uByte += sizeof( ChunkRun ) )
+            {
+                ChunkRun run;
+                memcpy( &run, pPayload + uByte, sizeof( run ) );
+
+                if ( uWritten + run.uLength > uCells )
+                    return false;
+
+                fill_n( chunk.vCells.begin() + uWritten, run.uLength, run.uCell );
+                uWritten += run.uLength;
+            }
+
+            if ( uWritten != uCells )
+                return false;
+            break;
+        }
+        case ChunkIndices8:
+        {
+            if ( uPayloadBytes != uCells )
+                return false;
+
+            copy( pPayload, pPayload + uCells, chunk.vCells.begin() );
+            break;
+        }
+        case ChunkIndices16:
+        {
+            if ( uPayloadBytes != uCells * sizeof( uint16_t ) )
+                return false;
+
+            memcpy( chunk.vCells.data(), pPayload, uPayloadBytes );
+            break;
+        }
+        default:
+            return false;
+    }
+
+    for ( const uint16_t uCell : chunk.vCells )
+    {
+        if ( uCell >= chunk.vPalette.size() )
+            return false;
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorldFile::WorldFile()
+  : m_uGridDim( 0 )
+  , m_vChunks()
+  , m_vChunkData()
+  , m_vObjects()
+  , m_pDecoded()
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+WorldFile::~WorldFile()
+{
+    Close();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool WorldFile::Save( const filesystem::path &path, const CubeWorld &world, JobSystem &jobSystem )
+{
+    const uint32_t uGridDim    = static_cast<uint32_t>( world.GetGridWidth() );
+    const size_t   uPerAxis    = ( uGridDim + ChunkDim - 1 ) / ChunkDim;
+    const size_t   uChunkCount = uPerAxis * uPerAxis * uPerAxis;
+
+    vector<ChunkRecord>     vRecords( uChunkCount );
+    vector<vector<uint8_t>> vEncoded( uChunkCount );
+
+    ParallelFor( jobSystem,
+                 uChunkCount,
+                 [ & ]( size_t uChunk )
+                 {
+                     EncodeChunk( world.GetGrid(), uGridDim, uChunk, vRecords[ uChunk ], vEncoded[ uChunk ] );
+                 } );
+
+    uint64_t uChunkDataSize = 0;
+    for ( auto &record : vRecords )
+    {
+        record.uOffset  = uChunkDataSize;
+        uChunkDataSize += record.uSize;
+    }
+
+    const ColoredCubes  &objects = world.GetObjects();
+    vector<ObjectRecord> vObjects( objects.GetPositions().size() );
+    for ( size_t i = 0; i < vObjects.size(); ++i )
+    {
+        const Vec3 &pos      = objects.GetPosition( i );
+        const Rot3 &rot      = objects.GetRotation( i );
+        const Vec3  halfSize = objects.GetHalfSize( i );
+
+        vObjects[ i ] = ObjectRecord { { pos.x, pos.y, pos.z },
+                                       { rot.x, rot.y, rot.z },
+                                       { halfSize.x, halfSize.y, halfSize.z },
+                                       objects.GetColor( i ) };
+    }
+
+    ofstream file( path, ios::binary | ios::trunc );
+    if ( !file.is_open() )
+    {
+        B33_LOG( Error, L"Couldn't create the world file. [Path: %ls]", path.wstring().c_str() );
+        return false;
+    }
+
+    WorldFileHeader header = {};
+    memcpy( header.Magic, WorldMagic, sizeof( header.Magic ) );
+    header.uVersion       = WorldVersion;
+    header.uGridDim       = uGridDim;
+    header.uChunkDim      = ChunkDim;
+    header.uChunkCount    = static_cast<uint32_t>( uChunkCount );
+    header.uObjectCount   = static_cast<uint32_t>( vObjects.size() );
+    header.uChunkDataSize = uChunkDataSize;
+
+    file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    file.write( reinterpret_cast<const char *>( vRecords.data() ), sizeof( ChunkRecord ) * vRecords.size() );
+    for ( const auto &vChunk : vEncoded )
+        file.write( reinterpret_cast<const char *>( vChunk.data() ), vChunk.size() );
+    file.write( reinterpret_cast<const char *>( vObjects.data() ), sizeof( ObjectRecord ) * vObjects.size() );
+
+    if ( !file )
+    {
+        B33_LOG( Error, L"Couldn't write the world file. [Path: %ls]", path.wstring().c_str() );
+        return false;
+    }
+
+    B33_LOG( Info,
+             L"World saved. [Path: %ls] [Chunks: %zu] [Objects: %zu] [ChunkBytes: %llu]",
+             path.wstring().c_str(),
+             uChunkCount,
+             vObjects.size(),
+             static_cast<unsigned long long>( uChunkDataSize ) );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool WorldFile::Open( const filesystem::path &path )
+{
+    Close();
+
+    ifstream file( path, ios::binary );
+    if ( !file.is_open() )
+    {
+        B33_LOG( Error, L"Couldn't open the world file. [Path: %ls]", path.wstring().c_str() );
+        return false;
+    }
+
+    WorldFileHeader header = {};
+    file.read( reinterpret_cast<char *>( &header ), sizeof( header ) );
+
+    const size_t uPerAxis = ( header.uGridDim + ChunkDim - 1 ) / ChunkDim;
+    if ( !file || memcmp( header.Magic, WorldMagic, sizeof( header.Magic ) ) != 0 ||
+         header.uVersion != WorldVersion || header.uChunkDim != ChunkDim || header.uGridDim == 0 ||
+         header.uChunkCount != uPerAxis * uPerAxis * uPerAxis )
+    {
+        B33_LOG( Error, L"File isn't a compatible world file. [Path: %ls]", path.wstring().c_str() );
+        return false;
+    }
+
+    m_vChunks.resize( header.uChunkCount );
+    m_vChunkData.resize( header.uChunkDataSize );
+    m_vObjects.resize( header.uObjectCount );
+
+    // Three reads, chunks aren't touched until they're accessed
+    file.read( reinterpret_cast<char *>( m_vChunks.data() ), sizeof( ChunkRecord ) * m_vChunks.size() );
+    file.read( reinterpret_cast<char *>( m_vChunkData.data() ), m_vChunkData.size() );
+    file.read( reinterpret_cast<char *>( m_vObjects.data() ), sizeof( ObjectRecord ) * m_vObjects.size() );
+
+    bool bValid = static_cast<bool>( file );
+    for ( size_t i = 0; bValid && i < m_vChunks.size(); ++i )
+        bValid = m_vChunks[ i ].uOffset + m_vChunks[ i ].uSize <= m_vChunkData.size();
+
+    if ( !bValid )
+    {
+        B33_LOG( Error, L"World file is truncated. [Path: %ls]", path.wstring().c_str() );
+        Close();
+        return false;
+    }
+
+    m_uGridDim = header.uGridDim;
+    m_pDecoded = make_unique<LazyChunk[]>( m_vChunks.size() );
+
+    B33_LOG( Info,
+             L"World file opened. [Path: %ls] [GridWidth: %u] [Chunks: %zu] [Objects: %zu]",
+             path.wstring().c_str(),
+             m_uGridDim,
+             m_vChunks.size(),
+             m_vObjects.size() );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void WorldFile::Close()
+{
+    m_uGridDim = 0;
+    m_vChunks.clear();
+    m_vChunkData.clear();
+    m_vObjects.clear();
+    m_pDecoded.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool WorldFile::Load( CubeWorld &world, JobSystem &jobSystem )
+{
+    B33_ASSERT( IsOpen() );
+    B33_ASSERT( world.GetStoredObjects().GetPositions().empty() );
+
+    if ( world.GetGridWidth() != m_uGridDim )
+    {
+        B33_LOG( Error,
+                 L"World file doesn't match the grid. [FileWidth: %u] [GridWidth: %zu]",
+                 m_uGridDim,
+                 world.GetGridWidth() );
+        return false;
+    }
+
+    vector<Voxel> &grid   = world.GetGrid();
+    atomic_bool    bValid = true;
+
+    ParallelFor( jobSystem,
+                 m_vChunks.size(),
+                 [ & ]( size_t uChunk )
+                 {
+                     const WorldChunk *pChunk = GetChunk( uChunk );
+                     if ( pChunk == nullptr )
+                     {
+                         bValid.store( false );
+                         return;
+                     }
+
+                     // Chunks don't overlap, every job writes its own cells
+                     size_t uCell = 0;
+                     for ( int32_t z = 0; z < pChunk->Extent.z; ++z )
+                     {
+                         for ( int32_t y = 0; y < pChunk->Extent.y; ++y )
+                         {
+                             const size_t uRow = pChunk->Origin.x +
+                                                 ( pChunk->Origin.y + y ) * static_cast<size_t>( m_uGridDim ) +
+                                                 ( pChunk->Origin.z + z ) * static_cast<size_t>( m_uGridDim ) *
+                                                     m_uGridDim;
+
+                             for ( int32_t x = 0; x < pChunk->Extent.x; ++x, ++uCell )
+                             {
+                                 const uint16_t uValue = pChunk->vCells[ uCell ];
+                                 Voxel         &voxel  = grid[ uRow + x ];
+
+                                 voxel.Type  = uValue != 0 ? Voxel::FullSolid : 0;
+                                 voxel.Color = pChunk->vPalette[ uValue ];
+                             }
+                         }
+                     }
+                 } );
+
+    if ( !bValid.load() )
+    {
+        B33_LOG( Error, L"World file has corrupted chunks." );
+        return false;
+    }
+
+    for ( const auto &object : m_vObjects )
+    {
+        const Vec3 pos( object.Position[ 0 ], object.Position[ 1 ], object.Position[ 2 ] );
+        const Rot3 rot( object.Rotation[ 0 ], object.Rotation[ 1 ], object.Rotation[ 2 ] );
+        const Vec3 halfSize( object.HalfSize[ 0 ], object.HalfSize[ 1 ], object.HalfSize[ 2 ] );
+
+        const size_t uId = world.RestoreObject( pos, rot, halfSize );
+
+        world.GetObjects().SetColorAndAlpha( object.uColor, uId );
+    }
+
+    const int32_t iLast = static_cast<int32_t>( m_uGridDim ) - 1;
+
+    world.MarkCellsChanged( iVec3( 0, 0, 0 ), iVec3( iLast, iLast, iLast ) );
+    world.ForceUpload();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const WorldChunk *WorldFile::GetChunk( size_t uChunk )
+{
+    B33_ASSERT( uChunk < m_vChunks.size() );
+
+    LazyChunk &lazy = m_pDecoded[ uChunk ];
+
+    call_once( lazy.Once,
+               [ & ]()
+               {
+                   const ChunkRecord &record = m_vChunks[ uChunk ];
+
+                   lazy.Chunk.Origin = CalcChunkOrigin( uChunk, m_uGridDim );
+                   lazy.Chunk.Extent = CalcChunkExtent( lazy.Chunk.Origin, m_uGridDim );
+                   lazy.bValid       = DecodeChunk( record, m_vChunkData.data() + record.uOffset, lazy.Chunk );
+               } );
+
+    return lazy.bValid ? &lazy.Chunk : nullptr;
+}
+
+} // namespace B33::Rendering
@@ -55,7 +55,7 @@ shared_ptr<GPUStreamBuffer> Memory::ReserveStagingBuffer( const size_t uSizeInBy
 }
 
 // --------------------------------------------------------------------------------------------------------------------
-shared_ptr<GPUBuffer> Memory::ReserveGPUBuffer( const size_t uSizeInBytes )
+shared_ptr<GPUBuffer> Memory::ReserveGPUBuffer( const size_t uSizeInBytes, const VkBufferUsageFlags usage )
 {
     B33_LOG( Info, L"Reserving gpu buffer of %llu bytes", uSizeInBytes );
 
@@ -67,7 +67,7 @@ shared_ptr<GPUBuffer> Memory::ReserveGPUBuffer( const size_t uSizeInBytes )
     VkBufferCreateInfo bufferInfo = {
         .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .size        = uSizeInBytes,
-        .usage       = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .usage       = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
     };
 
@@ -87,12 +87,78 @@ shared_ptr<GPUBuffer> Memory::ReserveGPUBuffer( const size_t uSizeInBytes )
     return make_shared<GPUBuffer>( m_pAdapter, deviceMem, buffer, uSizeInBytes );
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+shared_ptr<GPUImage> Memory::ReserveGPUImage( const uint32_t uWidth, const uint32_t uHeight, const VkFormat format )
+{
+    B33_LOG( Info, L"Reserving gpu image of %ux%u", uWidth, uHeight );
+
+    const VkDevice       da = m_pAdapter->GetAdapterHandle();
+    VkMemoryRequirements memRequirements;
+    VkImage              image;
+    VkImageView          imageView;
+    VkDeviceMemory       deviceMem;
+
+    VkImageCreateInfo imageInfo = {
+        .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType     = VK_IMAGE_TYPE_2D,
+        .format        = format,
+        .extent        = { uWidth, uHeight, 1 },
+        .mipLevels     = 1,
+        .arrayLayers   = 1,
+        .samples       = VK_SAMPLE_COUNT_1_BIT,
+        .tiling        = VK_IMAGE_TILING_OPTIMAL,
+        .usage         = VK_IMAGE_USAGE_STORAGE_BIT,
+        .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    THROW_IF_FAILED( vkCreateImage( da, &imageInfo, NULL, &image ) );
+
+    vkGetImageMemoryRequirements( da, image, &memRequirements );
+
+    VkMemoryAllocateInfo allocInfo = {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize  = memRequirements.size,
+        .memoryTypeIndex = FindMemoryType( memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT ),
+    };
+
+    THROW_IF_FAILED( vkAllocateMemory( da, &allocInfo, NULL, &deviceMem ) );
+    THROW_IF_FAILED( vkBindImageMemory( da, image, deviceMem, 0 ) );
+
+    VkImageViewCreateInfo viewInfo = {
+        .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image    = image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format   = format,
+        .subresourceRange {
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = 0,
+            .levelCount     = 1,
+            .baseArrayLayer = 0,
+            .layerCount     = 1,
+        },
+    };
+
+    THROW_IF_FAILED( vkCreateImageView( da, &viewInfo, NULL, &imageView ) );
+
+    return make_shared<GPUImage>( m_pAdapter, deviceMem, image, imageView, VkExtent2D { uWidth, uHeight }, format );
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 void Memory::UploadOnStreamBuffer( const void *pUpload, const size_t uUploadSize, const UploadDescriptor &onSet )
+{
+    UploadOnStreamBuffer( pUpload, uUploadSize, 0, onSet );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void Memory::UploadOnStreamBuffer( const void             *pUpload,
+                                   const size_t            uUploadSize,
+                                   const size_t            uOffset,
+                                   const UploadDescriptor &onSet )
 {
     B33_ASSERT( onSet.Buffer->GetMemoryHandle() != VK_NULL_HANDLE );
     B33_ASSERT( onSet.Buffer->GetBufferHandle() != VK_NULL_HANDLE );
-    B33_ASSERT( onSet.Buffer->GetSizeInBytes() >= uUploadSize );
+    B33_ASSERT( onSet.Buffer->GetSizeInBytes() >= uOffset + uUploadSize );
 
     if ( onSet.Type != UploadDescriptor::EUploadType::StreamBuffer )
     {
@@ -113,7 +179,7 @@ void Memory::UploadOnStreamBuffer( const void *pUpload, const size_t uUploadSize
                                       0,
                                       buffer->GetPtrToDataPointer() ) );
     }
-    memcpy( buffer->GetDataPointer(), pUpload, uUploadSize );
+    memcpy( static_cast<uint8_t *>( buffer->GetDataPointer() ) + uOffset, pUpload, uUploadSize );
     if ( updateDescSets )
     {
         vkUpdateDescriptorSets( da, 1, &onSet.Write, 0, NULL );
@@ -16,6 +16,22 @@ namespace B33::Rendering
 using namespace ::std;
 using namespace ::B33::Math;
 
+static constexpr char     PipelineCacheMagic[ 4 ] = { 'B', '3', '3', 'P' };
+static constexpr uint32_t PipelineCacheVersion    = 1;
+
+// Header, then uDataSize bytes of vkGetPipelineCacheData. The driver checks its own header too, this one also catches
+// driver updates that keep the cache UUID
+struct PipelineCacheFileHeader
+{
+    char     Magic[ 4 ];
+    uint32_t uVersion;
+    uint32_t uVendorId;
+    uint32_t uDeviceId;
+    uint32_t uDriverVersion;
+    uint8_t  CacheUuid[ VK_UUID_SIZE ];
+    uint64_t uDataSize;
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Renderer::Initialize( shared_ptr<const WindowDesc> wd )
 {
@@ -36,6 +52,8 @@ void Renderer::Initialize( shared_ptr<const WindowDesc> wd )
     m_CommandPool = CreateCommandPool( static_pointer_cast<AdapterWrapper>( m_pDeviceAdapter ),
                                        m_pDeviceAdapter->GetQueueFamilyIndex() );
 
+    m_TimestampPool = CreateTimestampPool();
+    m_PipelineCache = CreatePipelineCache();
 
     // Recreating swap chain also creates frame resources and initializes swap chain
     RecreateSwapChain();
@@ -93,7 +111,14 @@ void Renderer::Render()
     THROW_IF_FAILED( vkWaitForFences( device, 1, &frame.InFlightFence, VK_TRUE, UINT64_MAX ) );
     THROW_IF_FAILED( vkResetFences( device, 1, &frame.InFlightFence ) );
 
+    UpdateRenderScale( frame );
+    for ( auto &pipeline : m_vPipeline )
+    {
+        pipeline->SetRenderScale( m_fRenderScale );
+    }
+
     RecordCommands( frame.CommandBuffer );
+    frame.bTimestampsWritten = m_TimestampPool != VK_NULL_HANDLE;
 
     VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
@@ -120,6 +145,11 @@ void Renderer::Render()
     };
 
     m_LastResultState = vkQueuePresentKHR( m_pDeviceAdapter->GetQueueHandle(), &presentInfo );
+
+    // Pacing is measured between frames that were shown, a failed present keeps the previous time
+    if ( m_LastResultState == VK_SUCCESS )
+        m_LastPresentTime = ::std::chrono::steady_clock::now();
+
     if ( m_LastResultState == VK_SUBOPTIMAL_KHR || m_LastResultState == VK_ERROR_OUT_OF_DATE_KHR )
     {
         B33_ERROR( L"On render, after present got %d", m_LastResultState );
@@ -147,7 +177,21 @@ void Renderer::Destroy()
         m_CommandPool = VK_NULL_HANDLE;
     }
 
+    if ( m_TimestampPool != VK_NULL_HANDLE )
+    {
+        vkDestroyQueryPool( m_pDeviceAdapter->GetAdapterHandle(), m_TimestampPool, nullptr );
+        m_TimestampPool = VK_NULL_HANDLE;
+    }
+
     m_vPipeline.clear();
+
+    if ( m_PipelineCache != VK_NULL_HANDLE )
+    {
+        SavePipelineCache();
+        vkDestroyPipelineCache( m_pDeviceAdapter->GetAdapterHandle(), m_PipelineCache, nullptr );
+        m_PipelineCache = VK_NULL_HANDLE;
+    }
+
     m_pSwapChain     = nullptr;
     m_pMemory        = nullptr;
     m_pDeviceAdapter = nullptr;
@@ -240,6 +284,13 @@ void Renderer::RecordCommands( VkCommandBuffer &cmdBuff )
 
     THROW_IF_FAILED( vkBeginCommandBuffer( cmdBuff, &beginInfo ) );
 
+    const uint32_t uFirstQuery = static_cast<uint32_t>( m_uCurrentFrame * 2 );
+    if ( m_TimestampPool != VK_NULL_HANDLE )
+    {
+        vkCmdResetQueryPool( cmdBuff, m_TimestampPool, uFirstQuery, 2 );
+        vkCmdWriteTimestamp( cmdBuff, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampPool, uFirstQuery );
+    }
+
     VkPipelineStageFlagBits lastStage     = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
     VkImageLayout           lastImgLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     VkImageLayout           newImgLayout  = VK_IMAGE_LAYOUT_GENERAL;
@@ -314,9 +365,187 @@ void Renderer::RecordCommands( VkCommandBuffer &cmdBuff )
                           1,
                           &presentBarrier );
 
+    if ( m_TimestampPool != VK_NULL_HANDLE )
+        vkCmdWriteTimestamp( cmdBuff, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampPool, uFirstQuery + 1 );
+
     THROW_IF_FAILED( vkEndCommandBuffer( cmdBuff ) );
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+VkQueryPool Renderer::CreateTimestampPool()
+{
+    VkPhysicalDeviceProperties properties;
+    VkQueryPool                queryPool;
+
+    vkGetPhysicalDeviceProperties( m_pHardware->GetPhysicalDevice(), &properties );
+
+    if ( !properties.limits.timestampComputeAndGraphics || properties.limits.timestampPeriod <= 0.f )
+    {
+        B33_WARNING( L"Device has no timestamps, rendering always at the full resolution" );
+        return VK_NULL_HANDLE;
+    }
+
+    m_fTimestampPeriod = properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolInfo = {
+        .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = static_cast<uint32_t>( Frame::MAX_FRAMES_IN_FLIGHT * 2 ),
+    };
+
+    THROW_IF_FAILED( vkCreateQueryPool( m_pDeviceAdapter->GetAdapterHandle(), &queryPoolInfo, NULL, &queryPool ) );
+
+    return queryPool;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Renderer::UpdateRenderScale( const Frame &frame )
+{
+    if ( m_TimestampPool == VK_NULL_HANDLE || !frame.bTimestampsWritten )
+        return;
+
+    // Fence of the slot was waited on, its timestamps are there
+    uint64_t timestamps[ 2 ];
+    if ( vkGetQueryPoolResults( m_pDeviceAdapter->GetAdapterHandle(),
+                                m_TimestampPool,
+                                static_cast<uint32_t>( m_uCurrentFrame * 2 ),
+                                2,
+                                sizeof( timestamps ),
+                                timestamps,
+                                sizeof( uint64_t ),
+                                VK_QUERY_RESULT_64_BIT ) != VK_SUCCESS )
+    {
+        return;
+    }
+
+    const float fGpuTimeMs = static_cast<float>( timestamps[ 1 ] - timestamps[ 0 ] ) * m_fTimestampPeriod * 1e-6f;
+
+    m_fGpuTimeMs = m_fGpuTimeMs == 0.f ? fGpuTimeMs : m_fGpuTimeMs + ( fGpuTimeMs - m_fGpuTimeMs ) * GpuTimeSmoothing;
+
+    // Smoothed time has to catch up with the last change first
+    if ( m_uScaleCooldown > 0 )
+    {
+        --m_uScaleCooldown;
+        return;
+    }
+
+    float fScale = 1.f;
+    if ( m_fGpuBudgetMs > 0.f )
+    {
+        if ( m_fGpuTimeMs <= m_fGpuBudgetMs && m_fGpuTimeMs >= m_fGpuBudgetMs * GpuBudgetLowerBound )
+            return;
+
+        // Time follows the pixel count, the square of the scale. It aims in the middle of the budget band
+        const float fTargetMs = m_fGpuBudgetMs * ( 1.f + GpuBudgetLowerBound ) * 0.5f;
+
+        fScale = m_fRenderScale * sqrtf( fTargetMs / ::std::max( m_fGpuTimeMs, 1e-3f ) );
+        fScale = ::std::clamp( roundf( fScale / RenderScaleStep ) * RenderScaleStep, MinRenderScale, 1.f );
+    }
+
+    if ( fScale == m_fRenderScale )
+        return;
+
+    B33_INFO( L"GPU frame took %f ms of %f ms, render scale %f -> %f",
+              m_fGpuTimeMs,
+              m_fGpuBudgetMs,
+              m_fRenderScale,
+              fScale );
+
+    m_fRenderScale   = fScale;
+    m_uScaleCooldown = RenderScaleCooldown;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+VkPipelineCache Renderer::CreatePipelineCache()
+{
+    const filesystem::path path = ::B33::App::AppResources::Get().GetExecutablePathA() + "/" + PipelineCacheFile;
+
+    VkPhysicalDeviceProperties properties;
+    VkPipelineCache            pipelineCache;
+    vector<char>               vData;
+
+    vkGetPhysicalDeviceProperties( m_pHardware->GetPhysicalDevice(), &properties );
+
+    ifstream file( path, ios::binary );
+    if ( file.is_open() )
+    {
+        PipelineCacheFileHeader header = {};
+        file.read( reinterpret_cast<char *>( &header ), sizeof( header ) );
+
+        if ( file && memcmp( header.Magic, PipelineCacheMagic, sizeof( header.Magic ) ) == 0 &&
+             header.uVersion == PipelineCacheVersion && header.uVendorId == properties.vendorID &&
+             header.uDeviceId == properties.deviceID && header.uDriverVersion == properties.driverVersion &&
+             memcmp( header.CacheUuid, properties.pipelineCacheUUID, VK_UUID_SIZE ) == 0 )
+        {
+            vData.resize( static_cast<size_t>( header.uDataSize ) );
+            file.read( vData.data(), vData.size() );
+
+            if ( !file )
+            {
+                B33_WARNING( L"Pipeline cache file is cut short, starting with an empty cache" );
+                vData.clear();
+            }
+        }
+        else
+        {
+            B33_WARNING( L"Pipeline cache file was made by another device or driver, starting with an empty cache" );
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo = {
+        .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = vData.size(),
+        .pInitialData    = vData.empty() ? NULL : vData.data(),
+    };
+
+    THROW_IF_FAILED( vkCreatePipelineCache( m_pDeviceAdapter->GetAdapterHandle(), &cacheInfo, NULL, &pipelineCache ) );
+
+    B33_INFO( L"Pipeline cache starts with %zu bytes", vData.size() );
+
+    return pipelineCache;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Renderer::SavePipelineCache()
+{
+    const filesystem::path path = ::B33::App::AppResources::Get().GetExecutablePathA() + "/" + PipelineCacheFile;
+    const VkDevice         device = m_pDeviceAdapter->GetAdapterHandle();
+
+    VkPhysicalDeviceProperties properties;
+    size_t                     uDataSize = 0;
+    vector<char>               vData;
+
+    vkGetPhysicalDeviceProperties( m_pHardware->GetPhysicalDevice(), &properties );
+
+    if ( vkGetPipelineCacheData( device, m_PipelineCache, &uDataSize, NULL ) != VK_SUCCESS || uDataSize == 0 )
+        return;
+
+    vData.resize( uDataSize );
+    if ( vkGetPipelineCacheData( device, m_PipelineCache, &uDataSize, vData.data() ) != VK_SUCCESS )
+        return;
+
+    PipelineCacheFileHeader header = {};
+    memcpy( header.Magic, PipelineCacheMagic, sizeof( header.Magic ) );
+    memcpy( header.CacheUuid, properties.pipelineCacheUUID, VK_UUID_SIZE );
+    header.uVersion       = PipelineCacheVersion;
+    header.uVendorId      = properties.vendorID;
+    header.uDeviceId      = properties.deviceID;
+    header.uDriverVersion = properties.driverVersion;
+    header.uDataSize      = uDataSize;
+
+    ofstream file( path, ios::binary | ios::trunc );
+    file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    file.write( vData.data(), uDataSize );
+
+    if ( !file )
+    {
+        B33_WARNING( L"Couldn't write the pipeline cache, the next start compiles the pipelines again" );
+        return;
+    }
+
+    B33_INFO( L"Pipeline cache saved with %zu bytes", uDataSize );
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 void Renderer::DestroyFrameResources()
 {
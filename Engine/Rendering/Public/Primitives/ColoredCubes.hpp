@@ -15,6 +15,14 @@ class ColoredCubes
   , public B33::Rendering::ReflectionProperty
   , public B33::Rendering::RoughnessProperty
 {
+  public:
+    virtual ::size_t AddObject() override
+    {
+        ::size_t i = Cubes::AddObject();
+        this->AddColor();
+
+        return i;
+    }
 };
 
 } // namespace B33::Rendering
@@ -14,6 +14,19 @@ class alignas( 8 ) ColorProperty // : public IMaterialProperties
     }
 
   public:
+    static constexpr ::uint32_t DefaultColor = 0xFFFFFFFF;
+
+  public:
+    ::uint32_t GetColor( ::size_t uIndex ) const
+    {
+        return m_uColors[ uIndex ];
+    }
+
+    void AddColor( ::uint32_t uColor = DefaultColor )
+    {
+        m_uColors.push_back( uColor );
+    }
+
     void SetColor( ::uint32_t uColor, ::size_t uIndex )
     {
         m_uColors[ uIndex ] = ( uColor & 0xFFFFFF00 ) | ( m_uColors[ uIndex ] & 0x000000FF );
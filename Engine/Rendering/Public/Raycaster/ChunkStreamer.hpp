@@ -0,0 +1,263 @@
+#ifndef B33_CHUNK_STREAMER_H
+#define B33_CHUNK_STREAMER_H
+
+#include "B33Core.h"
+
+#include "Primitives/Camera.hpp"
+#include "Raycaster/TerrainGenerator.hpp"
+#include "Raycaster/WorldFile.hpp"
+#include "Synchronization/JobSystem.hpp"
+
+namespace B33::Rendering
+{
+
+struct ChunkStreamerDesc
+{
+    // Chunks within the radius around the camera are kept resident, in voxels
+    float fRadius = 64.f;
+
+    // Second sphere of the same radius is loaded ahead of the camera along the view direction
+    float fPrefetchDistance = 32.f;
+
+    // Limit of the CPU copies, chunks wanted by the current camera position are never evicted
+    size_t uBudgetBytes = 64ull << 20;
+
+    // GPU slots of ChunkDim^3 colors each
+    uint32_t uGpuSlots = 512;
+
+    // Chunks under or above aren't streamed
+    int32_t iMinChunkY = 0;
+    int32_t iMaxChunkY = INT32_MAX;
+
+    // Chunks inside of the dense grid of this width aren't streamed, the grid covers them
+    size_t uGridWidth = 0;
+};
+
+/**
+ * @brief Mirrors the chunk table layout the raycast shader reads, Slots[ WindowDim^3 ] follow it.
+ */
+struct ChunkTableHeader
+{
+    ::B33::Math::iVec3 WindowOrigin = {};
+    ::B33::Math::iVec3 WindowDim    = {};
+};
+
+/**
+ * @brief Keeps static chunks of ChunkDim^3 around the camera resident on the CPU and the GPU, the world outside of
+ * the dense grid is streamed through it.
+ *
+ * Chunks are loaded on its own job system closest to the camera first, CPU copies are evicted least recently wanted
+ * first once they go over the budget. GPU keeps uGpuSlots chunks, the table maps every chunk of a window around the
+ * camera to its slot, farthest slots are reused when they run out. Memory stays bounded however far the camera goes.
+ *
+ * Update and the GPU accessors have to be called from the same thread, the loader is called from the job processors.
+ */
+class ChunkStreamer
+{
+  public:
+    static constexpr uint32_t ChunkDim    = WorldFile::ChunkDim;
+    static constexpr uint32_t ChunkVoxels = ChunkDim * ChunkDim * ChunkDim;
+
+    // Table values that aren't slots, the chunk isn't on the GPU or has nothing to draw
+    static constexpr uint32_t SlotMissing = ~0u;
+    static constexpr uint32_t SlotEmpty   = ~0u - 1;
+
+    /**
+     * @brief Fills x major colors of the chunk, vColors comes zeroed with ChunkVoxels colors and 0 stays empty.
+     *
+     * @return False if the chunk couldn't be loaded, it's kept empty
+     */
+    using ChunkLoader = ::std::function<bool( const ::B33::Math::iVec3 &chunk, ::std::vector<uint32_t> &vColors )>;
+
+  public:
+    BEAST_API explicit ChunkStreamer( ChunkLoader loader, ChunkStreamerDesc desc = {} );
+
+    BEAST_API ~ChunkStreamer();
+
+  public:
+    ChunkStreamer( const ChunkStreamer & )            = delete;
+    ChunkStreamer &operator=( const ChunkStreamer & ) = delete;
+
+    ChunkStreamer( ChunkStreamer && )            = delete;
+    ChunkStreamer &operator=( ChunkStreamer && ) = delete;
+
+  public:
+    /**
+     * @brief Chunks outside of the file are empty.
+     */
+    BEAST_API static ChunkLoader FromWorldFile( ::std::shared_ptr<WorldFile> pWorldFile );
+
+    BEAST_API static ChunkLoader FromGenerator( ::std::shared_ptr<const TerrainGenerator> pGenerator );
+
+  public:
+    /**
+     * @brief Never blocks. Wanted chunks are recollected only when the camera or the prefetch point moves to
+     * another chunk, finished loads are picked up every call.
+     *
+     * @param lookDir - normalized view direction
+     */
+    BEAST_API void Update( const Camera &camera, const ::B33::Math::Vec3 &lookDir );
+
+    /**
+     * @brief Makes the next upload send the table and every slot in use, e.g. after the buffers were recreated.
+     */
+    BEAST_API void ForceGpuUpload();
+
+  public:
+    const ::std::vector<uint32_t> &GetDirtySlots() const
+    {
+        return m_vDirtySlots;
+    }
+
+    /**
+     * @return ChunkVoxels colors of the chunk in the slot
+     */
+    BEAST_API const uint32_t *GetSlotColors( uint32_t uSlot ) const;
+
+    bool IsTableDirty() const
+    {
+        return m_bTableDirty;
+    }
+
+    const ChunkTableHeader &GetTableHeader() const
+    {
+        return m_TableHeader;
+    }
+
+    const ::std::vector<uint32_t> &GetTable() const
+    {
+        return m_vTable;
+    }
+
+    void ClearGpuDirty()
+    {
+        m_vDirtySlots.clear();
+        m_bTableDirty = false;
+    }
+
+    size_t GetTableSizeInBytes() const
+    {
+        return sizeof( ChunkTableHeader ) + m_vTable.size() * sizeof( uint32_t );
+    }
+
+    size_t GetSlotsSizeInBytes() const
+    {
+        return static_cast<size_t>( m_Desc.uGpuSlots ) * ChunkVoxels * sizeof( uint32_t );
+    }
+
+  public:
+    size_t GetResidentCount() const
+    {
+        return m_Lru.size();
+    }
+
+    size_t GetResidentBytes() const
+    {
+        return m_uResidentBytes;
+    }
+
+    size_t GetQueuedCount() const
+    {
+        return m_Queue.size();
+    }
+
+    size_t GetInFlightCount() const
+    {
+        return m_uInFlight;
+    }
+
+    size_t GetSlotsInUse() const
+    {
+        return m_Desc.uGpuSlots - m_vFreeSlots.size();
+    }
+
+    const ChunkStreamerDesc &GetDesc() const
+    {
+        return m_Desc;
+    }
+
+  private:
+    struct StreamedChunk
+    {
+        ::B33::Math::iVec3 Chunk;
+
+        // Empty when the chunk has no voxels
+        ::std::vector<uint32_t>         vColors;
+        ::std::list<uint64_t>::iterator LruIt;
+        uint64_t                        uWantedEpoch;
+        uint32_t                        uSlot;
+        bool                            bLoading;
+    };
+
+    struct QueuedChunk
+    {
+        float              fDistanceSq;
+        ::B33::Math::iVec3 Chunk;
+
+        // Heap keeps the closest chunk on top
+        bool operator<( const QueuedChunk &other ) const
+        {
+            return fDistanceSq > other.fDistanceSq;
+        }
+    };
+
+    struct LoadedChunk
+    {
+        ::B33::Math::iVec3      Chunk;
+        ::std::vector<uint32_t> vColors;
+        bool                    bLoaded;
+    };
+
+  private:
+    static uint64_t ChunkKey( const ::B33::Math::iVec3 &chunk );
+
+    bool IsStreamed( const ::B33::Math::iVec3 &chunk ) const;
+
+    float DistanceSq( const ::B33::Math::iVec3 &chunk ) const;
+
+    int64_t TableIndex( const ::B33::Math::iVec3 &chunk ) const;
+
+    void ReleaseSlot( StreamedChunk &streamed );
+
+    void CollectWanted();
+
+    void DispatchQueued();
+
+    bool RetireLoaded();
+
+    bool Evict();
+
+    void AssignSlots();
+
+  private:
+    const ChunkStreamerDesc m_Desc;
+    const ChunkLoader       m_Loader;
+    const int32_t           m_iWindowReach;
+
+    ::std::unordered_map<uint64_t, StreamedChunk> m_Chunks;
+    ::std::list<uint64_t>                          m_Lru;
+    ::std::vector<QueuedChunk>                     m_Queue;
+    ::B33::Math::Vec3                              m_Focus;
+    ::B33::Math::Vec3                              m_Prefetch;
+    ::B33::Math::iVec3                             m_FocusChunk;
+    ::B33::Math::iVec3                             m_PrefetchChunk;
+    uint64_t                                       m_uWantedEpoch;
+    size_t                                         m_uResidentBytes;
+    size_t                                         m_uInFlight;
+
+    ::std::vector<uint64_t> m_vSlotOwners;
+    ::std::vector<uint32_t> m_vFreeSlots;
+    ::std::vector<uint32_t> m_vDirtySlots;
+    ChunkTableHeader        m_TableHeader;
+    ::std::vector<uint32_t> m_vTable;
+    bool                    m_bTableDirty;
+
+    ::std::mutex               m_LoadedMutex;
+    ::std::vector<LoadedChunk> m_vLoaded;
+
+    // Jobs write to m_vLoaded, the processors have to be joined before it goes
+    ::B33::Core::JobSystem m_JobSystem;
+};
+
+} // namespace B33::Rendering
+#endif // !B33_CHUNK_STREAMER_H
@@ -18,8 +18,11 @@ struct alignas( 16 ) VoxelPushConstants : IPushConstants
     Vec        CameraUp;
     float      fFov;
     ::uint32_t uMode;
-    ::uint32_t _Padding2;
-    ::uint32_t _Padding3;
+
+    // Set by the pipeline, frames since the history was reset and the size of the rendered image, width in the low
+    // 16 bits and height in the high ones
+    ::uint32_t uFrame;
+    ::uint32_t uRenderExtent;
 };
 
 } // namespace B33::Rendering
@@ -0,0 +1,186 @@
+#ifndef B33_TERRAIN_GENERATOR_H
+#define B33_TERRAIN_GENERATOR_H
+
+#include "B33Core.h"
+
+#include "Noise.hpp"
+#include "Raycaster/VoxelGrid.hpp"
+#include "Raycaster/WorldFile.hpp"
+#include "Synchronization/JobSystem.hpp"
+
+namespace B33::Rendering
+{
+
+struct TerrainParams
+{
+    uint32_t uSeed = 1337;
+
+    // Surface height is fBaseHeight + fHeightRange * fBm( x, z )
+    ::B33::Math::FractalParams Height       = { ::B33::Math::ENoiseType::Simplex, 5, 1.f / 96.f, 2.f, 0.5f };
+    float                      fBaseHeight  = 16.f;
+    float                      fHeightRange = 12.f;
+
+    // Tunnels are carved where two fBm fields are both close to zero, they stay iCaveRoof voxels under the surface
+    ::B33::Math::FractalParams Caves      = { ::B33::Math::ENoiseType::Value, 3, 1.f / 24.f, 2.f, 0.5f };
+    float                      fCaveWidth = 0.12f;
+    int32_t                    iCaveRoof  = 4;
+
+    int32_t  iDirtDepth  = 3;
+    uint32_t uGrassColor = 0x3A7D2CFF;
+    uint32_t uDirtColor  = 0x6B4A2BFF;
+    uint32_t uStoneColor = 0x5A5A5AFF;
+};
+
+/**
+ * @brief Generated static voxels of a chunk, Origin is in voxels.
+ */
+struct TerrainChunk
+{
+    ::B33::Math::iVec3 Origin      = {};
+    VoxelRegion        Region      = {};
+    size_t             uSolidCount = 0;
+};
+
+/**
+ * @brief Generates terrain chunks of WorldFile::ChunkDim^3 on its own job system, closest to the focus point first.
+ *
+ * SetFocus queues every missing chunk within the radius ordered by the distance, Update starts queued chunks on
+ * idle job processors and pastes the finished ones into the grid under a single edit batch, so the grid requests
+ * one upload per Update. Generated voxels are added to the grid, existing ones stay. SetFocus and Update have to
+ * be called from the same thread, GenerateChunk is safe to call from any.
+ */
+class TerrainGenerator
+{
+  public:
+    static constexpr uint32_t ChunkDim = WorldFile::ChunkDim;
+
+  public:
+    BEAST_API explicit TerrainGenerator( size_t uGridWidth, TerrainParams params = {} );
+
+    BEAST_API ~TerrainGenerator();
+
+  public:
+    TerrainGenerator( const TerrainGenerator & )            = delete;
+    TerrainGenerator &operator=( const TerrainGenerator & ) = delete;
+
+    TerrainGenerator( TerrainGenerator && )            = delete;
+    TerrainGenerator &operator=( TerrainGenerator && ) = delete;
+
+  public:
+    /**
+     * @brief Queue is rebuilt only when the focus moves to another chunk or the radius changes, chunks that left
+     * the radius before they were started are dropped from it.
+     */
+    BEAST_API void SetFocus( const ::B33::Math::Vec3 &focus, float fRadius );
+
+    /**
+     * @brief Never blocks.
+     *
+     * @param uMaxChunks - limit of finished chunks pasted into the grid, the rest waits for the next Update
+     * @return Number of chunks pasted into the grid
+     */
+    BEAST_API size_t Update( IWorldGrid &grid, size_t uMaxChunks = -1 );
+
+    /**
+     * @brief Generates every chunk of the grid that wasn't generated yet and waits for all of them.
+     */
+    BEAST_API void GenerateAll( IWorldGrid &grid );
+
+    /**
+     * @brief Chunks are generated again once they come into the focus.
+     */
+    BEAST_API void Reset();
+
+    /**
+     * @param chunk - chunk coordinates, voxel position divided by ChunkDim
+     */
+    BEAST_API void GenerateChunk( const ::B33::Math::iVec3 &chunk, TerrainChunk &out ) const;
+
+    /**
+     * @brief Generates any box of at most ChunkDim^3 voxels, the grid doesn't bound it. Safe to call from any thread.
+     *
+     * @param pColors - x major colors of the box, solid voxels are written and the empty ones are left untouched
+     * @return Number of solid voxels
+     */
+    BEAST_API size_t GenerateColors( const ::B33::Math::iVec3 &origin,
+                                     const ::B33::Math::iVec3 &extent,
+                                     uint32_t                 *pColors ) const;
+
+  public:
+    size_t GetQueuedCount() const
+    {
+        return m_Queue.size();
+    }
+
+    size_t GetInFlightCount() const
+    {
+        return m_uInFlight;
+    }
+
+    size_t GetGeneratedCount() const
+    {
+        return m_uGenerated;
+    }
+
+    size_t GetChunkCount() const
+    {
+        return m_vStates.size();
+    }
+
+    const TerrainParams &GetParams() const
+    {
+        return m_Params;
+    }
+
+  private:
+    enum EChunkState : uint8_t
+    {
+        ChunkMissing,
+        ChunkQueued,
+        ChunkGenerating,
+        ChunkGenerated,
+    };
+
+    struct QueuedChunk
+    {
+        float    fDistanceSq;
+        uint32_t uChunk;
+
+        // Heap keeps the closest chunk on top
+        bool operator<( const QueuedChunk &other ) const
+        {
+            return fDistanceSq > other.fDistanceSq;
+        }
+    };
+
+  private:
+    ::B33::Math::iVec3 ChunkCoord( size_t uChunk ) const;
+
+    size_t ChunkIndex( const ::B33::Math::iVec3 &chunk ) const;
+
+    void RebuildQueue();
+
+    void DispatchQueued();
+
+  private:
+    const TerrainParams m_Params;
+    const size_t        m_uGridDim;
+    const int32_t       m_iChunksPerAxis;
+
+    ::std::vector<uint8_t>     m_vStates;
+    ::std::vector<QueuedChunk> m_Queue;
+    ::B33::Math::Vec3          m_Focus;
+    ::B33::Math::iVec3         m_FocusChunk;
+    float                      m_fRadius;
+    size_t                     m_uInFlight;
+    size_t                     m_uGenerated;
+
+    ::std::mutex                m_CompletedMutex;
+    ::std::vector<TerrainChunk> m_vCompleted;
+
+    // Jobs write to m_vCompleted, the processors have to be joined before it goes
+    ::B33::Core::JobSystem m_JobSystem;
+};
+
+} // namespace B33::Rendering
+#endif // !B33_TERRAIN_GENERATOR_H
@@ -6,6 +6,7 @@
 #include "Primitives/ColoredCubes.hpp"
 #include "Primitives/Object.hpp"
 #include "Raycaster/Voxel.hpp"
+#include "Synchronization/JobSystem.hpp"
 #include "Vulkan/MemoryUploadTracker.hpp"
 
 namespace B33::Rendering
@@ -19,6 +20,16 @@ enum EGridChanged
     HalfSize  = Rotation << 1,
 };
 
+/**
+ * @brief Static voxels of a box, written by IWorldGrid::CopyRegion. Cells are x major.
+ */
+struct VoxelRegion
+{
+    ::B33::Math::iVec3      Extent  = {};
+    ::std::vector<uint32_t> vColors = {};
+    ::std::vector<uint8_t>  vSolid  = {};
+};
+
 class IWorldGrid : public ::B33::Rendering::MemoryUploadTracker
 {
     using Vec  = ::B33::Math::Vec3;
@@ -32,6 +43,14 @@ class IWorldGrid : public ::B33::Rendering::MemoryUploadTracker
       : m_uGridDim( uGridWidth )
       , m_VoxelGrid( uGridWidth * uGridWidth * uGridWidth )
       , m_uChanged( NoChanges )
+      , m_uPendingChanged( 0 )
+      , m_uBatchDepth( 0 )
+      , m_bBatchUpload( false )
+      , m_CellsChangedMin( 0, 0, 0 )
+      , m_CellsChangedMax( static_cast<int32_t>( uGridWidth ) - 1,
+                           static_cast<int32_t>( uGridWidth ) - 1,
+                           static_cast<int32_t>( uGridWidth ) - 1 )
+      , m_bCellsChanged( true )
     {
     }
 
@@ -75,38 +94,206 @@ class IWorldGrid : public ::B33::Rendering::MemoryUploadTracker
 
     virtual const ::B33::Math::WorldObjects &GetStoredObjects() const = 0;
 
+    /**
+     * @brief Saves object transforms before the simulation step moves them
+     */
+    virtual void StoreTransforms() = 0;
+
+    /**
+     * @brief Blends object transforms between the last two simulation steps for rendering
+     */
+    virtual void InterpolateTransforms( float fAlpha ) = 0;
+
   public:
     BEAST_API void SetVoxel( const iVec &pos, uint32_t uColor );
 
+    /**
+     * Region operations take inclusive bounds clipped to the grid. Cells are written row by row and an upload is
+     * requested once per call. Unlike SetVoxel they skip cells occupied by objects, so the object ids stay intact.
+     */
+    BEAST_API void FillBox( const iVec &min, const iVec &max, uint32_t uColor );
+
+    /**
+     * @brief Removes static voxels from the box, cells occupied by objects are kept.
+     */
+    BEAST_API void ClearBox( const iVec &min, const iVec &max );
+
+    BEAST_API void FillSphere( const iVec &center, int32_t iRadius, uint32_t uColor );
+
+    BEAST_API VoxelRegion CopyRegion( const iVec &min, const iVec &max ) const;
+
+    /**
+     * @param bPasteEmpty - empty cells of the region clear the static voxels under them as well
+     */
+    BEAST_API void PasteRegion( const VoxelRegion &region, const iVec &dst, bool bPasteEmpty = false );
+
+    /**
+     * @brief Calls fn( const iVec &pos, Voxel &voxel ) for every cell of the box, slabs of the box are processed in
+     * parallel on the job system. fn shouldn't touch cells occupied by objects.
+     */
+    template <class FUNCTION>
+    void ApplyRegion( const iVec &min, const iVec &max, ::B33::Core::JobSystem &jobSystem, FUNCTION fn )
+    {
+        iVec lo, hi;
+        if ( !ClipRegion( min, max, lo, hi ) )
+            return;
+
+        const int32_t iDepth  = hi.z - lo.z + 1;
+        const int32_t iJobs   = ::std::min<int32_t>( static_cast<int32_t>( jobSystem.GetProcessorCount() ), iDepth );
+        const int32_t iPerJob = ( iDepth + iJobs - 1 ) / iJobs;
+
+        for ( int32_t iJob = 0; iJob < iJobs; ++iJob )
+        {
+            jobSystem.PushJob(
+                [ this, &fn, &lo, &hi, iJob, iPerJob ]()
+                {
+                    const int32_t iEnd = ::std::min( hi.z + 1, lo.z + ( iJob + 1 ) * iPerJob );
+
+                    for ( int32_t z = lo.z + iJob * iPerJob; z < iEnd; ++z )
+                    {
+                        for ( int32_t y = lo.y; y <= hi.y; ++y )
+                        {
+                            Voxel *pRow = &m_VoxelGrid[ CalcIndex( iVec( lo.x, y, z ) ) ];
+
+                            for ( int32_t x = lo.x; x <= hi.x; ++x )
+                                fn( iVec( x, y, z ), pRow[ x - lo.x ] );
+                        }
+                    }
+                } );
+        }
+
+        jobSystem.BlockAndWait();
+        MarkCellsChanged( lo, hi );
+        RequestUpload();
+    }
+
+  public:
+    /**
+     * @brief Upload requests and change flags raised until the matching EndEditBatch are deferred to it, batches
+     * can be nested. See WorldEditBatch.
+     */
+    void BeginEditBatch()
+    {
+        ++m_uBatchDepth;
+    }
+
+    BEAST_API void EndEditBatch();
+
+    bool IsInEditBatch() const
+    {
+        return m_uBatchDepth != 0;
+    }
+
+  public:
+    /**
+     * @brief Grows the box of cells changed since the last ConsumeCellChanges, edits of the grid and objects moving
+     * over it call it on their own. Writes straight into GetGrid() have to call it.
+     */
+    BEAST_API void MarkCellsChanged( const iVec &min, const iVec &max );
+
+    /**
+     * @brief Data derived from the cells, like the mip chain, is rebuilt only over the returned box. Only one
+     * consumer can use it, the box is reset by the call.
+     *
+     * @return False if no cell changed
+     */
+    BEAST_API bool ConsumeCellChanges( iVec &min, iVec &max );
+
   public:
     virtual bool CheckIfVoxelOccupied( const iVec &pos ) const = 0;
 
   protected:
     BEAST_API ::size_t CalcIndex( const iVec &pos ) const;
 
+    /**
+     * @brief Clips inclusive bounds to the grid.
+     *
+     * @return False if nothing is left
+     */
+    BEAST_API bool ClipRegion( const iVec &min, const iVec &max, iVec &lo, iVec &hi ) const;
+
+    /**
+     * @brief ForceUpload that waits for the end of the edit batch.
+     */
+    void RequestUpload()
+    {
+        if ( m_uBatchDepth != 0 )
+        {
+            m_bBatchUpload = true;
+            return;
+        }
+
+        this->ForceUpload();
+    }
+
     BEAST_API void PlaceOnGrid( const iVec &pos, const iVec &area, const ::size_t uId );
 
     BEAST_API void RemoveFromGrid( const iVec &pos, const iVec &area, const ::size_t uId );
 
     void SetPositionChanged()
     {
-        m_uChanged |= EGridChanged::Position;
+        MarkChanged( EGridChanged::Position );
     }
 
     void SetRotationChanged()
     {
-        m_uChanged |= EGridChanged::Rotation;
+        MarkChanged( EGridChanged::Rotation );
     }
 
     void SetHalfSizeChanged()
     {
-        m_uChanged |= EGridChanged::HalfSize;
+        MarkChanged( EGridChanged::HalfSize );
     }
 
+  private:
+    void MarkChanged( EGridChanged changed )
+    {
+        if ( m_uBatchDepth != 0 )
+            m_uPendingChanged |= changed;
+        else
+            m_uChanged |= changed;
+    }
+
+    BEAST_API void WriteBox( const iVec &min, const iVec &max, uint32_t uType, uint32_t uColor );
+
   private:
     ::size_t                               m_uGridDim = -1;
     ::std::vector<::B33::Rendering::Voxel> m_VoxelGrid;
     ::uint32_t                             m_uChanged;
+    ::uint32_t                             m_uPendingChanged;
+    ::uint32_t                             m_uBatchDepth;
+    bool                                   m_bBatchUpload;
+    iVec                                   m_CellsChangedMin;
+    iVec                                   m_CellsChangedMax;
+    bool                                   m_bCellsChanged;
+};
+
+/**
+ * @brief Scope of bulk edits, the grid requests a single upload when the outermost batch ends.
+ */
+class WorldEditBatch
+{
+  public:
+    explicit WorldEditBatch( IWorldGrid &grid )
+      : m_Grid( grid )
+    {
+        m_Grid.BeginEditBatch();
+    }
+
+    ~WorldEditBatch()
+    {
+        m_Grid.EndEditBatch();
+    }
+
+  public:
+    WorldEditBatch( const WorldEditBatch & )            = delete;
+    WorldEditBatch &operator=( const WorldEditBatch & ) = delete;
+
+    WorldEditBatch( WorldEditBatch && )            = delete;
+    WorldEditBatch &operator=( WorldEditBatch && ) = delete;
+
+  private:
+    IWorldGrid &m_Grid;
 };
 
 template <class StoredObjectType>
@@ -130,6 +317,31 @@ class WorldGrid : public IWorldGrid
         return m_StoredObjects;
     }
 
+    const StoredObjectType &GetObjects() const
+    {
+        return m_StoredObjects;
+    }
+
+    StoredObjectType &GetObjects()
+    {
+        return m_StoredObjects;
+    }
+
+    virtual void StoreTransforms() override
+    {
+        m_StoredObjects.StoreTransforms();
+    }
+
+    virtual void InterpolateTransforms( float fAlpha ) override
+    {
+        if ( !m_StoredObjects.Interpolate( fAlpha ) )
+            return;
+
+        this->RequestUpload();
+        this->SetPositionChanged();
+        this->SetRotationChanged();
+    }
+
   public:
     virtual bool CheckIfVoxelOccupied( const iVec &pos ) const override
     {
@@ -154,13 +366,34 @@ class WorldGrid : public IWorldGrid
     size_t GenerateObjectAtVoxel( const iVec &pos, U &&sot )
     {
         size_t uId = GenerateObject( pos, this->GetGrid(), ::std::forward<U>( sot ) );
-        this->ForceUpload();
+        this->RequestUpload();
         this->SetPositionChanged();
         this->SetRotationChanged();
         this->SetHalfSizeChanged();
         return uId;
     }
 
+    /**
+     * @brief Adds an object with an exact transform, ex. read from a world file. Doesn't request an upload, caller
+     * does it once after the whole batch.
+     */
+    size_t RestoreObject( const Vec &pos, const Rot &rot, const Vec &halfSize )
+    {
+        const size_t uObjId = m_StoredObjects.AddObject();
+
+        m_StoredObjects.SetPositon( pos, uObjId );
+        m_StoredObjects.SetRotation( rot, uObjId );
+        m_StoredObjects.SetHalfSize( halfSize, uObjId );
+        m_StoredObjects.ResetInterpolation( uObjId );
+
+        this->PlaceOnGrid( iVec::ToVec( pos ), iVec::ToVec( halfSize + 1 ), uObjId );
+
+        this->SetPositionChanged();
+        this->SetRotationChanged();
+        this->SetHalfSizeChanged();
+        return uObjId;
+    }
+
     void RemoveObject( const size_t uObjectId )
     {
         const iVec area = iVec::ToVec( m_StoredObjects.GetHalfSize( uObjectId ) + 1 );
@@ -195,7 +428,7 @@ class WorldGrid : public IWorldGrid
         m_StoredObjects.SetPositon( newPos, uObjectId );
         this->PlaceOnGrid( iVec::ToVec( newPos ), area, uObjectId );
 
-        this->ForceUpload();
+        this->RequestUpload();
         this->SetPositionChanged();
     }
 
@@ -214,7 +447,7 @@ class WorldGrid : public IWorldGrid
 
         m_StoredObjects.SetRotation( newRot, uId );
 
-        this->ForceUpload();
+        this->RequestUpload();
         this->SetRotationChanged();
     }
 
@@ -232,6 +465,7 @@ class WorldGrid : public IWorldGrid
         m_StoredObjects.SetPositon( Vec::ToVec( pos ), uObjId );
         m_StoredObjects.SetRotation( sot.GetRotation(), uObjId );
         m_StoredObjects.SetHalfSize( sot.GetHalfSize(), uObjId );
+        m_StoredObjects.ResetInterpolation( uObjId );
 
         this->PlaceOnGrid( iVec::ToVec( m_StoredObjects.GetPosition( uObjId ) ),
                            iVec::ToVec( m_StoredObjects.GetHalfSize( uObjId ) + 1 ),
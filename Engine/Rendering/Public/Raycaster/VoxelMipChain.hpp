@@ -0,0 +1,127 @@
+#ifndef B33_VOXEL_MIP_CHAIN_H
+#define B33_VOXEL_MIP_CHAIN_H
+
+#include "B33Core.h"
+
+#include "Raycaster/VoxelGrid.hpp"
+
+namespace B33::Rendering
+{
+
+struct VoxelMipLevel
+{
+    // Index of the first color and of the first occupancy word of the level in the cells of all levels
+    uint32_t uOffset          = 0;
+    uint32_t uDim             = 0;
+    uint32_t uOccupancyOffset = 0;
+    uint32_t _Padding0        = 0;
+};
+
+/**
+ * @brief Mirrors the mip buffer layout the raycast shaders read, cells of every level follow it.
+ */
+struct VoxelMipHeader
+{
+    static constexpr uint32_t MaxLevels = 6;
+
+    uint32_t      uLevelCount = 0;
+    uint32_t      _Padding0   = 0;
+    uint32_t      _Padding1   = 0;
+    uint32_t      _Padding2   = 0;
+    VoxelMipLevel Levels[ MaxLevels ];
+};
+
+/**
+ * @brief Coarser copies of the static voxels of the grid, the raycast shader steps through them once the ray gets
+ * far enough from its origin.
+ *
+ * Level l has cells of 2^l voxels, built 2x2x2 to 1 from the level under it. A cell is solid if at least half of its
+ * children are, its color is the most common color of the solid ones, 0 stays empty. Objects aren't part of it.
+ * Every level also keeps a bit per cell set when anything, objects included, is in any of its voxels. Unlike the
+ * colors the bits are conservative, the beam pass skips only cells without them.
+ * Only the cells over the box of changed voxels are rebuilt, GetDirtySpans tells which parts have to be uploaded.
+ */
+class VoxelMipChain
+{
+  public:
+    /**
+     * @brief Range of the cells of all levels.
+     */
+    struct Span
+    {
+        size_t uBegin;
+        size_t uEnd;
+    };
+
+  public:
+    BEAST_API VoxelMipChain();
+
+    BEAST_API ~VoxelMipChain();
+
+  public:
+    VoxelMipChain( const VoxelMipChain & )            = delete;
+    VoxelMipChain &operator=( const VoxelMipChain & ) = delete;
+
+    VoxelMipChain( VoxelMipChain && )            = default;
+    VoxelMipChain &operator=( VoxelMipChain && ) = default;
+
+  public:
+    /**
+     * @brief Sizes the levels for the grid and builds all of them.
+     */
+    BEAST_API void Build( const IWorldGrid &grid );
+
+    /**
+     * @brief Rebuilds the cells over the inclusive box of grid voxels on every level.
+     */
+    BEAST_API void Update( const IWorldGrid &grid, const ::B33::Math::iVec3 &min, const ::B33::Math::iVec3 &max );
+
+  public:
+    const VoxelMipHeader &GetHeader() const
+    {
+        return m_Header;
+    }
+
+    /**
+     * @brief Colors of all levels followed by their occupancy bits.
+     */
+    const ::std::vector<uint32_t> &GetCells() const
+    {
+        return m_vCells;
+    }
+
+    /**
+     * @brief Span of the colors and of the occupancy of every level changed since the last ClearDirty, unchanged
+     * ones have uBegin == uEnd.
+     */
+    const ::std::vector<Span> &GetDirtySpans() const
+    {
+        return m_vDirtySpans;
+    }
+
+    void ClearDirty()
+    {
+        ::std::fill( m_vDirtySpans.begin(), m_vDirtySpans.end(), Span { 0, 0 } );
+    }
+
+    size_t GetSizeInBytes() const
+    {
+        return sizeof( VoxelMipHeader ) + m_vCells.size() * sizeof( uint32_t );
+    }
+
+  private:
+    void ReduceLevel( const IWorldGrid         &grid,
+                      uint32_t                  uLevel,
+                      const ::B33::Math::iVec3 &lo,
+                      const ::B33::Math::iVec3 &hi );
+
+    void MarkDirty( size_t uSpan, size_t uBegin, size_t uEnd );
+
+  private:
+    VoxelMipHeader          m_Header;
+    ::std::vector<uint32_t> m_vCells;
+    ::std::vector<Span>     m_vDirtySpans;
+};
+
+} // namespace B33::Rendering
+#endif // !B33_VOXEL_MIP_CHAIN_H
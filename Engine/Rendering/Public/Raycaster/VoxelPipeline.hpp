@@ -5,16 +5,82 @@
 #include "Vulkan/IPipeline.hpp"
 #include "Vulkan/Memory.hpp"
 #include "Vulkan/SwapChain.hpp"
+#include "Raycaster/ChunkStreamer.hpp"
 #include "Raycaster/PushConstants.hpp"
 #include "Raycaster/VoxelGrid.hpp"
+#include "Raycaster/VoxelMipChain.hpp"
 
 namespace B33::Rendering
 {
 
+/**
+ * @brief Mirrors the buffer the light cache pass reads, an inclusive box of the cells changed since the last reset
+ * and the inclusive box of voxels the pass runs over, the thread ids are offset by its origin.
+ * The cache holds the shadow of every face only, irradiance is still computed by the raycast each frame.
+ */
+struct LightCacheChanges
+{
+    ::B33::Math::iVec3 ChangedMin  = {};
+    ::B33::Math::iVec3 ChangedMax  = {};
+    ::B33::Math::iVec3 DispatchMin = {};
+    ::B33::Math::iVec3 DispatchMax = {};
+};
+
+/**
+ * @brief Mirrors the head of the object cells buffer, the lists of the cells follow it as a start and a length.
+ */
+struct ObjectGridHeader
+{
+    uint32_t uCellsPerAxis = 0;
+    uint32_t uObjectCount  = 0;
+    uint32_t uIdCapacity   = 0;
+    uint32_t _Padding0     = 0;
+};
+
+/**
+ * @brief Specialization constants of the raycast, the members are in the order of the constant ids.
+ */
+struct RaycastVariant
+{
+    ::uint32_t uDebugView     = 0;
+    ::int32_t  iShadowSamples = 1;
+    ::uint32_t uBounces       = 1;
+    float      fMaxRenderDist = 224.f;
+    ::int32_t  iMaxSteps      = 160;
+    ::uint32_t uGroupSizeX    = 32;
+    ::uint32_t uGroupSizeY    = 8;
+    ::uint32_t uTileCache     = 0;
+
+    bool operator==( const RaycastVariant & ) const = default;
+};
+
+/**
+ * @brief Mirrors the head of a queue of the wavefront mode, the passes dispatch indirectly from its first three
+ * members.
+ */
+struct WavefrontQueue
+{
+    ::VkDispatchIndirectCommand Dispatch = { 0, 1, 1 };
+    ::uint32_t                  uLength  = 0;
+};
+
+/**
+ * @brief Passes of the raycast in the wavefront mode, every pass is specialized like the raycast it replaces.
+ */
+struct WavefrontPipelines
+{
+    ::VkPipeline Primary    = VK_NULL_HANDLE;
+    ::VkPipeline Shadow     = VK_NULL_HANDLE;
+    ::VkPipeline Reflection = VK_NULL_HANDLE;
+    ::VkPipeline Shade      = VK_NULL_HANDLE;
+};
+
 class VoxelPipeline : public IPipeline<VoxelPipeline>
 {
-    using Vec  = ::B33::Math::Vec3;
-    using iVec = ::B33::Math::iVec3;
+    using Vec             = ::B33::Math::Vec3;
+    using iVec            = ::B33::Math::iVec3;
+    using VariantPipeline  = ::std::pair<::B33::Rendering::RaycastVariant, ::VkPipeline>;
+    using WavefrontVariant = ::std::pair<::B33::Rendering::RaycastVariant, ::B33::Rendering::WavefrontPipelines>;
 
   private:
     enum EShaderResource
@@ -23,8 +89,35 @@ class VoxelPipeline : public IPipeline<VoxelPipeline>
         ObjectPositions = VoxelGrid + 1,
         ObjectRotations = ObjectPositions + 1,
         ObjectHalfSizes = ObjectRotations + 1,
+        ChunkTable      = ObjectHalfSizes + 1,
+        ChunkSlots      = ChunkTable + 1,
+        VoxelMips       = ChunkSlots + 1,
+        TileStart       = VoxelMips + 1,
+        History         = TileStart + 1,
+        PreviousFrame   = History + 1,
+        UpscaleTarget   = PreviousFrame + 1,
+        LightCache      = UpscaleTarget + 1,
+        LightChanges    = LightCache + 1,
+        ObjectCells     = LightChanges + 1,
+        ObjectIds       = ObjectCells + 1,
+        WavefrontQueues = ObjectIds + 1,
+        HitRecords      = WavefrontQueues + 1,
     };
 
+    // Pixels of a tile share one beam, its start distance is where their rays begin
+    static constexpr uint32_t TileDim = 8;
+
+    // Has to match the object passes, cells of the object grid are 2^ObjectCellShift voxels wide
+    static constexpr uint32_t ObjectCellShift = 3;
+
+    // Bounds of the ids the object lists hold, lists past the upper one are cut
+    static constexpr uint32_t MinObjectIds = 4096;
+    static constexpr uint32_t MaxObjectIds = 1 << 24;
+
+    // Has to match the wavefront passes, shadow, reflection and shade queues in this order
+    static constexpr uint32_t WavefrontQueueCount = 3;
+    static constexpr uint32_t WavefrontRecordSize = 3 * 4 * sizeof( uint32_t );
+
   public:
     VoxelPipeline()
       : IPipeline( VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_BIND_POINT_COMPUTE )
@@ -44,6 +137,32 @@ class VoxelPipeline : public IPipeline<VoxelPipeline>
 
     BEAST_API virtual void Reset() override final;
 
+    virtual void SetRenderScale( float fScale ) override final
+    {
+        m_fRenderScale = fScale;
+    }
+
+    virtual void SetQuality( ERenderQuality quality ) override final
+    {
+        m_Quality = quality;
+    }
+
+    /**
+     * @brief Primary rays of a workgroup march the brick in front of them from shared memory first. Pays off when the
+     * raycast waits on memory, the debug view never uses it.
+     */
+    void SetTileCache( bool bTileCache )
+    {
+        m_bTileCache = bTileCache;
+    }
+
+    /**
+     * @brief Splits the raycast into a primary pass and queued shadow, reflection and shade passes, so the secondary
+     * rays run in full workgroups. The passes of the presets are built when the mode is turned on, or with the rest
+     * of the pipelines if that didn't happen yet. The debug view and variants without passes take the single raycast.
+     */
+    BEAST_API void SetWavefront( bool bWavefront );
+
     ::size_t GetPushConstantsByteSizeImpl()
     {
         return sizeof( m_Vpc );
@@ -56,6 +175,13 @@ class VoxelPipeline : public IPipeline<VoxelPipeline>
 
     BEAST_API void CreatePipelineResourcesImpl( ::std::shared_ptr<::B33::Rendering::CubeWorld> pWorld );
 
+    /**
+     * @brief Chunks of the streamer are drawn outside of the grid, the streamer has to be updated before the
+     * pipeline each frame.
+     */
+    BEAST_API void CreatePipelineResourcesImpl( ::std::shared_ptr<::B33::Rendering::CubeWorld>     pWorld,
+                                                ::std::shared_ptr<::B33::Rendering::ChunkStreamer> pChunkStreamer );
+
     BEAST_API ::VkDescriptorSet CreateDescriptorSetImpl();
 
     BEAST_API ::VkPipelineLayout CreatePipelineLayoutImpl();
@@ -70,6 +196,89 @@ class VoxelPipeline : public IPipeline<VoxelPipeline>
     UploadDescriptor GetUniformUploadDescriptor( const ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> &outBuffer,
                                                  const EShaderResource                                      &sr );
 
+    UploadDescriptor GetUniformUploadDescriptor( const ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> &outBuffer,
+                                                 const ::std::shared_ptr<::B33::Rendering::GPUBuffer>       &gpuBuffer,
+                                                 const EShaderResource                                      &sr );
+
+    void UploadStreamedChunks();
+
+    void UploadVoxelMips();
+
+    /**
+     * @brief Grows the box the light cache pass resets the next frame, faces lit through it have to be traced again.
+     */
+    void MarkLightChanges( const iVec &changedMin, const iVec &changedMax );
+
+    /**
+     * @brief Counts the cells the objects overlap and grows the buffer of the object lists to hold them, waits for the
+     * device when it has to replace the buffer.
+     */
+    void ReserveObjectIds();
+
+    /**
+     * @brief Grows the buffers sized by the window, the render image, the tile starts and the history. They can't be
+     * in use by the GPU.
+     */
+    void ReserveScreenBuffers();
+
+    /**
+     * @brief Points the binding at a buffer that never goes through a stage buffer.
+     */
+    void BindStorageBuffer( const ::std::shared_ptr<::B33::Rendering::GPUBuffer> &gpuBuffer,
+                            const EShaderResource                                &sr );
+
+    void BindStorageImage( ::VkImageView imageView, ::uint32_t uBinding );
+
+    /**
+     * @brief Doesn't throw, so it can run on the jobs of CreatePipelineImpl.
+     */
+    ::VkResult CreateComputePipeline( ::VkShaderModule              shaderModule,
+                                      const ::VkSpecializationInfo *pSpecialization,
+                                      ::VkPipeline                 &pipeline );
+
+    /**
+     * @brief Constants of the raycast for the preset, the debug view is a variant of its own.
+     */
+    static RaycastVariant GetRaycastVariant( ERenderQuality quality, bool bDebugView, bool bTileCache );
+
+    /**
+     * @brief Returns the raycast pipeline of the variant, variants of the presets are built up front, any other is
+     * created the first time it's asked for.
+     */
+    ::VkPipeline GetRaycastPipeline( const RaycastVariant &variant );
+
+    ::VkResult CreateRaycastPipeline( ::VkShaderModule      shaderModule,
+                                      const RaycastVariant &variant,
+                                      ::VkPipeline         &pipeline );
+
+    /**
+     * @brief Passes of the wavefront mode for the variant, nullptr if they weren't built. Never compiles anything.
+     */
+    const ::B33::Rendering::WavefrontPipelines *FindWavefrontPipelines( const RaycastVariant &variant ) const;
+
+    /**
+     * @brief Adds entries for the variants that have no passes yet, debug views are skipped.
+     *
+     * @return Index of the first added entry
+     */
+    ::size_t ReserveWavefrontVariants( const ::std::vector<RaycastVariant> &vVariants );
+
+    /**
+     * @brief Pushes a job per pass of the entry, the entry and the four results have to outlive the jobs.
+     */
+    void PushWavefrontJobs( ::B33::Core::JobSystem &jobSystem, WavefrontVariant &variant, ::VkResult *pResults );
+
+    /**
+     * @brief Resets the queues, records the primary pass over the render extent and the queued passes after it.
+     */
+    void RecordWavefront( ::VkCommandBuffer                            cmdBuffer,
+                          const ::B33::Rendering::WavefrontPipelines &pipelines,
+                          ::uint32_t                                  uGroupCountX,
+                          ::uint32_t                                  uGroupCountY );
+
+    /**
+     * @brief Makes the image the target of the upscale pass.
+     */
     void LoadImage( VkImage image );
 
     BEAST_API ::VkShaderModule LoadShader( const ::std::string &strPath );
@@ -88,9 +297,81 @@ class VoxelPipeline : public IPipeline<VoxelPipeline>
     ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> m_StageRotationsBuffer = nullptr;
     ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> m_StageHalfSizesBuffer = nullptr;
 
+    // Streamed chunks, only the changed parts are copied from the stage buffers
+    ::std::shared_ptr<::B33::Rendering::ChunkStreamer>   m_pChunkStreamer        = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer>       m_ChunkTableBuffer      = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer>       m_ChunkSlotsBuffer      = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> m_StageChunkTableBuffer = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> m_StageChunkSlotsBuffer = nullptr;
+    ::std::vector<::VkBufferCopy>                        m_vChunkTableCopies     = {};
+    ::std::vector<::VkBufferCopy>                        m_vChunkSlotsCopies     = {};
+
+    // Coarse levels of the static voxels, rebuilt and copied only over the changed box
+    ::B33::Rendering::VoxelMipChain                      m_VoxelMips            = {};
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer>       m_VoxelMipsBuffer      = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> m_StageVoxelMipsBuffer = nullptr;
+    ::std::vector<::VkBufferCopy>                        m_vVoxelMipsCopies     = {};
+
+    // Written by the beam pass before the raycast reads it, never leaves the GPU
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_TileStartBuffer = nullptr;
+
+    // Two halves of the accumulated color, distance and normal of every pixel, frames write them in turns. The
+    // push constants of the previous frame reproject the hits into the other half
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_HistoryBuffer       = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_PreviousFrameBuffer = nullptr;
+    ::B33::Rendering::VoxelPushConstants           m_PreviousVpc         = {};
+    ::uint32_t                                     m_uFrame              = 0;
+
+    // Raycast renders into the corner of the image, the upscale pass stretches it over the swapchain image
+    ::std::shared_ptr<::B33::Rendering::GPUImage> m_RenderImage  = nullptr;
+    ::VkExtent2D                                  m_RenderExtent = { 0, 0 };
+    float                                         m_fRenderScale = 1.f;
+
+    // Shadow of every face of the static voxels, the raycast fills it and the light cache pass resets the faces the
+    // changed cells may shadow
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_LightCacheBuffer   = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_LightChangesBuffer = nullptr;
+    ::B33::Rendering::LightCacheChanges            m_LightChanges       = {};
+    bool                                           m_bLightChanged      = false;
+
+    // Objects binned into a grid of cells, rebuilt by the object passes on frames the objects changed
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_ObjectCellsBuffer = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_ObjectIdsBuffer   = nullptr;
+    ::B33::Rendering::ObjectGridHeader             m_ObjectGridHeader  = {};
+    bool                                           m_bObjectGridDirty  = true;
+    bool                                           m_bObjectIdsCut     = false;
+
+    // Variants of the raycast built so far, the one the pipeline was created with is owned by the wrapper
+    ::B33::Rendering::ERenderQuality m_Quality          = ERenderQuality::Medium;
+    ::B33::Rendering::RaycastVariant m_BaseVariant      = {};
+    bool                             m_bTileCache       = false;
+    ::std::vector<VariantPipeline>   m_vRaycastVariants = {};
+
+    // Queues of pixels and the hit records of the wavefront mode, sized by the window
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_WavefrontQueuesBuffer = nullptr;
+    ::std::shared_ptr<::B33::Rendering::GPUBuffer> m_HitRecordsBuffer      = nullptr;
+    ::std::vector<WavefrontVariant>                m_vWavefrontVariants    = {};
+    bool                                           m_bWavefront            = false;
+
     ::uint32_t m_uStorageBuffersFlags = 0;
 
-    ::VkShaderModule m_ShaderModule = VK_NULL_HANDLE;
+    ::VkShaderModule m_ShaderModule            = VK_NULL_HANDLE;
+    ::VkShaderModule m_BeamShaderModule        = VK_NULL_HANDLE;
+    ::VkShaderModule m_UpscaleShaderModule     = VK_NULL_HANDLE;
+    ::VkShaderModule m_LightCacheShaderModule  = VK_NULL_HANDLE;
+    ::VkShaderModule m_ObjectCountShaderModule = VK_NULL_HANDLE;
+    ::VkShaderModule m_ObjectScanShaderModule  = VK_NULL_HANDLE;
+    ::VkShaderModule m_ObjectFillShaderModule  = VK_NULL_HANDLE;
+    ::VkShaderModule m_PrimaryShaderModule     = VK_NULL_HANDLE;
+    ::VkShaderModule m_ShadowShaderModule      = VK_NULL_HANDLE;
+    ::VkShaderModule m_ReflectionShaderModule  = VK_NULL_HANDLE;
+    ::VkShaderModule m_ShadeShaderModule       = VK_NULL_HANDLE;
+    ::VkPipeline     m_BeamPipeline            = VK_NULL_HANDLE;
+    ::VkPipeline     m_UpscalePipeline         = VK_NULL_HANDLE;
+    ::VkPipeline     m_LightCachePipeline      = VK_NULL_HANDLE;
+    ::VkPipeline     m_ObjectCountPipeline     = VK_NULL_HANDLE;
+    ::VkPipeline     m_ObjectScanPipeline      = VK_NULL_HANDLE;
+    ::VkPipeline     m_ObjectFillPipeline      = VK_NULL_HANDLE;
 
     ::VkImageView m_ImageView = VK_NULL_HANDLE;
 };
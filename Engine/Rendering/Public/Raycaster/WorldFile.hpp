@@ -0,0 +1,133 @@
+#ifndef B33_WORLD_FILE_H
+#define B33_WORLD_FILE_H
+
+#include "B33Core.h"
+
+#include "Raycaster/VoxelGrid.hpp"
+#include "Synchronization/JobSystem.hpp"
+
+namespace B33::Rendering
+{
+
+/**
+ * @brief Static voxels of a chunk, decoded. Cells are x major, cell 0 is empty, others are solid voxels colored
+ * vPalette[ cell ], vPalette[ 0 ] is unused.
+ */
+struct WorldChunk
+{
+    ::B33::Math::iVec3      Origin   = {};
+    ::B33::Math::iVec3      Extent   = {};
+    ::std::vector<uint32_t> vPalette = {};
+    ::std::vector<uint16_t> vCells   = {};
+};
+
+/**
+ * @brief Persistent CubeWorld: static voxels split into chunks of ChunkDim^3 encoded with a palette, either as a
+ * uniform value, runs or plain indices, whatever is the smallest, plus a table of the objects.
+ *
+ * Open only reads the file, a chunk is decoded the first time it's accessed. Saving encodes and loading decodes
+ * chunks in parallel on the job system.
+ */
+class WorldFile
+{
+  public:
+    static constexpr uint32_t ChunkDim = 16;
+
+  public:
+    BEAST_API WorldFile();
+
+    BEAST_API ~WorldFile();
+
+  public:
+    WorldFile( const WorldFile & )            = delete;
+    WorldFile &operator=( const WorldFile & ) = delete;
+
+    WorldFile( WorldFile && ) noexcept            = default;
+    WorldFile &operator=( WorldFile && ) noexcept = default;
+
+  public:
+    /**
+     * @return False if the file couldn't be written
+     */
+    BEAST_API static bool Save( const ::std::filesystem::path &path,
+                                const CubeWorld              &world,
+                                ::B33::Core::JobSystem       &jobSystem );
+
+    /**
+     * @return False if the file is missing or isn't a compatible world file
+     */
+    BEAST_API bool Open( const ::std::filesystem::path &path );
+
+    BEAST_API void Close();
+
+    bool IsOpen() const
+    {
+        return m_uGridDim != 0;
+    }
+
+  public:
+    /**
+     * @brief Decodes every chunk that wasn't accessed yet straight into the grid and restores the objects. World
+     * has to be freshly created with the same grid width, an upload is requested once at the end.
+     *
+     * @return False if the grid width differs or a chunk is corrupted
+     */
+    BEAST_API bool Load( CubeWorld &world, ::B33::Core::JobSystem &jobSystem );
+
+    /**
+     * @brief Decodes the chunk on the first access, safe to call from many threads.
+     *
+     * @return nullptr if the chunk is corrupted
+     */
+    BEAST_API const WorldChunk *GetChunk( size_t uChunk );
+
+    size_t GetChunkCount() const
+    {
+        return m_vChunks.size();
+    }
+
+    size_t GetGridWidth() const
+    {
+        return m_uGridDim;
+    }
+
+    size_t GetObjectCount() const
+    {
+        return m_vObjects.size();
+    }
+
+  public:
+    struct ChunkRecord
+    {
+        uint64_t uOffset;
+        uint32_t uSize;
+        uint16_t uEncoding;
+        uint16_t uPaletteSize;
+    };
+
+    struct ObjectRecord
+    {
+        float    Position[ 3 ];
+        float    Rotation[ 3 ];
+        float    HalfSize[ 3 ];
+        uint32_t uColor;
+    };
+
+  private:
+    struct LazyChunk
+    {
+        ::std::once_flag Once;
+        WorldChunk       Chunk;
+        bool             bValid = false;
+    };
+
+  private:
+    uint32_t                       m_uGridDim;
+    ::std::vector<ChunkRecord>     m_vChunks;
+    ::std::vector<uint8_t>         m_vChunkData;
+    ::std::vector<ObjectRecord>    m_vObjects;
+    ::std::unique_ptr<LazyChunk[]> m_pDecoded;
+};
+
+} // namespace B33::Rendering
+#endif // !B33_WORLD_FILE_H
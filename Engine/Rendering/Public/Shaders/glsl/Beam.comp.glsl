@@ -0,0 +1,162 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+#include "Common.glsl"
+
+// Every thread marches one conservative cone through the tile of TILE_DIM^2 pixels it covers, the raycast starts
+// the rays of the tile where the cone first may touch something
+layout( local_size_x = 8, local_size_y = 8 ) in;
+
+// Coarser levels of the cells, MipLevels[ l - 1 ] holds the offset, the width and the occupancy offset of level l
+layout( std430, binding = 7 ) readonly buffer VoxelMips
+{
+    uvec4 MipInfo;
+    uvec4 MipLevels[ 6 ];
+    uint  MipColors[];
+};
+
+layout( std430, binding = 8 ) writeonly buffer TileStart
+{
+    float TileStarts[];
+};
+
+layout( push_constant ) uniform PushConstants
+{
+    vec3  CameraPos;
+    uint  _Padding0;
+    ivec3 GridSize;
+    uint  _Padding1;
+    vec3  CameraLookDir;
+    uint  _Padding2;
+    vec3  CameraRight;
+    uint  _Padding3;
+    vec3  CameraUp;
+    uint  _Padding4;
+    float fFov;
+    uint  uDebugMode;
+    uint  uFrame;
+    uint  uRenderExtent;
+};
+
+// Has to match the raycast, the beam can't check cells finer than the level the rays use
+const float lodDistance  = 24.f;
+const int   beamMaxSteps = 48;
+const float beamMargin   = 0.05;
+
+#define TILE_DIM       8
+#define TILE_DIM_SHIFT 3
+#define BEAM_MAX_CELLS 4
+
+// --------------------------------------------------------------------------------------------------------------------
+vec3 TileRay( in const vec2 uv, in const float fAspectRatio, in const float fScale )
+{
+    return normalize( CameraLookDir + uv.x * fAspectRatio * fScale * CameraRight + uv.y * fScale * CameraUp );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Level the raycast uses at the distance t, at most
+int LodLevel( in const float t )
+{
+    return t <= lodDistance ? 0 : int( ceil( log2( t / lodDistance ) ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Returns true if any cell of the level over the box of voxels may hold something. Cells on the border of the grid
+// end the rays of the raycast, so they count as taken, just like the cells outside of it
+bool TestBeamBox( in const vec3 lo, in const vec3 hi, in const int level )
+{
+    const uvec4 levelInfo = MipLevels[ level - 1 ];
+    const ivec3 levelDim  = ivec3( levelInfo.y );
+    const ivec3 cellLo    = ivec3( floor( lo ) ) >> level;
+    const ivec3 cellHi    = ivec3( floor( hi ) ) >> level;
+
+    if ( any( lessThanEqual( cellLo, ivec3( 0 ) ) ) || any( greaterThanEqual( cellHi, levelDim - 1 ) ) ||
+         any( greaterThanEqual( cellHi - cellLo, ivec3( BEAM_MAX_CELLS ) ) ) )
+    {
+        return true;
+    }
+
+    uint uCell;
+    for ( int z = cellLo.z; z <= cellHi.z; ++z )
+    {
+        for ( int y = cellLo.y; y <= cellHi.y; ++y )
+        {
+            for ( int x = cellLo.x; x <= cellHi.x; ++x )
+            {
+                uCell = uint( x + y * levelDim.x + z * levelDim.x * levelDim.y );
+                if ( ( ( MipColors[ levelInfo.z + ( uCell >> 5 ) ] >> ( uCell & 31u ) ) & 1u ) != 0 )
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    const ivec2 tile      = ivec2( gl_GlobalInvocationID.xy );
+    const ivec2 imgSize   = ivec2( uRenderExtent & 0xFFFFu, uRenderExtent >> 16 );
+    const ivec2 tileCount = ( imgSize + TILE_DIM - 1 ) >> TILE_DIM_SHIFT;
+    const uint  uTile     = uint( tile.x + tile.y * tileCount.x );
+
+    if ( any( greaterThanEqual( tile, tileCount ) ) || uTile >= uint( TileStarts.length() ) )
+    {
+        return;
+    }
+
+    const float scale       = tan( fFov * 0.5 );
+    const float aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const vec2  uvLo        = ( vec2( tile << TILE_DIM_SHIFT ) / vec2( imgSize ) ) * 2. - 1.;
+    const vec2  uvHi        = ( vec2( ( tile + 1 ) << TILE_DIM_SHIFT ) / vec2( imgSize ) ) * 2. - 1.;
+    const vec3  axis        = TileRay( ( uvLo + uvHi ) * 0.5, aspectRatio, scale );
+
+    // Rays of the pixels lie between the rays of the tile corners
+    float fCos = 1.;
+    fCos       = min( fCos, dot( axis, TileRay( vec2( uvLo.x, uvLo.y ), aspectRatio, scale ) ) );
+    fCos       = min( fCos, dot( axis, TileRay( vec2( uvHi.x, uvLo.y ), aspectRatio, scale ) ) );
+    fCos       = min( fCos, dot( axis, TileRay( vec2( uvLo.x, uvHi.y ), aspectRatio, scale ) ) );
+    fCos       = min( fCos, dot( axis, TileRay( vec2( uvHi.x, uvHi.y ), aspectRatio, scale ) ) );
+
+    // Ball of the radius t * fSpread around the axis holds every ray of the tile at the distance t
+    const float fSpread   = sqrt( max( 1. - fCos * fCos, 0. ) ) / max( fCos, EPSILON );
+    const int   mipLevels = int( MipInfo.x );
+
+    float t     = 0.;
+    int   level = 1;
+    float fCellSize;
+    float tEnd;
+    float fRadius;
+    vec3  from;
+    vec3  to;
+    for ( int i = 0; i < beamMaxSteps && mipLevels > 0; ++i )
+    {
+        // Segments are a cell long, the level grows until the ball fits a cell and the rays use no coarser one
+        for ( ;; )
+        {
+            fCellSize = float( 1 << level );
+            tEnd      = t + fCellSize;
+            fRadius   = tEnd * fSpread + beamMargin;
+
+            if ( level >= mipLevels || ( fRadius <= fCellSize && LodLevel( tEnd ) <= level ) )
+            {
+                break;
+            }
+
+            ++level;
+        }
+
+        from = CameraPos + axis * t;
+        to   = CameraPos + axis * tEnd;
+        if ( TestBeamBox( min( from, to ) - fRadius, max( from, to ) + fRadius, level ) )
+        {
+            break;
+        }
+
+        t = tEnd;
+    }
+
+    TileStarts[ uTile ] = t;
+}
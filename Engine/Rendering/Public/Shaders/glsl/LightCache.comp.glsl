@@ -0,0 +1,79 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+#include "Math.glsl"
+
+// Every thread resets the cached light of the six faces of a voxel when the path from the face to the light crosses
+// the changed cells, the raycast traces the reset faces again. Only the voxels behind the cells are dispatched
+layout( local_size_x = 4, local_size_y = 4, local_size_z = 4 ) in;
+
+layout( push_constant ) uniform PushConstants
+{
+    vec3  CameraPos;
+    uint  _Padding0;
+    ivec3 GridSize;
+    uint  _Padding1;
+    vec3  CameraLookDir;
+    uint  _Padding2;
+    vec3  CameraRight;
+    uint  _Padding3;
+    vec3  CameraUp;
+    uint  _Padding4;
+    float fFov;
+    uint  uDebugMode;
+    uint  uFrame;
+    uint  uRenderExtent;
+};
+
+// Visibility of the light and the sample count as halfs, six faces per voxel of the grid
+layout( std430, binding = 12 ) writeonly buffer LightCache
+{
+    uint LightFaces[];
+};
+
+// Inclusive box of the cells changed since the last reset and of the voxels the pass runs over
+layout( std430, binding = 13 ) readonly buffer LightChanges
+{
+    ivec4 ChangedMin;
+    ivec4 ChangedMax;
+    ivec4 DispatchMin;
+    ivec4 DispatchMax;
+};
+
+// Has to match the raycast and MarkLightChanges
+const vec3 lightPos = vec3( 20.0, 5.0, 10.0 );
+
+// Soft shadow rays leave the face anywhere and bend a bit, so the box grows to catch them
+// Has to match MarkLightChanges
+const float changesMargin = 2.;
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    const ivec3 voxel = DispatchMin.xyz + ivec3( gl_GlobalInvocationID.xyz );
+
+    if ( any( greaterThan( voxel, DispatchMax.xyz ) ) || any( greaterThanEqual( voxel, GridSize ) ) )
+    {
+        return;
+    }
+
+    const vec3 boxHalfSize = vec3( ChangedMax.xyz - ChangedMin.xyz + 1 ) * 0.5 + changesMargin;
+    const vec3 boxCenter   = vec3( ChangedMin.xyz ) + vec3( ChangedMax.xyz - ChangedMin.xyz + 1 ) * 0.5;
+    const uint uVoxel      = uint( voxel.x + voxel.y * GridSize.x + voxel.z * GridSize.x * GridSize.y );
+
+    vec3  normal;
+    vec3  from;
+    float tMin;
+    float tMax;
+    for ( int i = 0; i < 6; ++i )
+    {
+        normal           = vec3( 0. );
+        normal[ i >> 1 ] = ( i & 1 ) == 0 ? 1. : -1.;
+        from             = vec3( voxel ) + 0.5 + normal * 0.5;
+
+        // Segment from the face to the light, t goes from 0 to 1
+        if ( IntersectRayAABB( from - boxCenter, lightPos - from, boxHalfSize, tMin, tMax ) && tMin <= 1. )
+        {
+            LightFaces[ uVoxel * 6 + uint( i ) ] = 0;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+// Objects are binned into cells of OBJECT_CELL_DIM^3 voxels, every cell lists the objects whose box overlaps it. The
+// count pass sizes the lists, the scan pass places them and the fill pass writes them
+
+#define OBJECT_CELL_DIM   8
+#define OBJECT_CELL_SHIFT 3
+
+layout( std430, binding = 2 ) readonly buffer ObjectPositions
+{
+    vec4 Positions[];
+};
+
+layout( std430, binding = 3 ) readonly buffer ObjectRotations
+{
+    vec4 Rotations[];
+};
+
+layout( std430, binding = 4 ) readonly buffer ObjectHalfSizes
+{
+    vec4 HalfSizes[];
+};
+
+// Cells per axis, object count and capacity of ObjectIds, followed by the start and the length of every list
+layout( std430, binding = 14 ) buffer ObjectCells
+{
+    uvec4 ObjectGridInfo;
+    uvec2 CellRanges[];
+};
+
+layout( std430, binding = 15 ) writeonly buffer ObjectIdLists
+{
+    uint ObjectIds[];
+};
+
+layout( push_constant ) uniform PushConstants
+{
+    vec3  CameraPos;
+    uint  _Padding0;
+    ivec3 GridSize;
+    uint  _Padding1;
+    vec3  CameraLookDir;
+    uint  _Padding2;
+    vec3  CameraRight;
+    uint  _Padding3;
+    vec3  CameraUp;
+    uint  _Padding4;
+    float fFov;
+    uint  uDebugMode;
+    uint  uFrame;
+    uint  uRenderExtent;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// Inclusive range of cells the rotated box of the object overlaps, false if it's removed or outside of the grid
+bool ObjectCellBounds( in const uint uObject, out ivec3 lo, out ivec3 hi )
+{
+    const vec3 halfSize = HalfSizes[ uObject ].xyz;
+
+    lo = ivec3( 0 );
+    hi = ivec3( -1 );
+
+    // Slots of removed objects stay, their size is zero
+    if ( all( equal( halfSize, vec3( 0. ) ) ) )
+    {
+        return false;
+    }
+
+    const mat3 toWorld = transpose( RotationMatrix( Rotations[ uObject ].xyz ) );
+    const vec3 extent  = abs( toWorld[ 0 ] ) * halfSize.x + abs( toWorld[ 1 ] ) * halfSize.y +
+                         abs( toWorld[ 2 ] ) * halfSize.z;
+    const int  iLast   = int( ObjectGridInfo.x ) - 1;
+
+    lo = ivec3( floor( Positions[ uObject ].xyz - extent ) ) >> OBJECT_CELL_SHIFT;
+    hi = ivec3( floor( Positions[ uObject ].xyz + extent ) ) >> OBJECT_CELL_SHIFT;
+
+    if ( any( lessThan( hi, ivec3( 0 ) ) ) || any( greaterThan( lo, ivec3( iLast ) ) ) )
+    {
+        return false;
+    }
+
+    lo = clamp( lo, ivec3( 0 ), ivec3( iLast ) );
+    hi = clamp( hi, ivec3( 0 ), ivec3( iLast ) );
+
+    return true;
+}
@@ -0,0 +1,32 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+#include "Math.glsl"
+#include "ObjectBin.glsl"
+
+// Every thread counts its object into the lists of the cells it overlaps, the lists are zeroed before
+layout( local_size_x = 64 ) in;
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    const uint uObject = gl_GlobalInvocationID.x;
+
+    ivec3 lo;
+    ivec3 hi;
+    if ( uObject >= ObjectGridInfo.y || !ObjectCellBounds( uObject, lo, hi ) )
+    {
+        return;
+    }
+
+    const int iCells = int( ObjectGridInfo.x );
+    for ( int z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int y = lo.y; y <= hi.y; ++y )
+        {
+            for ( int x = lo.x; x <= hi.x; ++x )
+            {
+                atomicAdd( CellRanges[ x + y * iCells + z * iCells * iCells ].y, 1u );
+            }
+        }
+    }
+}
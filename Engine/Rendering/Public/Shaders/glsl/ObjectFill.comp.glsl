@@ -0,0 +1,43 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+#include "Math.glsl"
+#include "ObjectBin.glsl"
+
+// Every thread writes its object into the lists of the cells it overlaps, the scan pass left the lengths at zero so
+// they count the written ids again
+layout( local_size_x = 64 ) in;
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    const uint uObject = gl_GlobalInvocationID.x;
+
+    ivec3 lo;
+    ivec3 hi;
+    if ( uObject >= ObjectGridInfo.y || !ObjectCellBounds( uObject, lo, hi ) )
+    {
+        return;
+    }
+
+    const int iCells = int( ObjectGridInfo.x );
+
+    uint uCell;
+    uint uSlot;
+    for ( int z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int y = lo.y; y <= hi.y; ++y )
+        {
+            for ( int x = lo.x; x <= hi.x; ++x )
+            {
+                uCell = uint( x + y * iCells + z * iCells * iCells );
+                uSlot = CellRanges[ uCell ].x + atomicAdd( CellRanges[ uCell ].y, 1u );
+
+                // Lists past the capacity are cut, the raycast clamps them the same way
+                if ( uSlot < ObjectGridInfo.z )
+                {
+                    ObjectIds[ uSlot ] = uObject;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+#include "Math.glsl"
+#include "ObjectBin.glsl"
+
+// Single group turns the lengths of the lists into their starts, every thread sums a run of cells and the runs are
+// scanned in shared memory
+#define SCAN_THREADS 256
+
+layout( local_size_x = SCAN_THREADS ) in;
+
+shared uint runSums[ SCAN_THREADS ];
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    const uint uThread    = gl_LocalInvocationIndex;
+    const uint uCellCount = ObjectGridInfo.x * ObjectGridInfo.x * ObjectGridInfo.x;
+    const uint uRun       = ( uCellCount + SCAN_THREADS - 1 ) / SCAN_THREADS;
+    const uint uFirst     = min( uThread * uRun, uCellCount );
+    const uint uEnd       = min( uFirst + uRun, uCellCount );
+
+    uint uSum = 0;
+    for ( uint c = uFirst; c < uEnd; ++c )
+    {
+        uSum += CellRanges[ c ].y;
+    }
+
+    runSums[ uThread ] = uSum;
+    memoryBarrierShared();
+    barrier();
+
+    uint uAdd;
+    for ( uint uOffset = 1; uOffset < SCAN_THREADS; uOffset <<= 1 )
+    {
+        uAdd = uThread >= uOffset ? runSums[ uThread - uOffset ] : 0;
+        memoryBarrierShared();
+        barrier();
+
+        runSums[ uThread ] += uAdd;
+        memoryBarrierShared();
+        barrier();
+    }
+
+    // Lengths are zeroed, the fill pass counts them again while it writes
+    uint uStart = runSums[ uThread ] - uSum;
+    uint uLength;
+    for ( uint c = uFirst; c < uEnd; ++c )
+    {
+        uLength         = CellRanges[ c ].y;
+        CellRanges[ c ] = uvec2( uStart, 0 );
+        uStart         += uLength;
+    }
+}
@@ -0,0 +1,1043 @@
+// Traversal and shading of the raycast, shared with the passes of the wavefront mode. Shaders declare their group
+// size before they include it, the tile cache reads it
+
+#include "Colors.glsl"
+#include "Common.glsl"
+#include "Math.glsl"
+#include "Random.glsl"
+
+struct Voxel
+{
+    uint Type;
+    uint Color;
+    uint Id[ 26 ];
+};
+
+struct CubeColored
+{
+    Cube  Geometry;
+    uint  Color;
+    float Reflection;
+    float Roughness;
+    uint  _Padding;
+};
+
+// Variants of the shader the pipeline specializes, the ids have to match RaycastVariant
+layout( constant_id = 0 ) const uint  debugView         = 0;
+layout( constant_id = 1 ) const int   shadowSamples     = 1;
+layout( constant_id = 2 ) const uint  reflectionBounces = 1;
+layout( constant_id = 3 ) const float maxRenderDist     = 224.f;
+layout( constant_id = 4 ) const int   maxSteps          = 160;
+layout( constant_id = 7 ) const uint  tileCache         = 0;
+
+layout( binding = 0, rgba8 ) uniform image2D outputImage;
+
+layout( std430, binding = 1 ) readonly buffer Voxels
+{
+    Voxel VoxelData[];
+};
+
+layout( std430, binding = 2 ) readonly buffer ObjectPositions
+{
+    vec4 Positions[];
+};
+
+layout( std430, binding = 3 ) readonly buffer ObjectRotations
+{
+    vec4 Rotations[];
+};
+
+layout( std430, binding = 4 ) readonly buffer ObjectHalfSizes
+{
+    vec4 HalfSizes[];
+};
+
+// Maps every chunk of a window around the camera to its slot in ChunkSlots
+layout( std430, binding = 5 ) readonly buffer ChunkTable
+{
+    ivec4 WindowOrigin;
+    ivec4 WindowDim;
+    uint  Slots[];
+};
+
+layout( std430, binding = 6 ) readonly buffer ChunkSlots
+{
+    uint SlotColors[];
+};
+
+// Coarser levels of the static voxels, MipLevels[ l - 1 ] holds the offset and the width of level l
+layout( std430, binding = 7 ) readonly buffer VoxelMips
+{
+    uvec4 MipInfo;
+    uvec4 MipLevels[ 6 ];
+    uint  MipColors[];
+};
+
+// Distance every tile of TILE_DIM^2 pixels is empty for, written by the beam pass
+layout( std430, binding = 8 ) readonly buffer TileStart
+{
+    float TileStarts[];
+};
+
+layout( push_constant ) uniform PushConstants
+{
+    vec3  CameraPos;
+    uint  _Padding0;
+    ivec3 GridSize;
+    uint  _Padding1;
+    vec3  CameraLookDir;
+    uint  _Padding2;
+    vec3  CameraRight;
+    uint  _Padding3;
+    vec3  CameraUp;
+    uint  _Padding4;
+    float fFov;
+    uint  uDebugMode;
+    uint  uFrame;
+    uint  uRenderExtent;
+};
+
+// Two halves of the accumulated color and history length as halfs, the normal and the distance of every pixel, the
+// frame writes the half ( uFrame & 1 ) and reads the other one
+layout( std430, binding = 9 ) buffer History
+{
+    uvec4 HistoryPixels[];
+};
+
+// Push constants of the previous frame, the history is reprojected with them
+layout( std430, binding = 10 ) readonly buffer PreviousFrame
+{
+    vec3  PrevCameraPos;
+    uint  _PrevPadding0;
+    ivec3 PrevGridSize;
+    uint  _PrevPadding1;
+    vec3  PrevCameraLookDir;
+    uint  _PrevPadding2;
+    vec3  PrevCameraRight;
+    uint  _PrevPadding3;
+    vec3  PrevCameraUp;
+    uint  _PrevPadding4;
+    float fPrevFov;
+    uint  uPrevDebugMode;
+    uint  uPrevFrame;
+    uint  _PrevPadding7;
+};
+
+// Visibility of the light and the sample count as halfs, six faces per voxel of the grid. The light cache pass resets
+// faces the changed cells may shadow, the raycast refines them until they have lightCacheSamples samples
+layout( std430, binding = 12 ) buffer LightCache
+{
+    uint LightFaces[];
+};
+
+// Objects binned into cells of OBJECT_CELL_DIM^3 voxels, cells per axis, object count and capacity of ObjectIds
+// followed by the start and the length of the list of every cell
+layout( std430, binding = 14 ) readonly buffer ObjectCells
+{
+    uvec4 ObjectGridInfo;
+    uvec2 CellRanges[];
+};
+
+layout( std430, binding = 15 ) readonly buffer ObjectIdLists
+{
+    uint ObjectIds[];
+};
+
+const vec4  baseSkyColor          = vec4( .4078, .4725, 1., 1. );
+const vec3  lightPos              = vec3( 20.0, 5.0, 10.0 );
+const vec3  lightColor            = vec3( 1., 1., 1. );
+const float lodDistance           = 24.f;
+const float phongAmbientStrength  = 0.01;
+const float phongDiffuseStrength  = 0.8;
+const float phongSpecularStrength = 0.8;
+const float phongShininess        = 512.0;
+const float historyMaxFrames      = 16.;
+const float historyDepthTolerance = 0.05;
+const float historyNormalMinCos   = 0.9;
+const float lightCacheSamples     = 16.;
+
+#define LAST_UNKNOWN_AXIS -1
+#define LAST_X_AXIS       0
+#define LAST_Y_AXIS       1
+#define LAST_Z_AXIS       2
+
+#define HIT_TYPE_UNKNOWN  0
+#define HIT_TYPE_VOXEL    -1
+#define HIT_TYPE_OBJECT   1
+#define HIT_TYPE_STREAMED 2
+#define HIT_TYPE_MIP      3
+
+#define CHUNK_DIM        16
+#define CHUNK_DIM_SHIFT  4
+#define CHUNK_VOXELS     4096
+#define CHUNK_SLOT_EMPTY 0xFFFFFFFEu
+
+#define TILE_DIM       8
+#define TILE_DIM_SHIFT 3
+
+#define OBJECT_CELL_SHIFT 3
+
+#define TILE_CACHE_DIM   16
+#define TILE_CACHE_SHIFT 4
+#define TILE_CACHE_WORDS 128
+
+// Occupancy of the brick of TILE_CACHE_DIM^3 voxels the primary rays of the workgroup enter first, a bit per voxel
+shared uint TileOccupancy[ TILE_CACHE_WORDS ];
+
+// First voxel of the brick, the same for every invocation of the workgroup
+ivec3 tileCacheOrigin = ivec3( 0 );
+
+// --------------------------------------------------------------------------------------------------------------------
+// Seed of the random directions, it changes every frame so the accumulated samples don't repeat
+vec2 FrameSeed()
+{
+    return vec2( 12.9898, 78.233 ) + float( uFrame % 64 ) * vec2( 0.7548777, 0.5698403 );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Returns -1 outside of the streamed window, 0 for empty voxels or chunks that aren't resident yet and 1 for a hit
+int TestStreamedVoxel( in const ivec3 voxel, out uint uColorIndex )
+{
+    const ivec3 chunk = ( voxel >> CHUNK_DIM_SHIFT ) - WindowOrigin.xyz;
+    if ( any( lessThan( chunk, ivec3( 0 ) ) ) || any( greaterThanEqual( chunk, WindowDim.xyz ) ) )
+    {
+        return -1;
+    }
+
+    const uint uSlot = Slots[ chunk.x + chunk.y * WindowDim.x + chunk.z * WindowDim.x * WindowDim.y ];
+    if ( uSlot >= CHUNK_SLOT_EMPTY )
+    {
+        return 0;
+    }
+
+    const ivec3 local = voxel & ( CHUNK_DIM - 1 );
+    uColorIndex       = uSlot * CHUNK_VOXELS + uint( local.x + local.y * CHUNK_DIM + local.z * CHUNK_DIM * CHUNK_DIM );
+
+    return SlotColors[ uColorIndex ] != 0 ? 1 : 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Returns true if the voxel of the brick is taken, voxels outside of the brick go to VoxelData
+bool TestTileCache( in const ivec3 voxel, out bool bTaken )
+{
+    const ivec3 local = voxel - tileCacheOrigin;
+    if ( any( greaterThanEqual( uvec3( local ), uvec3( TILE_CACHE_DIM ) ) ) )
+    {
+        return false;
+    }
+
+    const uint uBit = uint( local.x + ( local.y << TILE_CACHE_SHIFT ) + ( local.z << ( 2 * TILE_CACHE_SHIFT ) ) );
+    bTaken          = ( ( TileOccupancy[ uBit >> 5 ] >> ( uBit & 31u ) ) & 1u ) != 0;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+bool RayIntersectsAABB( in const vec3 ro,
+                        in const vec3 rd,
+                        in const uint uIndexCube,
+                        out float     fHitMin,
+                        out float     fHitMax,
+                        out vec3      normal )
+{
+    const mat3 cubeRot = RotationMatrix( Rotations[ uIndexCube ].xyz );
+    const vec3 lro     = cubeRot * ( ro - Positions[ uIndexCube ].xyz );
+    const vec3 lrd     = cubeRot * rd;
+
+    if ( !IntersectRayAABB( lro, lrd, HalfSizes[ uIndexCube ].xyz, fHitMin, fHitMax ) )
+    {
+        return false;
+    }
+
+    normal = normalize( transpose( cubeRot ) * CubeNormal( lro + lrd * fHitMin, HalfSizes[ uIndexCube ].xyz ) );
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Starts the traversal of cells of 2^level voxels at the distance t along the ray
+void StartTraversal( in const vec3  ro,
+                     in const vec3  rd,
+                     in const float t,
+                     in const int   level,
+                     out ivec3      cell,
+                     out vec3       tMax,
+                     out vec3       tDelta )
+{
+    const float fCellSize = float( 1 << level );
+    const vec3  pos       = ( ro + rd * t ) / fCellSize;
+
+    cell   = ivec3( floor( pos ) );
+    tDelta = abs( fCellSize / rd );
+
+    float offset;
+    for ( int i = 0; i < 3; ++i )
+    {
+        offset    = rd[ i ] > 0.0 ? 1.0 - fract( pos[ i ] ) : fract( pos[ i ] );
+        tMax[ i ] = t + tDelta[ i ] * offset;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Walks the cells of the object grid along the ray and returns the closest object it hits. Lists of a cell are only
+// tested once the ray gets there, a hit inside of the cell ends the walk
+bool TestObjectGrid( in const vec3 ro, in const vec3 rd, out uint uHitIndex, out float fDistance, out vec3 normal )
+{
+    fDistance = INF;
+
+    const int iCells = int( ObjectGridInfo.x );
+    if ( ObjectGridInfo.y == 0 )
+    {
+        return false;
+    }
+
+    const vec3 gridHalfSize = vec3( iCells << OBJECT_CELL_SHIFT ) * 0.5;
+
+    float tEnter;
+    float tExit;
+    if ( !IntersectRayAABB( ro - gridHalfSize, rd, gridHalfSize, tEnter, tExit ) )
+    {
+        return false;
+    }
+
+    ivec3 cell;
+    vec3  tMax;
+    vec3  tDelta;
+    StartTraversal( ro, rd, max( tEnter, 0. ) + EPSILON, OBJECT_CELL_SHIFT, cell, tMax, tDelta );
+
+    const ivec3 step = ivec3( sign( rd ) );
+
+    uvec2 range;
+    uint  uId;
+    float fHitMin;
+    float fHitMax;
+    vec3  hitNormal;
+    for ( int i = 0; i < 3 * iCells; ++i )
+    {
+        if ( any( lessThan( cell, ivec3( 0 ) ) ) || any( greaterThanEqual( cell, ivec3( iCells ) ) ) )
+        {
+            break;
+        }
+
+        range   = CellRanges[ cell.x + cell.y * iCells + cell.z * iCells * iCells ];
+        range.y = min( range.y, ObjectGridInfo.z - min( range.x, ObjectGridInfo.z ) );
+
+        for ( uint k = range.x; k < range.x + range.y; ++k )
+        {
+            uId = ObjectIds[ k ];
+
+            // Object position is in oposite direction (more then 90 degrees)
+            if ( dot( rd, Positions[ uId ].xyz - ro ) < 0. )
+                continue;
+
+            if ( RayIntersectsAABB( ro, rd, uId, fHitMin, fHitMax, hitNormal ) && fHitMin < fDistance &&
+                 fHitMin >= EPSILON )
+            {
+                uHitIndex = uId;
+                fDistance = fHitMin;
+                normal    = hitNormal;
+            }
+        }
+
+        // Cells further along can't hold anything closer
+        if ( fDistance <= min( tMax.x, min( tMax.y, tMax.z ) ) )
+        {
+            break;
+        }
+
+        if ( tMax.x < tMax.y && tMax.x < tMax.z )
+        {
+            cell.x += step.x;
+            tMax.x += tDelta.x;
+        }
+        else if ( tMax.y < tMax.z )
+        {
+            cell.y += step.y;
+            tMax.y += tDelta.y;
+        }
+        else
+        {
+            cell.z += step.z;
+            tMax.z += tDelta.z;
+        }
+    }
+
+    return fDistance != INF;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+bool MarchTheRay( in const vec3  ro,
+                  in const vec3  rd,
+                  in const float tStart,
+                  in const int   maxSteps,
+                  in const bool  bTileCache,
+                  out vec3       hitCoords,
+                  out uint       hitIndex,
+                  out float      fDistance,
+                  out vec3       normal,
+                  out int        hitType )
+{
+    ivec3 voxel;
+    ivec3 step = ivec3( sign( rd ) );
+    vec3  tDelta;
+    vec3  tMax;
+
+    // Every level is used for twice the distance of the previous one with cells twice as big, so the steps per
+    // level stay the same however far the ray goes
+    const int mipLevels   = int( MipInfo.x );
+    int       level       = 0;
+    float     t           = tStart;
+    float     fNextLevel  = lodDistance;
+    ivec3     levelDim    = GridSize;
+    uint      levelOffset = 0;
+
+    // Rays starting further away start on the level they would have reached by then
+    while ( t > fNextLevel && level < mipLevels )
+    {
+        ++level;
+        fNextLevel  *= 2.;
+        levelOffset  = MipLevels[ level - 1 ].x;
+        levelDim     = ivec3( MipLevels[ level - 1 ].y );
+    }
+
+    StartTraversal( ro, rd, t, level, voxel, tMax, tDelta );
+
+    int lastStepAxis = LAST_UNKNOWN_AXIS;
+    if ( t > 0. )
+    {
+        // Face the ray entered the first cell through, the last boundary it crossed
+        const vec3 tEntry = tMax - tDelta;
+        if ( tEntry.x > tEntry.y && tEntry.x > tEntry.z )
+        {
+            lastStepAxis = LAST_X_AXIS;
+        }
+        else if ( tEntry.y > tEntry.z )
+        {
+            lastStepAxis = LAST_Y_AXIS;
+        }
+        else
+        {
+            lastStepAxis = LAST_Z_AXIS;
+        }
+    }
+
+    // Closest object ends the march once the ray gets past it, the ids listed in the voxels are left to the CPU
+    uint  uObjectIndex;
+    float fObjectDistance;
+    vec3  objectNormal;
+    TestObjectGrid( ro, rd, uObjectIndex, fObjectDistance, objectNormal );
+
+    int  index;
+    uint testedVoxel;
+    int  streamedHit;
+    uint uColorIndex;
+    bool bTaken;
+    bool stepX;
+    bool stepY;
+    for ( int stepCount = 0; stepCount < maxSteps; ++stepCount )
+    {
+        if ( t >= fObjectDistance )
+        {
+            break;
+        }
+
+        if ( t > fNextLevel && level < mipLevels )
+        {
+            ++level;
+            fNextLevel  *= 2.;
+            levelOffset  = MipLevels[ level - 1 ].x;
+            levelDim     = ivec3( MipLevels[ level - 1 ].y );
+
+            StartTraversal( ro, rd, t + EPSILON, level, voxel, tMax, tDelta );
+        }
+
+        if ( level > 0 )
+        {
+            if ( all( greaterThanEqual( voxel, ivec3( 0 ) ) ) && all( lessThan( voxel, levelDim ) ) )
+            {
+                index = int( levelOffset ) + voxel.x + voxel.y * levelDim.x + voxel.z * levelDim.x * levelDim.y;
+
+                if ( MipColors[ index ] != 0 )
+                {
+                    fDistance              = t;
+                    normal                 = vec3( 0. );
+                    normal[ lastStepAxis ] = -float( step[ lastStepAxis ] );
+
+                    hitIndex  = index;
+                    hitCoords = ro + rd * fDistance;
+                    hitType   = HIT_TYPE_MIP;
+
+                    return true;
+                }
+            }
+            else
+            {
+                // Coarse cells outside of the grid sample the streamed voxel in their corner
+                streamedHit = TestStreamedVoxel( voxel << level, uColorIndex );
+                if ( streamedHit < 0 )
+                {
+                    return false;
+                }
+                if ( streamedHit > 0 )
+                {
+                    fDistance              = t;
+                    normal                 = vec3( 0. );
+                    normal[ lastStepAxis ] = -float( step[ lastStepAxis ] );
+
+                    hitIndex  = uColorIndex;
+                    hitCoords = ro + rd * fDistance;
+                    hitType   = HIT_TYPE_STREAMED;
+
+                    return true;
+                }
+            }
+
+            testedVoxel = HIT_TYPE_UNKNOWN;
+        }
+        else if ( voxel.x <= 0 || voxel.x >= GridSize.x || voxel.y <= 0 || voxel.y >= GridSize.y || voxel.z <= 0 ||
+                  voxel.z >= GridSize.z )
+        {
+            // Outside of the grid the world continues with the streamed chunks
+            streamedHit = TestStreamedVoxel( voxel, uColorIndex );
+            if ( streamedHit < 0 )
+            {
+                return false;
+            }
+            if ( streamedHit > 0 )
+            {
+                fDistance              = t;
+                normal                 = vec3( 0. );
+                normal[ lastStepAxis ] = -float( step[ lastStepAxis ] );
+
+                hitIndex  = uColorIndex;
+                hitCoords = ro + rd * fDistance;
+                hitType   = HIT_TYPE_STREAMED;
+
+                return true;
+            }
+
+            testedVoxel = HIT_TYPE_UNKNOWN;
+        }
+        else
+        {
+            index = voxel.x + voxel.y * GridSize.x + voxel.z * GridSize.x * GridSize.y;
+
+            // Check for hits, primary rays of the workgroup read the brick they share first
+            if ( tileCache == 1 && bTileCache && TestTileCache( voxel, bTaken ) )
+            {
+                testedVoxel = bTaken ? uint( HIT_TYPE_VOXEL ) : uint( HIT_TYPE_UNKNOWN );
+            }
+            else
+            {
+                testedVoxel = VoxelData[ index ].Type;
+            }
+        }
+
+        if ( testedVoxel == uint( HIT_TYPE_VOXEL ) )
+        {
+            fDistance              = t;
+            normal                 = vec3( 0. );
+            normal[ lastStepAxis ] = -float( step[ lastStepAxis ] );
+
+            hitIndex  = index;
+            hitCoords = ro + rd * fDistance;
+            hitType   = HIT_TYPE_VOXEL;
+
+            return true;
+        }
+        if ( debugView == 1 && testedVoxel > HIT_TYPE_UNKNOWN && testedVoxel < uint( HIT_TYPE_VOXEL ) )
+        {
+            fDistance              = t;
+            normal                 = vec3( 0. );
+            normal[ lastStepAxis ] = -float( step[ lastStepAxis ] );
+
+            hitIndex  = index;
+            hitCoords = ro + rd * fDistance;
+            hitType   = HIT_TYPE_VOXEL;
+
+            return true;
+        }
+        // Move the ray, t is where the ray enters the next cell
+        stepX = ( tMax.x < tMax.y ) && ( tMax.x < tMax.z );
+        stepY = ( tMax.y < tMax.z );
+
+        if ( stepX )
+        {
+            t = tMax.x;
+            voxel.x += step.x;
+            tMax.x += tDelta.x;
+            lastStepAxis = LAST_X_AXIS;
+            continue;
+        }
+        if ( stepY )
+        {
+            t = tMax.y;
+            voxel.y += step.y;
+            tMax.y += tDelta.y;
+            lastStepAxis = LAST_Y_AXIS;
+            continue;
+        }
+        t = tMax.z;
+        voxel.z += step.z;
+        tMax.z += tDelta.z;
+        lastStepAxis = LAST_Z_AXIS;
+    }
+
+    if ( t < fObjectDistance )
+    {
+        return false;
+    }
+
+    fDistance = fObjectDistance;
+    normal    = objectNormal;
+    hitIndex  = uObjectIndex;
+    hitCoords = ro + rd * fDistance;
+    hitType   = HIT_TYPE_OBJECT;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+bool ShadowRay( in const vec3 from, in const vec3 to, in const int maxDistance )
+{
+    const vec3 dir = normalize( to - from );
+    vec3       dummyHit;
+    uint       dummyIndex;
+    vec3       dummyNormal;
+    float      dummyDistance;
+    int        dummyHitType;
+
+    return MarchTheRay( from + dir * EPSILON,
+                        dir,
+                        0.,
+                        maxDistance,
+                        false,
+                        dummyHit,
+                        dummyIndex,
+                        dummyDistance,
+                        dummyNormal,
+                        dummyHitType );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+float SoftShadowRay( in const vec3 from, in const vec3 to, in const vec3 normal, in const int maxDistance )
+{
+    const float r       = 0.5;
+    const float samples = float( shadowSamples );
+
+    vec3  dir = normalize( to - from );
+    vec3  dummyHit;
+    uint  dummyIndex;
+    vec3  dummyNormal;
+    float dummyDistance;
+    int   dummyHitType;
+    float shadow = 1. + phongAmbientStrength;
+
+    const float sampleStep  = TWO_PI / samples;
+    const float mixFactor   = 0.015;
+    const float shadowConst = 1. / samples;
+
+    // Samples turn a bit every frame, the history accumulates them into the penumbra
+    const float fRotation = fract( Random( vec2( gl_GlobalInvocationID.xy ) ) + float( uFrame ) * 0.618034 );
+
+    float angle;
+    vec3  offset;
+    for ( int i = 0; i < shadowSamples; ++i )
+    {
+        angle  = ( float( i ) + fRotation ) * sampleStep;
+        offset = vec3( cos( angle ), sin( angle ), 0.0 ) * r;
+
+        dir = normalize( to + offset - from );
+        dir = mix( dir, RandomPointOnHemisphere( normal, FrameSeed() ), mixFactor );
+
+        if ( MarchTheRay( from + dir * EPSILON,
+                          dir,
+                          0.,
+                          maxDistance,
+                          false,
+                          dummyHit,
+                          dummyIndex,
+                          dummyDistance,
+                          dummyNormal,
+                          dummyHitType ) )
+        {
+            shadow -= shadowConst;
+        }
+    }
+
+    return shadow;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+vec3 Phong( in const vec3 camPos, in const vec3 pos, in const vec3 normal, in const int maxDistance )
+{
+    const float ambientStrength  = 0.1;
+    const float diffuseStrength  = 0.9;
+    const float specularStrength = 0.4;
+    const float shininess        = 256.0;
+
+    vec3 lightDir   = normalize( lightPos - pos );
+    vec3 viewDir    = normalize( camPos - pos );
+    vec3 reflectDir = normalize( lightDir + viewDir );
+
+    float diff = max( dot( normal, lightDir ), 0.0 );
+    float spec = pow( max( dot( normal, reflectDir ), 0.0 ), shininess );
+
+    vec3 ambient  = ambientStrength * lightColor;
+    vec3 diffuse  = diffuseStrength * diff * lightColor;
+    vec3 specular = specularStrength * spec * lightColor;
+
+    return ambient + diffuse + specular;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+vec3 PhongShadows( in const vec3 camPos, in const vec3 pos, in const vec3 normal, in const int maxDistance )
+{
+    vec3 lightDir   = normalize( lightPos - pos );
+    vec3 viewDir    = normalize( camPos - pos );
+    vec3 reflectDir = normalize( lightDir + viewDir );
+
+    float diff   = max( dot( normal, lightDir ), 0.0 );
+    float spec   = pow( max( dot( normal, reflectDir ), 0.0 ), phongShininess );
+    float shadow = ShadowRay( pos, lightPos, int( maxDistance ) ) ? 0.05 : 1.0;
+
+    vec3 ambient  = phongAmbientStrength * lightColor;
+    vec3 diffuse  = phongDiffuseStrength * diff * lightColor * shadow;
+    vec3 specular = phongSpecularStrength * spec * lightColor * shadow;
+
+    return ambient + diffuse + specular;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Face of the voxel the axis aligned normal points out of, has to match the light cache pass
+uint FaceIndex( in const vec3 normal )
+{
+    const vec3 axis = abs( normal );
+    const int  i    = axis.x > 0.5 ? 0 : ( axis.y > 0.5 ? 1 : 2 );
+
+    return uint( i * 2 + ( normal[ i ] < 0. ? 1 : 0 ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Soft shadow of a hit, faces of the static voxels come from the cache. Faces that don't have enough samples yet trace
+// one more, only bRefine adds it to the cache, shorter rays would skew it
+float HitShadow( in const int  hitType,
+                 in const uint uIndex,
+                 in const vec3 pos,
+                 in const vec3 normal,
+                 in const int  maxDistance,
+                 in const bool bRefine )
+{
+    const uint uFace = uIndex * 6 + FaceIndex( normal );
+
+    if ( hitType != HIT_TYPE_VOXEL || uFace >= uint( LightFaces.length() ) )
+    {
+        return SoftShadowRay( pos, lightPos, normal, maxDistance );
+    }
+
+    const vec2 cached = unpackHalf2x16( LightFaces[ uFace ] );
+    if ( cached.y >= lightCacheSamples )
+    {
+        return cached.x;
+    }
+
+    const float fShadow = SoftShadowRay( pos, lightPos, normal, maxDistance );
+    if ( !bRefine )
+    {
+        return fShadow;
+    }
+
+    // Pixels of the same face race here, a lost sample only delays the cache by a frame
+    const float fCount    = cached.y + 1.;
+    const float fResolved = mix( cached.x, fShadow, 1. / fCount );
+
+    LightFaces[ uFace ] = packHalf2x16( vec2( fResolved, fCount ) );
+
+    return fResolved;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+vec3 PhongShadowed( in const vec3 camPos, in const vec3 pos, in const vec3 normal, in const float shadow )
+{
+    vec3 lightDir   = normalize( lightPos - pos );
+    vec3 viewDir    = normalize( camPos - pos );
+    vec3 reflectDir = normalize( lightDir + viewDir );
+
+    float diff = max( dot( normal, lightDir ), 0.0 );
+    float spec = pow( max( dot( normal, reflectDir ), 0.0 ), phongShininess );
+
+    vec3 ambient  = phongAmbientStrength * lightColor;
+    vec3 diffuse  = phongDiffuseStrength * diff * lightColor * shadow;
+    vec3 specular = phongSpecularStrength * spec * lightColor * shadow;
+
+    return ambient + diffuse + specular;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Color, reflection power and roughness of the surface a primary ray hit
+vec4 HitMaterial( in const int hitType, in const uint uIndex, out float reflectionPower, out float fRoughness )
+{
+    reflectionPower = 0.;
+    fRoughness      = 0.;
+
+    if ( hitType == HIT_TYPE_VOXEL )
+    {
+        reflectionPower = 0.1;
+        return ExtractColorInt( 0x0000FFFF );
+    }
+    if ( hitType == HIT_TYPE_OBJECT )
+    {
+        // FIXME: return ExtractColorInt( CubeData[ uIndex ].Color );
+        reflectionPower = 0.25;
+        fRoughness      = 0.08;
+        return ExtractColorInt( 0xFFFFFFFF );
+    }
+    if ( hitType == HIT_TYPE_STREAMED )
+    {
+        reflectionPower = 0.1;
+        return ExtractColorInt( SlotColors[ uIndex ] );
+    }
+    if ( hitType == HIT_TYPE_MIP )
+    {
+        reflectionPower = 0.1;
+        return ExtractColorInt( MipColors[ uIndex ] );
+    }
+
+    return baseSkyColor;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Light the bounces add to the surface, every bounce blends over the color of the surface before it. The reflection is
+// the color of the surface times fBaseWeight plus the returned light
+vec3 ReflectionLight( in vec3       from,
+                      in vec3       to,
+                      in int        maxSteps,
+                      in const uint bounces,
+                      in vec3       normal,
+                      in float      fMaterialReflectPower,
+                      in float      fRoughness,
+                      out float     fBaseWeight )
+{
+    vec3  dir;
+    vec3  hit;
+    uint  index;
+    float fDistance = 1.;
+    vec3  normalRef;
+    int   hitType;
+
+    vec3  incident;
+    float fShadow;
+    float fLocalReflect;
+    vec3  reflectedColor = vec3( 0. );
+    vec4  hitBaseColor;
+
+    fBaseWeight = 1.;
+
+    for ( uint i = 0; i < bounces; ++i )
+    {
+        if ( fMaterialReflectPower <= 0.0 )
+            break;
+
+        dir = reflect( normalize( to - from ), normal );
+        dir = mix( dir, RandomPointOnHemisphere( normal, FrameSeed() ), fRoughness * fDistance * 0.25 );
+
+        if ( !MarchTheRay( to + dir * EPSILON, dir, 0., maxSteps, false, hit, index, fDistance, normalRef, hitType ) )
+        {
+            reflectedColor  = mix( reflectedColor, baseSkyColor.xyz, fMaterialReflectPower );
+            fBaseWeight    *= 1. - fMaterialReflectPower;
+            return reflectedColor;
+        }
+
+        from   = to;
+        to     = hit;
+        normal = normalRef;
+
+        if ( hitType == HIT_TYPE_VOXEL )
+        {
+            hitBaseColor  = ExtractColorInt( VoxelData[ index ].Color );
+            fLocalReflect = 0.1;
+            fRoughness    = 0.0;
+        }
+        if ( hitType == HIT_TYPE_OBJECT )
+        {
+            // FIXME: CubeColored c = CubeData[index];
+            hitBaseColor  = ExtractColorInt( 0xFFFFFFFF );
+            fLocalReflect = 0.25;
+            fRoughness    = 0.08;
+        }
+        if ( hitType == HIT_TYPE_STREAMED )
+        {
+            hitBaseColor  = ExtractColorInt( SlotColors[ index ] );
+            fLocalReflect = 0.1;
+            fRoughness    = 0.0;
+        }
+        if ( hitType == HIT_TYPE_MIP )
+        {
+            hitBaseColor  = ExtractColorInt( MipColors[ index ] );
+            fLocalReflect = 0.1;
+            fRoughness    = 0.0;
+        }
+
+        fShadow        = HitShadow( hitType, index, hit, normal, int( maxSteps * 0.25 ), false );
+        reflectedColor = mix( reflectedColor,
+                              PhongShadowed( CameraPos.xyz, hit, normal, fShadow ) * hitBaseColor.xyz,
+                              fMaterialReflectPower );
+        fBaseWeight   *= 1. - fMaterialReflectPower;
+
+        fMaterialReflectPower *= fLocalReflect * 2;
+        maxSteps = maxSteps / 2;
+    }
+
+    return reflectedColor;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+vec3 Reflection( in const vec3  from,
+                 in const vec3  to,
+                 in const int   maxSteps,
+                 in const uint  bounces,
+                 in const vec3  baseColor,
+                 in const vec3  normal,
+                 in const float fMaterialReflectPower,
+                 in const float fRoughness )
+{
+    float      fBaseWeight;
+    const vec3 light =
+        ReflectionLight( from, to, maxSteps, bounces, normal, fMaterialReflectPower, fRoughness, fBaseWeight );
+
+    return baseColor * fBaseWeight + light;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Projects the point with the camera of the previous frame, false if it was behind it or off the screen
+bool ReprojectPoint( in const vec3 pos, in const ivec2 imgSize, out ivec2 prevPixel, out float fPrevDistance )
+{
+    const vec3  toPos  = pos - PrevCameraPos;
+    const float fDepth = dot( toPos, PrevCameraLookDir );
+
+    prevPixel     = ivec2( 0 );
+    fPrevDistance = length( toPos );
+
+    if ( fDepth <= EPSILON )
+    {
+        return false;
+    }
+
+    const float scale       = tan( fPrevFov * 0.5 );
+    const float aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const vec2  uv          = vec2( dot( toPos, PrevCameraRight ) / ( fDepth * aspectRatio * scale ),
+                              dot( toPos, PrevCameraUp ) / ( fDepth * scale ) );
+
+    prevPixel = ivec2( floor( ( uv * 0.5 + 0.5 ) * vec2( imgSize ) ) );
+
+    return all( greaterThanEqual( prevPixel, ivec2( 0 ) ) ) && all( lessThan( prevPixel, imgSize ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Blends the color with the previous frames seen by the pixel and stores the result. History of the previous frame is
+// dropped when its distance or normal don't match the hit, the surface wasn't visible there. Misses only reset it
+vec3 ResolveHistory( in const ivec2 pixel,
+                     in const ivec2 imgSize,
+                     in const vec3  color,
+                     in const bool  bHit,
+                     in const vec3  hitPos,
+                     in const vec3  normal )
+{
+    const uint uHalf     = uint( HistoryPixels.length() ) / 2;
+    const uint uCurrent  = ( uFrame & 1u ) * uHalf;
+    const uint uPrevious = uHalf - uCurrent;
+    const uint uPixel    = uint( pixel.x + pixel.y * imgSize.x );
+
+    if ( uPixel >= uHalf )
+    {
+        return color;
+    }
+
+    vec3  resolved = color;
+    float fCount   = 1.;
+
+    ivec2 prevPixel;
+    float fPrevDistance;
+    uvec4 history;
+    vec2  historyBlue;
+    float fHistoryDistance;
+    if ( bHit && uFrame != 0 && ReprojectPoint( hitPos, imgSize, prevPixel, fPrevDistance ) )
+    {
+        history          = HistoryPixels[ uPrevious + uint( prevPixel.x + prevPixel.y * imgSize.x ) ];
+        historyBlue      = unpackHalf2x16( history.y );
+        fHistoryDistance = uintBitsToFloat( history.w );
+
+        if ( fHistoryDistance >= 0. &&
+             abs( fHistoryDistance - fPrevDistance ) <= historyDepthTolerance * fPrevDistance + 0.1 &&
+             dot( unpackSnorm4x8( history.z ).xyz, normal ) >= historyNormalMinCos )
+        {
+            fCount   = min( historyBlue.y + 1., historyMaxFrames );
+            resolved = mix( vec3( unpackHalf2x16( history.x ), historyBlue.x ), color, 1. / fCount );
+        }
+    }
+
+    HistoryPixels[ uCurrent + uPixel ] = uvec4( packHalf2x16( resolved.rg ),
+                                                packHalf2x16( vec2( resolved.b, fCount ) ),
+                                                packSnorm4x8( vec4( normal, 0. ) ),
+                                                floatBitsToUint( bHit ? distance( hitPos, CameraPos ) : -1. ) );
+
+    return resolved;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Loads the occupancy of the brick around the point where the central ray of the workgroup leaves the empty space of
+// its tiles. The rays of a workgroup barely spread over the brick, most of them march their first cells from it. Has
+// to be reached by every invocation of the workgroup
+void LoadTileCache( in const ivec2 imgSize )
+{
+    const ivec2 groupPixel  = ivec2( gl_WorkGroupID.xy * gl_WorkGroupSize.xy );
+    const ivec2 tileCount   = ( imgSize + TILE_DIM - 1 ) >> TILE_DIM_SHIFT;
+    const ivec2 tileLo      = groupPixel >> TILE_DIM_SHIFT;
+    const ivec2 tileHi      = min( ( groupPixel + ivec2( gl_WorkGroupSize.xy ) - 1 ) >> TILE_DIM_SHIFT, tileCount - 1 );
+    const float scale       = tan( fFov * 0.5 );
+    const float aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const vec2  uv = ( ( vec2( groupPixel ) + vec2( gl_WorkGroupSize.xy ) * 0.5 ) / vec2( imgSize ) ) * 2. - 1.;
+    const vec3  rd = normalize( CameraLookDir + uv.x * aspectRatio * scale * CameraRight + uv.y * scale * CameraUp );
+
+    // Closest start of the tiles, the rays of the workgroup start there at the earliest
+    float tStart = INF;
+    uint  uTile;
+    for ( int y = tileLo.y; y <= tileHi.y; ++y )
+    {
+        for ( int x = tileLo.x; x <= tileHi.x; ++x )
+        {
+            uTile  = uint( x + y * tileCount.x );
+            tStart = min( tStart, uTile < uint( TileStarts.length() ) ? TileStarts[ uTile ] : 0. );
+        }
+    }
+
+    // Brick reaches a few voxels behind the start for the rays around the central one and the rest ahead of it
+    const vec3 center = CameraPos + rd * ( min( tStart, maxRenderDist ) + float( TILE_CACHE_DIM / 2 - 2 ) );
+    tileCacheOrigin   = ivec3( floor( center ) ) - TILE_CACHE_DIM / 2;
+
+    const uint uInvocations = gl_WorkGroupSize.x * gl_WorkGroupSize.y;
+    for ( uint uWord = gl_LocalInvocationIndex; uWord < TILE_CACHE_WORDS; uWord += uInvocations )
+    {
+        TileOccupancy[ uWord ] = 0;
+    }
+
+    barrier();
+
+    // Neighbouring invocations read neighbouring voxels, only the inside of the grid is cached like in MarchTheRay
+    ivec3 voxel;
+    for ( uint uBit = gl_LocalInvocationIndex; uBit < TILE_CACHE_WORDS * 32; uBit += uInvocations )
+    {
+        voxel = tileCacheOrigin + ivec3( uBit & ( TILE_CACHE_DIM - 1 ),
+                                         ( uBit >> TILE_CACHE_SHIFT ) & ( TILE_CACHE_DIM - 1 ),
+                                         uBit >> ( 2 * TILE_CACHE_SHIFT ) );
+
+        if ( all( greaterThan( voxel, ivec3( 0 ) ) ) && all( lessThan( voxel, GridSize ) ) &&
+             VoxelData[ voxel.x + voxel.y * GridSize.x + voxel.z * GridSize.x * GridSize.y ].Type ==
+                 uint( HIT_TYPE_VOXEL ) )
+        {
+            atomicOr( TileOccupancy[ uBit >> 5 ], 1u << ( uBit & 31u ) );
+        }
+    }
+
+    barrier();
+}
@@ -0,0 +1,77 @@
+#version 450
+
+// Stretches the rendered corner of the render image over the swapchain image, bilinear with a sharpening clamped to
+// the closest texels so edges don't ring
+layout( local_size_x = 8, local_size_y = 8 ) in;
+
+layout( binding = 0, rgba8 ) uniform readonly image2D renderImage;
+layout( binding = 11, rgba8 ) uniform writeonly image2D outputImage;
+
+layout( push_constant ) uniform PushConstants
+{
+    vec3  CameraPos;
+    uint  _Padding0;
+    ivec3 GridSize;
+    uint  _Padding1;
+    vec3  CameraLookDir;
+    uint  _Padding2;
+    vec3  CameraRight;
+    uint  _Padding3;
+    vec3  CameraUp;
+    uint  _Padding4;
+    float fFov;
+    uint  uDebugMode;
+    uint  uFrame;
+    uint  uRenderExtent;
+};
+
+const float upscaleSharpness = 0.25;
+
+// --------------------------------------------------------------------------------------------------------------------
+vec4 LoadTexel( in const ivec2 texel, in const ivec2 extent )
+{
+    return imageLoad( renderImage, clamp( texel, ivec2( 0 ), extent - 1 ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    const ivec2 pixel   = ivec2( gl_GlobalInvocationID.xy );
+    const ivec2 outSize = imageSize( outputImage );
+    const ivec2 extent  = ivec2( uRenderExtent & 0xFFFFu, uRenderExtent >> 16 );
+
+    if ( any( greaterThanEqual( pixel, outSize ) ) )
+    {
+        return;
+    }
+
+    // Nothing to filter at the full resolution
+    if ( extent == outSize )
+    {
+        imageStore( outputImage, pixel, LoadTexel( pixel, extent ) );
+        return;
+    }
+
+    const vec2  pos  = ( vec2( pixel ) + 0.5 ) * vec2( extent ) / vec2( outSize ) - 0.5;
+    const ivec2 base = ivec2( floor( pos ) );
+    const vec2  f    = pos - vec2( base );
+
+    const vec4 bilinear = mix( mix( LoadTexel( base, extent ), LoadTexel( base + ivec2( 1, 0 ), extent ), f.x ),
+                               mix( LoadTexel( base + ivec2( 0, 1 ), extent ), LoadTexel( base + 1, extent ), f.x ),
+                               f.y );
+
+    const ivec2 nearest = ivec2( floor( pos + 0.5 ) );
+    const vec4  center  = LoadTexel( nearest, extent );
+    const vec4  north   = LoadTexel( nearest + ivec2( 0, -1 ), extent );
+    const vec4  south   = LoadTexel( nearest + ivec2( 0, 1 ), extent );
+    const vec4  east    = LoadTexel( nearest + ivec2( 1, 0 ), extent );
+    const vec4  west    = LoadTexel( nearest + ivec2( -1, 0 ), extent );
+
+    const vec4 lo = min( center, min( min( north, south ), min( east, west ) ) );
+    const vec4 hi = max( center, max( max( north, south ), max( east, west ) ) );
+
+    const vec4 sharpened =
+        clamp( bilinear + ( center - ( north + south + east + west ) * 0.25 ) * upscaleSharpness, lo, hi );
+
+    imageStore( outputImage, pixel, vec4( sharpened.rgb, 1. ) );
+}
@@ -0,0 +1,91 @@
+// Wavefront mode splits the raycast into passes. The primary pass writes a record of the hit of every pixel and queues
+// the pixels that need more work, the shadow and reflection passes trace the secondary rays of their queues and the
+// shade pass puts the records together. Queues are dispatched indirectly, pixels that see the sky never reach them
+
+#define WAVEFRONT_GROUP_SIZE 64
+
+#define QUEUE_SHADOW     0
+#define QUEUE_REFLECTION 1
+#define QUEUE_SHADE      2
+#define QUEUE_COUNT      3
+
+#define RECORD_SHADED    1u
+#define RECORD_REFLECTED 2u
+
+// Group count, 1, 1 and the length of every queue, the first three are the arguments of its indirect dispatch. The
+// packed pixels of the queues follow, each queue has a segment as long as the buffer has room for
+layout( std430, binding = 16 ) buffer WavefrontQueues
+{
+    uint QueueArgs[ QUEUE_COUNT * 4 ];
+    uint QueueItems[];
+};
+
+// Hit position and distance, normal as halfs, hit type and index, shadow, reflected light and the weight of the color
+// of the surface as halfs and the flags, three uvec4 per pixel of the rendered image
+layout( std430, binding = 17 ) buffer HitRecords
+{
+    uvec4 Records[];
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+uint QueueCapacity()
+{
+    return uint( QueueItems.length() ) / QUEUE_COUNT;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Adds the pixel to the queue and grows the group count of its dispatch to cover it
+void Enqueue( in const uint uQueue, in const ivec2 pixel )
+{
+    const uint uSlot = atomicAdd( QueueArgs[ uQueue * 4 + 3 ], 1u );
+    if ( uSlot >= QueueCapacity() )
+    {
+        return;
+    }
+
+    atomicMax( QueueArgs[ uQueue * 4 ], uSlot / WAVEFRONT_GROUP_SIZE + 1 );
+
+    QueueItems[ uQueue * QueueCapacity() + uSlot ] = uint( pixel.x ) | ( uint( pixel.y ) << 16 );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Pixel of the queue the invocation works on, false past the end of the queue
+bool Dequeue( in const uint uQueue, out ivec2 pixel )
+{
+    const uint uSlot = gl_GlobalInvocationID.x;
+
+    pixel = ivec2( 0 );
+    if ( uSlot >= min( QueueArgs[ uQueue * 4 + 3 ], QueueCapacity() ) )
+    {
+        return false;
+    }
+
+    const uint uItem = QueueItems[ uQueue * QueueCapacity() + uSlot ];
+    pixel            = ivec2( uItem & 0xFFFFu, uItem >> 16 );
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+uint RecordIndex( in const ivec2 pixel )
+{
+    return uint( pixel.x + pixel.y * int( uRenderExtent & 0xFFFFu ) ) * 3;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void ReadHit( in const uint  uRecord,
+              out vec3       hitPos,
+              out float      fDistance,
+              out vec3       normal,
+              out int        hitType,
+              out uint       uIndex )
+{
+    const uvec4 hit     = Records[ uRecord ];
+    const uvec4 surface = Records[ uRecord + 1 ];
+
+    hitPos    = uintBitsToFloat( hit.xyz );
+    fDistance = uintBitsToFloat( hit.w );
+    normal    = vec3( unpackHalf2x16( surface.x ), unpackHalf2x16( surface.y ).x );
+    hitType   = int( surface.z );
+    uIndex    = surface.w;
+}
@@ -0,0 +1,86 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+
+// Every thread marches the primary ray of its pixel and writes the record of the hit. Misses are finished here, hits
+// are queued for the shade pass and for the shadow and reflection passes when they need them
+layout( local_size_x = 32, local_size_y = 8, local_size_x_id = 5, local_size_y_id = 6 ) in;
+
+#include "Raycast.glsl"
+#include "Wavefront.glsl"
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    const ivec2 pixel   = ivec2( gl_GlobalInvocationID.xy );
+    const ivec2 imgSize = ivec2( uRenderExtent & 0xFFFFu, uRenderExtent >> 16 );
+
+    if ( tileCache == 1 )
+    {
+        LoadTileCache( imgSize );
+    }
+
+    if ( any( greaterThanEqual( pixel, imgSize ) ) )
+    {
+        return;
+    }
+
+    const float scale       = tan( fFov * 0.5 );
+    const float aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const vec2  uv          = ( ( vec2( pixel ) + vec2( 0.5 ) ) / vec2( imgSize ) ) * 2. - 1.;
+
+    if ( IsCrosshair( uv, aspectRatio ) )
+    {
+        ResolveHistory( pixel, imgSize, vec3( 1. ), false, vec3( 0. ), vec3( 0. ) );
+        imageStore( outputImage, pixel, vec4( 1., 1., 1., 1. ) );
+        return;
+    }
+
+    const vec3 rd = normalize( CameraLookDir + uv.x * aspectRatio * scale * CameraRight + uv.y * scale * CameraUp );
+
+    // Beam pass already stepped over the empty space in front of the whole tile
+    const ivec2 tile   = pixel >> TILE_DIM_SHIFT;
+    const uint  uTile  = uint( tile.x + tile.y * ( ( imgSize.x + TILE_DIM - 1 ) >> TILE_DIM_SHIFT ) );
+    const float tStart = uTile < uint( TileStarts.length() ) ? TileStarts[ uTile ] : 0.;
+
+    vec3  hitPos;
+    uint  index;
+    float fDistance;
+    vec3  normal;
+    int   hitType;
+    if ( !MarchTheRay( CameraPos, rd, tStart, maxSteps, true, hitPos, index, fDistance, normal, hitType ) )
+    {
+        ResolveHistory( pixel, imgSize, baseSkyColor.xyz, false, vec3( 0. ), vec3( 0. ) );
+        imageStore( outputImage, pixel, baseSkyColor );
+        return;
+    }
+
+    const uint uRecord = RecordIndex( pixel );
+    if ( uRecord + 2 >= uint( Records.length() ) )
+    {
+        return;
+    }
+
+    float reflectionPower;
+    float fRoughness;
+    HitMaterial( hitType, index, reflectionPower, fRoughness );
+
+    // Hits further than the raycast shades keep the plain color of the surface
+    uint uFlags = 0;
+    if ( fDistance <= maxSteps )
+    {
+        uFlags |= RECORD_SHADED;
+        Enqueue( QUEUE_SHADOW, pixel );
+
+        if ( reflectionBounces > 0 && reflectionPower > 0. )
+        {
+            uFlags |= RECORD_REFLECTED;
+            Enqueue( QUEUE_REFLECTION, pixel );
+        }
+    }
+
+    Records[ uRecord ]     = uvec4( floatBitsToUint( hitPos ), floatBitsToUint( fDistance ) );
+    Records[ uRecord + 1 ] = uvec4( packHalf2x16( normal.xy ), packHalf2x16( vec2( normal.z, 0. ) ), hitType, index );
+    Records[ uRecord + 2 ] = uvec4( floatBitsToUint( 1. ), 0, packHalf2x16( vec2( 0., 1. ) ), uFlags );
+
+    Enqueue( QUEUE_SHADE, pixel );
+}
@@ -0,0 +1,44 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+
+// Every thread traces the bounces of a pixel of the reflection queue. The light they add and the weight left to the
+// surface go to the record, the shade pass blends them over the shaded color
+layout( local_size_x = 64 ) in;
+
+#include "Raycast.glsl"
+#include "Wavefront.glsl"
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    ivec2 pixel;
+    if ( !Dequeue( QUEUE_REFLECTION, pixel ) )
+    {
+        return;
+    }
+
+    const uint uRecord = RecordIndex( pixel );
+
+    vec3  hitPos;
+    float fDistance;
+    vec3  normal;
+    int   hitType;
+    uint  index;
+    ReadHit( uRecord, hitPos, fDistance, normal, hitType, index );
+
+    float reflectionPower;
+    float fRoughness;
+    HitMaterial( hitType, index, reflectionPower, fRoughness );
+
+    float      fBaseWeight;
+    const vec3 light = ReflectionLight( CameraPos,
+                                        hitPos,
+                                        int( maxSteps * 0.5f ),
+                                        reflectionBounces,
+                                        normal,
+                                        reflectionPower,
+                                        fRoughness,
+                                        fBaseWeight );
+
+    Records[ uRecord + 2 ].yz = uvec2( packHalf2x16( light.rg ), packHalf2x16( vec2( light.b, fBaseWeight ) ) );
+}
@@ -0,0 +1,58 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+
+// Every thread shades a pixel of the shade queue from its record and resolves it with the history
+layout( local_size_x = 64 ) in;
+
+#include "Raycast.glsl"
+#include "Wavefront.glsl"
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    ivec2 pixel;
+    if ( !Dequeue( QUEUE_SHADE, pixel ) )
+    {
+        return;
+    }
+
+    const ivec2 imgSize = ivec2( uRenderExtent & 0xFFFFu, uRenderExtent >> 16 );
+    const uint  uRecord = RecordIndex( pixel );
+    const uvec4 light   = Records[ uRecord + 2 ];
+
+    vec3  hitPos;
+    float fDistance;
+    vec3  normal;
+    int   hitType;
+    uint  index;
+    ReadHit( uRecord, hitPos, fDistance, normal, hitType, index );
+
+    float reflectionPower;
+    float fRoughness;
+    vec4  finalColor = HitMaterial( hitType, index, reflectionPower, fRoughness );
+
+    if ( ( light.w & RECORD_SHADED ) != 0 )
+    {
+        vec3 shaded = PhongShadowed( CameraPos.xyz, hitPos, normal, uintBitsToFloat( light.x ) ) * finalColor.xyz;
+
+        if ( ( light.w & RECORD_REFLECTED ) != 0 )
+        {
+            const vec2 reflectedBlue = unpackHalf2x16( light.z );
+
+            shaded = shaded * reflectedBlue.y + vec3( unpackHalf2x16( light.y ), reflectedBlue.x );
+        }
+
+        finalColor = vec4( shaded, finalColor.w );
+    }
+
+    if ( fDistance > maxRenderDist )
+    {
+        finalColor = mix( finalColor,
+                          baseSkyColor,
+                          clamp( fDistance - maxRenderDist, 0.f, maxRenderDist * .5f ) / ( maxRenderDist * .5f ) );
+    }
+
+    finalColor.xyz = ResolveHistory( pixel, imgSize, finalColor.xyz, true, hitPos, normal );
+
+    imageStore( outputImage, pixel, finalColor );
+}
@@ -0,0 +1,31 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+
+// Every thread traces the soft shadow of a pixel of the shadow queue, the light cache is refined like in the raycast
+layout( local_size_x = 64 ) in;
+
+#include "Raycast.glsl"
+#include "Wavefront.glsl"
+
+// --------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    ivec2 pixel;
+    if ( !Dequeue( QUEUE_SHADOW, pixel ) )
+    {
+        return;
+    }
+
+    const uint uRecord = RecordIndex( pixel );
+
+    vec3  hitPos;
+    float fDistance;
+    vec3  normal;
+    int   hitType;
+    uint  index;
+    ReadHit( uRecord, hitPos, fDistance, normal, hitType, index );
+
+    const float fShadow = HitShadow( hitType, index, hitPos, normal, int( distance( hitPos, lightPos ) ), true );
+
+    Records[ uRecord + 2 ].x = floatBitsToUint( fShadow );
+}
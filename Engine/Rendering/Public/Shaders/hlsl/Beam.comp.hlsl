@@ -0,0 +1,166 @@
+#include "Math.hlsl"
+
+// Every thread marches one conservative cone through the tile of TILE_DIM^2 pixels it covers, the raycast starts
+// the rays of the tile where the cone first may touch something
+
+#define TILE_DIM       8
+#define TILE_DIM_SHIFT 3
+
+#define VOXEL_MIPS_HEAD 112
+
+// Has to match the raycast, the beam can't check cells finer than the level the rays use
+#define LOD_DISTANCE   24.f
+#define BEAM_MAX_STEPS 48
+#define BEAM_MAX_CELLS 4
+#define BEAM_MARGIN    0.05
+
+struct PushConstants
+{
+    float3 CameraPos;
+    uint   _Padding0;
+    int3   GridSize;
+    uint   _Padding1;
+    float3 CameraLookDir;
+    uint   _Padding2;
+    float3 CameraRight;
+    uint   _Padding3;
+    float3 CameraUp;
+    uint   _Padding4;
+    float  fFov;
+    uint   uDebugMode;
+    uint   uFrame;
+    uint   uRenderExtent;
+};
+
+// Level count, then offset, width and occupancy offset of every level as uint4, followed by the cells of all levels
+ByteAddressBuffer g_VoxelMips : register( t7 );
+
+RWStructuredBuffer<float> g_TileStart : register( u8 );
+
+#if defined( VULKAN )
+
+[[vk::push_constant]]
+PushConstants pc;
+
+#else
+
+cbuffer PushConstantsBuffer : register( b1 )
+{
+    PushConstants pc;
+};
+
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+float3 TileRay( in const float2 uv, in const float aspectRatio, in const float scale )
+{
+    return normalize( pc.CameraLookDir + uv.x * aspectRatio * scale * pc.CameraRight + uv.y * scale * pc.CameraUp );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Level the raycast uses at the distance t, at most
+int LodLevel( in const float t )
+{
+    return t <= LOD_DISTANCE ? 0 : int( ceil( log2( t / LOD_DISTANCE ) ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Returns true if any cell of the level over the box of voxels may hold something. Cells on the border of the grid
+// end the rays of the raycast, so they count as taken, just like the cells outside of it
+bool TestBeamBox( in const float3 lo, in const float3 hi, in const int level )
+{
+    const uint3 levelInfo = g_VoxelMips.Load3( 16 * level );
+    const int3  levelDim  = int3( levelInfo.yyy );
+    const int3  cellLo    = int3( floor( lo ) ) >> level;
+    const int3  cellHi    = int3( floor( hi ) ) >> level;
+
+    if ( any( cellLo <= 0 ) || any( cellHi >= levelDim - 1 ) || any( cellHi - cellLo >= BEAM_MAX_CELLS ) )
+        return true;
+
+    uint uCell;
+    uint uWord;
+    for ( int z = cellLo.z; z <= cellHi.z; ++z )
+    {
+        for ( int y = cellLo.y; y <= cellHi.y; ++y )
+        {
+            for ( int x = cellLo.x; x <= cellHi.x; ++x )
+            {
+                uCell = uint( x + y * levelDim.x + z * levelDim.x * levelDim.y );
+                uWord = g_VoxelMips.Load( VOXEL_MIPS_HEAD + ( levelInfo.z + ( uCell >> 5 ) ) * 4 );
+
+                if ( ( uWord >> ( uCell & 31 ) ) & 1 )
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature( "DescriptorTable( SRV( t7 ), UAV( u8 ), CBV( b1 ) )" ) ][ numthreads( 8, 8, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    const uint outputImageWidth  = pc.uRenderExtent & 0xFFFF;
+    const uint outputImageHeight = pc.uRenderExtent >> 16;
+
+    uint tileStartCount = 0, tileStartStride = 0;
+    g_TileStart.GetDimensions( tileStartCount, tileStartStride );
+
+    const uint2 imgSize   = uint2( outputImageWidth, outputImageHeight );
+    const uint2 tileCount = ( imgSize + TILE_DIM - 1 ) >> TILE_DIM_SHIFT;
+    const uint2 tile      = dispatchThreadId.xy;
+    const uint  uTile     = tile.x + tile.y * tileCount.x;
+
+    if ( any( tile >= tileCount ) || uTile >= tileStartCount )
+        return;
+
+    const float  scale       = tan( pc.fFov * 0.5 );
+    const float  aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const float2 uvLo        = ( float2( tile << TILE_DIM_SHIFT ) / float2( imgSize ) ) * 2. - 1.;
+    const float2 uvHi        = ( float2( ( tile + 1 ) << TILE_DIM_SHIFT ) / float2( imgSize ) ) * 2. - 1.;
+    const float3 axis        = TileRay( ( uvLo + uvHi ) * 0.5, aspectRatio, scale );
+
+    // Rays of the pixels lie between the rays of the tile corners
+    float cosSpread = 1.;
+    cosSpread       = min( cosSpread, dot( axis, TileRay( float2( uvLo.x, uvLo.y ), aspectRatio, scale ) ) );
+    cosSpread       = min( cosSpread, dot( axis, TileRay( float2( uvHi.x, uvLo.y ), aspectRatio, scale ) ) );
+    cosSpread       = min( cosSpread, dot( axis, TileRay( float2( uvLo.x, uvHi.y ), aspectRatio, scale ) ) );
+    cosSpread       = min( cosSpread, dot( axis, TileRay( float2( uvHi.x, uvHi.y ), aspectRatio, scale ) ) );
+
+    // Ball of the radius t * spread around the axis holds every ray of the tile at the distance t
+    const float spread    = sqrt( max( 1. - cosSpread * cosSpread, 0. ) ) / max( cosSpread, EPSILON );
+    const int   mipLevels = int( g_VoxelMips.Load( 0 ) );
+
+    float  t     = 0.;
+    int    level = 1;
+    float  cellSize;
+    float  tEnd;
+    float  radius;
+    float3 from;
+    float3 to;
+    for ( int i = 0; i < BEAM_MAX_STEPS && mipLevels > 0; ++i )
+    {
+        // Segments are a cell long, the level grows until the ball fits a cell and the rays use no coarser one
+        for ( ;; )
+        {
+            cellSize = float( 1 << level );
+            tEnd     = t + cellSize;
+            radius   = tEnd * spread + BEAM_MARGIN;
+
+            if ( level >= mipLevels || ( radius <= cellSize && LodLevel( tEnd ) <= level ) )
+                break;
+
+            ++level;
+        }
+
+        from = pc.CameraPos + axis * t;
+        to   = pc.CameraPos + axis * tEnd;
+        if ( TestBeamBox( min( from, to ) - radius, max( from, to ) + radius, level ) )
+            break;
+
+        t = tEnd;
+    }
+
+    g_TileStart[ uTile ] = t;
+}
@@ -0,0 +1,80 @@
+#include "Intersect.hlsl"
+
+// Every thread resets the cached light of the six faces of a voxel when the path from the face to the light crosses
+// the changed cells, the raycast traces the reset faces again. Only the voxels behind the cells are dispatched
+
+// Has to match the raycast and MarkLightChanges
+#define PHONG_LIGHT_POS float3( 20.0, 25.0, 10.0 )
+
+// Soft shadow rays leave the face anywhere and bend a bit, so the box grows to catch them
+// Has to match MarkLightChanges
+#define CHANGES_MARGIN 2.
+
+struct PushConstants
+{
+    float3 CameraPos;
+    uint   _Padding0;
+    int3   GridSize;
+    uint   _Padding1;
+    float3 CameraLookDir;
+    uint   _Padding2;
+    float3 CameraRight;
+    uint   _Padding3;
+    float3 CameraUp;
+    uint   _Padding4;
+    float  fFov;
+    uint   uDebugMode;
+    uint   uFrame;
+    uint   uRenderExtent;
+};
+
+// Visibility of the light and the sample count as halfs, six faces per voxel of the grid
+RWStructuredBuffer<uint> g_LightCache : register( u12 );
+
+// Inclusive boxes of the cells changed since the last reset and of the voxels the pass runs over as four int4
+ByteAddressBuffer g_LightChanges : register( t13 );
+
+#if defined( VULKAN )
+
+[[vk::push_constant]]
+PushConstants pc;
+
+#else
+
+cbuffer PushConstantsBuffer : register( b1 )
+{
+    PushConstants pc;
+};
+
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature( "DescriptorTable( UAV( u12 ), SRV( t13 ), CBV( b1 ) )" ) ][ numthreads( 4, 4, 4 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    const int3 voxel = asint( g_LightChanges.Load3( 32 ) ) + int3( dispatchThreadId );
+
+    if ( any( voxel > asint( g_LightChanges.Load3( 48 ) ) ) || any( voxel >= pc.GridSize ) )
+        return;
+
+    const int3   changedMin  = asint( g_LightChanges.Load3( 0 ) );
+    const int3   changedMax  = asint( g_LightChanges.Load3( 16 ) );
+    const float3 boxHalfSize = float3( changedMax - changedMin + 1 ) * 0.5 + CHANGES_MARGIN;
+    const float3 boxCenter   = float3( changedMin ) + float3( changedMax - changedMin + 1 ) * 0.5;
+    const uint   uVoxel      = voxel.x + voxel.y * pc.GridSize.x + voxel.z * pc.GridSize.x * pc.GridSize.y;
+
+    float3 normal;
+    float3 from;
+    float  tMin;
+    float  tMax;
+    for ( int i = 0; i < 6; ++i )
+    {
+        normal           = float3( 0., 0., 0. );
+        normal[ i >> 1 ] = ( i & 1 ) == 0 ? 1. : -1.;
+        from             = float3( voxel ) + 0.5 + normal * 0.5;
+
+        // Segment from the face to the light, t goes from 0 to 1
+        if ( IntersectRayAABB( from - boxCenter, PHONG_LIGHT_POS - from, boxHalfSize, tMin, tMax ) && tMin <= 1. )
+            g_LightCache[ uVoxel * 6 + i ] = 0;
+    }
+}
@@ -0,0 +1,76 @@
+#include "Math.hlsl"
+
+// Objects are binned into cells of OBJECT_CELL_DIM^3 voxels, every cell lists the objects whose box overlaps it. The
+// count pass sizes the lists, the scan pass places them and the fill pass writes them
+
+#define OBJECT_CELL_DIM   8
+#define OBJECT_CELL_SHIFT 3
+#define OBJECT_CELLS_HEAD 16
+
+struct PushConstants
+{
+    float3 CameraPos;
+    uint   _Padding0;
+    int3   GridSize;
+    uint   _Padding1;
+    float3 CameraLookDir;
+    uint   _Padding2;
+    float3 CameraRight;
+    uint   _Padding3;
+    float3 CameraUp;
+    uint   _Padding4;
+    float  fFov;
+    uint   uDebugMode;
+    uint   uFrame;
+    uint   uRenderExtent;
+};
+
+StructuredBuffer<float4> g_Positions : register( t2 );
+StructuredBuffer<float4> g_Rotations : register( t3 );
+StructuredBuffer<float4> g_HalfSizes : register( t4 );
+
+// Cells per axis, object count and capacity of g_ObjectIds as uint4, followed by the start and the length of every
+// list as uint2
+RWByteAddressBuffer    g_ObjectCells : register( u14 );
+RWStructuredBuffer<uint> g_ObjectIds : register( u15 );
+
+#if defined( VULKAN )
+
+[[vk::push_constant]]
+PushConstants pc;
+
+#else
+
+cbuffer PushConstantsBuffer : register( b1 )
+{
+    PushConstants pc;
+};
+
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Inclusive range of cells the rotated box of the object overlaps, false if it's removed or outside of the grid
+bool ObjectCellBounds( in const uint uObject, in const int iCells, out int3 lo, out int3 hi )
+{
+    const float3 halfSize = g_HalfSizes[ uObject ].xyz;
+
+    lo = int3( 0, 0, 0 );
+    hi = int3( -1, -1, -1 );
+
+    // Slots of removed objects stay, their size is zero
+    if ( all( halfSize == 0. ) )
+        return false;
+
+    const float3 extent = mul( abs( transpose( RotationMatrix( g_Rotations[ uObject ].xyz ) ) ), halfSize );
+
+    lo = int3( floor( g_Positions[ uObject ].xyz - extent ) ) >> OBJECT_CELL_SHIFT;
+    hi = int3( floor( g_Positions[ uObject ].xyz + extent ) ) >> OBJECT_CELL_SHIFT;
+
+    if ( any( hi < 0 ) || any( lo >= iCells ) )
+        return false;
+
+    lo = clamp( lo, 0, iCells - 1 );
+    hi = clamp( hi, 0, iCells - 1 );
+
+    return true;
+}
@@ -0,0 +1,31 @@
+#include "ObjectBin.hlsl"
+
+// Every thread counts its object into the lists of the cells it overlaps, the lists are zeroed before
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature( "DescriptorTable( SRV( t2, numDescriptors = 3 ), UAV( u14 ), UAV( u15 ), CBV( b1 ) )" ) ]
+[ numthreads( 64, 1, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    const uint4 info    = g_ObjectCells.Load4( 0 );
+    const uint  uObject = dispatchThreadId.x;
+    const int   iCells  = int( info.x );
+
+    int3 lo;
+    int3 hi;
+    if ( uObject >= info.y || !ObjectCellBounds( uObject, iCells, lo, hi ) )
+        return;
+
+    uint uCell;
+    for ( int z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int y = lo.y; y <= hi.y; ++y )
+        {
+            for ( int x = lo.x; x <= hi.x; ++x )
+            {
+                uCell = uint( x + y * iCells + z * iCells * iCells );
+                g_ObjectCells.InterlockedAdd( OBJECT_CELLS_HEAD + uCell * 8 + 4, 1 );
+            }
+        }
+    }
+}
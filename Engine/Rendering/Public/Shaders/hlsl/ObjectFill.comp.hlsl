@@ -0,0 +1,41 @@
+#include "ObjectBin.hlsl"
+
+// Every thread writes its object into the lists of the cells it overlaps, the scan pass left the lengths at zero so
+// they count the written ids again
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature( "DescriptorTable( SRV( t2, numDescriptors = 3 ), UAV( u14 ), UAV( u15 ), CBV( b1 ) )" ) ]
+[ numthreads( 64, 1, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    const uint4 info    = g_ObjectCells.Load4( 0 );
+    const uint  uObject = dispatchThreadId.x;
+    const int   iCells  = int( info.x );
+
+    int3 lo;
+    int3 hi;
+    if ( uObject >= info.y || !ObjectCellBounds( uObject, iCells, lo, hi ) )
+        return;
+
+    uint uCell;
+    uint uOffset;
+    uint uSlot;
+    for ( int z = lo.z; z <= hi.z; ++z )
+    {
+        for ( int y = lo.y; y <= hi.y; ++y )
+        {
+            for ( int x = lo.x; x <= hi.x; ++x )
+            {
+                uCell   = uint( x + y * iCells + z * iCells * iCells );
+                uOffset = OBJECT_CELLS_HEAD + uCell * 8;
+
+                g_ObjectCells.InterlockedAdd( uOffset + 4, 1, uSlot );
+                uSlot += g_ObjectCells.Load( uOffset );
+
+                // Lists past the capacity are cut, the raycast clamps them the same way
+                if ( uSlot < info.z )
+                    g_ObjectIds[ uSlot ] = uObject;
+            }
+        }
+    }
+}
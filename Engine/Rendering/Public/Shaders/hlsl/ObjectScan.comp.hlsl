@@ -0,0 +1,48 @@
+#include "ObjectBin.hlsl"
+
+// Single group turns the lengths of the lists into their starts, every thread sums a run of cells and the runs are
+// scanned in shared memory
+
+#define SCAN_THREADS 256
+
+groupshared uint g_RunSums[ SCAN_THREADS ];
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature( "DescriptorTable( SRV( t2, numDescriptors = 3 ), UAV( u14 ), UAV( u15 ), CBV( b1 ) )" ) ]
+[ numthreads( SCAN_THREADS, 1, 1 ) ] void
+main( uint3 groupThreadId : SV_GroupThreadID )
+{
+    const uint uCells     = g_ObjectCells.Load( 0 );
+    const uint uThread    = groupThreadId.x;
+    const uint uCellCount = uCells * uCells * uCells;
+    const uint uRun       = ( uCellCount + SCAN_THREADS - 1 ) / SCAN_THREADS;
+    const uint uFirst     = min( uThread * uRun, uCellCount );
+    const uint uEnd       = min( uFirst + uRun, uCellCount );
+
+    uint uSum = 0;
+    for ( uint c = uFirst; c < uEnd; ++c )
+        uSum += g_ObjectCells.Load( OBJECT_CELLS_HEAD + c * 8 + 4 );
+
+    g_RunSums[ uThread ] = uSum;
+    GroupMemoryBarrierWithGroupSync();
+
+    uint uAdd;
+    for ( uint uOffset = 1; uOffset < SCAN_THREADS; uOffset <<= 1 )
+    {
+        uAdd = uThread >= uOffset ? g_RunSums[ uThread - uOffset ] : 0;
+        GroupMemoryBarrierWithGroupSync();
+
+        g_RunSums[ uThread ] += uAdd;
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // Lengths are zeroed, the fill pass counts them again while it writes
+    uint uStart = g_RunSums[ uThread ] - uSum;
+    uint uLength;
+    for ( uint c = uFirst; c < uEnd; ++c )
+    {
+        uLength = g_ObjectCells.Load( OBJECT_CELLS_HEAD + c * 8 + 4 );
+        g_ObjectCells.Store2( OBJECT_CELLS_HEAD + c * 8, uint2( uStart, 0 ) );
+        uStart += uLength;
+    }
+}
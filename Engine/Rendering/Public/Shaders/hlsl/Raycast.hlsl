@@ -0,0 +1,914 @@
+// Traversal and shading of the raycast, shared with the passes of the wavefront mode
+
+#include "Colors.hlsl"
+#include "Intersect.hlsl"
+#include "Random.hlsl"
+
+#define LAST_UNKNOWN_AXIS -1
+#define LAST_X_AXIS       0
+#define LAST_Y_AXIS       1
+#define LAST_Z_AXIS       2
+
+#define HIT_TYPE_UNKNOWN  0
+#define HIT_TYPE_VOXEL    -1
+#define HIT_TYPE_OBJECT   1
+#define HIT_TYPE_STREAMED 2
+#define HIT_TYPE_MIP      3
+
+#define CHUNK_DIM        16
+#define CHUNK_DIM_SHIFT  4
+#define CHUNK_VOXELS     4096
+#define CHUNK_SLOT_EMPTY 0xFFFFFFFE
+#define CHUNK_TABLE_HEAD 32
+
+#define VOXEL_MIPS_HEAD 112
+
+#define TILE_DIM       8
+#define TILE_DIM_SHIFT 3
+
+#define OBJECT_CELL_SHIFT 3
+#define OBJECT_CELLS_HEAD 16
+
+#define GROUP_SIZE_X 32
+#define GROUP_SIZE_Y 8
+
+#define TILE_CACHE_DIM   16
+#define TILE_CACHE_SHIFT 4
+#define TILE_CACHE_WORDS 128
+
+#define HALF_MAX_RENDER_DIST 80.f
+#define LOD_DISTANCE         24.f
+#define BASE_SKY_COLOR       float4( .4078, .4725, 1., 1. )
+
+#define PHONG_AMBIENT     0.2
+#define PHONG_DIFFUSE     0.8
+#define PHONG_SPECULAR    0.8
+#define PHONG_SHININESS   512.0
+#define PHONG_LIGHT_POS   float3( 20.0, 25.0, 10.0 )
+#define PHONG_LIGHT_COLOR float3( 1., 1., .8 )
+
+#define SOFT_SHADOW_R            0.5
+#define SOFT_SHADOW_SAMPLE_STEP  ( TWO_PI / SOFT_SHADOW_SAMPLES )
+#define SOFT_SHADOW_MIX_FACTOR   0.015
+#define SOFT_SHADOW_SHADOW_CONST ( 1. / SOFT_SHADOW_SAMPLES )
+
+#define HISTORY_MAX_FRAMES      16.
+#define HISTORY_DEPTH_TOLERANCE 0.05
+#define HISTORY_NORMAL_MIN_COS  0.9
+
+#define LIGHT_CACHE_SAMPLES 16.
+
+// Variants of the shader the pipeline specializes, the ids have to match RaycastVariant
+#if defined( VULKAN )
+
+[[vk::constant_id( 0 )]] const uint  DEBUG_VIEW          = 0;
+[[vk::constant_id( 1 )]] const int   SOFT_SHADOW_SAMPLES = 1;
+[[vk::constant_id( 2 )]] const uint  REFLECTION_BOUNCES  = 1;
+[[vk::constant_id( 3 )]] const float MAX_RENDER_DIST     = 224.f;
+[[vk::constant_id( 4 )]] const int   MAX_STEPS           = 160;
+[[vk::constant_id( 7 )]] const uint  TILE_CACHE          = 0;
+
+#else
+
+static const uint  DEBUG_VIEW          = 0;
+static const int   SOFT_SHADOW_SAMPLES = 1;
+static const uint  REFLECTION_BOUNCES  = 1;
+static const float MAX_RENDER_DIST     = 224.f;
+static const int   MAX_STEPS           = 160;
+static const uint  TILE_CACHE          = 0;
+
+#endif
+
+struct PushConstants
+{
+    float3 CameraPos;
+    uint   _Padding0;
+    int3   GridSize;
+    uint   _Padding1;
+    float3 CameraLookDir;
+    uint   _Padding2;
+    float3 CameraRight;
+    uint   _Padding3;
+    float3 CameraUp;
+    uint   _Padding4;
+    float  fFov;
+    uint   uDebugMode;
+    uint   uFrame;
+    uint   uRenderExtent;
+};
+
+struct Voxel
+{
+    uint Type;
+    uint Color;
+    uint Id[ 26 ];
+};
+
+RWTexture2D<float4>      g_OutputImage : register( u0 );
+StructuredBuffer<Voxel>  g_Voxels : register( t1 );
+StructuredBuffer<float4> g_Positions : register( t2 );
+StructuredBuffer<float4> g_Rotations : register( t3 );
+StructuredBuffer<float4> g_HalfSizes : register( t4 );
+
+// WindowOrigin and WindowDim as int4, followed by the slot of every chunk in the window
+ByteAddressBuffer      g_ChunkTable : register( t5 );
+StructuredBuffer<uint> g_ChunkSlots : register( t6 );
+
+// Level count, then offset and width of every level as uint4, followed by the colors of all levels
+ByteAddressBuffer g_VoxelMips : register( t7 );
+
+// Distance every tile of TILE_DIM^2 pixels is empty for, written by the beam pass
+StructuredBuffer<float> g_TileStart : register( t8 );
+
+// Two halves of the accumulated color and history length as halfs, the normal and the distance of every pixel, the
+// frame writes the half ( uFrame & 1 ) and reads the other one
+RWStructuredBuffer<uint4> g_History : register( u9 );
+
+// Push constants of the previous frame, the history is reprojected with them
+StructuredBuffer<PushConstants> g_PreviousFrame : register( t10 );
+
+// Visibility of the light and the sample count as halfs, six faces per voxel of the grid. The light cache pass resets
+// faces the changed cells may shadow, the raycast refines them until they have LIGHT_CACHE_SAMPLES samples
+RWStructuredBuffer<uint> g_LightCache : register( u12 );
+
+// Objects binned into cells of OBJECT_CELL_DIM^3 voxels, cells per axis, object count and capacity of g_ObjectIds as
+// uint4 followed by the start and the length of the list of every cell as uint2
+ByteAddressBuffer      g_ObjectCells : register( t14 );
+StructuredBuffer<uint> g_ObjectIds : register( t15 );
+
+// Occupancy of the brick of TILE_CACHE_DIM^3 voxels the primary rays of the group enter first, a bit per voxel
+groupshared uint g_TileOccupancy[ TILE_CACHE_WORDS ];
+
+// First voxel of the brick, the same for every thread of the group
+static int3 g_TileCacheOrigin = int3( 0, 0, 0 );
+
+#if defined( VULKAN )
+
+[[vk::push_constant]]
+PushConstants pc;
+
+#else
+
+cbuffer PushConstantsBuffer : register( b1 )
+{
+    PushConstants pc;
+};
+
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Seed of the random directions, it changes every frame so the accumulated samples don't repeat
+float2 FrameSeed()
+{
+    return float2( 12.9898, 78.233 ) + float( pc.uFrame % 64 ) * float2( 0.7548777, 0.5698403 );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Returns -1 outside of the streamed window, 0 for empty voxels or chunks that aren't resident yet and 1 for a hit
+int TestStreamedVoxel( in const int3 voxel, out uint uColorIndex )
+{
+    const int3 windowOrigin = asint( g_ChunkTable.Load4( 0 ).xyz );
+    const int3 windowDim    = asint( g_ChunkTable.Load4( 16 ).xyz );
+    const int3 chunk        = ( voxel >> CHUNK_DIM_SHIFT ) - windowOrigin;
+
+    uColorIndex = 0;
+    if ( any( chunk < 0 ) || any( chunk >= windowDim ) )
+        return -1;
+
+    const int  iChunk = chunk.x + chunk.y * windowDim.x + chunk.z * windowDim.x * windowDim.y;
+    const uint uSlot  = g_ChunkTable.Load( CHUNK_TABLE_HEAD + iChunk * 4 );
+    if ( uSlot >= CHUNK_SLOT_EMPTY )
+        return 0;
+
+    const int3 local = voxel & ( CHUNK_DIM - 1 );
+    uColorIndex      = uSlot * CHUNK_VOXELS + uint( local.x + local.y * CHUNK_DIM + local.z * CHUNK_DIM * CHUNK_DIM );
+
+    return g_ChunkSlots[ uColorIndex ] != 0 ? 1 : 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Returns true if the voxel is in the brick, voxels outside of it go to g_Voxels
+bool TestTileCache( in const int3 voxel, out bool bTaken )
+{
+    const int3 local = voxel - g_TileCacheOrigin;
+
+    bTaken = false;
+    if ( any( uint3( local ) >= TILE_CACHE_DIM ) )
+        return false;
+
+    const uint uBit = uint( local.x + ( local.y << TILE_CACHE_SHIFT ) + ( local.z << ( 2 * TILE_CACHE_SHIFT ) ) );
+    bTaken          = ( ( g_TileOccupancy[ uBit >> 5 ] >> ( uBit & 31 ) ) & 1 ) != 0;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Starts the traversal of cells of 2^level voxels at the distance t along the ray
+void StartTraversal( in const float3 ro,
+                     in const float3 rd,
+                     in const float  t,
+                     in const int    level,
+                     out int3        cell,
+                     out float3      tMax,
+                     out float3      tDelta )
+{
+    const float  fCellSize = float( 1 << level );
+    const float3 pos       = ( ro + rd * t ) / fCellSize;
+
+    cell   = int3( floor( pos ) );
+    tDelta = abs( fCellSize / rd );
+
+    float offset;
+    for ( int i = 0; i < 3; ++i )
+    {
+        offset    = rd[ i ] > 0.0 ? 1.0 - frac( pos[ i ] ) : frac( pos[ i ] );
+        tMax[ i ] = t + tDelta[ i ] * offset;
+    }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Walks the cells of the object grid along the ray and returns the closest object it hits. Lists of a cell are only
+// tested once the ray gets there, a hit inside of the cell ends the walk
+bool TestObjectGrid( in const float3 ro,
+                     in const float3 rd,
+                     out uint        uHitIndex,
+                     out float       distance,
+                     out float3      normal )
+{
+    distance  = INF;
+    uHitIndex = 0;
+    normal    = float3( 0., 0., 0. );
+
+    const uint4 info   = g_ObjectCells.Load4( 0 );
+    const int   iCells = int( info.x );
+    if ( info.y == 0 )
+        return false;
+
+    const float3 gridHalfSize = ( float( iCells << OBJECT_CELL_SHIFT ) * 0.5 ).xxx;
+
+    float tEnter;
+    float tExit;
+    if ( !IntersectRayAABB( ro - gridHalfSize, rd, gridHalfSize, tEnter, tExit ) )
+        return false;
+
+    int3   cell;
+    float3 tMax;
+    float3 tDelta;
+    StartTraversal( ro, rd, max( tEnter, 0. ) + EPSILON, OBJECT_CELL_SHIFT, cell, tMax, tDelta );
+
+    const int3 stepV = int3( sign( rd ) );
+
+    uint   uCell;
+    uint2  range;
+    uint   uId;
+    float  fHitMin;
+    float  fHitMax;
+    float3 hitNormal;
+    bool3  tMin;
+    for ( int i = 0; i < 3 * iCells; ++i )
+    {
+        if ( any( cell < 0 ) || any( cell >= iCells ) )
+            break;
+
+        uCell   = uint( cell.x + cell.y * iCells + cell.z * iCells * iCells );
+        range   = g_ObjectCells.Load2( OBJECT_CELLS_HEAD + uCell * 8 );
+        range.y = min( range.y, info.z - min( range.x, info.z ) );
+
+        for ( uint k = range.x; k < range.x + range.y; ++k )
+        {
+            uId = g_ObjectIds[ k ];
+
+            // Object position is in oposite direction (more then 90 degrees)
+            if ( dot( rd, g_Positions[ uId ].xyz - ro ) < 0. )
+                continue;
+
+            if ( RayIntersectsAABB( ro,
+                                    rd,
+                                    g_Positions[ uId ].xyz,
+                                    g_Rotations[ uId ].xyz,
+                                    g_HalfSizes[ uId ].xyz,
+                                    fHitMin,
+                                    fHitMax,
+                                    hitNormal ) &&
+                fHitMin < distance && fHitMin >= EPSILON )
+            {
+                uHitIndex = uId;
+                distance  = fHitMin;
+                normal    = hitNormal;
+            }
+        }
+
+        // Cells further along can't hold anything closer
+        if ( distance <= min( tMax.x, min( tMax.y, tMax.z ) ) )
+            break;
+
+        tMin   = bool3( tMax.x < tMax.y && tMax.x < tMax.z, tMax.y <= tMax.x && tMax.y < tMax.z, false );
+        tMin.z = !tMin.x && !tMin.y;
+
+        cell += tMin * stepV;
+        tMax += tMin * tDelta;
+    }
+
+    return distance != INF;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+bool MarchTheRay( in const float3 ro,
+                  in const float3 rd,
+                  in const float  tStart,
+                  in const int    maxSteps,
+                  in const bool   bTileCache,
+                  out float3      hitCoords,
+                  out uint        hitIndex,
+                  out float       distance,
+                  out float3      normal,
+                  out int         hitType )
+{
+    int3   voxel;
+    int3   stepV = int3( sign( rd ) );
+    float3 tDelta;
+    float3 tMax;
+    bool3  tMin = false;
+
+    // Every level is used for twice the distance of the previous one with cells twice as big, so the steps per
+    // level stay the same however far the ray goes
+    const int mipLevels   = int( g_VoxelMips.Load( 0 ) );
+    int       level       = 0;
+    float     t           = tStart;
+    float     fNextLevel  = LOD_DISTANCE;
+    int3      levelDim    = pc.GridSize;
+    uint      levelOffset = 0;
+    uint2     levelInfo;
+
+    // Rays starting further away start on the level they would have reached by then
+    while ( t > fNextLevel && level < mipLevels )
+    {
+        ++level;
+        fNextLevel  *= 2.;
+        levelInfo    = g_VoxelMips.Load2( 16 * level );
+        levelOffset  = levelInfo.x;
+        levelDim     = int3( levelInfo.yyy );
+    }
+
+    StartTraversal( ro, rd, t, level, voxel, tMax, tDelta );
+
+    // Face the ray entered the first cell through, the last boundary it crossed
+    if ( t > 0. )
+    {
+        const float3 tEntry = tMax - tDelta;
+
+        tMin = bool3( tEntry.x > tEntry.y && tEntry.x > tEntry.z,
+                      tEntry.y >= tEntry.x && tEntry.y > tEntry.z,
+                      tEntry.z >= tEntry.x && tEntry.z >= tEntry.y );
+    }
+
+    // Closest object ends the march once the ray gets past it, the ids listed in the voxels are left to the CPU
+    uint   uObjectIndex;
+    float  fObjectDistance;
+    float3 objectNormal;
+    TestObjectGrid( ro, rd, uObjectIndex, fObjectDistance, objectNormal );
+
+    int  i;
+    int  index;
+    uint testedVoxel;
+    int  streamedHit;
+    uint uColorIndex;
+    bool bTaken;
+    for ( i = 0; i < maxSteps; ++i )
+    {
+        if ( t >= fObjectDistance )
+            break;
+
+        if ( t > fNextLevel && level < mipLevels )
+        {
+            ++level;
+            fNextLevel  *= 2.;
+            levelInfo    = g_VoxelMips.Load2( 16 * level );
+            levelOffset  = levelInfo.x;
+            levelDim     = int3( levelInfo.yyy );
+
+            StartTraversal( ro, rd, t + EPSILON, level, voxel, tMax, tDelta );
+        }
+
+        if ( level > 0 )
+        {
+            if ( all( voxel >= 0 ) && all( voxel < levelDim ) )
+            {
+                index = int( levelOffset ) + voxel.x + voxel.y * levelDim.x + voxel.z * levelDim.x * levelDim.y;
+
+                if ( g_VoxelMips.Load( VOXEL_MIPS_HEAD + index * 4 ) != 0 )
+                {
+                    distance  = t;
+                    hitIndex  = index;
+                    hitCoords = ro + rd * distance;
+                    hitType   = HIT_TYPE_MIP;
+                    normal    = -float3(stepV) * tMin;
+                    return true;
+                }
+            }
+            else
+            {
+                // Coarse cells outside of the grid sample the streamed voxel in their corner
+                streamedHit = TestStreamedVoxel( voxel << level, uColorIndex );
+                if ( streamedHit < 0 )
+                    return false;
+
+                if ( streamedHit > 0 )
+                {
+                    distance  = t;
+                    hitIndex  = uColorIndex;
+                    hitCoords = ro + rd * distance;
+                    hitType   = HIT_TYPE_STREAMED;
+                    normal    = -float3(stepV) * tMin;
+                    return true;
+                }
+            }
+
+            testedVoxel = HIT_TYPE_UNKNOWN;
+        }
+        else if ( voxel.x <= 0 || voxel.x >= pc.GridSize.x || voxel.y <= 0 || voxel.y >= pc.GridSize.y ||
+                  voxel.z <= 0 || voxel.z >= pc.GridSize.z )
+        {
+            // Outside of the grid the world continues with the streamed chunks
+            streamedHit = TestStreamedVoxel( voxel, uColorIndex );
+            if ( streamedHit < 0 )
+                return false;
+
+            if ( streamedHit > 0 )
+            {
+                distance  = t;
+                hitIndex  = uColorIndex;
+                hitCoords = ro + rd * distance;
+                hitType   = HIT_TYPE_STREAMED;
+                normal    = -float3(stepV) * tMin;
+                return true;
+            }
+
+            testedVoxel = HIT_TYPE_UNKNOWN;
+        }
+        else
+        {
+            index = voxel.x + voxel.y * pc.GridSize.x + voxel.z * pc.GridSize.x * pc.GridSize.y;
+
+            // Check for hits, primary rays of the group read the brick they share first
+            if ( TILE_CACHE == 1 && bTileCache && TestTileCache( voxel, bTaken ) )
+                testedVoxel = bTaken ? uint( HIT_TYPE_VOXEL ) : uint( HIT_TYPE_UNKNOWN );
+            else
+                testedVoxel = g_Voxels[ index ].Type;
+        }
+
+        if ( testedVoxel == uint( HIT_TYPE_VOXEL ) ||
+             ( DEBUG_VIEW == 1 && testedVoxel > HIT_TYPE_UNKNOWN && testedVoxel < uint( HIT_TYPE_VOXEL ) ) )
+        {
+            distance  = t;
+            hitIndex  = index;
+            hitCoords = ro + rd * distance;
+            hitType   = HIT_TYPE_VOXEL;
+            normal    = -float3(stepV) * tMin;
+            return true;
+        }
+
+        // tMin = bool3(
+        //     ( tMax.x < tMax.y && tMax.x < tMax.z ),
+        //     ( tMax.y < tMax.x && tMax.y < tMax.z ),
+        //     ( tMax.z < tMax.y && tMax.z < tMax.x )
+        // );
+        tMin = int3(
+            ( 1 - step(tMax.y, tMax.x) ) * ( 1 - step(tMax.z, tMax.x) ),
+            ( 1 - step(tMax.x, tMax.y) ) * ( 1 - step(tMax.z, tMax.y) ),
+            ( 1 - step(tMax.x, tMax.z) ) * ( 1 - step(tMax.y, tMax.z) )
+        );
+
+        // t is where the ray enters the next cell
+        t      = dot( tMin, tMax );
+        voxel += tMin * stepV;
+        tMax  += tMin * tDelta;
+    }
+
+    if ( t < fObjectDistance )
+        return false;
+
+    distance  = fObjectDistance;
+    normal    = objectNormal;
+    hitIndex  = uObjectIndex;
+    hitCoords = ro + rd * distance;
+    hitType   = HIT_TYPE_OBJECT;
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+float SoftShadowRay( in const float2 uv,
+                     in const float3 from,
+                     in const float3 to,
+                     in const float3 normal,
+                     in const int    maxDistance )
+{
+    float3 dir = normalize( to - from );
+    float3 dummyHit;
+    uint   dummyIndex;
+    float3 dummyNormal;
+    float  dummyDistance;
+    int    dummyHitType;
+    float  shadow = 1.;
+
+    // Samples turn a bit every frame, the history accumulates them into the penumbra
+    const float rotation = frac( Random( uv ) + float( pc.uFrame ) * 0.618034 );
+
+    float  angle;
+    float3 offset;
+    for ( int i = 0; i < SOFT_SHADOW_SAMPLES; ++i )
+    {
+        angle  = ( float( i ) + rotation ) * SOFT_SHADOW_SAMPLE_STEP;
+        offset = float3( cos( angle ), sin( angle ), 0. ) * SOFT_SHADOW_R;
+
+        dir = normalize( to + offset - from );
+        dir = lerp( dir, RandomPointOnHemisphere( normal, uv, FrameSeed() ), SOFT_SHADOW_MIX_FACTOR );
+
+        if ( MarchTheRay( from + dir * EPSILON,
+                          dir,
+                          0.,
+                          maxDistance,
+                          false,
+                          dummyHit,
+                          dummyIndex,
+                          dummyDistance,
+                          dummyNormal,
+                          dummyHitType ) )
+        {
+            shadow -= SOFT_SHADOW_SHADOW_CONST;
+        }
+    }
+
+    return shadow;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Face of the voxel the axis aligned normal points out of, has to match the light cache pass
+uint FaceIndex( in const float3 normal )
+{
+    const float3 axis = abs( normal );
+    const int    i    = axis.x > 0.5 ? 0 : ( axis.y > 0.5 ? 1 : 2 );
+
+    return uint( i * 2 + ( normal[ i ] < 0. ? 1 : 0 ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Soft shadow of a hit, faces of the static voxels come from the cache. Faces that don't have enough samples yet trace
+// one more, only bRefine adds it to the cache, shorter rays would skew it
+float HitShadow( in const float2 uv,
+                 in const int    hitType,
+                 in const uint   uIndex,
+                 in const float3 hitPos,
+                 in const float3 normal,
+                 in const int    maxDistance,
+                 in const bool   bRefine )
+{
+    uint lightCacheCount = 0, lightCacheStride = 0;
+    g_LightCache.GetDimensions( lightCacheCount, lightCacheStride );
+
+    const uint uFace = uIndex * 6 + FaceIndex( normal );
+
+    if ( hitType != HIT_TYPE_VOXEL || uFace >= lightCacheCount )
+        return SoftShadowRay( uv, hitPos, PHONG_LIGHT_POS, normal, maxDistance );
+
+    const uint  cached      = g_LightCache[ uFace ];
+    const float cachedCount = f16tof32( cached >> 16 );
+    if ( cachedCount >= LIGHT_CACHE_SAMPLES )
+        return f16tof32( cached );
+
+    const float shadow = SoftShadowRay( uv, hitPos, PHONG_LIGHT_POS, normal, maxDistance );
+    if ( !bRefine )
+        return shadow;
+
+    // Pixels of the same face race here, a lost sample only delays the cache by a frame
+    const float count    = cachedCount + 1.;
+    const float resolved = lerp( f16tof32( cached ), shadow, 1. / count );
+
+    g_LightCache[ uFace ] = f32tof16( resolved ) | ( f32tof16( count ) << 16 );
+
+    return resolved;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+float3 PhongShadowed( in const float3 camPos, in const float3 hitPos, in const float3 normal, in const float shadow )
+{
+    const float3 lightDir   = normalize( PHONG_LIGHT_POS - hitPos );
+    const float3 viewDir    = normalize( camPos - hitPos );
+    const float3 reflectDir = normalize( lightDir + viewDir );
+
+    const float diff = max( dot( normal, lightDir ), 0.0 );
+    const float spec = pow( max( dot( normal, reflectDir ), 0.0 ), PHONG_SHININESS );
+
+    const float3 ambient  = PHONG_AMBIENT * PHONG_LIGHT_COLOR;
+    const float3 diffuse  = PHONG_DIFFUSE * diff * PHONG_LIGHT_COLOR * shadow;
+    const float3 specular = PHONG_SPECULAR * spec * PHONG_LIGHT_COLOR * shadow;
+
+    return ambient + diffuse + specular;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+float3 PhongSoftShadows( in const float2 uv,
+                         in const float3 camPos,
+                         in const float3 hitPos,
+                         in const float3 normal,
+                         in const int    maxDistance )
+{
+    return PhongShadowed( camPos, hitPos, normal, SoftShadowRay( uv, hitPos, PHONG_LIGHT_POS, normal, maxDistance ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Color, reflection power and roughness of the surface a primary ray hit
+float4 HitMaterial( in const int hitType, in const uint uIndex, out float reflectionPower, out float roughness )
+{
+    reflectionPower = 0.;
+    roughness       = 0.;
+
+    if ( hitType == HIT_TYPE_VOXEL )
+    {
+        reflectionPower = 0.2;
+        return ExtractColorInt( 0x00FF77FF );
+    }
+    if ( hitType == HIT_TYPE_OBJECT )
+    {
+        reflectionPower = 0.45;
+        return ExtractColorInt( 0xFFFFFFFF );
+    }
+    if ( hitType == HIT_TYPE_STREAMED )
+    {
+        reflectionPower = 0.2;
+        return ExtractColorInt( g_ChunkSlots[ uIndex ] );
+    }
+    if ( hitType == HIT_TYPE_MIP )
+    {
+        reflectionPower = 0.2;
+        return ExtractColorInt( g_VoxelMips.Load( VOXEL_MIPS_HEAD + uIndex * 4 ) );
+    }
+
+    return float4( 1., 0.5, 1., 1. );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Light the bounces add to the surface, every bounce blends over the color of the surface before it. The reflection is
+// the color of the surface times baseWeight plus the returned light
+float3 ReflectionLight( in const float2 uv,
+                        in float3       from,
+                        in float3       to,
+                        in int          maxSteps,
+                        in const uint   bounces,
+                        in float3       normal,
+                        in float        fMaterialReflectPower,
+                        in float        fRoughness,
+                        out float       baseWeight )
+{
+    float3 dir;
+    float3 hit;
+    uint   index;
+    float  fDistance = 1.;
+    float3 normalRef;
+    int    hitType;
+
+    float3 incident;
+    float  fShadow;
+    float  fLocalReflect;
+    float3 reflectedColor = float3( 0., 0., 0. );
+    float4 hitBaseColor;
+
+    baseWeight = 1.;
+
+    for ( uint i = 0; i < bounces; ++i )
+    {
+        if ( fMaterialReflectPower <= 0.0 )
+            break;
+
+        dir = reflect( normalize( to - from ), normal );
+        dir = lerp( dir, RandomPointOnHemisphere( normal, uv, FrameSeed() ), fRoughness * fDistance * 0.25 );
+
+        if ( !MarchTheRay( to + dir * EPSILON, dir, 0., maxSteps, false, hit, index, fDistance, normalRef, hitType ) )
+        {
+            reflectedColor  = lerp( reflectedColor, BASE_SKY_COLOR.xyz, fMaterialReflectPower );
+            baseWeight     *= 1. - fMaterialReflectPower;
+            return reflectedColor;
+        }
+
+        from   = to;
+        to     = hit;
+        normal = normalRef;
+
+        if ( hitType == HIT_TYPE_VOXEL )
+        {
+            hitBaseColor  = ExtractColorInt( g_Voxels[ index ].Color );
+            fLocalReflect = 0.1;
+            fRoughness    = 0.01;
+        }
+        if ( hitType == HIT_TYPE_OBJECT )
+        {
+            hitBaseColor  = ExtractColorInt( 0xFFFFFFFF );
+            fLocalReflect = 0.25;
+            fRoughness    = 0.01;
+        }
+        if ( hitType == HIT_TYPE_STREAMED )
+        {
+            hitBaseColor  = ExtractColorInt( g_ChunkSlots[ index ] );
+            fLocalReflect = 0.1;
+            fRoughness    = 0.01;
+        }
+        if ( hitType == HIT_TYPE_MIP )
+        {
+            hitBaseColor  = ExtractColorInt( g_VoxelMips.Load( VOXEL_MIPS_HEAD + index * 4 ) );
+            fLocalReflect = 0.1;
+            fRoughness    = 0.01;
+        }
+
+        fShadow        = HitShadow( uv, hitType, index, hit, normal, maxSteps, false );
+        reflectedColor = lerp( reflectedColor,
+                               PhongShadowed( from, hit, normal, fShadow ) * hitBaseColor.xyz,
+                               fMaterialReflectPower );
+        baseWeight    *= 1. - fMaterialReflectPower;
+
+        fMaterialReflectPower *= fLocalReflect * 2;
+        maxSteps = maxSteps * 0.5;
+    }
+
+    return reflectedColor;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+float3 Reflection( in const float2 uv,
+                   in const float3 from,
+                   in const float3 to,
+                   in const int    maxSteps,
+                   in const uint   bounces,
+                   in const float3 baseColor,
+                   in const float3 normal,
+                   in const float  fMaterialReflectPower,
+                   in const float  fRoughness )
+{
+    float        baseWeight;
+    const float3 light =
+        ReflectionLight( uv, from, to, maxSteps, bounces, normal, fMaterialReflectPower, fRoughness, baseWeight );
+
+    return baseColor * baseWeight + light;
+}
+
+/*
+ * Use the diffrence of distance and MAX_RENDER_DIST as the value that interpolates between colors.
+ * Clamp that value to HALF_MAX_RENDER_DIST (it creates that slow fading gradient).
+ * Divide the clamped value by HALF_MAX_RENDER_DIST to get number between 0. and 1. */
+float4 FadeOutHorizont( float4 finalColor, float distance )
+{
+    return lerp( finalColor,
+                 BASE_SKY_COLOR,
+                 clamp( distance - MAX_RENDER_DIST, 0.f, HALF_MAX_RENDER_DIST ) / HALF_MAX_RENDER_DIST );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+uint PackSnorm4x8( in const float4 v )
+{
+    const int4 i = int4( round( clamp( v, -1., 1. ) * 127. ) ) & 0xFF;
+    return uint( i.x | ( i.y << 8 ) | ( i.z << 16 ) | ( i.w << 24 ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+float4 UnpackSnorm4x8( in const uint u )
+{
+    const int4 i = int4( u << 24, u << 16, u << 8, u ) >> 24;
+    return clamp( float4( i ) / 127., -1., 1. );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Projects the point with the camera of the previous frame, false if it was behind it or off the screen
+bool ReprojectPoint( in const float3 pos, in const uint2 imgSize, out int2 prevPixel, out float prevDistance )
+{
+    const PushConstants prev  = g_PreviousFrame[ 0 ];
+    const float3        toPos = pos - prev.CameraPos;
+    const float         depth = dot( toPos, prev.CameraLookDir );
+
+    prevPixel    = int2( 0, 0 );
+    prevDistance = length( toPos );
+
+    if ( depth <= EPSILON )
+        return false;
+
+    const float  scale       = tan( prev.fFov * 0.5 );
+    const float  aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const float2 uv          = float2( dot( toPos, prev.CameraRight ) / ( depth * aspectRatio * scale ),
+                              dot( toPos, prev.CameraUp ) / ( depth * scale ) );
+
+    prevPixel = int2( floor( ( uv * 0.5 + 0.5 ) * float2( imgSize ) ) );
+
+    return all( prevPixel >= 0 ) && all( prevPixel < int2( imgSize ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Blends the color with the previous frames seen by the pixel and stores the result. History of the previous frame is
+// dropped when its distance or normal don't match the hit, the surface wasn't visible there. Misses only reset it
+float3 ResolveHistory( in const uint2  pixel,
+                       in const uint2  imgSize,
+                       in const float3 color,
+                       in const bool   bHit,
+                       in const float3 hitPos,
+                       in const float3 normal )
+{
+    uint historyCount = 0, historyStride = 0;
+    g_History.GetDimensions( historyCount, historyStride );
+
+    const uint uHalf     = historyCount / 2;
+    const uint uCurrent  = ( pc.uFrame & 1 ) * uHalf;
+    const uint uPrevious = uHalf - uCurrent;
+    const uint uPixel    = pixel.x + pixel.y * imgSize.x;
+
+    if ( uPixel >= uHalf )
+        return color;
+
+    float3 resolved = color;
+    float  count    = 1.;
+
+    int2  prevPixel;
+    float prevDistance;
+    uint4 history;
+    float historyDistance;
+    if ( bHit && pc.uFrame != 0 && ReprojectPoint( hitPos, imgSize, prevPixel, prevDistance ) )
+    {
+        history         = g_History[ uPrevious + uint( prevPixel.x ) + uint( prevPixel.y ) * imgSize.x ];
+        historyDistance = asfloat( history.w );
+
+        if ( historyDistance >= 0. &&
+             abs( historyDistance - prevDistance ) <= HISTORY_DEPTH_TOLERANCE * prevDistance + 0.1 &&
+             dot( UnpackSnorm4x8( history.z ).xyz, normal ) >= HISTORY_NORMAL_MIN_COS )
+        {
+            count    = min( f16tof32( history.y >> 16 ) + 1., HISTORY_MAX_FRAMES );
+            resolved = lerp( f16tof32( uint3( history.x, history.x >> 16, history.y ) ), color, 1. / count );
+        }
+    }
+
+    g_History[ uCurrent + uPixel ] =
+        uint4( f32tof16( resolved.r ) | ( f32tof16( resolved.g ) << 16 ),
+               f32tof16( resolved.b ) | ( f32tof16( count ) << 16 ),
+               PackSnorm4x8( float4( normal, 0. ) ),
+               asuint( bHit ? distance( hitPos, pc.CameraPos ) : -1. ) );
+
+    return resolved;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Loads the occupancy of the brick around the point where the central ray of the group leaves the empty space of its
+// tiles. The rays of a group barely spread over the brick, most of them march their first cells from it. Has to be
+// reached by every thread of the group
+void LoadTileCache( in const uint2 imgSize, in const uint2 groupId, in const uint uGroupIndex )
+{
+    uint tileStartCount = 0, tileStartStride = 0;
+    g_TileStart.GetDimensions( tileStartCount, tileStartStride );
+
+    const uint2  groupSize   = uint2( GROUP_SIZE_X, GROUP_SIZE_Y );
+    const uint2  groupPixel  = groupId * groupSize;
+    const uint2  tileCount   = ( imgSize + TILE_DIM - 1 ) >> TILE_DIM_SHIFT;
+    const uint2  tileLo      = groupPixel >> TILE_DIM_SHIFT;
+    const uint2  tileHi      = min( ( groupPixel + groupSize - 1 ) >> TILE_DIM_SHIFT, tileCount - 1 );
+    const float  scale       = tan( pc.fFov * 0.5 );
+    const float  aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const float2 uv          = ( ( float2( groupPixel ) + float2( groupSize ) * 0.5 ) / float2( imgSize ) ) * 2. - 1.;
+    const float3 rd =
+        normalize( pc.CameraLookDir + uv.x * aspectRatio * scale * pc.CameraRight + uv.y * scale * pc.CameraUp );
+
+    // Closest start of the tiles, the rays of the group start there at the earliest
+    float tStart = INF;
+    uint  uTile;
+    for ( uint y = tileLo.y; y <= tileHi.y; ++y )
+    {
+        for ( uint x = tileLo.x; x <= tileHi.x; ++x )
+        {
+            uTile  = x + y * tileCount.x;
+            tStart = min( tStart, uTile < tileStartCount ? g_TileStart[ uTile ] : 0. );
+        }
+    }
+
+    // Brick reaches a few voxels behind the start for the rays around the central one and the rest ahead of it
+    const float3 center = pc.CameraPos + rd * ( min( tStart, MAX_RENDER_DIST ) + float( TILE_CACHE_DIM / 2 - 2 ) );
+    g_TileCacheOrigin   = int3( floor( center ) ) - TILE_CACHE_DIM / 2;
+
+    uint uWord;
+    for ( uWord = uGroupIndex; uWord < TILE_CACHE_WORDS; uWord += GROUP_SIZE_X * GROUP_SIZE_Y )
+        g_TileOccupancy[ uWord ] = 0;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // Neighbouring threads read neighbouring voxels, only the inside of the grid is cached like in MarchTheRay
+    int3 voxel;
+    uint uBit;
+    for ( uBit = uGroupIndex; uBit < TILE_CACHE_WORDS * 32; uBit += GROUP_SIZE_X * GROUP_SIZE_Y )
+    {
+        voxel = g_TileCacheOrigin + int3( uBit & ( TILE_CACHE_DIM - 1 ),
+                                          ( uBit >> TILE_CACHE_SHIFT ) & ( TILE_CACHE_DIM - 1 ),
+                                          uBit >> ( 2 * TILE_CACHE_SHIFT ) );
+
+        if ( all( voxel > 0 ) && all( voxel < pc.GridSize ) &&
+             g_Voxels[ voxel.x + voxel.y * pc.GridSize.x + voxel.z * pc.GridSize.x * pc.GridSize.y ].Type ==
+                 uint( HIT_TYPE_VOXEL ) )
+        {
+            InterlockedOr( g_TileOccupancy[ uBit >> 5 ], 1u << ( uBit & 31 ) );
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+}
@@ -0,0 +1,94 @@
+// Stretches the rendered corner of the render image over the swapchain image, bilinear with a sharpening clamped to
+// the closest texels so edges don't ring
+
+#define UPSCALE_SHARPNESS 0.25
+
+struct PushConstants
+{
+    float3 CameraPos;
+    uint   _Padding0;
+    int3   GridSize;
+    uint   _Padding1;
+    float3 CameraLookDir;
+    uint   _Padding2;
+    float3 CameraRight;
+    uint   _Padding3;
+    float3 CameraUp;
+    uint   _Padding4;
+    float  fFov;
+    uint   uDebugMode;
+    uint   uFrame;
+    uint   uRenderExtent;
+};
+
+#if defined( VULKAN )
+[[vk::image_format( "rgba8" )]]
+#endif
+RWTexture2D<float4> g_RenderImage : register( u0 );
+RWTexture2D<float4> g_OutputImage : register( u11 );
+
+#if defined( VULKAN )
+
+[[vk::push_constant]]
+PushConstants pc;
+
+#else
+
+cbuffer PushConstantsBuffer : register( b1 )
+{
+    PushConstants pc;
+};
+
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+float4 LoadTexel( in const int2 texel, in const int2 extent )
+{
+    return g_RenderImage[ clamp( texel, int2( 0, 0 ), extent - 1 ) ];
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature( "DescriptorTable( UAV( u0 ), UAV( u11 ), CBV( b1 ) )" ) ][ numthreads( 8, 8, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    uint outputImageWidth = 0, outputImageHeight = 0;
+    g_OutputImage.GetDimensions( outputImageWidth, outputImageHeight );
+
+    const int2 pixel   = int2( dispatchThreadId.xy );
+    const int2 outSize = int2( outputImageWidth, outputImageHeight );
+    const int2 extent  = int2( pc.uRenderExtent & 0xFFFF, pc.uRenderExtent >> 16 );
+
+    if ( any( pixel >= outSize ) )
+        return;
+
+    // Nothing to filter at the full resolution
+    if ( all( extent == outSize ) )
+    {
+        g_OutputImage[ pixel ] = LoadTexel( pixel, extent );
+        return;
+    }
+
+    const float2 pos  = ( float2( pixel ) + 0.5 ) * float2( extent ) / float2( outSize ) - 0.5;
+    const int2   base = int2( floor( pos ) );
+    const float2 f    = pos - float2( base );
+
+    const float4 bilinear =
+        lerp( lerp( LoadTexel( base, extent ), LoadTexel( base + int2( 1, 0 ), extent ), f.x ),
+              lerp( LoadTexel( base + int2( 0, 1 ), extent ), LoadTexel( base + int2( 1, 1 ), extent ), f.x ),
+              f.y );
+
+    const int2   nearest = int2( floor( pos + 0.5 ) );
+    const float4 center  = LoadTexel( nearest, extent );
+    const float4 north   = LoadTexel( nearest + int2( 0, -1 ), extent );
+    const float4 south   = LoadTexel( nearest + int2( 0, 1 ), extent );
+    const float4 east    = LoadTexel( nearest + int2( 1, 0 ), extent );
+    const float4 west    = LoadTexel( nearest + int2( -1, 0 ), extent );
+
+    const float4 lo = min( center, min( min( north, south ), min( east, west ) ) );
+    const float4 hi = max( center, max( max( north, south ), max( east, west ) ) );
+
+    const float4 sharpened =
+        clamp( bilinear + ( center - ( north + south + east + west ) * 0.25 ) * UPSCALE_SHARPNESS, lo, hi );
+
+    g_OutputImage[ pixel ] = float4( sharpened.rgb, 1. );
+}
@@ -0,0 +1,88 @@
+// Wavefront mode splits the raycast into passes. The primary pass writes a record of the hit of every pixel and queues
+// the pixels that need more work, the shadow and reflection passes trace the secondary rays of their queues and the
+// shade pass puts the records together. Queues are dispatched indirectly, pixels that see the sky never reach them
+
+#define WAVEFRONT_GROUP_SIZE 64
+
+#define QUEUE_SHADOW     0
+#define QUEUE_REFLECTION 1
+#define QUEUE_SHADE      2
+#define QUEUE_COUNT      3
+#define QUEUES_HEAD      ( QUEUE_COUNT * 16 )
+
+#define RECORD_SHADED    1
+#define RECORD_REFLECTED 2
+
+// Group count, 1, 1 and the length of every queue as uint4, the first three are the arguments of its indirect
+// dispatch. The packed pixels of the queues follow, each queue has a segment as long as the buffer has room for
+RWByteAddressBuffer g_WavefrontQueues : register( u16 );
+
+// Hit position and distance, normal as halfs, hit type and index, shadow, reflected light and the weight of the color
+// of the surface as halfs and the flags, three uint4 per pixel of the rendered image
+RWStructuredBuffer<uint4> g_HitRecords : register( u17 );
+
+// --------------------------------------------------------------------------------------------------------------------
+uint QueueCapacity()
+{
+    uint uBytes = 0;
+    g_WavefrontQueues.GetDimensions( uBytes );
+
+    return ( uBytes - QUEUES_HEAD ) / 4 / QUEUE_COUNT;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Adds the pixel to the queue and grows the group count of its dispatch to cover it
+void Enqueue( in const uint uQueue, in const uint2 pixel )
+{
+    const uint uCapacity = QueueCapacity();
+
+    uint uSlot;
+    g_WavefrontQueues.InterlockedAdd( uQueue * 16 + 12, 1, uSlot );
+    if ( uSlot >= uCapacity )
+        return;
+
+    uint uGroups;
+    g_WavefrontQueues.InterlockedMax( uQueue * 16, uSlot / WAVEFRONT_GROUP_SIZE + 1, uGroups );
+
+    g_WavefrontQueues.Store( QUEUES_HEAD + ( uQueue * uCapacity + uSlot ) * 4, pixel.x | ( pixel.y << 16 ) );
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Pixel of the queue the thread works on, false past the end of the queue
+bool Dequeue( in const uint uQueue, in const uint uSlot, out uint2 pixel )
+{
+    const uint uCapacity = QueueCapacity();
+
+    pixel = uint2( 0, 0 );
+    if ( uSlot >= min( g_WavefrontQueues.Load( uQueue * 16 + 12 ), uCapacity ) )
+        return false;
+
+    const uint uItem = g_WavefrontQueues.Load( QUEUES_HEAD + ( uQueue * uCapacity + uSlot ) * 4 );
+    pixel            = uint2( uItem & 0xFFFF, uItem >> 16 );
+
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+uint RecordIndex( in const uint2 pixel )
+{
+    return ( pixel.x + pixel.y * ( pc.uRenderExtent & 0xFFFF ) ) * 3;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+void ReadHit( in const uint  uRecord,
+              out float3     hitPos,
+              out float      hitDistance,
+              out float3     normal,
+              out int        hitType,
+              out uint       uIndex )
+{
+    const uint4 hit     = g_HitRecords[ uRecord ];
+    const uint4 surface = g_HitRecords[ uRecord + 1 ];
+
+    hitPos      = asfloat( hit.xyz );
+    hitDistance = asfloat( hit.w );
+    normal      = float3( f16tof32( surface.x ), f16tof32( surface.x >> 16 ), f16tof32( surface.y ) );
+    hitType     = int( surface.z );
+    uIndex      = surface.w;
+}
@@ -0,0 +1,82 @@
+#include "Raycast.hlsl"
+#include "Wavefront.hlsl"
+
+// Every thread marches the primary ray of its pixel and writes the record of the hit. Misses are finished here, hits
+// are queued for the shade pass and for the shadow and reflection passes when they need them
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature(
+    "DescriptorTable( UAV( u0 ), SRV( t1, numDescriptors = 8 ), UAV( u9 ), SRV( t10 ), UAV( u12 ), "
+    "SRV( t14, numDescriptors = 2 ), UAV( u16, numDescriptors = 2 ), CBV( b1 ) )" ) ]
+[ numthreads( GROUP_SIZE_X, GROUP_SIZE_Y, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID, uint3 groupId : SV_GroupID, uint uGroupIndex : SV_GroupIndex )
+{
+    const uint2 imgSize = uint2( pc.uRenderExtent & 0xFFFF, pc.uRenderExtent >> 16 );
+    const uint2 pixel   = dispatchThreadId.xy;
+
+    if ( TILE_CACHE == 1 )
+        LoadTileCache( imgSize, groupId.xy, uGroupIndex );
+
+    if ( any( pixel >= imgSize ) )
+        return;
+
+    const float  scale       = tan( pc.fFov * 0.5 );
+    const float  aspectRatio = float( imgSize.x ) / float( imgSize.y );
+    const float2 uv          = ( ( pixel + float2( 0.5, 0.5 ) ) / float2( imgSize ) ) * 2. - 1.;
+    const float3 rd =
+        normalize( pc.CameraLookDir + uv.x * aspectRatio * scale * pc.CameraRight + uv.y * scale * pc.CameraUp );
+
+    // Beam pass already stepped over the empty space in front of the whole tile
+    uint tileStartCount = 0, tileStartStride = 0;
+    g_TileStart.GetDimensions( tileStartCount, tileStartStride );
+
+    const uint2 tile   = pixel >> TILE_DIM_SHIFT;
+    const uint  uTile  = tile.x + tile.y * ( ( imgSize.x + TILE_DIM - 1 ) >> TILE_DIM_SHIFT );
+    const float tStart = uTile < tileStartCount ? g_TileStart[ uTile ] : 0.;
+
+    float3 hitPos;
+    uint   index;
+    float  hitDistance;
+    float3 normal;
+    int    hitType;
+    if ( !MarchTheRay( pc.CameraPos, rd, tStart, MAX_STEPS, true, hitPos, index, hitDistance, normal, hitType ) )
+    {
+        ResolveHistory( pixel, imgSize, BASE_SKY_COLOR.xyz, false, float3( 0., 0., 0. ), float3( 0., 0., 0. ) );
+        g_OutputImage[ pixel ] = BASE_SKY_COLOR;
+        return;
+    }
+
+    uint recordCount = 0, recordStride = 0;
+    g_HitRecords.GetDimensions( recordCount, recordStride );
+
+    const uint uRecord = RecordIndex( pixel );
+    if ( uRecord + 2 >= recordCount )
+        return;
+
+    float reflectionPower;
+    float roughness;
+    HitMaterial( hitType, index, reflectionPower, roughness );
+
+    // Hits further than the raycast shades keep the plain color of the surface
+    uint uFlags = 0;
+    if ( hitDistance <= MAX_STEPS )
+    {
+        uFlags |= RECORD_SHADED;
+        Enqueue( QUEUE_SHADOW, pixel );
+
+        if ( REFLECTION_BOUNCES > 0 && reflectionPower > 0. )
+        {
+            uFlags |= RECORD_REFLECTED;
+            Enqueue( QUEUE_REFLECTION, pixel );
+        }
+    }
+
+    g_HitRecords[ uRecord ]     = uint4( asuint( hitPos ), asuint( hitDistance ) );
+    g_HitRecords[ uRecord + 1 ] = uint4( f32tof16( normal.x ) | ( f32tof16( normal.y ) << 16 ),
+                                         f32tof16( normal.z ),
+                                         uint( hitType ),
+                                         index );
+    g_HitRecords[ uRecord + 2 ] = uint4( asuint( 1. ), 0, f32tof16( 1. ) << 16, uFlags );
+
+    Enqueue( QUEUE_SHADE, pixel );
+}
@@ -0,0 +1,44 @@
+#include "Raycast.hlsl"
+#include "Wavefront.hlsl"
+
+// Every thread traces the bounces of a pixel of the reflection queue. The light they add and the weight left to the
+// surface go to the record, the shade pass blends them over the shaded color
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature(
+    "DescriptorTable( UAV( u0 ), SRV( t1, numDescriptors = 8 ), UAV( u9 ), SRV( t10 ), UAV( u12 ), "
+    "SRV( t14, numDescriptors = 2 ), UAV( u16, numDescriptors = 2 ), CBV( b1 ) )" ) ]
+[ numthreads( WAVEFRONT_GROUP_SIZE, 1, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    uint2 pixel;
+    if ( !Dequeue( QUEUE_REFLECTION, dispatchThreadId.x, pixel ) )
+        return;
+
+    const uint uRecord = RecordIndex( pixel );
+
+    float3 hitPos;
+    float  hitDistance;
+    float3 normal;
+    int    hitType;
+    uint   index;
+    ReadHit( uRecord, hitPos, hitDistance, normal, hitType, index );
+
+    float reflectionPower;
+    float roughness;
+    HitMaterial( hitType, index, reflectionPower, roughness );
+
+    float        baseWeight;
+    const float3 light = ReflectionLight( pixel,
+                                          pc.CameraPos,
+                                          hitPos,
+                                          MAX_STEPS / 2,
+                                          REFLECTION_BOUNCES,
+                                          normal,
+                                          reflectionPower,
+                                          roughness,
+                                          baseWeight );
+
+    g_HitRecords[ uRecord + 2 ].y = f32tof16( light.r ) | ( f32tof16( light.g ) << 16 );
+    g_HitRecords[ uRecord + 2 ].z = f32tof16( light.b ) | ( f32tof16( baseWeight ) << 16 );
+}
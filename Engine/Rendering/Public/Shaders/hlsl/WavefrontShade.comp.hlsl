@@ -0,0 +1,49 @@
+#include "Raycast.hlsl"
+#include "Wavefront.hlsl"
+
+// Every thread shades a pixel of the shade queue from its record and resolves it with the history
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature(
+    "DescriptorTable( UAV( u0 ), SRV( t1, numDescriptors = 8 ), UAV( u9 ), SRV( t10 ), UAV( u12 ), "
+    "SRV( t14, numDescriptors = 2 ), UAV( u16, numDescriptors = 2 ), CBV( b1 ) )" ) ]
+[ numthreads( WAVEFRONT_GROUP_SIZE, 1, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    uint2 pixel;
+    if ( !Dequeue( QUEUE_SHADE, dispatchThreadId.x, pixel ) )
+        return;
+
+    const uint2 imgSize = uint2( pc.uRenderExtent & 0xFFFF, pc.uRenderExtent >> 16 );
+    const uint  uRecord = RecordIndex( pixel );
+    const uint4 light   = g_HitRecords[ uRecord + 2 ];
+
+    float3 hitPos;
+    float  hitDistance;
+    float3 normal;
+    int    hitType;
+    uint   index;
+    ReadHit( uRecord, hitPos, hitDistance, normal, hitType, index );
+
+    float  reflectionPower;
+    float  roughness;
+    float4 finalColor = HitMaterial( hitType, index, reflectionPower, roughness );
+
+    if ( light.w & RECORD_SHADED )
+    {
+        finalColor.xyz = finalColor.xyz * PhongShadowed( pc.CameraPos, hitPos, normal, asfloat( light.x ) );
+
+        if ( light.w & RECORD_REFLECTED )
+        {
+            finalColor.xyz = finalColor.xyz * f16tof32( light.z >> 16 ) +
+                             float3( f16tof32( light.y ), f16tof32( light.y >> 16 ), f16tof32( light.z ) );
+        }
+    }
+
+    if ( hitDistance > MAX_RENDER_DIST )
+        finalColor = FadeOutHorizont( finalColor, hitDistance );
+
+    finalColor.xyz = ResolveHistory( pixel, imgSize, finalColor.xyz, true, hitPos, normal );
+
+    g_OutputImage[ pixel ] = finalColor;
+}
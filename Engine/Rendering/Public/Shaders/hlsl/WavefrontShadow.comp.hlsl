@@ -0,0 +1,30 @@
+#include "Raycast.hlsl"
+#include "Wavefront.hlsl"
+
+// Every thread traces the soft shadow of a pixel of the shadow queue, the light cache is refined like in the raycast
+
+// --------------------------------------------------------------------------------------------------------------------
+[ RootSignature(
+    "DescriptorTable( UAV( u0 ), SRV( t1, numDescriptors = 8 ), UAV( u9 ), SRV( t10 ), UAV( u12 ), "
+    "SRV( t14, numDescriptors = 2 ), UAV( u16, numDescriptors = 2 ), CBV( b1 ) )" ) ]
+[ numthreads( WAVEFRONT_GROUP_SIZE, 1, 1 ) ] void
+main( uint3 dispatchThreadId : SV_DispatchThreadID )
+{
+    uint2 pixel;
+    if ( !Dequeue( QUEUE_SHADOW, dispatchThreadId.x, pixel ) )
+        return;
+
+    const uint uRecord = RecordIndex( pixel );
+
+    float3 hitPos;
+    float  hitDistance;
+    float3 normal;
+    int    hitType;
+    uint   index;
+    ReadHit( uRecord, hitPos, hitDistance, normal, hitType, index );
+
+    const int   phongDistanceMax = int( distance( hitPos, PHONG_LIGHT_POS ) );
+    const float shadow           = HitShadow( pixel, hitType, index, hitPos, normal, phongDistanceMax, true );
+
+    g_HitRecords[ uRecord + 2 ].x = asuint( shadow );
+}
@@ -12,6 +12,9 @@ struct Frame
     ::VkSemaphore     ImageAvailable;
     ::VkSemaphore     RenderFinished;
     ::VkCommandBuffer CommandBuffer;
+
+    // Timestamps of the frame were recorded by the last use of the slot
+    bool bTimestampsWritten = false;
 };
 
 } // namespace B33::Rendering
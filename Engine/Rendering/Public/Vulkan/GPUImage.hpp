@@ -0,0 +1,94 @@
+#ifndef B33_GPU_IMAGE_H
+#define B33_GPU_IMAGE_H
+
+#include "WrapperAdapter.hpp"
+
+namespace B33::Rendering
+{
+
+/**
+ * @brief Single 2D image in the device local memory with a view over all of it, only shaders access it.
+ */
+class GPUImage
+{
+  public:
+    GPUImage( ::std::shared_ptr<const ::B33::Rendering::AdapterWrapper> da,
+              ::VkDeviceMemory                                          deviceMemory,
+              ::VkImage                                                 image,
+              ::VkImageView                                             imageView,
+              ::VkExtent2D                                              extent,
+              ::VkFormat                                                format )
+      : m_pDeviceAdapter( da )
+      , m_DeviceMemory( deviceMemory )
+      , m_Image( image )
+      , m_ImageView( imageView )
+      , m_Extent( extent )
+      , m_Format( format )
+    {
+    }
+
+    ~GPUImage()
+    {
+        if ( m_pDeviceAdapter == nullptr )
+        {
+            return;
+        }
+        if ( m_ImageView != VK_NULL_HANDLE )
+        {
+            ::vkDestroyImageView( m_pDeviceAdapter->GetAdapterHandle(), m_ImageView, NULL );
+        }
+        if ( m_Image != VK_NULL_HANDLE )
+        {
+            ::vkDestroyImage( m_pDeviceAdapter->GetAdapterHandle(), m_Image, NULL );
+        }
+        if ( m_DeviceMemory != VK_NULL_HANDLE )
+        {
+            ::vkFreeMemory( m_pDeviceAdapter->GetAdapterHandle(), m_DeviceMemory, NULL );
+        }
+        m_pDeviceAdapter = nullptr;
+    }
+
+  public:
+    GPUImage( const GPUImage &other )                     = delete;
+    GPUImage &operator=( const GPUImage &other ) noexcept = delete;
+
+    GPUImage( GPUImage &&other )                     = delete;
+    GPUImage &operator=( GPUImage &&other ) noexcept = delete;
+
+  public:
+    ::VkDeviceMemory GetMemoryHandle() const
+    {
+        return m_DeviceMemory;
+    }
+
+    ::VkImage GetImageHandle() const
+    {
+        return m_Image;
+    }
+
+    ::VkImageView GetViewHandle() const
+    {
+        return m_ImageView;
+    }
+
+    const ::VkExtent2D &GetExtent() const
+    {
+        return m_Extent;
+    }
+
+    ::VkFormat GetFormat() const
+    {
+        return m_Format;
+    }
+
+  private:
+    ::std::shared_ptr<const ::B33::Rendering::AdapterWrapper> m_pDeviceAdapter = nullptr;
+    ::VkDeviceMemory                                          m_DeviceMemory   = VK_NULL_HANDLE;
+    ::VkImage                                                 m_Image          = VK_NULL_HANDLE;
+    ::VkImageView                                             m_ImageView      = VK_NULL_HANDLE;
+    ::VkExtent2D                                              m_Extent         = { 0, 0 };
+    ::VkFormat                                                m_Format         = VK_FORMAT_UNDEFINED;
+};
+
+} // namespace B33::Rendering
+#endif //! B33_GPU_IMAGE_H
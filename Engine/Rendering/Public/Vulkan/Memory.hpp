@@ -2,6 +2,7 @@
 #define B33_MEMORY_H
 
 #include "GPUBuffer.hpp"
+#include "GPUImage.hpp"
 #include "GPUStreamBuffer.hpp"
 #include "WrapperAdapter.hpp"
 #include "WrapperHardware.hpp"
@@ -100,10 +101,29 @@ class Memory
   public:
     BEAST_API ::std::shared_ptr<::B33::Rendering::GPUStreamBuffer> ReserveStagingBuffer( const ::size_t uSizeInBytes );
 
-    BEAST_API ::std::shared_ptr<::B33::Rendering::GPUBuffer> ReserveGPUBuffer( const ::size_t uSizeInBytes );
+    /**
+     * @brief Storage buffer the transfers can write to, usage adds to that, e.g. the arguments of indirect dispatches.
+     */
+    BEAST_API ::std::shared_ptr<::B33::Rendering::GPUBuffer> ReserveGPUBuffer( const ::size_t             uSizeInBytes,
+                                                                               const ::VkBufferUsageFlags usage = 0 );
 
+    /**
+     * @brief Storage image in the undefined layout, the first barrier over it has to move it to the general one.
+     */
+    BEAST_API ::std::shared_ptr<::B33::Rendering::GPUImage> ReserveGPUImage( const ::uint32_t uWidth,
+                                                                             const ::uint32_t uHeight,
+                                                                             const ::VkFormat format );
+
+    BEAST_API void UploadOnStreamBuffer( const void                               *pUpload,
+                                         const ::size_t                            uUploadSize,
+                                         const ::B33::Rendering::UploadDescriptor &onSet );
+
+    /**
+     * @brief Writes at uOffset bytes into the stream buffer, the rest of it stays as it was.
+     */
     BEAST_API void UploadOnStreamBuffer( const void                               *pUpload,
                                          const ::size_t                            uUploadSize,
+                                         const ::size_t                            uOffset,
                                          const ::B33::Rendering::UploadDescriptor &onSet );
 
   private:
@@ -19,6 +19,16 @@ class Renderer
 {
     using FramesArray = ::std::array<::B33::Rendering::Frame, ::B33::Rendering::Frame::MAX_FRAMES_IN_FLIGHT>;
 
+  public:
+    // Dynamic resolution, the scale moves in steps so the upscaled image doesn't shimmer between frames
+    static constexpr float      MinRenderScale      = 0.5f;
+    static constexpr float      RenderScaleStep     = 1.f / 16.f;
+    static constexpr float      GpuTimeSmoothing    = 0.1f;
+    static constexpr float      GpuBudgetLowerBound = 0.75f;
+    static constexpr ::uint32_t RenderScaleCooldown = 16;
+
+    static constexpr const char *PipelineCacheFile = "PipelineCache.bin";
+
   public:
     Renderer()
       : m_pInstance( nullptr )
@@ -32,6 +42,14 @@ class Renderer
       , m_LastResultState( VK_SUCCESS )
       , m_uCurrentFrame( 0 )
       , m_vFrames()
+      , m_LastPresentTime()
+      , m_TimestampPool( VK_NULL_HANDLE )
+      , m_fTimestampPeriod( 0.f )
+      , m_fGpuBudgetMs( 0.f )
+      , m_fGpuTimeMs( 0.f )
+      , m_fRenderScale( 1.f )
+      , m_uScaleCooldown( 0 )
+      , m_PipelineCache( VK_NULL_HANDLE )
     {
     }
 
@@ -61,7 +79,7 @@ class Renderer
     {
         auto pipeline = ::std::make_shared<PIPE_LINE>();
 
-        pipeline->Initialize( m_pDeviceAdapter, m_pMemory, m_pWindowDesc, m_pSwapChain, *pipeline );
+        pipeline->Initialize( m_pDeviceAdapter, m_pMemory, m_pWindowDesc, m_pSwapChain, m_PipelineCache, *pipeline );
         pipeline->CreatePipelineResources( args... );
 
         m_vPipeline.push_back( ::std::static_pointer_cast<::B33::Rendering::PipelineWrapper>( pipeline ) );
@@ -72,6 +90,36 @@ class Renderer
         return m_vPipeline[ uIndex ];
     }
 
+    /**
+     * @return Time at which the last successful vkQueuePresentKHR returned, can be fed in to the FpsLimiter
+     */
+    const ::std::chrono::steady_clock::time_point &GetLastPresentTime() const
+    {
+        return m_LastPresentTime;
+    }
+
+    /**
+     * @brief Frames taking longer on the GPU are rendered at a lower resolution and upscaled to the window, faster
+     * ones go back up. Zero, the default, keeps the full resolution.
+     */
+    void SetGpuBudget( const float fMilliseconds )
+    {
+        m_fGpuBudgetMs = fMilliseconds;
+    }
+
+    /**
+     * @return Smoothed GPU time of the recorded commands, 0 if the device has no timestamps
+     */
+    float GetGpuTime() const
+    {
+        return m_fGpuTimeMs;
+    }
+
+    float GetRenderScale() const
+    {
+        return m_fRenderScale;
+    }
+
   private:
     ::VkCommandPool CreateCommandPool( ::std::shared_ptr<const ::B33::Rendering::AdapterWrapper> da,
                                        ::uint32_t                                                uQueueFamily );
@@ -86,6 +134,20 @@ class Renderer
 
     void RecordCommands( ::VkCommandBuffer &cmdBuff );
 
+    ::VkQueryPool CreateTimestampPool();
+
+    /**
+     * @brief Reads the GPU time of the last use of the frame slot and moves the render scale towards the budget.
+     */
+    void UpdateRenderScale( const ::B33::Rendering::Frame &frame );
+
+    /**
+     * @brief Starts the cache with the file saved by the last run, if it was made by the same device and driver.
+     */
+    ::VkPipelineCache CreatePipelineCache();
+
+    void SavePipelineCache();
+
   private:
     void DestroyFrameResources();
 
@@ -106,6 +168,19 @@ class Renderer
     VkResult                       m_LastResultState;
     ::size_t                       m_uCurrentFrame;
     ::std::unique_ptr<FramesArray> m_vFrames = nullptr;
+
+    ::std::chrono::steady_clock::time_point m_LastPresentTime = {};
+
+    // Two timestamps per frame in flight, around everything the frame records
+    ::VkQueryPool m_TimestampPool    = VK_NULL_HANDLE;
+    float         m_fTimestampPeriod = 0.f;
+    float         m_fGpuBudgetMs     = 0.f;
+    float         m_fGpuTimeMs       = 0.f;
+    float         m_fRenderScale     = 1.f;
+    ::uint32_t    m_uScaleCooldown   = 0;
+
+    // Shared by every pipeline, kept between runs in PipelineCacheFile next to the executable
+    ::VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
 };
 
 } // namespace B33::Rendering
@@ -9,6 +9,13 @@
 namespace B33::Rendering
 {
 
+enum class ERenderQuality
+{
+    Low,
+    Medium,
+    High,
+};
+
 class PipelineWrapper
 {
     using Vec  = ::B33::Math::Vec3;
@@ -65,6 +72,7 @@ class PipelineWrapper
                      ::std::shared_ptr<::B33::Rendering::Memory>               pMemory,
                      ::std::shared_ptr<const ::WindowDesc>                     pWindowDesc,
                      ::std::shared_ptr<const ::B33::Rendering::Swapchain>      pSwapChain,
+                     ::VkPipelineCache                                         pipelineCache,
                      T                                                        &pPipeline )
     {
         B33_LOG( Core::Debug::Info, L"Initializing pipeline" );
@@ -73,6 +81,7 @@ class PipelineWrapper
         m_pMemory        = pMemory;
         m_pWindowDesc    = pWindowDesc;
         m_pSwapChain     = pSwapChain;
+        m_PipelineCache  = pipelineCache;
 
         m_uPushConstantsByteSize = pPipeline.GetPushConstantsByteSize();
         m_pPushConstants         = pPipeline.GetPushConstants();
@@ -89,6 +98,20 @@ class PipelineWrapper
 
     virtual void Reset() = 0;
 
+    /**
+     * @brief Fraction of the window size the pipeline should render at, pipelines that can't scale ignore it.
+     */
+    virtual void SetRenderScale( float )
+    {
+    }
+
+    /**
+     * @brief Preset of the work the pipeline does per pixel, pipelines without presets ignore it.
+     */
+    virtual void SetQuality( ERenderQuality )
+    {
+    }
+
     void LoadPushConstants( const IPushConstants &constants, ::size_t uByteSize )
     {
         B33_ASSERT( uByteSize == m_uPushConstantsByteSize );
@@ -159,11 +182,20 @@ class PipelineWrapper
         return m_DescriptorPool;
     }
 
+    /**
+     * @brief Cache of the renderer, it's internally synchronized so pipelines can be created on any thread.
+     */
+    ::VkPipelineCache GetPipelineCacheInternal() const
+    {
+        return m_PipelineCache;
+    }
+
   private:
     ::std::shared_ptr<const ::B33::Rendering::AdapterWrapper> m_pDeviceAdapter = nullptr;
     ::std::shared_ptr<::B33::Rendering::Memory>               m_pMemory        = nullptr;
     ::std::shared_ptr<const ::WindowDesc>                     m_pWindowDesc    = nullptr;
     ::std::weak_ptr<const ::B33::Rendering::Swapchain>        m_pSwapChain     = {};
+    ::VkPipelineCache                                         m_PipelineCache  = VK_NULL_HANDLE;
 
     ::size_t            m_uPushConstantsByteSize = 0;
     IPushConstants     *m_pPushConstants         = nullptr;
@@ -14,4 +14,10 @@ ComponentOrderRegister ComponentOrderRegister::RegisterOrder( vector<string_view
     return ComponentOrderRegister();
 }
 
+ComponentOrderRegister ComponentOrderRegister::RegisterFixedTimestep( float fHz )
+{
+    EngineLoop::m_fFixedTimestepRegistry = fHz;
+    return ComponentOrderRegister();
+}
+
 } // namespace B33::System
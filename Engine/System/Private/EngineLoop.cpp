@@ -14,34 +14,91 @@ using namespace B33;
 void EngineLoop::InitializeComponents()
 {
     m_bInitialized = true;
+    m_ComponentNames.clear();
     m_Components.clear();
 
     for ( auto &requiredComponent : m_ComponentOrderRegistry )
         AddComponentInternal( requiredComponent );
+
+    BuildSchedule();
 }
 
 void EngineLoop::UpdateComponents( float fDelta )
 {
-    for ( IComponent *component : m_AsyncComponents )
-        m_JobSystem.PushJob(
-            [ & ]()
-            {
-                component->Update( m_ComponentBridge, fDelta );
-            } );
+    if ( m_bScheduleDirty )
+        BuildSchedule();
+
+    // Replays step with the recorded deltas, the number of fixed steps has to match the recorded run
+    if ( m_ComponentBridge.m_DeltaSource )
+        m_ComponentBridge.m_DeltaSource( fDelta );
+
+    if ( !IsFixedTimestep() )
+    {
+        m_ComponentBridge.m_fInterpolationAlpha = 1.f;
+        RunSchedule( m_Schedule, fDelta );
+        return;
+    }
+
+    uint32_t uSteps = 0;
+
+    RunSchedule( m_PreFixedSchedule, fDelta );
+
+    m_fAccumulatorMs += fDelta;
+    while ( m_fAccumulatorMs >= m_fFixedStepMs && uSteps < m_uMaxFixedSteps )
+    {
+        RunSchedule( m_FixedSchedule, m_fFixedStepMs );
+        m_fAccumulatorMs -= m_fFixedStepMs;
+        ++uSteps;
+    }
 
-    m_JobSystem.BlockAndWait();
+    if ( m_fAccumulatorMs >= m_fFixedStepMs )
+    {
+        B33_WARNING( L"EngineLoop: simulation can't keep up, dropping %f ms", m_fAccumulatorMs - m_fFixedStepMs );
+        m_fAccumulatorMs = fmod( m_fAccumulatorMs, m_fFixedStepMs );
+    }
 
-    for ( auto component : m_Components )
-        component->Update( m_ComponentBridge, fDelta );
+    m_ComponentBridge.m_fInterpolationAlpha = m_fAccumulatorMs / m_fFixedStepMs;
+    RunSchedule( m_FrameSchedule, fDelta );
 }
 
 void EngineLoop::DestroyComponents()
 {
-    for ( int i = m_AsyncComponents.size() - 1; i >= 0; --i )
-        m_AsyncComponents[ i ]->Destroy( m_ComponentBridge );
-
     for ( int i = m_Components.size() - 1; i >= 0; --i )
         m_Components[ i ]->Destroy( m_ComponentBridge );
+
+    m_Schedule.clear();
+    m_PreFixedSchedule.clear();
+    m_FixedSchedule.clear();
+    m_FrameSchedule.clear();
+    m_bScheduleDirty = true;
+}
+
+void EngineLoop::SetFixedTimestep( float fHz, uint32_t uMaxStepsPerFrame )
+{
+    B33_ASSERT_MSG( fHz >= 0.f, "Fixed timestep rate can't be negative" );
+
+    m_fFixedStepMs   = fHz > 0.f ? 1000.f / fHz : 0.f;
+    m_fAccumulatorMs = 0.f;
+    m_uMaxFixedSteps = max( uMaxStepsPerFrame, 1u );
+}
+
+void EngineLoop::RunSchedule( const vector<ScheduleStage> &schedule, float fDelta )
+{
+    for ( const auto &stage : schedule )
+    {
+        for ( IComponent *component : stage.Async )
+            m_JobSystem.PushJob(
+                [ this, component, fDelta ]()
+                {
+                    component->Update( m_ComponentBridge, fDelta );
+                } );
+
+        for ( IComponent *component : stage.Main )
+            component->Update( m_ComponentBridge, fDelta );
+
+        if ( !stage.Async.empty() )
+            m_JobSystem.BlockAndWait();
+    }
 }
 
 void EngineLoop::AddComponentInternal( ::std::string_view componentName )
@@ -49,9 +106,9 @@ void EngineLoop::AddComponentInternal( ::std::string_view componentName )
     B33_ASSERT_MSG( m_ComponentRegistry.find( componentName ) != m_ComponentRegistry.end(),
                     "That component isn't registered. B33COMPONENT macro might be missing in the class body. " );
 
-    m_ComponentBridge.m_ComponentMap[ componentName ] = m_ComponentRegistry[ componentName ]();
-
-    auto component = ( m_ComponentBridge.m_ComponentMap[ componentName ] ).get();
+    auto component = m_ComponentBridge.AddComponent( componentName,
+                                                     m_ComponentIdRegistry[ componentName ],
+                                                     m_ComponentRegistry[ componentName ]() );
     switch ( component->GetComponentType() )
     {
         case Abstract:
@@ -59,26 +116,144 @@ void EngineLoop::AddComponentInternal( ::std::string_view componentName )
             throw B33_EXCEPT( "Component type is abstract? Shouldn't be created." );
         }
         case Default:
+        case Async:
         {
             if ( m_bInitialized )
                 component->Initialize( m_ComponentBridge );
 
+            m_ComponentNames.push_back( componentName );
             m_Components.push_back( component );
+            m_bScheduleDirty = true;
             break;
         }
-        case Async:
+        default:
         {
-            if ( m_bInitialized )
-                component->Initialize( m_ComponentBridge );
+            B33_ASSERT_MSG( false, "Unknown component type" );
+        }
+    }
+}
 
-            m_AsyncComponents.push_back( component );
-            break;
+void EngineLoop::BuildSchedule()
+{
+    const size_t                  uCount = m_Components.size();
+    vector<ComponentDependencies> deps;
+    vector<bool>                  bBeforeFixed( uCount, false );
+    vector<bool>                  bAfterFixed( uCount, false );
+    vector<size_t>                all;
+    vector<size_t>                preFixed;
+    vector<size_t>                fixed;
+    vector<size_t>                frame;
+
+    for ( size_t i = 0; i < uCount; ++i )
+    {
+        deps.push_back( m_Components[ i ]->GetDependencies() );
+        deps.back().Writes.push_back( m_ComponentNames[ i ] );
+    }
+
+    auto isFixed = [ this ]( size_t i )
+    {
+        return m_Components[ i ]->GetComponentTick() == Fixed;
+    };
+
+    // Edges go from earlier to later components over both tick groups. Frame components that lead to a fixed one
+    // run before the fixed steps, the rest after them.
+    for ( size_t j = 0; j < uCount; ++j )
+        for ( size_t i = 0; i < j; ++i )
+            if ( Conflicts( deps[ i ], deps[ j ] ) && ( isFixed( i ) || bAfterFixed[ i ] ) )
+                bAfterFixed[ j ] = true;
+
+    for ( size_t i = uCount; i-- > 0; )
+        for ( size_t j = i + 1; j < uCount; ++j )
+            if ( Conflicts( deps[ i ], deps[ j ] ) && ( isFixed( j ) || bBeforeFixed[ j ] ) )
+                bBeforeFixed[ i ] = true;
+
+    for ( size_t i = 0; i < uCount; ++i )
+    {
+        all.push_back( i );
+
+        if ( isFixed( i ) )
+        {
+            fixed.push_back( i );
         }
-        default:
+        else if ( bBeforeFixed[ i ] )
         {
-            B33_ASSERT_MSG( false, "Unknown component type" );
+            if ( bAfterFixed[ i ] )
+            {
+                const wstring name( m_ComponentNames[ i ].begin(), m_ComponentNames[ i ].end() );
+                B33_WARNING( L"EngineLoop: %ls depends on fixed step components on both sides, it runs before the "
+                             L"fixed steps and sees their state from the previous frame",
+                             name.c_str() );
+            }
+
+            preFixed.push_back( i );
+        }
+        else
+        {
+            frame.push_back( i );
+        }
+    }
+
+    m_Schedule         = BuildStages( all, deps );
+    m_PreFixedSchedule = BuildStages( preFixed, deps );
+    m_FixedSchedule    = BuildStages( fixed, deps );
+    m_FrameSchedule    = BuildStages( frame, deps );
+
+    B33_INFO( L"EngineLoop: %zu components scheduled in %zu stages, %zu before, %zu in and %zu after the fixed steps",
+              uCount,
+              m_Schedule.size(),
+              m_PreFixedSchedule.size(),
+              m_FixedSchedule.size(),
+              m_FrameSchedule.size() );
+    m_bScheduleDirty = false;
+}
+
+bool EngineLoop::Conflicts( const ComponentDependencies &lhs, const ComponentDependencies &rhs )
+{
+    auto touches = []( const vector<string_view> &lhs, const vector<string_view> &rhs )
+    {
+        for ( const auto &name : lhs )
+            if ( find( rhs.begin(), rhs.end(), name ) != rhs.end() )
+                return true;
+
+        return false;
+    };
+
+    return lhs.bExclusive || rhs.bExclusive || touches( lhs.Writes, rhs.Writes ) || touches( lhs.Writes, rhs.Reads ) ||
+           touches( lhs.Reads, rhs.Writes );
+}
+
+vector<EngineLoop::ScheduleStage> EngineLoop::BuildStages( const vector<size_t>                &members,
+                                                           const vector<ComponentDependencies> &deps )
+{
+    const size_t   uCount  = members.size();
+    vector<size_t> stageOf( uCount, 0 );
+    size_t         uStages = 0;
+
+    // Edge from earlier to later component whenever they touch the same component and at least one of them writes,
+    // registration order decides the direction so B33_CREATE_COMPONENTS stays meaningful.
+    for ( size_t j = 0; j < uCount; ++j )
+    {
+        for ( size_t i = 0; i < j; ++i )
+        {
+            if ( Conflicts( deps[ members[ i ] ], deps[ members[ j ] ] ) )
+                stageOf[ j ] = max( stageOf[ j ], stageOf[ i ] + 1 );
         }
+
+        uStages = max( uStages, stageOf[ j ] + 1 );
     }
+
+    vector<ScheduleStage> stages( uStages );
+    for ( size_t i = 0; i < uCount; ++i )
+    {
+        IComponent *component = m_Components[ members[ i ] ];
+
+        if ( component->GetComponentType() == Async )
+            stages[ stageOf[ i ] ].Async.push_back( component );
+        else
+            stages[ stageOf[ i ] ].Main.push_back( component );
+    }
+
+    return stages;
 }
 
 } // namespace B33::System
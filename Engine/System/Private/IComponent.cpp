@@ -8,9 +8,14 @@ namespace B33::System
 using namespace std;
 using namespace B33;
 
-void ComponentInstanceRegister::RegisterInternal( const ::std::string_view &className, ComponentFactory factory )
+size_t ComponentInstanceRegister::RegisterInternal( const ::std::string_view &className, ComponentFactory factory )
 {
+    auto itId = EngineLoop::m_ComponentIdRegistry.find( className );
+    if ( itId == EngineLoop::m_ComponentIdRegistry.end() )
+        itId = EngineLoop::m_ComponentIdRegistry.emplace( className, EngineLoop::m_ComponentIdRegistry.size() ).first;
+
     EngineLoop::m_ComponentRegistry[ className ] = factory;
+    return itId->second;
 }
 
 } // namespace B33::System
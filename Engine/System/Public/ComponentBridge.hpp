@@ -3,6 +3,10 @@
 
 #include "IComponent.hpp"
 
+#if defined( _DEBUG ) && !defined( B33_UNCHECKED_COMPONENT_QUERIES )
+#    define B33_CHECKED_COMPONENT_QUERIES
+#endif
+
 namespace B33::System
 {
 
@@ -12,7 +16,10 @@ class ComponentBridge
 
   public:
     ComponentBridge()
-      : m_ComponentMap()
+      : m_Components()
+      , m_ComponentIds()
+      , m_fInterpolationAlpha( 1.f )
+      , m_DeltaSource()
     {
     }
 
@@ -25,23 +32,70 @@ class ComponentBridge
     ComponentBridge &operator=( ComponentBridge && )      = delete;
 
   public:
+    /**
+     * @brief Looks the component up by its name, meant for tooling. Use typed query in a hot path.
+     */
     BEAST_API IComponent &QueryComponent( ::std::string strComponentName )
     {
-        B33_ASSERT( m_ComponentMap.find( strComponentName ) != m_ComponentMap.end() );
-        return *m_ComponentMap[ strComponentName ].get();
+        auto itId = m_ComponentIds.find( strComponentName );
+        B33_ASSERT( itId != m_ComponentIds.end() );
+        return *m_Components[ itId->second ].get();
     }
 
+    /**
+     * @brief Returns component by its registration id, define B33_UNCHECKED_COMPONENT_QUERIES to skip type checks
+     * in debug builds.
+     */
     template <class COMPONENT_DERIVED>
     COMPONENT_DERIVED &QueryComponent()
     {
-        B33_ASSERT( m_ComponentMap.find( COMPONENT_DERIVED::GetComponentName() ) != m_ComponentMap.end() );
-        IComponent        *result        = m_ComponentMap[ COMPONENT_DERIVED::GetComponentName() ].get();
-        COMPONENT_DERIVED *resultDerived = dynamic_cast<COMPONENT_DERIVED *>( result );
-        return *resultDerived;
+        const ::size_t uId = COMPONENT_DERIVED::GetComponentId();
+
+#if defined( B33_CHECKED_COMPONENT_QUERIES )
+        B33_ASSERT_MSG( uId < m_Components.size() && m_Components[ uId ] != nullptr,
+                        "Component isn't created by this EngineLoop." );
+        B33_ASSERT_MSG( dynamic_cast<COMPONENT_DERIVED *>( m_Components[ uId ].get() ) != nullptr,
+                        "Component id doesn't match queried type." );
+#endif
+
+        return *static_cast<COMPONENT_DERIVED *>( m_Components[ uId ].get() );
+    }
+
+    /**
+     * @brief Position of the current frame between the last two fixed steps, 0 is the previous step, 1 the last one.
+     * Always 1 when EngineLoop runs without a fixed timestep.
+     */
+    float GetInterpolationAlpha() const
+    {
+        return m_fInterpolationAlpha;
+    }
+
+    /**
+     * @brief Lets a component replace the delta of the coming frames, ex. with the deltas of a replayed recording.
+     * The source is asked before every UpdateComponents, the measured delta is used while it returns false.
+     */
+    void SetDeltaSource( ::std::function<bool( float & )> deltaSource )
+    {
+        m_DeltaSource = ::std::move( deltaSource );
+    }
+
+  private:
+    IComponent *AddComponent( ::std::string_view componentName, ::size_t uId, ComponentInstance component )
+    {
+        if ( uId >= m_Components.size() )
+            m_Components.resize( uId + 1 );
+
+        m_Components[ uId ]             = ::std::move( component );
+        m_ComponentIds[ componentName ] = uId;
+
+        return m_Components[ uId ].get();
     }
 
   private:
-    ::std::unordered_map<::std::string_view, ::std::unique_ptr<IComponent>> m_ComponentMap = {};
+    ::std::vector<ComponentInstance>                   m_Components          = {};
+    ::std::unordered_map<::std::string_view, ::size_t> m_ComponentIds        = {};
+    float                                              m_fInterpolationAlpha = 1.f;
+    ::std::function<bool( float & )>                   m_DeltaSource         = {};
 };
 
 } // namespace B33::System
@@ -22,6 +22,8 @@ struct ComponentOrderRegister
 
   public:
     BEAST_API static ComponentOrderRegister RegisterOrder( ::std::vector<::std::string_view> order );
+
+    BEAST_API static ComponentOrderRegister RegisterFixedTimestep( float fHz );
 };
 
 /**
@@ -35,5 +37,12 @@ struct ComponentOrderRegister
     static ::B33::System::ComponentOrderRegister g_ComponentOrder =                                                    \
         ::B33::System::ComponentOrderRegister::RegisterOrder( { __VA_ARGS__ } );
 
+/**
+* @brief Makes every EngineLoop object run B33_COMPONENT_FIXED_STEP components at a fixed rate of HZ updates per second.
+*/
+#define B33_FIXED_TIMESTEP( HZ )                                                                                       \
+    static ::B33::System::ComponentOrderRegister g_FixedTimestep =                                                     \
+        ::B33::System::ComponentOrderRegister::RegisterFixedTimestep( HZ );
+
 } // namespace B33::System
 #endif // !B33_COMPONENTS_ORDER_HPP
@@ -17,11 +17,22 @@ class EngineLoop
 
   public:
     EngineLoop()
-      : m_Components()
+      : m_ComponentNames()
+      , m_Components()
+      , m_Schedule()
+      , m_PreFixedSchedule()
+      , m_FixedSchedule()
+      , m_FrameSchedule()
       , m_ComponentBridge()
       , m_JobSystem()
+      , m_fFixedStepMs( 0.f )
+      , m_fAccumulatorMs( 0.f )
+      , m_uMaxFixedSteps( DefaultMaxFixedSteps )
       , m_bInitialized( false )
+      , m_bScheduleDirty( true )
     {
+        if ( m_fFixedTimestepRegistry > 0.f )
+            SetFixedTimestep( m_fFixedTimestepRegistry );
     }
 
     ~EngineLoop() = default;
@@ -44,7 +55,10 @@ class EngineLoop
     BEAST_API void InitializeComponents();
 
     /**
-     * @brief Updates components in the order described in B33_ORDER_COMPONENTS, every component gets last fDelta
+     * @brief Updates components, every component gets last fDelta. Components that don't depend on each other are
+     * updated in parallel, conflicting ones keep the order described in B33_ORDER_COMPONENTS. With fixed timestep
+     * enabled, fixed step components are updated with the step instead, as many times as accumulated time allows.
+     * Frame components a fixed step component depends on are updated before the steps, the rest after them.
      *
      * @param fDelta Time diffrence in ms between two subsequent calls
      */
@@ -55,21 +69,68 @@ class EngineLoop
      */
     BEAST_API void DestroyComponents();
 
+  public:
+    /**
+     * @brief Switches loop in to the accumulator mode. Fixed step components are updated fHz times per second,
+     * frame components once per UpdateComponents with the interpolation alpha available in ComponentBridge.
+     *
+     * @param fHz Simulation rate, 0 disables the fixed timestep
+     * @param uMaxStepsPerFrame Limit of simulation steps in one frame, remaining time is dropped after a spike
+     */
+    BEAST_API void SetFixedTimestep( float fHz, ::uint32_t uMaxStepsPerFrame = DefaultMaxFixedSteps );
+
+    bool IsFixedTimestep() const
+    {
+        return m_fFixedStepMs > 0.f;
+    }
+  private:
+    static constexpr ::uint32_t DefaultMaxFixedSteps = 8;
+
+    /**
+     * @brief Group of components without any dependencies between them. Async components are updated on the job
+     * system, the rest on the calling thread. Stages are separated by a fence.
+     */
+    struct ScheduleStage
+    {
+        ::std::vector<IComponent *> Async = {};
+        ::std::vector<IComponent *> Main  = {};
+    };
+
   private:
     BEAST_API void AddComponentInternal( ::std::string_view componentName );
 
+    BEAST_API void BuildSchedule();
+
+    BEAST_API ::std::vector<ScheduleStage> BuildStages( const ::std::vector<::size_t>                &members,
+                                                        const ::std::vector<ComponentDependencies> &deps );
+
+    static bool Conflicts( const ComponentDependencies &lhs, const ComponentDependencies &rhs );
+
+    BEAST_API void RunSchedule( const ::std::vector<ScheduleStage> &schedule, float fDelta );
+
   private:
     static inline ::std::unordered_map<::std::string_view, ComponentFactory> m_ComponentRegistry      = {};
+    static inline ::std::unordered_map<::std::string_view, ::size_t>         m_ComponentIdRegistry    = {};
     static inline ::std::vector<::std::string_view>                          m_ComponentOrderRegistry = {};
+    static inline float                                                      m_fFixedTimestepRegistry = 0.f;
 
-    ::std::vector<IComponent *> m_Components      = {};
-    ::std::vector<IComponent *> m_AsyncComponents = {};
-    ComponentBridge             m_ComponentBridge = {};
+    ::std::vector<::std::string_view> m_ComponentNames   = {};
+    ::std::vector<IComponent *>       m_Components       = {};
+    ::std::vector<ScheduleStage>      m_Schedule         = {};
+    ::std::vector<ScheduleStage>      m_PreFixedSchedule = {};
+    ::std::vector<ScheduleStage>      m_FixedSchedule    = {};
+    ::std::vector<ScheduleStage>      m_FrameSchedule    = {};
+    ComponentBridge                   m_ComponentBridge  = {};
 
     ::B33::Core::JobSystem m_JobSystem = {};
 
+    float      m_fFixedStepMs   = 0.f;
+    float      m_fAccumulatorMs = 0.f;
+    ::uint32_t m_uMaxFixedSteps = DefaultMaxFixedSteps;
+
 
-    bool m_bInitialized = false;
+    bool m_bInitialized   = false;
+    bool m_bScheduleDirty = true;
 };
 
 } // namespace B33::System
@@ -13,6 +13,24 @@ enum EComponentType
     Async,
 };
 
+enum EComponentTick
+{
+    Frame,
+    Fixed,
+};
+
+/**
+ * @brief Describes which components are touched by a component during its Update.
+ * Names are the same as the ones used in B33_CREATE_COMPONENTS. Every component implicitly writes to itself.
+ * Component that doesn't declare anything is treated as exclusive and runs alone, in the registered order.
+ */
+struct ComponentDependencies
+{
+    ::std::vector<::std::string_view> Reads      = {};
+    ::std::vector<::std::string_view> Writes     = {};
+    bool                              bExclusive = false;
+};
+
 class IComponent;
 using ComponentInstance = ::std::unique_ptr<IComponent>;
 using ComponentFactory  = ComponentInstance ( * )();
@@ -25,6 +43,16 @@ class IComponent
         return ::B33::System::EComponentType::Abstract;
     }
 
+    virtual ::B33::System::EComponentTick GetComponentTick()
+    {
+        return ::B33::System::EComponentTick::Frame;
+    }
+
+    virtual ::B33::System::ComponentDependencies GetDependencies()
+    {
+        return { .bExclusive = true };
+    }
+
   public:
     virtual ~IComponent() = default;
 
@@ -37,7 +65,10 @@ class IComponent
 struct ComponentInstanceRegister
 {
   private:
-    ComponentInstanceRegister() = default;
+    explicit ComponentInstanceRegister( ::size_t uId )
+      : m_uId( uId )
+    {
+    }
 
   public:
     ~ComponentInstanceRegister() = default;
@@ -57,12 +88,23 @@ struct ComponentInstanceRegister
 
     static ComponentInstanceRegister Register( const ::std::string_view &className, ComponentFactory factory )
     {
-        RegisterInternal( className, factory );
-        return {};
+        return ComponentInstanceRegister( RegisterInternal( className, factory ) );
+    }
+
+  public:
+    /**
+     * @brief Dense index of the component, assigned in the registration order
+     */
+    ::size_t GetId() const
+    {
+        return m_uId;
     }
 
   private:
-    BEAST_API static void RegisterInternal( const ::std::string_view &className, ComponentFactory factory );
+    BEAST_API static ::size_t RegisterInternal( const ::std::string_view &className, ComponentFactory factory );
+
+  private:
+    ::size_t m_uId = -1;
 };
 
 #define B33_COMPONENT_HELPER( CLASS_NAME )                                                                             \
@@ -74,6 +116,10 @@ struct ComponentInstanceRegister
     static ::std::string_view GetComponentName()                                                                       \
     {                                                                                                                  \
         return #CLASS_NAME;                                                                                            \
+    }                                                                                                                  \
+    static ::size_t GetComponentId()                                                                                   \
+    {                                                                                                                  \
+        return RegisteredComponent.GetId();                                                                            \
     }                                                                                                                  \
                                                                                                                        \
   private:                                                                                                             \
@@ -103,5 +149,31 @@ struct ComponentInstanceRegister
                                                                                                                        \
   private:
 
+/**
+ * @brief Declares components read and written by this component during Update, ex.
+ * B33_COMPONENT_DEPENDENCIES( .Reads = { "MainWindow" }, .Writes = { "MyGame" } )
+ */
+#define B33_COMPONENT_DEPENDENCIES( ... )                                                                              \
+  public:                                                                                                              \
+    virtual ::B33::System::ComponentDependencies GetDependencies() override                                            \
+    {                                                                                                                  \
+        return { __VA_ARGS__ };                                                                                        \
+    }                                                                                                                  \
+                                                                                                                       \
+  private:
+
+/**
+ * @brief Marks component as a simulation component. When EngineLoop runs with a fixed timestep, its Update is called
+ * with the fixed step, zero or more times per frame. Frame components it depends on are updated before the steps.
+ */
+#define B33_COMPONENT_FIXED_STEP()                                                                                     \
+  public:                                                                                                              \
+    virtual ::B33::System::EComponentTick GetComponentTick() override                                                  \
+    {                                                                                                                  \
+        return ::B33::System::EComponentTick::Fixed;                                                                   \
+    }                                                                                                                  \
+                                                                                                                       \
+  private:
+
 } // namespace B33::System
 #endif // !B33_ICOMPONENT_H
@@ -20,7 +20,9 @@
 #include "B33Core.h"
 
 #include "Primitives/ColoredCube.hpp"
+#include "Raycaster/TerrainGenerator.hpp"
 #include "Raycaster/VoxelGrid.hpp"
+#include "Raycaster/WorldFile.hpp"
 #include "Vec3.hpp"
 
 namespace Layers
@@ -304,25 +306,58 @@ class World : public ::B33::Rendering::CubeWorld
     World()
       : ::B33::Rendering::CubeWorld()
     {
-        GenerateFloor();
+        // Saved maps skip the generation, the first run writes the generated one to the file
+        const char *pszWorld = ::std::getenv( "B33_WORLD_FILE" );
+        if ( pszWorld != nullptr && LoadWorld( pszWorld ) )
+            return;
+
+        // Procedural terrain instead of the flat floor
+        const char *pszTerrainSeed = ::std::getenv( "B33_TERRAIN_SEED" );
+        if ( pszTerrainSeed != nullptr )
+            GenerateTerrain( static_cast<uint32_t>( ::std::strtoul( pszTerrainSeed, nullptr, 10 ) ) );
+        else
+            GenerateFloor();
+
+        if ( pszWorld != nullptr && !::std::filesystem::exists( pszWorld ) )
+        {
+            ::B33::Core::JobSystem jobSystem = {};
+            ::B33::Rendering::WorldFile::Save( pszWorld, *this, jobSystem );
+        }
     }
 
   private:
+    bool LoadWorld( const char *pszWorld )
+    {
+        ::B33::Rendering::WorldFile worldFile = {};
+        ::B33::Core::JobSystem      jobSystem = {};
+
+        if ( !worldFile.Open( pszWorld ) )
+            return false;
+
+        if ( worldFile.Load( *this, jobSystem ) )
+            return true;
+
+        // Chunks decoded before the failure would stay under the generated world
+        const int32_t iLast = static_cast<int32_t>( this->GetGridWidth() ) - 1;
+
+        this->ClearBox( B33::Math::iVec3( 0, 0, 0 ), B33::Math::iVec3( iLast, iLast, iLast ) );
+        return false;
+    }
+
     void GenerateFloor()
     {
-        const size_t                  uDim = this->GetGridWidth();
-        ::B33::Rendering::ColoredCube cc   = {};
+        const int32_t iLast = static_cast<int32_t>( this->GetGridWidth() ) - 1;
 
-        for ( uint32_t z = 0; z < uDim; ++z )
-        {
-            for ( uint32_t y = 0; y < 2; ++y )
-            {
-                for ( uint32_t x = 0; x < uDim; ++x )
-                {
-                    this->SetVoxel( B33::Math::iVec3( x, y, z ), 0x101010FF );
-                }
-            }
-        }
+        this->FillBox( B33::Math::iVec3( 0, 0, 0 ), B33::Math::iVec3( iLast, 1, iLast ), 0x101010FF );
+    }
+
+    void GenerateTerrain( uint32_t uSeed )
+    {
+        ::B33::Rendering::TerrainParams params = {};
+        params.uSeed                           = uSeed;
+
+        ::B33::Rendering::TerrainGenerator generator( this->GetGridWidth(), params );
+        generator.GenerateAll( *this );
     }
 };
 
@@ -444,6 +479,8 @@ class Game
 
     void Update( float fDelta )
     {
+        m_pWorld->StoreTransforms();
+
         for ( auto &inWorldCube : m_vInWorldObjects )
             inWorldCube.Update( fDelta );
 
@@ -8,16 +8,47 @@ void MainWindow::Initialize( ::B33::System::ComponentBridge &bridge )
     m_WindowInstance.Create();
     m_WindowPuppet.BindToInput( m_WindowInstance.GetInput().lock() );
     m_WindowInstance.GetInput().lock()->StartCapturing();
+
+    // Reproducible benchmark runs, record a session once and replay it instead of the keyboard and mouse
+    if ( const char *pszReplay = ::std::getenv( "B33_REPLAY_INPUT" ) )
+    {
+        m_bReplayRun = m_WindowInstance.GetInput().lock()->StartReplay( pszReplay );
+
+        // Frames run with the recorded deltas, so the fixed steps and the actions see what they saw while recording
+        if ( m_bReplayRun )
+        {
+            bridge.SetDeltaSource(
+                [ this ]( float &fDelta )
+                {
+                    auto pInput = m_WindowInstance.GetInput().lock();
+                    return pInput && pInput->PeekReplayDelta( fDelta );
+                } );
+        }
+    }
+    else if ( const char *pszRecord = ::std::getenv( "B33_RECORD_INPUT" ) )
+    {
+        m_WindowInstance.GetInput().lock()->StartRecording( pszRecord );
+    }
 }
 
 void MainWindow::Update( ::B33::System::ComponentBridge &bridge, float fDelta )
 {
     m_WindowInstance.Update( fDelta );
     m_WindowInstance.GetInput().lock()->Update( fDelta );
+
+    // Replay finished, close the window so the run ends on its own
+    if ( m_bReplayRun && !m_WindowInstance.GetInput().lock()->IsReplaying() )
+    {
+        B33_LOG( ::B33::Core::Debug::Info, L"Input replay finished, closing the benchmark run." );
+        m_bReplayRun = false;
+        bridge.SetDeltaSource( nullptr );
+        m_WindowInstance.Destroy();
+    }
 }
 
 void MainWindow::Destroy( ::B33::System::ComponentBridge &bridge )
 {
+    m_WindowInstance.GetInput().lock()->StopRecording();
     m_WindowInstance.GetInput().lock()->StopCapturing();
     m_WindowInstance.Destroy();
 }
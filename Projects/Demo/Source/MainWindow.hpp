@@ -7,15 +7,19 @@
 #include "Window/WindowPolicy/GameSystemPolicy.hpp"
 
 B33_CREATE_COMPONENTS( "MainWindow", "MyGame", "Renderer" )
+B33_FIXED_TIMESTEP( 60.f )
 
 class MainWindow : public ::B33::System::IComponent
 {
     B33_COMPONENT( MainWindow );
+    // Input actions move the character and toggle renderer debug mode
+    B33_COMPONENT_DEPENDENCIES( .Writes = { "MyGame", "Renderer" } );
 
   public:
     MainWindow()
       : m_WindowInstance( L"Cool Game", 1200, 700 )
       , m_WindowPuppet( m_WindowInstance )
+      , m_bReplayRun( false )
     {
     }
 
@@ -33,4 +37,5 @@ class MainWindow : public ::B33::System::IComponent
   private:
     ::B33::App::EmptyCanvas<true, ::B33::App::DefaultGameSystemWindowPolicy> m_WindowInstance;
     WindowMasterPuppet                                                       m_WindowPuppet;
+    bool                                                                     m_bReplayRun;
 };
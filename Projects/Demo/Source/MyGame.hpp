@@ -7,6 +7,8 @@
 class MyGame : public ::B33::System::IComponent
 {
     B33_ASYNC_UPDATE_COMPONENT( MyGame );
+    B33_COMPONENT_DEPENDENCIES();
+    B33_COMPONENT_FIXED_STEP();
 
   public:
     MyGame()
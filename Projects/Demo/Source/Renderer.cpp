@@ -15,9 +15,27 @@ void Renderer::Initialize( ::B33::System::ComponentBridge &bridge )
     }
 
     m_RendererInstance.Initialize( bridge.QueryComponent<MainWindow>().GetWindowInstance().GetWindowDesc() );
+    m_RendererInstance.SetGpuBudget( m_FrameLimiter.GetTarget() );
 
-    m_RendererInstance.PushPipeline<::B33::Rendering::VoxelPipeline>(
-        bridge.QueryComponent<MyGame>().GetGameInstance().GetWorld() );
+    auto pWorld = bridge.QueryComponent<MyGame>().GetGameInstance().GetWorld();
+
+    // Same terrain continues outside of the grid
+    const char *pszTerrainSeed = ::std::getenv( "B33_TERRAIN_SEED" );
+    if ( pszTerrainSeed != nullptr )
+    {
+        ::B33::Rendering::TerrainParams params = {};
+        params.uSeed                           = static_cast<uint32_t>( ::std::strtoul( pszTerrainSeed, nullptr, 10 ) );
+
+        ::B33::Rendering::ChunkStreamerDesc desc = {};
+        desc.uGridWidth                          = pWorld->GetGridWidth();
+
+        m_pChunkStreamer = ::std::make_shared<::B33::Rendering::ChunkStreamer>(
+            ::B33::Rendering::ChunkStreamer::FromGenerator(
+                ::std::make_shared<::B33::Rendering::TerrainGenerator>( pWorld->GetGridWidth(), params ) ),
+            desc );
+    }
+
+    m_RendererInstance.PushPipeline<::B33::Rendering::VoxelPipeline>( pWorld, m_pChunkStreamer );
 
     m_RendererInstance.PushPipeline<::B33::Rendering::EditorPipeline>();
 }
@@ -42,13 +60,53 @@ void Renderer::Update( ::B33::System::ComponentBridge &bridge, float fDelta )
     constants.GridSize                           = iVec3( uWorldWidth, uWorldWidth, uWorldWidth );
     constants.uMode                              = m_RendererMaster.GetGameMaster().GetDebugMode();
 
+    gameHandle.GetWorld()->InterpolateTransforms( bridge.GetInterpolationAlpha() );
+
+    if ( m_pChunkStreamer )
+        m_pChunkStreamer->Update( characterHandle, rotVec );
+
     m_RendererInstance.GetPipeline( 0 )->LoadPushConstants( constants, sizeof( constants ) );
     m_RendererInstance.GetPipeline( 1 )->LoadPushConstants( constants, sizeof( constants ) );
     m_RendererInstance.Update( fDelta );
     m_RendererInstance.Render();
+
+    m_FrameLimiter.ReportPresent( m_RendererInstance.GetLastPresentTime() );
+
+    // Oldest input consumed this frame up to the present call, a lower bound of input to photon latency
+    auto input = bridge.QueryComponent<MainWindow>().GetWindowInstance().GetInput().lock();
+    if ( input && input->GetOldestInputTimestamp() != 0 )
+    {
+        const uint64_t uPresentTime = ::std::chrono::duration_cast<::std::chrono::microseconds>(
+                                          m_RendererInstance.GetLastPresentTime().time_since_epoch() )
+                                          .count();
+
+        if ( uPresentTime > input->GetOldestInputTimestamp() )
+        {
+            m_fInputLatencySumMs += ( uPresentTime - input->GetOldestInputTimestamp() ) / 1000.;
+            ++m_uInputLatencySamples;
+        }
+    }
+
+    m_FrameLimiter.Pace();
 }
 
 void Renderer::Destroy( ::B33::System::ComponentBridge &bridge )
 {
+    const auto stats = m_FrameLimiter.GetStats();
+    B33_INFO( L"Frame pacing: target %f ms, mean %f ms, std dev %f ms, max error %f ms, missed %u of %u",
+              stats.fTargetMs,
+              stats.fMeanMs,
+              stats.fStdDevMs,
+              stats.fMaxErrorMs,
+              stats.uMissed,
+              stats.uSamples );
+
+    if ( m_uInputLatencySamples )
+    {
+        B33_INFO( L"Input to present latency: mean %f ms over %u frames with input",
+                  m_fInputLatencySumMs / m_uInputLatencySamples,
+                  m_uInputLatencySamples );
+    }
+
     m_RendererInstance.Destroy();
 }
@@ -1,18 +1,25 @@
 #pragma once
 
 #include "B33System.hpp"
+#include "Raycaster/ChunkStreamer.hpp"
 #include "Raycaster/VoxelPipeline.hpp"
 #include "RendererMaster.hpp"
+#include "Synchronization/FpsLimiter.hpp"
 #include "Vulkan/Renderer.hpp"
 
 class Renderer : public ::B33::System::IComponent
 {
     B33_COMPONENT( Renderer );
+    B33_COMPONENT_DEPENDENCIES( .Reads = { "MainWindow", "MyGame" } );
 
   public:
     Renderer()
       : m_RendererInstance()
       , m_RendererMaster( m_RendererInstance )
+      , m_FrameLimiter( 1000.f / 144.f, ::B33::Core::EPacingMode::DeadlineSpin )
+      , m_fInputLatencySumMs( 0. )
+      , m_uInputLatencySamples( 0 )
+      , m_pChunkStreamer( nullptr )
     {
     }
 
@@ -24,4 +31,10 @@ class Renderer : public ::B33::System::IComponent
   private:
     ::B33::Rendering::Renderer m_RendererInstance = {};
     RendererMasterPuppet       m_RendererMaster;
+    ::B33::Core::FpsLimiter    m_FrameLimiter;
+    double                     m_fInputLatencySumMs;
+    uint32_t                   m_uInputLatencySamples;
+
+    // Terrain past the grid, only with B33_TERRAIN_SEED
+    ::std::shared_ptr<::B33::Rendering::ChunkStreamer> m_pChunkStreamer;
 };